@@ -3,8 +3,14 @@
 #include <golos/chain/account_object.hpp>
 #include <golos/chain/steem_objects.hpp>
 #include <golos/chain/curation_info.hpp>
+#include <golos/chain/operation_notification.hpp>
 #include <fc/io/json.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <memory>
+#include <tuple>
+#include <unordered_map>
 
 
 namespace golos { namespace api {
@@ -16,6 +22,26 @@ namespace golos { namespace api {
         return result;
     }
 
+    /**
+     * Values of the comment, which are derived from all its votes
+     */
+    struct comment_votes_info final {
+        /// Fields, which change on voting and payout, cached values are recalculated when they differ
+        using state_type = std::tuple<
+            time_point_sec, uint32_t, share_type, share_type, time_point_sec, protocol::curation_curve>;
+
+        state_type state;
+
+        protocol::curation_curve curve = protocol::curation_curve::detect;
+        uint64_t total_vote_weight = 0;
+        uint64_t auction_window_weight = 0;
+        uint64_t votes_in_auction_window_weight = 0;
+
+        std::vector<vote_state> active_votes; ///< sorted by weight, without reputations
+    };
+
+    using comment_votes_info_ptr = std::shared_ptr<const comment_votes_info>;
+
     struct discussion_helper::impl final {
     public:
         impl() = delete;
@@ -28,6 +54,9 @@ namespace golos { namespace api {
               fill_reputation_(fill_reputation),
               fill_promoted_(fill_promoted),
               fill_comment_info_(fill_comment_info) {
+            votes_cache_connection_ = db.post_apply_operation.connect([&](const operation_notification& note) {
+                note.op.visit(votes_cache_invalidator{*this});
+            });
         }
         ~impl() = default;
 
@@ -39,7 +68,11 @@ namespace golos { namespace api {
             const std::string& author, const std::string& permlink, uint32_t limit, uint32_t offset
         ) const;
 
-        std::vector<vote_state> select_active_votes(const comment_curation_info&, uint32_t limit, uint32_t offset) const;
+        std::vector<vote_state> select_active_votes(const comment_votes_info&, uint32_t limit, uint32_t offset) const;
+
+        comment_votes_info_ptr get_votes_info(const comment_object& comment) const;
+
+        void invalidate_votes_info(const account_name_type& author, const std::string& permlink);
 
         void set_pending_payout(discussion& d) const;
 
@@ -64,11 +97,47 @@ namespace golos { namespace api {
     private:
         void distribute_auction_tokens(discussion& d, share_type& curator_tokens, share_type& author_tokens) const;
 
+        comment_votes_info::state_type get_votes_state(const comment_object& comment) const;
+
+        struct votes_cache_invalidator {
+            using result_type = void;
+
+            impl& self;
+
+            template <typename Op>
+            void operator()(const Op&) const {
+            }
+
+            void operator()(const vote_operation& op) const {
+                self.invalidate_votes_info(op.author, op.permlink);
+            }
+
+            void operator()(const comment_operation& op) const {
+                self.invalidate_votes_info(op.author, op.permlink);
+            }
+
+            void operator()(const comment_options_operation& op) const {
+                self.invalidate_votes_info(op.author, op.permlink);
+            }
+
+            void operator()(const comment_payout_update_operation& op) const {
+                self.invalidate_votes_info(op.author, op.permlink);
+            }
+        };
+
+        /// The cache is cleared when it reaches this size, active comments are quickly cached again
+        static constexpr std::size_t max_votes_cache_size = 100000;
+
     private:
         golos::chain::database& database_;
         std::function<void(const golos::chain::database&, const account_name_type&, fc::optional<share_type>&)> fill_reputation_;
         std::function<void(const golos::chain::database&, discussion&)> fill_promoted_;
         std::function<void(const golos::chain::database&, const comment_object&, comment_api_object&)> fill_comment_info_;
+
+        // readers only look up the immutable value under the shared lock, it's calculated outside of the lock
+        mutable boost::shared_mutex votes_cache_mutex_;
+        mutable std::unordered_map<int64_t, comment_votes_info_ptr> votes_cache_;
+        boost::signals2::scoped_connection votes_cache_connection_;
     };
 
 // create_comment_api_object 
@@ -162,13 +231,13 @@ namespace golos { namespace api {
 
         d.active_votes_count = comment.total_votes;
 
-        comment_curation_info c{database_, comment, true};
+        auto info = get_votes_info(comment);
 
-        d.curation_reward_curve = c.curve;
-        d.total_vote_weight = c.total_vote_weight;
-        d.auction_window_weight = c.auction_window_weight;
-        d.votes_in_auction_window_weight = c.votes_in_auction_window_weight;
-        d.active_votes = select_active_votes(c, vote_limit, offset);
+        d.curation_reward_curve = info->curve;
+        d.total_vote_weight = info->total_vote_weight;
+        d.auction_window_weight = info->auction_window_weight;
+        d.votes_in_auction_window_weight = info->votes_in_auction_window_weight;
+        d.active_votes = select_active_votes(*info, vote_limit, offset);
 
         set_pending_payout(d);
     }
@@ -185,37 +254,25 @@ namespace golos { namespace api {
         const std::string& author, const std::string& permlink, uint32_t limit, uint32_t offset
     ) const {
         const auto& comment = database_.get_comment(author, permlink);
-        comment_curation_info c{database_, comment, true};
 
-        return select_active_votes(c, limit, offset);
+        return select_active_votes(*get_votes_info(comment), limit, offset);
     }
 
     std::vector<vote_state> discussion_helper::impl::select_active_votes(
-        const comment_curation_info& c, uint32_t limit, uint32_t offset
+        const comment_votes_info& info, uint32_t limit, uint32_t offset
     ) const {
-        offset = std::min(offset, uint32_t(c.vote_list.size()));
-        limit = std::min(limit, uint32_t(c.vote_list.size() - offset));
+        offset = std::min(offset, uint32_t(info.active_votes.size()));
+        limit = std::min(limit, uint32_t(info.active_votes.size() - offset));
 
         if (limit == 0) {
             return {};
         }
 
-        auto itr = c.vote_list.begin();
-        std::advance(itr, offset);
-
-        std::vector<vote_state> result;
-        result.reserve(limit);
+        auto itr = info.active_votes.begin() + offset;
+        std::vector<vote_state> result(itr, itr + limit);
 
-        for (; itr != c.vote_list.end() && result.size() < limit; ++itr) {
-            const auto& vo = database().get(itr->vote->voter);
-            vote_state vstate;
-            vstate.voter = vo.name;
-            vstate.weight = itr->weight;
-            vstate.rshares = itr->vote->rshares;
-            vstate.percent = itr->vote->vote_percent;
-            vstate.time = itr->vote->last_update;
-            fill_reputation_(database(), vo.name, vstate.reputation);
-            result.emplace_back(std::move(vstate));
+        for (auto& vstate: result) {
+            fill_reputation_(database(), vstate.voter, vstate.reputation);
         }
         return result;
     }
@@ -226,6 +283,64 @@ namespace golos { namespace api {
         return pimpl->select_active_votes(author, permlink, limit, offset);
     }
 
+//
+// get_votes_info
+    comment_votes_info::state_type discussion_helper::impl::get_votes_state(const comment_object& comment) const {
+        return std::make_tuple(
+            comment.created, comment.total_votes, comment.net_rshares, comment.vote_rshares, comment.last_payout,
+            database_.get_witness_schedule_object().median_props.curation_reward_curve);
+    }
+
+    comment_votes_info_ptr discussion_helper::impl::get_votes_info(const comment_object& comment) const {
+        // the state also protects from values of reverted blocks, which aren't passed to the invalidator
+        auto state = get_votes_state(comment);
+
+        {
+            boost::shared_lock<boost::shared_mutex> lock(votes_cache_mutex_);
+            auto itr = votes_cache_.find(comment.id._id);
+            if (itr != votes_cache_.end() && itr->second->state == state) {
+                return itr->second;
+            }
+        }
+
+        comment_curation_info c{database_, comment, true};
+
+        auto info = std::make_shared<comment_votes_info>();
+        info->state = state;
+        info->curve = c.curve;
+        info->total_vote_weight = c.total_vote_weight;
+        info->auction_window_weight = c.auction_window_weight;
+        info->votes_in_auction_window_weight = c.votes_in_auction_window_weight;
+        info->active_votes.reserve(c.vote_list.size());
+
+        for (const auto& vote: c.vote_list) {
+            vote_state vstate;
+            vstate.voter = database_.get(vote.vote->voter).name;
+            vstate.weight = vote.weight;
+            vstate.rshares = vote.vote->rshares;
+            vstate.percent = vote.vote->vote_percent;
+            vstate.time = vote.vote->last_update;
+            info->active_votes.emplace_back(std::move(vstate));
+        }
+
+        boost::unique_lock<boost::shared_mutex> lock(votes_cache_mutex_);
+        if (votes_cache_.size() >= max_votes_cache_size) {
+            votes_cache_.clear();
+        }
+        votes_cache_[comment.id._id] = info;
+        return info;
+    }
+
+    void discussion_helper::impl::invalidate_votes_info(const account_name_type& author, const std::string& permlink) {
+        const auto* comment = database_.find_comment(author, permlink);
+        if (comment == nullptr) {
+            return;
+        }
+
+        boost::unique_lock<boost::shared_mutex> lock(votes_cache_mutex_);
+        votes_cache_.erase(comment->id._id);
+    }
+
 //
 // set_pending_payout
 
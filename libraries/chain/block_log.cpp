@@ -1,10 +1,15 @@
 #include <algorithm>
 #include <fstream>
 #include <golos/chain/block_log.hpp>
+#include <golos/chain/compressed_block_file.hpp>
 #include <golos/protocol/exceptions.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
 
 namespace golos { namespace chain {
     namespace detail {
@@ -22,11 +27,13 @@ namespace golos { namespace chain {
             std::string index_path;
             boost::iostreams::mapped_file block_mapped_file;
             boost::iostreams::mapped_file index_mapped_file;
+            compressed_block_file compressed_file;
+            bool is_compressed = false;
+            bool is_read_only = false;
             read_write_mutex mutex;
 
             bool has_block_records() const {
-                auto size = block_mapped_file.size();
-                return (size > min_valid_file_size);
+                return (get_block_file_size() > min_valid_file_size);
             }
 
             bool has_index_records() const {
@@ -42,6 +49,13 @@ namespace golos { namespace chain {
                 return size;
             }
 
+            std::size_t get_block_file_size() const {
+                if (is_compressed) {
+                    return compressed_file.size();
+                }
+                return get_mapped_size(block_mapped_file);
+            }
+
             uint64_t get_uint64(const boost::iostreams::mapped_file& mapped_file, std::size_t pos) const {
                 uint64_t value;
                 auto file_size = get_mapped_size(mapped_file);
@@ -50,8 +64,8 @@ namespace golos { namespace chain {
                         "Reading data beyond end of file",
                         ("pos", pos)("size", sizeof(value))("file_size", file_size));
 
-                auto* ptr = mapped_file.data() + pos;
-                value = *reinterpret_cast<uint64_t*>(ptr);
+                auto* ptr = mapped_file.const_data() + pos;
+                value = *reinterpret_cast<const uint64_t*>(ptr);
                 return value;
             }
 
@@ -63,11 +77,32 @@ namespace golos { namespace chain {
                         "Reading data beyond end of file",
                         ("size", sizeof(value))("file_size", file_size));
 
-                auto* ptr = mapped_file.data() + file_size - sizeof(value);
-                value = *reinterpret_cast<uint64_t*>(ptr);
+                auto* ptr = mapped_file.const_data() + file_size - sizeof(value);
+                value = *reinterpret_cast<const uint64_t*>(ptr);
                 return value;
             }
 
+            uint64_t get_block_uint64(std::size_t pos) const {
+                if (is_compressed) {
+                    uint64_t value;
+                    compressed_file.read(pos, reinterpret_cast<char*>(&value), sizeof(value));
+                    return value;
+                }
+                return get_uint64(block_mapped_file, pos);
+            }
+
+            uint64_t get_last_block_uint64() const {
+                if (is_compressed) {
+                    auto file_size = compressed_file.size();
+                    GOLOS_CHECK_DATABASE(sizeof(uint64_t) <= file_size,
+                            database_corrupted::reading_data_beyond_end_of_file,
+                            "Reading data beyond end of file",
+                            ("size", sizeof(uint64_t))("file_size", file_size));
+                    return get_block_uint64(file_size - sizeof(uint64_t));
+                }
+                return get_last_uint64(block_mapped_file);
+            }
+
             uint64_t get_block_pos(uint32_t block_num) const {
                 if (head.valid() &&
                     block_num <= protocol::block_header::num_from_id(head_id) &&
@@ -78,22 +113,68 @@ namespace golos { namespace chain {
                 return block_log::npos;
             }
 
+            /**
+             * Size of the block in the compressed file: the number of the block is read from its header,
+             *   and the block ends at the position marker before the next block from the index.
+             * The index isn't known while it's reconstructed, then the size is limited by the max block size.
+             */
+            std::size_t get_compressed_block_size(uint64_t pos, std::size_t available_size) const {
+                static constexpr std::size_t max_header_size = 1024;
+
+                const auto max_block_size = std::min<std::size_t>(available_size, STEEMIT_MAX_BLOCK_SIZE);
+
+                std::vector<char> buffer(std::min(max_header_size, available_size));
+                compressed_file.read(pos, buffer.data(), buffer.size());
+                fc::datastream<const char*> ds(buffer.data(), buffer.size());
+                signed_block_header header;
+                fc::raw::unpack(ds, header);
+
+                const auto block_num = header.block_num();
+                uint64_t end_pos = block_log::npos;
+                if (head.valid() && block_num < protocol::block_header::num_from_id(head_id)) {
+                    end_pos = get_block_pos(block_num + 1);
+                } else if (pos == get_last_block_uint64()) {
+                    end_pos = get_block_file_size();
+                }
+
+                if (end_pos == block_log::npos || end_pos < pos + sizeof(uint64_t) || end_pos - pos > available_size) {
+                    return max_block_size;
+                }
+                return std::min<std::size_t>(end_pos - pos - sizeof(uint64_t), max_block_size);
+            }
+
+            std::size_t unpack_compressed_block(uint64_t pos, std::size_t available_size, signed_block& block) const {
+                std::vector<char> buffer(get_compressed_block_size(pos, available_size));
+                compressed_file.read(pos, buffer.data(), buffer.size());
+
+                fc::datastream<const char*> ds(buffer.data(), buffer.size());
+                fc::raw::unpack(ds, block);
+                return ds.tellp();
+            }
+
             uint64_t read_block(uint64_t pos, signed_block& block) const {
-                const auto file_size = get_mapped_size(block_mapped_file);
+                const auto file_size = get_block_file_size();
                 GOLOS_CHECK_DATABASE(pos < file_size,
                         database_corrupted::reading_data_beyond_end_of_file,
                         "Reading data beyond end of file",
                         ("pos", pos)("file_size", file_size));
 
-                const auto* ptr = block_mapped_file.data() + pos;
                 const auto available_size = file_size - pos;
-                const auto max_block_size = std::min<std::size_t>(available_size, STEEMIT_MAX_BLOCK_SIZE);
+                std::size_t block_size;
 
-                fc::datastream<const char*> ds(ptr, max_block_size);
-                fc::raw::unpack(ds, block);
+                if (is_compressed) {
+                    block_size = unpack_compressed_block(pos, available_size, block);
+                } else {
+                    const auto* ptr = block_mapped_file.const_data() + pos;
+                    const auto max_block_size = std::min<std::size_t>(available_size, STEEMIT_MAX_BLOCK_SIZE);
+
+                    fc::datastream<const char*> ds(ptr, max_block_size);
+                    fc::raw::unpack(ds, block);
+                    block_size = ds.tellp();
+                }
 
-                const auto end_pos = pos + ds.tellp();
-                const auto block_pos = get_uint64(block_mapped_file, end_pos);
+                const auto end_pos = pos + block_size;
+                const auto block_pos = get_block_uint64(end_pos);
                 GOLOS_CHECK_DATABASE(block_pos == pos,
                         database_corrupted::wrong_position_marker_was_read,
                         "Wrong position makers was read (read ${block_pos}, expected ${expected})",
@@ -102,8 +183,40 @@ namespace golos { namespace chain {
                 return end_pos + sizeof(uint64_t);
             }
 
+            bool read_serialized_block(uint32_t block_num, const block_log::serialized_block_visitor& visitor) const {
+                const auto pos = get_block_pos(block_num);
+                if (pos == block_log::npos) {
+                    return false;
+                }
+
+                // the block is followed by its position, and then by the next block
+                const auto end_pos = (block_num < protocol::block_header::num_from_id(head_id))
+                    ? get_block_pos(block_num + 1)
+                    : get_block_file_size();
+                GOLOS_CHECK_DATABASE(end_pos >= pos + sizeof(uint64_t),
+                        database_corrupted::wrong_position_marker_was_read,
+                        "Wrong position of the next block (read ${end_pos}, block position ${pos})",
+                        ("end_pos", end_pos)("pos", pos));
+
+                const auto size = end_pos - pos - sizeof(uint64_t);
+                const auto block_pos = get_block_uint64(pos + size);
+                GOLOS_CHECK_DATABASE(block_pos == pos,
+                        database_corrupted::wrong_position_marker_was_read,
+                        "Wrong position makers was read (read ${block_pos}, expected ${expected})",
+                        ("block_pos", block_pos)("expected", pos));
+
+                if (is_compressed) {
+                    std::vector<char> data(size);
+                    compressed_file.read(pos, data.data(), size);
+                    visitor(data.data(), size);
+                } else {
+                    visitor(block_mapped_file.const_data() + pos, size);
+                }
+                return true;
+            }
+
             signed_block read_head() const {
-                auto pos = get_last_uint64(block_mapped_file);
+                auto pos = get_last_block_uint64();
                 signed_block block;
                 read_block(pos, block);
                 return block;
@@ -118,10 +231,19 @@ namespace golos { namespace chain {
             }
 
             void open_block_mapped_file() {
+                if (is_compressed) {
+                    compressed_file.open(block_path);
+                    return;
+                }
                 create_nonexist_file(block_path);
                 block_mapped_file.open(block_path, boost::iostreams::mapped_file::readwrite);
             }
 
+            void close_block_mapped_file() {
+                block_mapped_file.close();
+                compressed_file.close();
+            }
+
             void open_index_mapped_file() {
                 create_nonexist_file(index_path);
                 index_mapped_file.open(index_path, boost::iostreams::mapped_file::readwrite);
@@ -135,7 +257,7 @@ namespace golos { namespace chain {
                 index_mapped_file.resize(head->block_num() * sizeof(uint64_t));
 
                 uint64_t pos = 0;
-                uint64_t end_pos = get_last_uint64(block_mapped_file);
+                uint64_t end_pos = get_last_block_uint64();
                 auto* idx_ptr = index_mapped_file.data();
                 signed_block tmp_block;
 
@@ -146,12 +268,84 @@ namespace golos { namespace chain {
                 }
             }
 
-            void open(const fc::path& file) { try {
-                block_mapped_file.close();
+            /**
+             * Map files of the block log of another process for reading, and find the last block, which is completely
+             *   written. The writer appends the block before its position in the index, but the index can be already
+             *   resized when the position isn't written yet, so the last record of the index is checked.
+             */
+            void open_read_only() {
+                close_block_mapped_file();
+                index_mapped_file.close();
+                head.reset();
+                head_id = block_id_type();
+
+                if (!boost::filesystem::is_regular_file(block_path) || !boost::filesystem::is_regular_file(index_path)) {
+                    return;
+                }
+
+                // the index is mapped first, so positions from it point to blocks inside the mapped block file
+                index_mapped_file.open(index_path, boost::iostreams::mapped_file::readonly);
+                block_mapped_file.open(block_path, boost::iostreams::mapped_file::readonly);
+
+                static constexpr uint32_t max_incomplete_blocks = 2;
+
+                auto block_num = uint32_t(get_mapped_size(index_mapped_file) / sizeof(uint64_t));
+                for (uint32_t i = 0; i < max_incomplete_blocks && block_num > 0; ++i, --block_num) {
+                    try {
+                        signed_block block;
+                        read_block(get_uint64(index_mapped_file, sizeof(uint64_t) * (block_num - 1)), block);
+                        if (block.block_num() == block_num) {
+                            head = std::move(block);
+                            head_id = head->id();
+                            return;
+                        }
+                    } catch (const fc::exception&) {
+                        // the block isn't completely written
+                    }
+                }
+            }
+
+            /**
+             * Remap files, if the writer process has appended blocks to them
+             */
+            void refresh() {
+                auto file_size = [](const std::string& path) -> std::size_t {
+                    boost::system::error_code ec;
+                    auto size = boost::filesystem::file_size(path, ec);
+                    return ec ? 0 : size;
+                };
+
+                if (block_mapped_file.is_open() && index_mapped_file.is_open() &&
+                    file_size(block_path) == block_mapped_file.size() &&
+                    file_size(index_path) == index_mapped_file.size()
+                ) {
+                    return;
+                }
+                open_read_only();
+            }
+
+            bool is_behind(uint32_t block_num) const {
+                return !head.valid() || block_num > protocol::block_header::num_from_id(head_id);
+            }
+
+            void open(const fc::path& file, bool read_only) { try {
+                close_block_mapped_file();
                 index_mapped_file.close();
 
                 block_path = file.string();
                 index_path = boost::filesystem::path(file.string() + ".index").string();
+                is_compressed = compressed_block_file::is_compressed(block_path);
+                if (is_compressed) {
+                    ilog("Block log is compressed");
+                }
+
+                is_read_only = read_only;
+                if (is_read_only) {
+                    FC_ASSERT(!is_compressed, "Compressed block log ${path} can't be opened in read-only mode",
+                        ("path", block_path));
+                    open_read_only();
+                    return;
+                }
 
                 open_block_mapped_file();
                 open_index_mapped_file();
@@ -183,7 +377,7 @@ namespace golos { namespace chain {
                     if (has_index_records()) {
                         ilog("Index is nonempty");
 
-                        auto block_pos = get_last_uint64(block_mapped_file);
+                        auto block_pos = get_last_block_uint64();
                         auto index_pos = get_last_uint64(index_mapped_file);
 
                         if (block_pos != index_pos) {
@@ -197,9 +391,17 @@ namespace golos { namespace chain {
                 } else if (has_index_records()) {
                     ilog("Index is nonempty, remove and recreate it");
                     index_mapped_file.close();
-                    block_mapped_file.close();
 
-                    boost::filesystem::remove_all(block_path);
+                    if (is_compressed) {
+                        // keep parameters of compression
+                        auto chunk_size = compressed_file.chunk_size();
+                        auto dictionary = compressed_file.dictionary();
+                        compressed_file.close();
+                        compressed_block_file::create(block_path, chunk_size, dictionary);
+                    } else {
+                        block_mapped_file.close();
+                        boost::filesystem::remove_all(block_path);
+                    }
                     boost::filesystem::remove_all(index_path);
 
                     open_block_mapped_file();
@@ -216,16 +418,21 @@ namespace golos { namespace chain {
                     ("position", index_pos)
                     ("expected", (b.block_num() - 1) * sizeof(uint64_t)));
 
-                uint64_t block_pos = get_mapped_size(block_mapped_file);
-
-                block_mapped_file.resize(block_pos + data.size() + sizeof(block_pos));
-                auto* ptr = block_mapped_file.data() + block_pos;
-                std::memcpy(ptr, data.data(), data.size());
-                ptr += data.size();
-                *reinterpret_cast<uint64_t*>(ptr) = block_pos;
+                uint64_t block_pos = get_block_file_size();
+
+                if (is_compressed) {
+                    compressed_file.append(data.data(), data.size());
+                    compressed_file.append(reinterpret_cast<const char*>(&block_pos), sizeof(block_pos));
+                } else {
+                    block_mapped_file.resize(block_pos + data.size() + sizeof(block_pos));
+                    auto* ptr = block_mapped_file.data() + block_pos;
+                    std::memcpy(ptr, data.data(), data.size());
+                    ptr += data.size();
+                    *reinterpret_cast<uint64_t*>(ptr) = block_pos;
+                }
 
                 index_mapped_file.resize(index_pos + sizeof(index_pos));
-                ptr = index_mapped_file.data() + index_pos;
+                auto* ptr = index_mapped_file.data() + index_pos;
                 *reinterpret_cast<uint64_t*>(ptr) = block_pos;
 
                 head = b;
@@ -233,13 +440,75 @@ namespace golos { namespace chain {
                 return block_pos;
             } FC_LOG_AND_RETHROW() }
 
+            void advise(std::size_t begin, std::size_t end, int advice) const {
+                const auto file_size = get_mapped_size(block_mapped_file);
+                end = std::min(end, file_size);
+                if (begin >= end) {
+                    return;
+                }
+
+                // madvise() requires the page-aligned address
+                static const std::size_t page_size = sysconf(_SC_PAGESIZE);
+                auto* base = const_cast<char*>(block_mapped_file.const_data());
+                auto aligned_begin = begin - (reinterpret_cast<std::uintptr_t>(base + begin) % page_size);
+                if (::madvise(base + aligned_begin, end - aligned_begin, advice) != 0) {
+                    wlog("Failed to advise access to block log: ${e}", ("e", strerror(errno)));
+                }
+            }
+
+            void prefetch_blocks(uint32_t first_block_num, uint32_t last_block_num) const {
+                auto begin = get_block_pos(first_block_num);
+                if (begin == block_log::npos) {
+                    return;
+                }
+
+                auto end = get_block_pos(last_block_num + 1);
+                if (end == block_log::npos) {
+                    end = get_block_file_size();
+                }
+
+                if (is_compressed) {
+                    compressed_file.prefetch(begin, end);
+                } else {
+                    advise(begin, end, MADV_WILLNEED);
+                }
+            }
+
+            void set_sequential_access(bool value) const {
+                if (is_compressed) {
+                    compressed_file.set_sequential_access(value);
+                } else {
+                    advise(0, get_mapped_size(block_mapped_file), value ? MADV_SEQUENTIAL : MADV_NORMAL);
+                }
+            }
+
             void close() {
-                block_mapped_file.close();
+                close_block_mapped_file();
                 index_mapped_file.close();
                 head.reset();
                 head_id = block_id_type();
             }
         };
+
+        /**
+         * In read-only mode, remap files of the block log, if the block is after the known head,
+         *   because it can be appended by the writer process
+         */
+        void refresh_if_behind(block_log_impl& impl, uint32_t block_num) {
+            if (!impl.is_read_only) {
+                return;
+            }
+            {
+                read_lock lock(impl.mutex);
+                if (!impl.is_behind(block_num)) {
+                    return;
+                }
+            }
+            write_lock lock(impl.mutex);
+            if (impl.is_behind(block_num)) {
+                impl.refresh();
+            }
+        }
     }
 
     block_log::block_log()
@@ -250,9 +519,14 @@ namespace golos { namespace chain {
         flush();
     }
 
-    void block_log::open(const fc::path& file) {
+    void block_log::open(const fc::path& file, bool read_only) {
         detail::write_lock lock(my->mutex);
-        my->open(file);
+        my->open(file, read_only);
+    }
+
+    void block_log::create_compressed(const fc::path& file, uint32_t chunk_size, const std::vector<char>& dictionary) {
+        compressed_block_file::create(file.string(), chunk_size, dictionary);
+        boost::filesystem::remove_all(file.string() + ".index");
     }
 
     void block_log::close() {
@@ -262,10 +536,11 @@ namespace golos { namespace chain {
 
     bool block_log::is_open() const {
         detail::read_lock lock(my->mutex);
-        return my->block_mapped_file.is_open();
+        return my->block_mapped_file.is_open() || my->compressed_file.is_open();
     }
 
     uint64_t block_log::append(const signed_block& block) { try {
+        FC_ASSERT(!my->is_read_only, "Block can't be appended to block log opened in read-only mode");
         auto data = fc::raw::pack(block);
         detail::write_lock lock(my->mutex);
         return my->append(block, data);
@@ -283,6 +558,7 @@ namespace golos { namespace chain {
     }
 
     optional<signed_block> block_log::read_block_by_num(uint32_t block_num) const { try {
+        detail::refresh_if_behind(*my, block_num);
         detail::read_lock lock(my->mutex);
         optional<signed_block> result;
         uint64_t pos = my->get_block_pos(block_num);
@@ -298,17 +574,35 @@ namespace golos { namespace chain {
         return result;
     } FC_LOG_AND_RETHROW() }
 
+    bool block_log::read_serialized_block(uint32_t block_num, const serialized_block_visitor& visitor) const { try {
+        detail::refresh_if_behind(*my, block_num);
+        detail::read_lock lock(my->mutex);
+        return my->read_serialized_block(block_num, visitor);
+    } FC_LOG_AND_RETHROW() }
+
     uint64_t block_log::get_block_pos(uint32_t block_num) const {
+        detail::refresh_if_behind(*my, block_num);
         detail::read_lock lock(my->mutex);
         return my->get_block_pos(block_num);
     }
 
+    void block_log::prefetch_blocks(uint32_t first_block_num, uint32_t last_block_num) const {
+        detail::read_lock lock(my->mutex);
+        my->prefetch_blocks(first_block_num, last_block_num);
+    }
+
+    void block_log::set_sequential_access(bool value) const {
+        detail::read_lock lock(my->mutex);
+        my->set_sequential_access(value);
+    }
+
     signed_block block_log::read_head() const {
         detail::read_lock lock(my->mutex);
         return my->read_head();
     }
 
-    const optional<signed_block>& block_log::head() const {
+    optional<signed_block> block_log::head() const {
+        // the copy is made under the lock, because the head is replaced on append() and on remapping of files
         detail::read_lock lock(my->mutex);
         return my->head;
     }
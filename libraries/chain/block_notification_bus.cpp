@@ -0,0 +1,195 @@
+#include <golos/chain/block_notification_bus.hpp>
+#include <golos/chain/database.hpp>
+
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace golos { namespace chain {
+
+    notified_operation::notified_operation(const operation_notification& note)
+        : op(note.op),
+          trx_id(note.trx_id),
+          trx_in_block(note.trx_in_block),
+          op_in_trx(note.op_in_trx),
+          virtual_op(note.virtual_op) {
+    }
+
+    namespace detail {
+        class block_notification_bus_impl final {
+        public:
+            block_notification_bus_impl(block_notification_bus& self, database& db)
+                : self(self),
+                  db(db) {
+            }
+
+            ~block_notification_bus_impl() {
+                stop_thread();
+            }
+
+            void start(bool async, uint32_t queue_size) {
+                stop_thread();
+
+                if (!async) {
+                    return;
+                }
+
+                queue = std::make_unique<queue_type>(std::max<uint32_t>(queue_size, 1));
+                is_stopping = false;
+                thread = std::thread([this]() { run(); });
+
+                ilog("Started asynchronous notification of plugins with queue of ${n} blocks", ("n", queue_size));
+            }
+
+            void stop() {
+                stop_thread();
+
+                if (!reversible_blocks.empty()) {
+                    ilog("Notification bus drops ${n} reversible blocks, they are collected again after restart",
+                        ("n", reversible_blocks.size()));
+                    reversible_blocks.clear();
+                }
+            }
+
+            void stop_thread() {
+                if (!queue) {
+                    return;
+                }
+
+                is_stopping = true;
+                wakeup.notify_one();
+                thread.join();
+                queue.reset();
+            }
+
+            bool is_async() const {
+                return queue != nullptr;
+            }
+
+            void on_pre_apply_block(const signed_block& block) {
+                if (self.on_irreversible_block.empty()) {
+                    return;
+                }
+                current = std::make_shared<block_notification>();
+                current->block_num = block.block_num();
+            }
+
+            void on_operation(const operation_notification& note) {
+                // operations of pending transactions are skipped
+                if (current) {
+                    current->operations.emplace_back(note);
+                }
+            }
+
+            void on_applied_block(const signed_block& block) {
+                if (!current) {
+                    return;
+                }
+
+                const auto block_num = current->block_num;
+                current->block = block;
+
+                // blocks of the switched fork
+                reversible_blocks.erase(reversible_blocks.lower_bound(block_num), reversible_blocks.end());
+                reversible_blocks.emplace(block_num, std::move(current));
+                current.reset();
+
+                auto end = reversible_blocks.upper_bound(db.last_non_undoable_block_num());
+                for (auto itr = reversible_blocks.begin(); itr != end; ++itr) {
+                    push(std::move(itr->second));
+                }
+                reversible_blocks.erase(reversible_blocks.begin(), end);
+            }
+
+        private:
+            using queue_type = boost::lockfree::spsc_queue<block_notification_ptr>;
+
+            void push(block_notification_ptr block) {
+                if (!queue) {
+                    notify(*block);
+                    return;
+                }
+
+                // handlers are slower than applying of blocks, so applying waits for them
+                while (!queue->push(block)) {
+                    wakeup.notify_one();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                wakeup.notify_one();
+            }
+
+            void run() {
+                block_notification_ptr block;
+                while (true) {
+                    if (queue->pop(block)) {
+                        notify(*block);
+                        block.reset();
+                        continue;
+                    }
+                    if (is_stopping) {
+                        break;
+                    }
+                    std::unique_lock<std::mutex> lock(wakeup_mutex);
+                    wakeup.wait_for(lock, std::chrono::milliseconds(10));
+                }
+            }
+
+            void notify(const block_notification& block) {
+                try {
+                    self.on_irreversible_block(block);
+                } catch (const fc::exception& e) {
+                    elog("Error on notification of plugins about block ${b}: ${e}",
+                        ("b", block.block_num)("e", e.to_detail_string()));
+                } catch (const std::exception& e) {
+                    elog("Error on notification of plugins about block ${b}: ${e}",
+                        ("b", block.block_num)("e", e.what()));
+                }
+            }
+
+            block_notification_bus& self;
+            database& db;
+
+            std::shared_ptr<block_notification> current;
+            std::map<uint32_t, std::shared_ptr<block_notification>> reversible_blocks;
+
+            std::unique_ptr<queue_type> queue;
+            std::thread thread;
+            std::atomic<bool> is_stopping{false};
+            std::mutex wakeup_mutex;
+            std::condition_variable wakeup;
+        };
+    } // detail
+
+    block_notification_bus::block_notification_bus(database& db)
+        : my(std::make_unique<detail::block_notification_bus_impl>(*this, db)) {
+        db.pre_apply_block.connect([&](const signed_block& block) {
+            my->on_pre_apply_block(block);
+        });
+        db.post_apply_operation.connect([&](const operation_notification& note) {
+            my->on_operation(note);
+        });
+        db.applied_block.connect([&](const signed_block& block) {
+            my->on_applied_block(block);
+        });
+    }
+
+    block_notification_bus::~block_notification_bus() = default;
+
+    void block_notification_bus::start(bool async, uint32_t queue_size) {
+        my->start(async, queue_size);
+    }
+
+    void block_notification_bus::stop() {
+        my->stop();
+    }
+
+    bool block_notification_bus::is_async() const {
+        return my->is_async();
+    }
+
+} } // golos::chain
@@ -0,0 +1,131 @@
+#include <golos/chain/block_prevalidator.hpp>
+#include <golos/chain/block_log.hpp>
+#include <golos/chain/database.hpp>
+#include <golos/chain/database_exceptions.hpp>
+
+namespace golos { namespace chain {
+
+    block_prevalidator::block_prevalidator() = default;
+
+    block_prevalidator::~block_prevalidator() {
+        stop();
+    }
+
+    void block_prevalidator::start(uint32_t threads) {
+        stop();
+
+        if (!threads) {
+            return;
+        }
+
+        _ios = std::make_unique<boost::asio::io_service>();
+        _work = std::make_unique<boost::asio::io_service::work>(*_ios);
+        for (uint32_t i = 0; i < threads; ++i) {
+            _thread_pool.create_thread([ios = _ios.get()]() { ios->run(); });
+        }
+        _threads = threads;
+
+        ilog("Started block prevalidation with ${n} threads", ("n", threads));
+    }
+
+    void block_prevalidator::stop() {
+        if (!_ios) {
+            return;
+        }
+
+        _work.reset();
+        _thread_pool.join_all();
+        _ios.reset();
+        _threads = 0;
+    }
+
+    bool block_prevalidator::is_started() const {
+        return _threads > 0;
+    }
+
+    uint32_t block_prevalidator::threads() const {
+        return _threads;
+    }
+
+    uint32_t block_prevalidator::queue_depth() const {
+        return std::max<uint32_t>(1, _threads * 8);
+    }
+
+    template <typename Loader>
+    std::future<prevalidated_block_ptr> block_prevalidator::post(Loader&& loader, uint32_t skip) {
+        auto task = std::make_shared<std::packaged_task<prevalidated_block_ptr()>>(
+            [loader = std::forward<Loader>(loader), skip]() mutable {
+                auto pb = std::make_shared<prevalidated_block>();
+                pb->block = loader();
+                prevalidate(*pb, skip);
+                return pb;
+            });
+
+        auto result = task->get_future();
+        if (is_started()) {
+            _ios->post([task]() { (*task)(); });
+        } else {
+            (*task)();
+        }
+        return result;
+    }
+
+    std::future<prevalidated_block_ptr> block_prevalidator::prevalidate(signed_block block, uint32_t skip) {
+        return post([block = std::move(block)]() mutable { return std::move(block); }, skip);
+    }
+
+    std::future<prevalidated_block_ptr> block_prevalidator::prevalidate(
+        const block_log& log, uint32_t block_num, uint32_t skip
+    ) {
+        return post([&log, block_num]() {
+            auto block = log.read_block_by_num(block_num);
+            GOLOS_ASSERT(block.valid(), block_log_exception,
+                "Block ${block_num} is absent in block log", ("block_num", block_num));
+            return std::move(*block);
+        }, skip);
+    }
+
+    void block_prevalidator::prevalidate(prevalidated_block& pb, uint32_t skip) {
+        const auto& block = pb.block;
+
+        pb.size = fc::raw::pack_size(block);
+
+        if (!(skip & database::skip_merkle_check)) {
+            pb.merkle_root = block.calculate_merkle_root();
+            pb.has_merkle_root = true;
+        }
+
+        const bool need_validate = !(skip & database::skip_validate_operations);
+        const bool need_keys = !(skip & (database::skip_transaction_signatures | database::skip_authority_check));
+
+        pb.transactions.resize(block.transactions.size());
+        if (!need_validate && !need_keys) {
+            return;
+        }
+
+        const chain_id_type& chain_id = STEEMIT_CHAIN_ID;
+
+        for (size_t i = 0, e = block.transactions.size(); i < e; ++i) {
+            const auto& trx = block.transactions[i];
+            auto& pt = pb.transactions[i];
+
+            // errors are ignored here, the write thread will repeat the failed check and throw the original error
+            if (need_validate) {
+                try {
+                    trx.validate();
+                    pt.is_validated = true;
+                } catch (const fc::exception&) {
+                }
+            }
+
+            if (need_keys) {
+                try {
+                    pt.signature_keys = trx.get_signature_keys(chain_id);
+                    pt.has_signature_keys = true;
+                } catch (const fc::exception&) {
+                }
+            }
+        }
+    }
+
+} } // golos::chain
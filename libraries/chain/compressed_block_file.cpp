@@ -0,0 +1,440 @@
+#include <golos/chain/compressed_block_file.hpp>
+#include <golos/protocol/exceptions.hpp>
+
+#include <fc/log/logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <zlib.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+namespace golos { namespace chain {
+
+    namespace {
+        constexpr char compressed_magic[] = {'G', 'O', 'L', 'O', 'S', 'B', 'L', 'Z'};
+        constexpr uint32_t compressed_version = 1;
+        constexpr std::size_t header_size = sizeof(compressed_magic) + sizeof(uint32_t) * 3;
+
+        template <typename T>
+        T get_blob(const char* ptr) {
+            T value;
+            std::memcpy(&value, ptr, sizeof(value));
+            return value;
+        }
+
+        template <typename T>
+        void put_blob(std::ostream& out, const T& value) {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+    }
+
+    compressed_block_file::compressed_block_file() = default;
+
+    compressed_block_file::~compressed_block_file() {
+        close();
+    }
+
+    bool compressed_block_file::is_compressed(const std::string& path) {
+        char magic[sizeof(compressed_magic)];
+        std::ifstream in(path, std::ios::in|std::ios::binary);
+        in.read(magic, sizeof(magic));
+        return in.gcount() == sizeof(magic) && !std::memcmp(magic, compressed_magic, sizeof(magic));
+    }
+
+    void compressed_block_file::create(const std::string& path, uint32_t chunk_size, const std::vector<char>& dictionary) {
+        FC_ASSERT(chunk_size > 0, "Size of chunk should be positive");
+
+        remove(path);
+
+        auto dict_size = std::min<uint32_t>(dictionary.size(), max_dictionary_size);
+        auto* dict_data = dictionary.data() + dictionary.size() - dict_size;
+
+        std::ofstream out(path, std::ios::out|std::ios::binary|std::ios::trunc);
+        out.write(compressed_magic, sizeof(compressed_magic));
+        put_blob(out, compressed_version);
+        put_blob(out, chunk_size);
+        put_blob(out, dict_size);
+        out.write(dict_data, dict_size);
+        out.close();
+
+        FC_ASSERT(!out.fail(), "Failed to create compressed block log ${path}", ("path", path));
+    }
+
+    void compressed_block_file::remove(const std::string& path) {
+        boost::filesystem::remove_all(path);
+        boost::filesystem::remove_all(path + ".chunks");
+        boost::filesystem::remove_all(path + ".tail");
+    }
+
+    void compressed_block_file::open(const std::string& path) {
+        close();
+
+        _path = path;
+        _chunks_path = path + ".chunks";
+        _tail_path = path + ".tail";
+
+        _file.open(_path, boost::iostreams::mapped_file::readwrite);
+
+        read_header();
+        load_chunks();
+        load_tail();
+    }
+
+    void compressed_block_file::close() {
+        _file.close();
+        _chunks.clear();
+        _tail.clear();
+        _dictionary.clear();
+
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        _cache.clear();
+    }
+
+    bool compressed_block_file::is_open() const {
+        return _file.is_open();
+    }
+
+    uint64_t compressed_block_file::size() const {
+        return _chunks.size() * _chunk_size + _tail.size();
+    }
+
+    uint32_t compressed_block_file::chunk_size() const {
+        return _chunk_size;
+    }
+
+    const std::vector<char>& compressed_block_file::dictionary() const {
+        return _dictionary;
+    }
+
+    void compressed_block_file::read_header() {
+        const auto* ptr = _file.const_data();
+        const auto file_size = _file.size();
+
+        GOLOS_CHECK_DATABASE(file_size >= header_size && !std::memcmp(ptr, compressed_magic, sizeof(compressed_magic)),
+            database_corrupted::wrong_compressed_data,
+            "Wrong header of compressed block log ${path}", ("path", _path));
+        ptr += sizeof(compressed_magic);
+
+        auto version = get_blob<uint32_t>(ptr);
+        GOLOS_CHECK_DATABASE(version == compressed_version,
+            database_corrupted::wrong_compressed_data,
+            "Unsupported version ${version} of compressed block log", ("version", version));
+        ptr += sizeof(uint32_t);
+
+        _chunk_size = get_blob<uint32_t>(ptr);
+        ptr += sizeof(uint32_t);
+
+        auto dict_size = get_blob<uint32_t>(ptr);
+        ptr += sizeof(uint32_t);
+
+        GOLOS_CHECK_DATABASE(_chunk_size > 0 && header_size + dict_size <= file_size,
+            database_corrupted::wrong_compressed_data,
+            "Wrong header of compressed block log ${path}", ("path", _path));
+
+        _dictionary.assign(ptr, ptr + dict_size);
+        _data_start = header_size + dict_size;
+    }
+
+    void compressed_block_file::load_chunks() {
+        const auto file_size = _file.size();
+
+        if (boost::filesystem::is_regular_file(_chunks_path)) {
+            auto count = boost::filesystem::file_size(_chunks_path) / sizeof(uint64_t);
+            _chunks.resize(count);
+
+            std::ifstream in(_chunks_path, std::ios::in|std::ios::binary);
+            in.read(reinterpret_cast<char*>(_chunks.data()), count * sizeof(uint64_t));
+            if (in.gcount() != std::streamsize(count * sizeof(uint64_t))) {
+                _chunks.clear();
+            }
+        }
+
+        // The list of chunks is valid if the last chunk ends in the end of file
+        bool is_valid = false;
+        if (_chunks.empty()) {
+            is_valid = (file_size == _data_start);
+        } else {
+            auto pos = _chunks.back();
+            if (pos >= _data_start && pos + sizeof(uint32_t) <= file_size) {
+                auto stored_size = get_blob<uint32_t>(_file.const_data() + pos);
+                is_valid = (stored_size <= _chunk_size && pos + sizeof(uint32_t) + stored_size == file_size);
+            }
+        }
+
+        if (!is_valid) {
+            construct_chunks();
+        }
+    }
+
+    void compressed_block_file::construct_chunks() {
+        ilog("Reconstructing chunks of compressed block log...");
+
+        const auto file_size = _file.size();
+        const auto* data = _file.const_data();
+        uint64_t pos = _data_start;
+
+        _chunks.clear();
+        while (pos + sizeof(uint32_t) <= file_size) {
+            auto stored_size = get_blob<uint32_t>(data + pos);
+            if (stored_size > _chunk_size || pos + sizeof(uint32_t) + stored_size > file_size) {
+                break;
+            }
+            _chunks.push_back(pos);
+            pos += sizeof(uint32_t) + stored_size;
+        }
+
+        if (pos != file_size) {
+            // the last chunk wasn't completely written, its data is still in the tail file
+            wlog("Truncate incomplete chunk of compressed block log at ${pos}", ("pos", pos));
+            _file.resize(pos);
+        }
+
+        write_chunks();
+    }
+
+    void compressed_block_file::write_chunks() const {
+        std::ofstream out(_chunks_path, std::ios::out|std::ios::binary|std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(_chunks.data()), _chunks.size() * sizeof(uint64_t));
+    }
+
+    void compressed_block_file::load_tail() {
+        const uint64_t chunks_end = _chunks.size() * _chunk_size;
+        uint64_t tail_start = chunks_end;
+
+        _tail.clear();
+        if (boost::filesystem::is_regular_file(_tail_path) &&
+            boost::filesystem::file_size(_tail_path) >= sizeof(uint64_t)
+        ) {
+            auto tail_size = boost::filesystem::file_size(_tail_path) - sizeof(uint64_t);
+            _tail.resize(tail_size);
+
+            std::ifstream in(_tail_path, std::ios::in|std::ios::binary);
+            in.read(reinterpret_cast<char*>(&tail_start), sizeof(tail_start));
+            in.read(_tail.data(), tail_size);
+        }
+
+        GOLOS_CHECK_DATABASE(tail_start <= chunks_end,
+            database_corrupted::wrong_compressed_data,
+            "Data between the last chunk and the tail of compressed block log is lost",
+            ("chunks_end", chunks_end)("tail_start", tail_start));
+
+        if (tail_start == chunks_end && _tail.size() < _chunk_size) {
+            return;
+        }
+
+        // the tail was already compressed to the chunk, but the tail file wasn't updated
+        auto covered = std::min<uint64_t>(chunks_end - tail_start, _tail.size());
+        _tail.erase(_tail.begin(), _tail.begin() + covered);
+
+        while (_tail.size() >= _chunk_size) {
+            append_chunk(_tail.data());
+            _tail.erase(_tail.begin(), _tail.begin() + _chunk_size);
+        }
+
+        write_tail();
+    }
+
+    void compressed_block_file::write_tail() const {
+        const uint64_t tail_start = _chunks.size() * _chunk_size;
+
+        std::ofstream out(_tail_path, std::ios::out|std::ios::binary|std::ios::trunc);
+        put_blob(out, tail_start);
+        out.write(_tail.data(), _tail.size());
+    }
+
+    std::vector<char> compressed_block_file::compress_chunk(const char* data) const {
+        std::vector<char> result(compressBound(_chunk_size));
+
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+
+        auto ret = deflateInit(&stream, Z_BEST_COMPRESSION);
+        FC_ASSERT(ret == Z_OK, "Failed to initialize compression of block log: ${ret}", ("ret", ret));
+
+        if (!_dictionary.empty()) {
+            deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(_dictionary.data()), _dictionary.size());
+        }
+
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream.avail_in = _chunk_size;
+        stream.next_out = reinterpret_cast<Bytef*>(result.data());
+        stream.avail_out = result.size();
+
+        ret = deflate(&stream, Z_FINISH);
+        deflateEnd(&stream);
+
+        // incompressible data is stored as is, it's marked by the full size of chunk
+        if (ret != Z_STREAM_END || stream.total_out >= _chunk_size) {
+            result.assign(data, data + _chunk_size);
+        } else {
+            result.resize(stream.total_out);
+        }
+        return result;
+    }
+
+    void compressed_block_file::decompress_chunk(const char* data, uint32_t size, std::vector<char>& result) const {
+        result.resize(_chunk_size);
+
+        if (size == _chunk_size) {
+            std::memcpy(result.data(), data, size);
+            return;
+        }
+
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+
+        auto ret = inflateInit(&stream);
+        FC_ASSERT(ret == Z_OK, "Failed to initialize decompression of block log: ${ret}", ("ret", ret));
+
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream.avail_in = size;
+        stream.next_out = reinterpret_cast<Bytef*>(result.data());
+        stream.avail_out = result.size();
+
+        ret = inflate(&stream, Z_FINISH);
+        if (ret == Z_NEED_DICT) {
+            inflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(_dictionary.data()), _dictionary.size());
+            ret = inflate(&stream, Z_FINISH);
+        }
+        auto total_out = stream.total_out;
+        inflateEnd(&stream);
+
+        GOLOS_CHECK_DATABASE(ret == Z_STREAM_END && total_out == _chunk_size,
+            database_corrupted::wrong_compressed_data,
+            "Failed to decompress chunk of block log", ("ret", ret)("size", total_out));
+    }
+
+    compressed_block_file::chunk_ptr compressed_block_file::get_chunk(uint64_t num) const {
+        {
+            std::lock_guard<std::mutex> lock(_cache_mutex);
+            auto itr = std::find_if(_cache.begin(), _cache.end(), [&](const auto& item) {
+                return item.first == num;
+            });
+            if (itr != _cache.end()) {
+                std::rotate(_cache.begin(), itr, itr + 1);
+                return _cache.front().second;
+            }
+        }
+
+        const auto pos = _chunks[num];
+        const auto* ptr = _file.const_data() + pos;
+        auto chunk = std::make_shared<std::vector<char>>();
+        decompress_chunk(ptr + sizeof(uint32_t), get_blob<uint32_t>(ptr), *chunk);
+
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        if (_cache.size() >= cache_size) {
+            _cache.pop_back();
+        }
+        _cache.emplace(_cache.begin(), num, chunk);
+        return chunk;
+    }
+
+    void compressed_block_file::read(uint64_t pos, char* data, std::size_t size) const {
+        const auto file_size = this->size();
+        GOLOS_CHECK_DATABASE(pos + size <= file_size,
+            database_corrupted::reading_data_beyond_end_of_file,
+            "Reading data beyond end of file",
+            ("pos", pos)("size", size)("file_size", file_size));
+
+        const uint64_t chunks_end = _chunks.size() * _chunk_size;
+        while (size > 0) {
+            std::size_t copy_size;
+            if (pos < chunks_end) {
+                const auto offset = pos % _chunk_size;
+                copy_size = std::min<std::size_t>(size, _chunk_size - offset);
+                auto chunk = get_chunk(pos / _chunk_size);
+                std::memcpy(data, chunk->data() + offset, copy_size);
+            } else {
+                copy_size = size;
+                std::memcpy(data, _tail.data() + (pos - chunks_end), copy_size);
+            }
+            data += copy_size;
+            pos += copy_size;
+            size -= copy_size;
+        }
+    }
+
+    void compressed_block_file::append_chunk(const char* data) {
+        auto compressed = compress_chunk(data);
+        const uint32_t stored_size = compressed.size();
+        const uint64_t pos = _file.size();
+
+        _file.resize(pos + sizeof(stored_size) + stored_size);
+        auto* ptr = _file.data() + pos;
+        std::memcpy(ptr, &stored_size, sizeof(stored_size));
+        std::memcpy(ptr + sizeof(stored_size), compressed.data(), stored_size);
+
+        _chunks.push_back(pos);
+
+        std::ofstream out(_chunks_path, std::ios::out|std::ios::binary|std::ios::app);
+        put_blob(out, pos);
+    }
+
+    void compressed_block_file::append(const char* data, std::size_t size) {
+        bool has_new_chunks = false;
+        const auto* tail_data = data;
+        auto tail_size = size;
+
+        while (size > 0) {
+            auto copy_size = std::min<std::size_t>(size, _chunk_size - _tail.size());
+            _tail.insert(_tail.end(), data, data + copy_size);
+            data += copy_size;
+            size -= copy_size;
+
+            if (_tail.size() == _chunk_size) {
+                append_chunk(_tail.data());
+                _tail.clear();
+                has_new_chunks = true;
+            }
+        }
+
+        if (has_new_chunks ||
+            !boost::filesystem::is_regular_file(_tail_path) ||
+            boost::filesystem::file_size(_tail_path) < sizeof(uint64_t)
+        ) {
+            write_tail();
+        } else {
+            std::ofstream out(_tail_path, std::ios::out|std::ios::binary|std::ios::app);
+            out.write(tail_data, tail_size);
+        }
+    }
+
+    void compressed_block_file::advise(std::size_t begin, std::size_t end, int advice) const {
+        end = std::min(end, _file.size());
+        if (begin >= end) {
+            return;
+        }
+
+        // madvise() requires the page-aligned address
+        static const std::size_t page_size = sysconf(_SC_PAGESIZE);
+        auto* base = const_cast<char*>(_file.const_data());
+        auto aligned_begin = begin - (reinterpret_cast<std::uintptr_t>(base + begin) % page_size);
+        if (::madvise(base + aligned_begin, end - aligned_begin, advice) != 0) {
+            wlog("Failed to advise access to compressed block log: ${e}", ("e", strerror(errno)));
+        }
+    }
+
+    void compressed_block_file::prefetch(uint64_t begin, uint64_t end) const {
+        const auto first_chunk = begin / _chunk_size;
+        const auto last_chunk = end / _chunk_size + 1;
+        if (first_chunk >= _chunks.size()) {
+            return;
+        }
+
+        const auto file_begin = _chunks[first_chunk];
+        const auto file_end = last_chunk < _chunks.size() ? _chunks[last_chunk] : _file.size();
+        advise(file_begin, file_end, MADV_WILLNEED);
+    }
+
+    void compressed_block_file::set_sequential_access(bool value) const {
+        advise(_data_start, _file.size(), value ? MADV_SEQUENTIAL : MADV_NORMAL);
+    }
+
+} } // golos::chain
@@ -187,6 +187,22 @@ namespace golos { namespace chain {
         }
 
         void database::open(const fc::path &data_dir, const fc::path &shared_mem_dir, uint64_t initial_supply, uint64_t shared_file_size, uint32_t chainbase_flags) {
+            _open(data_dir, shared_mem_dir, shared_file_size, chainbase_flags, [&]() {
+                init_genesis(initial_supply);
+            });
+        }
+
+        void database::open_from_state_snapshot(const fc::path &data_dir, const fc::path &shared_mem_dir, const fc::path &snapshot, uint64_t shared_file_size, uint32_t chainbase_flags) {
+            bool loaded = false;
+            _open(data_dir, shared_mem_dir, shared_file_size, chainbase_flags, [&]() {
+                load_state_snapshot(snapshot);
+                loaded = true;
+            });
+            GOLOS_ASSERT(loaded, state_snapshot_exception,
+                "Database is not empty, state snapshot ${snapshot} is not loaded", ("snapshot", snapshot));
+        }
+
+        void database::_open(const fc::path &data_dir, const fc::path &shared_mem_dir, uint64_t shared_file_size, uint32_t chainbase_flags, std::function<void()> init_state) {
             try {
                 auto start = fc::time_point::now();
                 wlog("Start opening database. Please wait, don't break application...");
@@ -206,7 +222,7 @@ namespace golos { namespace chain {
 
                     if (!find<dynamic_global_property_object>()) {
                         with_strong_write_lock([&]() {
-                            init_genesis(initial_supply);
+                            init_state();
                         });
                     }
 
@@ -240,6 +256,9 @@ namespace golos { namespace chain {
                     }
                     end = fc::time_point::now();
                     wlog("Done opening block log, elapsed time ${t} sec", ("t", double((end - start).count()) / 1000000.0));
+                } else {
+                    // the block log is appended by the node, which owns the shared memory
+                    _block_log.open(data_dir / "block_log", true);
                 }
 
                 with_strong_read_lock([&]() {
@@ -279,6 +298,62 @@ namespace golos { namespace chain {
                     auto last_block_pos = _block_log.get_block_pos(last_block_num);
                     int last_reindex_percent = 0;
 
+                    // blocks are read from the block log, unpacked and prevalidated ahead of the applying,
+                    //   at least one reader thread is used even if the prevalidation is disabled
+                    bool own_prevalidator = !_block_prevalidator.is_started();
+                    if (own_prevalidator) {
+                        _block_prevalidator.start(1);
+                    }
+
+                    _block_log.set_sequential_access(true);
+
+                    const uint32_t prefetch_window = 10000;
+                    auto prefetched_block_num = cur_block_num;
+
+                    std::deque<std::future<prevalidated_block_ptr>> prevalidated_queue;
+                    auto next_block_num = cur_block_num;
+                    auto next_prevalidated_block = [&]() {
+                        if (next_block_num + _block_prevalidator.queue_depth() >= prefetched_block_num &&
+                            prefetched_block_num <= last_block_num
+                        ) {
+                            // ask OS to load the next window of blocks while the current one is being applied
+                            _block_log.prefetch_blocks(prefetched_block_num, prefetched_block_num + prefetch_window - 1);
+                            prefetched_block_num += prefetch_window;
+                        }
+
+                        while (prevalidated_queue.size() < _block_prevalidator.queue_depth() &&
+                            next_block_num <= last_block_num
+                        ) {
+                            prevalidated_queue.push_back(
+                                _block_prevalidator.prevalidate(_block_log, next_block_num, skip_flags));
+                            ++next_block_num;
+                        }
+                        auto result = prevalidated_queue.front().get();
+                        prevalidated_queue.pop_front();
+                        return result;
+                    };
+
+                    auto apply_prevalidated_block = [&](const prevalidated_block& pb) {
+                        detail::with_prevalidated_block(*this, pb, [&]() {
+                            apply_block(pb.block, skip_flags);
+                        });
+                    };
+
+                    // stop reading ahead on any exit from the replay
+                    struct reading_guard final {
+                        std::function<void()> stop;
+
+                        ~reading_guard() {
+                            stop();
+                        }
+                    } stop_reading{[&]() {
+                        prevalidated_queue.clear();
+                        if (own_prevalidator) {
+                            _block_prevalidator.stop();
+                        }
+                        _block_log.set_sequential_access(false);
+                    }};
+
                     set_reserved_memory(1024*1024*1024); // protect from memory fragmentations ...
                     while (cur_block_num < last_block_num) {
                         if (signal_guard::get_is_interrupted()) {
@@ -287,7 +362,7 @@ namespace golos { namespace chain {
 
                         auto end = fc::time_point::now();
                         auto cur_block_pos = _block_log.get_block_pos(cur_block_num);
-                        auto cur_block = *_block_log.read_block_by_num(cur_block_num);
+                        auto cur_block = next_prevalidated_block();
 
                         auto reindex_percent = cur_block_pos * 100 / last_block_pos;
                         if (reindex_percent - last_reindex_percent >= 1) {
@@ -300,7 +375,7 @@ namespace golos { namespace chain {
                             last_reindex_percent = reindex_percent;
                         }
 
-                        apply_block(cur_block, skip_flags);
+                        apply_prevalidated_block(*cur_block);
 
                         if (cur_block_num % 1000 == 0) {
                             set_revision(head_block_num());
@@ -310,8 +385,8 @@ namespace golos { namespace chain {
                         cur_block_num++;
                     }
 
-                    auto cur_block = *_block_log.read_block_by_num(cur_block_num);
-                    apply_block(cur_block, skip_flags);
+                    auto cur_block = next_prevalidated_block();
+                    apply_prevalidated_block(*cur_block);
                     set_reserved_memory(0);
                     set_revision(head_block_num());
                 });
@@ -606,19 +681,19 @@ namespace golos { namespace chain {
 
         const witness_object &database::get_witness(const account_name_type &name) const {
             try {
-                return get<witness_object, by_name>(name);
+                return get<witness_object, by_hashed_name>(name);
             } catch(const std::out_of_range &e) {
                 GOLOS_THROW_MISSING_OBJECT("witness", name);
             } FC_CAPTURE_AND_RETHROW((name))
         }
 
         const witness_object *database::find_witness(const account_name_type &name) const {
-            return find<witness_object, by_name>(name);
+            return find<witness_object, by_hashed_name>(name);
         }
 
         const account_object &database::get_account(const account_name_type &name) const {
             try {
-                return get<account_object, by_name>(name);
+                return get<account_object, by_hashed_name>(name);
             } catch(const std::out_of_range &e) {
                 GOLOS_THROW_MISSING_OBJECT("account", name);
             }
@@ -626,7 +701,7 @@ namespace golos { namespace chain {
         }
 
         const account_object *database::find_account(const account_name_type &name) const {
-            return find<account_object, by_name>(name);
+            return find<account_object, by_hashed_name>(name);
         }
 
         const comment_object &database::get_comment(const account_name_type &author, const shared_string &permlink) const {
@@ -721,7 +796,7 @@ namespace golos { namespace chain {
 
         const account_authority_object &database::get_authority(const account_name_type &name) const {
             try {
-                return get<account_authority_object, by_account>(name);
+                return get<account_authority_object, by_hashed_name>(name);
             } catch(const std::out_of_range &e) {
                 GOLOS_THROW_MISSING_OBJECT("authority", name);
             } FC_CAPTURE_AND_RETHROW((name))
@@ -888,11 +963,29 @@ namespace golos { namespace chain {
             return skip;
         }
 
-        void database::_validate_block(const signed_block& new_block, uint32_t skip) {
+        uint32_t database::validate_block(const prevalidated_block& new_block, uint32_t skip) {
+            uint32_t validate_block_steps =
+                skip_merkle_check |
+                skip_block_size_check;
+
+            if ((skip & validate_block_steps) != validate_block_steps) {
+                with_strong_read_lock([&](){
+                    _validate_block(new_block.block, skip, &new_block);
+                });
+
+                skip |= validate_block_steps;
+            }
+
+            return skip;
+        }
+
+        void database::_validate_block(const signed_block& new_block, uint32_t skip, const prevalidated_block* prevalidated) {
             uint32_t new_block_num = new_block.block_num();
 
             if (!(skip & skip_merkle_check)) {
-                auto merkle_root = new_block.calculate_merkle_root();
+                auto merkle_root = (prevalidated && prevalidated->has_merkle_root)
+                    ? prevalidated->merkle_root
+                    : new_block.calculate_merkle_root();
 
                 try {
                     FC_ASSERT(
@@ -914,7 +1007,7 @@ namespace golos { namespace chain {
 
             if (!(skip & skip_block_size_check)) {
                 const auto &gprops = get_dynamic_global_properties();
-                auto block_size = fc::raw::pack_size(new_block);
+                auto block_size = prevalidated ? prevalidated->size : fc::raw::pack_size(new_block);
                 if (has_hardfork(STEEMIT_HARDFORK_0_12)) {
                     FC_ASSERT(
                         block_size <= gprops.maximum_block_size,
@@ -926,6 +1019,25 @@ namespace golos { namespace chain {
             }
         }
 
+        template <typename Lambda>
+        void database::with_block_write_lock(Lambda&& callback) {
+            struct block_writer_guard final {
+                block_writer_guard(database& db): db(db) {
+                    ++db._block_writers;
+                }
+
+                ~block_writer_guard() {
+                    if (--db._block_writers == 0) {
+                        db.notify_block_write_unlocked();
+                    }
+                }
+
+                database& db;
+            } guard(*this);
+
+            with_strong_write_lock(std::forward<Lambda>(callback));
+        }
+
        /**
         * Push block "may fail" in which case every partial change is unwound. After
         * push block is successful the block is appended to the chain database on disk.
@@ -936,25 +1048,8 @@ namespace golos { namespace chain {
             //fc::time_point begin_time = fc::time_point::now();
 
             bool result;
-            with_strong_write_lock([&]() {
-                detail::without_pending_transactions(*this, skip, std::move(_pending_tx), [&]() {
-                    try {
-                        result = _push_block(new_block, skip);
-                        check_free_memory(false, new_block.block_num());
-                    } catch (const fc::exception &e) {
-                        auto msg = std::string(e.what());
-                        // TODO: there is no easy way to catch boost::interprocess::bad_alloc
-                        if (msg.find("boost::interprocess::bad_alloc") == msg.npos) {
-                            throw e;
-                        }
-                        wlog("Receive bad_alloc exception. Forcing to resize shared memory file.");
-                        set_reserved_memory(free_memory());
-                        if (!_resize(new_block.block_num())) {
-                            throw e;
-                        }
-                        result = _push_block(new_block, skip);
-                    }
-                });
+            with_block_write_lock([&]() {
+                result = _push_block_without_pending(new_block, skip);
             });
 
             //fc::time_point end_time = fc::time_point::now();
@@ -964,6 +1059,39 @@ namespace golos { namespace chain {
             return result;
         }
 
+        bool database::push_block(const prevalidated_block &new_block, uint32_t skip) {
+            bool result;
+            with_block_write_lock([&]() {
+                detail::with_prevalidated_block(*this, new_block, [&]() {
+                    result = _push_block_without_pending(new_block.block, skip);
+                });
+            });
+            return result;
+        }
+
+        bool database::_push_block_without_pending(const signed_block &new_block, uint32_t skip) {
+            bool result;
+            detail::without_pending_transactions(*this, skip, std::move(_pending_tx), [&]() {
+                try {
+                    result = _push_block(new_block, skip);
+                    check_free_memory(false, new_block.block_num());
+                } catch (const fc::exception &e) {
+                    auto msg = std::string(e.what());
+                    // TODO: there is no easy way to catch boost::interprocess::bad_alloc
+                    if (msg.find("boost::interprocess::bad_alloc") == msg.npos) {
+                        throw e;
+                    }
+                    wlog("Receive bad_alloc exception. Forcing to resize shared memory file.");
+                    set_reserved_memory(free_memory());
+                    if (!_resize(new_block.block_num())) {
+                        throw e;
+                    }
+                    result = _push_block(new_block, skip);
+                }
+            });
+            return result;
+        }
+
         void database::_maybe_warn_multiple_production(uint32_t height) const {
             auto blocks = _fork_db.fetch_block_by_number(height);
             if (blocks.size() > 1) {
@@ -1147,7 +1275,7 @@ namespace golos { namespace chain {
 
             signed_block pending_block;
 
-            with_strong_write_lock([&]() { detail::with_generating(*this, [&]() {
+            with_block_write_lock([&]() { detail::with_generating(*this, [&]() {
                 //
                 // The following code throws away existing pending_tx_session and
                 // rebuilds it by re-applying pending transactions.
@@ -1325,6 +1453,10 @@ namespace golos { namespace chain {
             notify_post_apply_operation(note);
         }
 
+        void database::notify_pre_apply_block(const signed_block &block) {
+            STEEMIT_TRY_NOTIFY(pre_apply_block, block)
+        }
+
         void database::notify_applied_block(const signed_block &block) {
             STEEMIT_TRY_NOTIFY(applied_block, block)
         }
@@ -1337,6 +1469,13 @@ namespace golos { namespace chain {
             STEEMIT_TRY_NOTIFY(on_applied_transaction, tx)
         }
 
+        void database::notify_block_write_unlocked() {
+            // it's called from the destructor, so exceptions aren't passed
+            try {
+                block_write_unlocked();
+            } FC_CAPTURE_AND_LOG(())
+        }
+
         account_name_type database::get_scheduled_witness(uint32_t slot_num) const {
             const dynamic_global_property_object &dpo = get_dynamic_global_properties();
             const witness_schedule_object &wso = get_witness_schedule_object();
@@ -3441,7 +3580,11 @@ namespace golos { namespace chain {
         }
 
         void database::_validate_transaction(const signed_transaction &trx, uint32_t skip) {
-            if (!(skip & skip_validate_operations)) {   /* issue #505 explains why this skip_flag is disabled */
+            const auto* prevalidated = find_prevalidated_transaction(trx);
+
+            if (!(skip & skip_validate_operations) &&  /* issue #505 explains why this skip_flag is disabled */
+                !(prevalidated && prevalidated->is_validated)
+            ) {
                 trx.validate();
             }
 
@@ -3461,7 +3604,13 @@ namespace golos { namespace chain {
                 };
 
                 try {
-                    trx.verify_authority(chain_id, get_active, get_owner, get_posting, STEEMIT_MAX_SIG_CHECK_DEPTH);
+                    if (prevalidated && prevalidated->has_signature_keys) {
+                        golos::protocol::verify_authority(
+                            trx.operations, prevalidated->signature_keys,
+                            get_active, get_owner, get_posting, STEEMIT_MAX_SIG_CHECK_DEPTH);
+                    } else {
+                        trx.verify_authority(chain_id, get_active, get_owner, get_posting, STEEMIT_MAX_SIG_CHECK_DEPTH);
+                    }
                 }
                 catch (protocol::tx_missing_active_auth &e) {
                     if (get_shared_db_merkle().find(head_block_num() + 1) == get_shared_db_merkle().end()) {
@@ -3544,6 +3693,31 @@ namespace golos { namespace chain {
             return _block_log;
         }
 
+        block_prevalidator &database::get_block_prevalidator() {
+            return _block_prevalidator;
+        }
+
+        const prevalidated_block* database::find_prevalidated_block(const signed_block& block) const {
+            if (_prevalidated_block && &_prevalidated_block->block == &block) {
+                return _prevalidated_block;
+            }
+            return nullptr;
+        }
+
+        const prevalidated_transaction* database::find_prevalidated_transaction(const signed_transaction& trx) const {
+            if (!_prevalidated_block || _prevalidated_block->block.transactions.empty()) {
+                return nullptr;
+            }
+
+            // only transactions of the prevalidated block itself, not their copies
+            const auto& transactions = _prevalidated_block->block.transactions;
+            std::less<const signed_transaction*> less;
+            if (less(&trx, &transactions.front()) || less(&transactions.back(), &trx)) {
+                return nullptr;
+            }
+            return &_prevalidated_block->transactions[&trx - &transactions.front()];
+        }
+
 //////////////////// private methods ////////////////////
 
         void database::apply_block(const signed_block &next_block, uint32_t skip) {
@@ -3613,12 +3787,24 @@ namespace golos { namespace chain {
         }
 
         void database::_apply_block(const signed_block &next_block, uint32_t skip) {
+            struct applying_block_guard final {
+                applying_block_guard(database& db): db(db) {
+                    db._is_applying_block = true;
+                }
+
+                ~applying_block_guard() {
+                    db._is_applying_block = false;
+                }
+
+                database& db;
+            } guard(*this);
+
             try {
                 uint32_t next_block_num = next_block.block_num();
                 const auto &gprops = get_dynamic_global_properties();
                 //block_id_type next_block_id = next_block.id();
 
-                _validate_block(next_block, skip);
+                _validate_block(next_block, skip, find_prevalidated_block(next_block));
 
                 const witness_object &signing_witness = validate_block_header(skip, next_block);
 
@@ -3626,6 +3812,8 @@ namespace golos { namespace chain {
                 _current_trx_in_block = 0;
                 _current_virtual_op = 0;
 
+                notify_pre_apply_block(next_block);
+
                 /// modify current witness so transaction evaluators can know who included the transaction,
                 /// this is mostly for POW operations which must pay the current_witness
                 modify(gprops, [&](dynamic_global_property_object &dgp) {
@@ -10,6 +10,7 @@
 #include <golos/chain/shared_authority.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
 
 #include <numeric>
 
@@ -280,6 +281,7 @@ public:
 };
 
 struct by_name;
+struct by_hashed_name;
 struct by_next_vesting_withdrawal;
 
 /**
@@ -293,6 +295,9 @@ typedef multi_index_container<
                 ordered_unique<tag<by_name>,
                         member<account_object, account_name_type, &account_object::name>,
                         protocol::string_less>,
+                hashed_unique<tag<by_hashed_name>,
+                        member<account_object, account_name_type, &account_object::name>,
+                        protocol::string_hash>,
                 ordered_unique<tag<by_next_vesting_withdrawal>,
 
                 composite_key < account_object,
@@ -354,6 +359,9 @@ typedef multi_index_container<
                 composite_key_compare <
                 std::less<account_name_type>, std::less<account_authority_id_type>>
 >,
+                hashed_unique<tag<by_hashed_name>,
+                        member<account_authority_object, account_name_type, &account_authority_object::account>,
+                        protocol::string_hash>,
 ordered_unique<tag<by_last_owner_update>,
         composite_key < account_authority_object,
         member<account_authority_object, time_point_sec, &account_authority_object::last_owner_update>,
@@ -559,3 +567,39 @@ FC_REFLECT((golos::chain::change_recovery_account_request_object),
         (id)(account_to_recover)(recovery_account)(effective_on)
 )
 CHAINBASE_SET_INDEX_TYPE(golos::chain::change_recovery_account_request_object, golos::chain::change_recovery_account_request_index)
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::account_object,
+    (id)(name)(memo_key)(proxy)(last_account_update)(created)(mined)(owner_challenged)(active_challenged)
+    (last_owner_proved)(last_active_proved)(recovery_account)(reset_account)(last_account_recovery)
+    (comment_count)(lifetime_vote_count)(post_count)(can_vote)(voting_power)(posts_capacity)
+    (comments_capacity)(voting_capacity)(last_vote_time)(balance)(savings_balance)(sbd_balance)(sbd_seconds)
+    (sbd_seconds_last_update)(sbd_last_interest_payment)(savings_sbd_balance)(savings_sbd_seconds)
+    (savings_sbd_seconds_last_update)(savings_sbd_last_interest_payment)(savings_withdraw_requests)
+    (benefaction_rewards)(curation_rewards)(delegation_rewards)(posting_rewards)(vesting_shares)
+    (delegated_vesting_shares)(received_vesting_shares)(vesting_withdraw_rate)(next_vesting_withdrawal)
+    (withdrawn)(to_withdraw)(withdraw_routes)(proxied_vsf_votes)(witnesses_voted_for)(last_post)
+    (referrer_account)(referrer_interest_rate)(referral_end_date)(referral_break_fee))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::account_authority_object,
+    (id)(account)(owner)(active)(posting)(last_owner_update))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::account_bandwidth_object,
+    (id)(account)(type)(average_bandwidth)(lifetime_bandwidth)(last_bandwidth_update))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::account_metadata_object,
+    (id)(account)(json_metadata))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::vesting_delegation_object,
+    (id)(delegator)(delegatee)(vesting_shares)(interest_rate)(payout_strategy)(min_delegation_time))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::vesting_delegation_expiration_object,
+    (id)(delegator)(vesting_shares)(expiration))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::owner_authority_history_object,
+    (id)(account)(previous_owner_authority)(last_valid_time))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::account_recovery_request_object,
+    (id)(account_to_recover)(new_owner_authority)(expires))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::change_recovery_account_request_object,
+    (id)(account_to_recover)(recovery_account)(effective_on))
@@ -3,6 +3,8 @@
 #include <fc/filesystem.hpp>
 #include <golos/protocol/block.hpp>
 
+#include <functional>
+
 namespace golos {
     namespace chain {
 
@@ -33,6 +35,13 @@ namespace golos {
          *
          * The main file is the only file that needs to persist. The index file can be reconstructed during a
          * linear scan of the main file.
+         *
+         * The main file can be stored in the compressed format (see compressed_block_file), it is detected on open.
+         * Positions of blocks are the positions in the uncompressed data, so the index file is the same for both formats.
+         *
+         * The block log of another process can be opened in read-only mode. Files are remapped, when a block after
+         * the known head is requested, so blocks appended by the writer become visible. Compressed block log isn't
+         * supported in this mode.
          */
 
         class block_log {
@@ -41,7 +50,13 @@ namespace golos {
 
             ~block_log();
 
-            void open(const fc::path& file);
+            void open(const fc::path& file, bool read_only = false);
+
+            /**
+             * Create the empty block log in the compressed format, next blocks will be appended to it by open() and append().
+             * @param dictionary samples of blocks, which are used as the preset dictionary for compression
+             */
+            static void create_compressed(const fc::path& file, uint32_t chunk_size, const std::vector<char>& dictionary);
 
             void close();
 
@@ -55,14 +70,41 @@ namespace golos {
 
             optional <signed_block> read_block_by_num(uint32_t block_num) const;
 
+            using serialized_block_visitor = std::function<void(const char* data, std::size_t size)>;
+
+            /**
+             * Call the visitor with the serialized block without its unpacking. The block is located by positions
+             *   of it and of the next block in the index file. The data is borrowed from the memory-mapped file,
+             *   so it is valid only inside the visitor. A shared read lock of the block log is held while it is called,
+             *   so appending of blocks waits for the visitor, and it should only copy or parse the data.
+             * @return false if the block does not exist
+             */
+            bool read_serialized_block(uint32_t block_num, const serialized_block_visitor& visitor) const;
+
             /**
              * Return offset of block in file, or block_log::npos if it does not exist.
              */
             uint64_t get_block_pos(uint32_t block_num) const;
 
+            /**
+             * Ask OS to load blocks from the range into the page cache in background.
+             */
+            void prefetch_blocks(uint32_t first_block_num, uint32_t last_block_num) const;
+
+            /**
+             * Hint OS that the block log is read sequentially (on replay), so it can read ahead aggressively.
+             */
+            void set_sequential_access(bool value) const;
+
             signed_block read_head() const;
 
-            const optional <signed_block>& head() const;
+            /**
+             * Return the copy of the head block, because it is replaced by appending of blocks,
+             *   and in read-only mode by remapping of files in other threads.
+             * In read-only mode, files aren't remapped by this call, the head is updated,
+             *   when a block after it is requested.
+             */
+            optional <signed_block> head() const;
 
             static const uint64_t npos = std::numeric_limits<uint64_t>::max();
 
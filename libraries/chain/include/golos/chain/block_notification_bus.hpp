@@ -0,0 +1,79 @@
+#pragma once
+
+#include <golos/protocol/block.hpp>
+#include <golos/chain/operation_notification.hpp>
+
+#include <boost/signals2.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace golos { namespace chain {
+
+    class database;
+
+    /**
+     * Copy of the operation notification, which can be passed to other threads
+     */
+    struct notified_operation final {
+        notified_operation(const operation_notification& note);
+
+        operation op;
+        transaction_id_type trx_id;
+        uint32_t trx_in_block = 0;
+        uint16_t op_in_trx = 0;
+        uint32_t virtual_op = 0;
+    };
+
+    /**
+     * Block with all its operations, including the virtual ones, in the order of applying
+     */
+    struct block_notification final {
+        uint32_t block_num = 0;
+        protocol::signed_block block;
+        std::vector<notified_operation> operations;
+    };
+
+    using block_notification_ptr = std::shared_ptr<const block_notification>;
+
+    namespace detail { class block_notification_bus_impl; }
+
+    /**
+     * Ordered stream of irreversible blocks for read-model plugins.
+     *
+     * Operations are collected while blocks are applied, and blocks are kept until they become irreversible,
+     *   blocks of switched forks are replaced by new ones. Irreversible blocks are passed to handlers in order:
+     *   - in the synchronous mode, in the applied_block handler of the database;
+     *   - in the asynchronous mode, in the separate thread, which reads blocks from the lock-free queue,
+     *     so the time of applying of blocks doesn't depend on the number of handlers,
+     *     but handlers can't access the database.
+     *
+     * Reversible blocks aren't passed to handlers on stop: the database rewinds the state
+     *   to the last irreversible block on open, so these blocks are applied and collected again after restart.
+     */
+    class block_notification_bus final {
+    public:
+        block_notification_bus(database& db);
+
+        ~block_notification_bus();
+
+        /**
+         * @param async pass blocks to handlers in the separate thread
+         * @param queue_size max number of blocks, which wait for handlers, applying of blocks waits when it's reached
+         */
+        void start(bool async, uint32_t queue_size);
+
+        /**
+         * Stop the thread after handling of the queued blocks, reversible blocks are dropped
+         */
+        void stop();
+
+        bool is_async() const;
+
+        boost::signals2::signal<void(const block_notification&)> on_irreversible_block;
+
+    private:
+        std::unique_ptr<detail::block_notification_bus_impl> my;
+    };
+
+} } // golos::chain
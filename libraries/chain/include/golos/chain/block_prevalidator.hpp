@@ -0,0 +1,90 @@
+#pragma once
+
+#include <golos/protocol/block.hpp>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <future>
+#include <memory>
+
+namespace golos { namespace chain {
+
+    using namespace golos::protocol;
+
+    class block_log;
+
+    /**
+     * Results of the stateless checks of a transaction.
+     * If a check fails, its result is left unset and the write thread repeats it to get the original error.
+     */
+    struct prevalidated_transaction final {
+        bool is_validated = false;       ///< trx.validate() passed
+        bool has_signature_keys = false; ///< signatures were recovered without errors
+        flat_set<public_key_type> signature_keys;
+    };
+
+    /**
+     * Block with the results of the stateless part of its validation. Nothing here depends on the chain state,
+     * that is why it can be calculated in worker threads, while the write thread only applies state changes.
+     */
+    struct prevalidated_block final {
+        signed_block block;
+        uint32_t size = 0;
+        bool has_merkle_root = false;
+        checksum_type merkle_root;
+        std::vector<prevalidated_transaction> transactions;
+    };
+
+    using prevalidated_block_ptr = std::shared_ptr<prevalidated_block>;
+
+    /**
+     * Pool of worker threads for the stateless block validation: size calculation, merkle root,
+     *   trx.validate() and recovering of signature keys.
+     *
+     * If the pool isn't started, blocks are prevalidated in the calling thread.
+     */
+    class block_prevalidator final {
+    public:
+        block_prevalidator();
+
+        ~block_prevalidator();
+
+        void start(uint32_t threads);
+
+        void stop();
+
+        bool is_started() const;
+
+        uint32_t threads() const;
+
+        /**
+         * Number of blocks which is reasonable to keep in flight to load all threads
+         */
+        uint32_t queue_depth() const;
+
+        /**
+         * Start prevalidation of the block
+         * @param skip validation steps to skip (see database::validation_steps)
+         */
+        std::future<prevalidated_block_ptr> prevalidate(signed_block block, uint32_t skip);
+
+        /**
+         * Start reading of the block from the block log and its prevalidation
+         * @param skip validation steps to skip (see database::validation_steps)
+         */
+        std::future<prevalidated_block_ptr> prevalidate(const block_log& log, uint32_t block_num, uint32_t skip);
+
+        static void prevalidate(prevalidated_block& pb, uint32_t skip);
+
+    private:
+        template <typename Loader>
+        std::future<prevalidated_block_ptr> post(Loader&& loader, uint32_t skip);
+
+        std::unique_ptr<boost::asio::io_service> _ios;
+        std::unique_ptr<boost::asio::io_service::work> _work;
+        boost::thread_group _thread_pool;
+        uint32_t _threads = 0;
+    };
+
+} } // golos::chain
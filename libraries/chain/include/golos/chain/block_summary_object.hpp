@@ -46,3 +46,6 @@ namespace golos {
 
 FC_REFLECT((golos::chain::block_summary_object), (id)(block_id))
 CHAINBASE_SET_INDEX_TYPE(golos::chain::block_summary_object, golos::chain::block_summary_index)
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::block_summary_object,
+    (id)(block_id))
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace golos { namespace chain {
+
+    /**
+     * Compressed storage of the block log data.
+     *
+     * It keeps the same byte stream as the plain block log file (blocks with positions after them),
+     *   so positions of blocks and the index file are the same for both formats.
+     *
+     * The stream is split into chunks of fixed size, each chunk is compressed by zlib with the preset
+     *   dictionary from the header. The last incomplete chunk is kept uncompressed in the tail file
+     *   until it is filled.
+     *
+     * Files:
+     *   - <path>: header (magic, version, chunk size, dictionary) and compressed chunks [size][data];
+     *   - <path>.chunks: positions of compressed chunks in the main file, it can be reconstructed;
+     *   - <path>.tail: stream position of the tail and uncompressed data of the tail.
+     */
+    class compressed_block_file final {
+    public:
+        static constexpr uint32_t default_chunk_size = 128 * 1024;
+
+        /// zlib uses only the last 32K of dictionary
+        static constexpr uint32_t max_dictionary_size = 32 * 1024;
+
+        compressed_block_file();
+
+        ~compressed_block_file();
+
+        /**
+         * Check that the file has the header of compressed format
+         */
+        static bool is_compressed(const std::string& path);
+
+        /**
+         * Create empty compressed file
+         */
+        static void create(const std::string& path, uint32_t chunk_size, const std::vector<char>& dictionary);
+
+        /**
+         * Remove the file and all its secondary files
+         */
+        static void remove(const std::string& path);
+
+        void open(const std::string& path);
+
+        void close();
+
+        bool is_open() const;
+
+        /**
+         * Size of the uncompressed stream
+         */
+        uint64_t size() const;
+
+        uint32_t chunk_size() const;
+
+        const std::vector<char>& dictionary() const;
+
+        /**
+         * Copy data of the uncompressed stream
+         */
+        void read(uint64_t pos, char* data, std::size_t size) const;
+
+        void append(const char* data, std::size_t size);
+
+        /**
+         * Ask OS to load compressed chunks of the range into the page cache
+         */
+        void prefetch(uint64_t begin, uint64_t end) const;
+
+        void set_sequential_access(bool value) const;
+
+    private:
+        using chunk_ptr = std::shared_ptr<const std::vector<char>>;
+
+        chunk_ptr get_chunk(uint64_t num) const;
+
+        std::vector<char> compress_chunk(const char* data) const;
+
+        void decompress_chunk(const char* data, uint32_t size, std::vector<char>& result) const;
+
+        void read_header();
+
+        void load_chunks();
+
+        void construct_chunks();
+
+        void write_chunks() const;
+
+        void load_tail();
+
+        void write_tail() const;
+
+        void append_chunk(const char* data);
+
+        void advise(std::size_t begin, std::size_t end, int advice) const;
+
+        std::string _path;
+        std::string _chunks_path;
+        std::string _tail_path;
+
+        boost::iostreams::mapped_file _file;
+
+        uint32_t _chunk_size = default_chunk_size;
+        std::vector<char> _dictionary;
+        std::size_t _data_start = 0;    ///< position of the first chunk in the file
+
+        std::vector<uint64_t> _chunks;  ///< positions of chunks in the file
+        std::vector<char> _tail;        ///< uncompressed data after the last chunk
+
+        /// small cache of decompressed chunks, it's used by several reading threads
+        static constexpr std::size_t cache_size = 16;
+        mutable std::mutex _cache_mutex;
+        mutable std::vector<std::pair<uint64_t, chunk_ptr>> _cache;
+    };
+
+} } // golos::chain
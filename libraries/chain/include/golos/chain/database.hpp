@@ -4,13 +4,16 @@
 #include <golos/chain/node_property_object.hpp>
 #include <golos/chain/fork_database.hpp>
 #include <golos/chain/block_log.hpp>
+#include <golos/chain/block_prevalidator.hpp>
 #include <golos/chain/hardfork.hpp>
+#include <golos/chain/state_snapshot.hpp>
 #include <golos/protocol/protocol.hpp>
 
 #include <fc/signals.hpp>
 
 #include <fc/log/logger.hpp>
 
+#include <atomic>
 #include <map>
 
 namespace golos { namespace chain {
@@ -30,6 +33,10 @@ namespace golos { namespace chain {
 
         struct comment_curation_info;
 
+        namespace detail {
+            struct prevalidated_block_helper;
+        }
+
         /**
          *   @class database
          *   @brief tracks the blockchain state in an extensible manner
@@ -58,10 +65,25 @@ namespace golos { namespace chain {
                 _is_generating = p;
             }
 
+            /**
+             * @return true while a block is pushed or generated, including waiting for the strong write lock
+             */
+            bool is_writing_block() const {
+                return _block_writers.load() != 0;
+            }
+
+            /**
+             * @return true while a block is applied, it's reset also if applying of the block fails
+             */
+            bool is_applying_block() const {
+                return _is_applying_block;
+            }
+
             bool is_transit_enabled() const;
 
             bool _is_producing = false;
             bool _is_generating = false;
+            bool _is_applying_block = false;
             bool _is_testing = false;           ///< set for tests to avoid low free memory spam
             bool _log_hardforks = true;
             uint32_t _fixed_irreversible_block_num = UINT32_MAX;
@@ -98,6 +120,9 @@ namespace golos { namespace chain {
              * Opens a database in the specified directory. If no initialized database is found the database
              * will be initialized with the default state.
              *
+             * If the shared memory is opened in read-only mode, the block log is opened only for reading,
+             * it's appended by the node which owns the shared memory.
+             *
              * @param data_dir Path to open or create database in
              */
             void open(const fc::path &data_dir, const fc::path &shared_mem_dir, uint64_t initial_supply = STEEMIT_INIT_SUPPLY, uint64_t shared_file_size = 0, uint32_t chainbase_flags = 0);
@@ -111,6 +136,30 @@ namespace golos { namespace chain {
             void reindex(const fc::path &data_dir, const fc::path &shared_mem_dir, uint32_t from_block_num, uint64_t shared_file_size = (
                     1024l * 1024l * 1024l * 8l));
 
+            /**
+             * @brief Open a database, initializing an empty one from the state snapshot
+             *
+             * The block log should contain the head block of the snapshot, blocks after it can be applied by
+             * @ref database::reindex.
+             *
+             * @param snapshot Path to the snapshot created by @ref database::create_state_snapshot
+             */
+            void open_from_state_snapshot(const fc::path &data_dir, const fc::path &shared_mem_dir, const fc::path &snapshot, uint64_t shared_file_size = 0, uint32_t chainbase_flags = 0);
+
+            /**
+             * @brief Save the state to the snapshot
+             *
+             * Database should be without undo history (e.g. just after opening), so the last irreversible state is saved.
+             */
+            void create_state_snapshot(const fc::path &snapshot);
+
+            void add_state_snapshot_index(std::unique_ptr<abstract_state_snapshot_index> index);
+
+            /**
+             * Set number of threads to create and load state snapshots, each index is processed by one thread
+             */
+            void set_state_snapshot_threads(uint32_t threads);
+
             void set_min_free_shared_memory_size(size_t);
             void set_inc_shared_memory_size(size_t);
             void set_block_num_check_free_size(uint32_t);
@@ -250,8 +299,16 @@ namespace golos { namespace chain {
 
             uint32_t validate_block(const signed_block &b, uint32_t skip = skip_nothing);
 
+            uint32_t validate_block(const prevalidated_block &b, uint32_t skip = skip_nothing);
+
             bool push_block(const signed_block &b, uint32_t skip = skip_nothing);
 
+            /**
+             * Push the block using the results of its stateless validation,
+             * which were calculated by the block_prevalidator
+             */
+            bool push_block(const prevalidated_block &b, uint32_t skip = skip_nothing);
+
             void enable_plugins_on_push_transaction(bool);
 
             void push_transaction(const signed_transaction &trx, uint32_t skip = skip_nothing);
@@ -260,6 +317,8 @@ namespace golos { namespace chain {
 
             bool _push_block(const signed_block &b, uint32_t skip);
 
+            bool _push_block_without_pending(const signed_block &b, uint32_t skip);
+
             void _push_transaction(const signed_transaction &trx, uint32_t skip);
 
             void push_proposal(const proposal_object&);
@@ -297,18 +356,28 @@ namespace golos { namespace chain {
             void notify_post_apply_operation(const operation_notification &note);
 
             inline const void push_virtual_operation(const operation &op, bool force = false); // vops are not needed for low mem. Force will push them on low mem.
+            void notify_pre_apply_block(const signed_block &block);
+
             void notify_applied_block(const signed_block &block);
 
             void notify_on_pending_transaction(const signed_transaction &tx);
 
             void notify_on_applied_transaction(const signed_transaction &tx);
 
+            void notify_block_write_unlocked();
+
             /**
              *  This signal is emitted for plugins to process every operation after it has been fully applied.
              */
             fc::signal<void(operation_notification &)> pre_apply_operation;
             fc::signal<void(const operation_notification &)> post_apply_operation;
 
+            /**
+             *  This signal is emitted before operations of a block are applied, it allows plugins
+             *  to collect data of the whole block and to process it in the applied_block handler.
+             */
+            fc::signal<void(const signed_block &)> pre_apply_block;
+
             /**
              *  This signal is emitted after all operations and virtual operation for a
              *  block have been applied but before the get_applied_operations() are cleared.
@@ -336,6 +405,12 @@ namespace golos { namespace chain {
              */
             fc::signal<void(const uint32_t, const uint32_t)> transit_to_cyberway;
 
+            /**
+             * This signal is emitted after the strong write lock of pushing or generating of a block is released.
+             * It is emitted in the write thread, so handlers should only schedule their work.
+             */
+            fc::signal<void()> block_write_unlocked;
+
             /**
              *  Emitted After a block has been applied and committed.  The callback
              *  should not yield and should execute quickly.
@@ -557,6 +632,8 @@ namespace golos { namespace chain {
 
             const block_log &get_block_log() const;
 
+            block_prevalidator &get_block_prevalidator();
+
         protected:
             //Mark pop_undo() as protected -- we do not want outside calling pop_undo(); it should call pop_block() instead
             //void pop_undo() { object_database::pop_undo(); }
@@ -565,11 +642,22 @@ namespace golos { namespace chain {
         private:
             optional<chainbase::database::session> _pending_tx_session;
 
+            void _open(const fc::path &data_dir, const fc::path &shared_mem_dir, uint64_t shared_file_size, uint32_t chainbase_flags, std::function<void()> init_state);
+
+            void load_state_snapshot(const fc::path &snapshot);
+
             void apply_block(const signed_block &next_block, uint32_t skip = skip_nothing);
 
             void apply_transaction(const signed_transaction &trx, uint32_t skip = skip_nothing);
 
-            void _validate_block(const signed_block& next_block, uint32_t skip);
+            void _validate_block(const signed_block& next_block, uint32_t skip, const prevalidated_block* prevalidated = nullptr);
+
+            const prevalidated_block* find_prevalidated_block(const signed_block& block) const;
+
+            const prevalidated_transaction* find_prevalidated_transaction(const signed_transaction& trx) const;
+
+            template <typename Lambda>
+            void with_block_write_lock(Lambda&& callback);
 
             void _apply_block(const signed_block &next_block, uint32_t skip);
 
@@ -632,14 +720,28 @@ namespace golos { namespace chain {
 
             block_log _block_log;
 
+            // it should be destroyed before _block_log, because its threads can read from the block log
+            block_prevalidator _block_prevalidator;
+
+            // block which is applied now, it's used only by the write thread
+            const prevalidated_block* _prevalidated_block = nullptr;
+
+            // number of threads, which push or generate blocks
+            std::atomic<uint32_t> _block_writers{0};
+
             // this function needs access to _plugin_index_signal
             template<typename MultiIndexType>
             friend void add_plugin_index(database &db);
 
             friend struct database_fixture;
 
+            friend struct detail::prevalidated_block_helper;
+
             fc::signal<void()> _plugin_index_signal;
 
+            flat_map<uint16_t, std::unique_ptr<abstract_state_snapshot_index>> _state_snapshot_indexes;
+            uint32_t _state_snapshot_threads = 1;
+
             transaction_id_type _current_trx_id;
             uint32_t _current_block_num = 0;
             uint16_t _current_trx_in_block = 0;
@@ -42,6 +42,8 @@ namespace golos {
 
         FC_DECLARE_DERIVED_EXCEPTION(database_signal_exception, golos::chain::chain_exception, 4130000, "database signal exception")
 
+        FC_DECLARE_DERIVED_EXCEPTION(state_snapshot_exception, golos::chain::chain_exception, 4140000, "state snapshot exception")
+
     }
 } // golos::chain
 
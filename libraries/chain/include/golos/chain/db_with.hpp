@@ -97,6 +97,21 @@ namespace golos {
                 database &_db;
             };
 
+            /**
+             * Class is used to help the with_prevalidated_block implementation
+             */
+            struct prevalidated_block_helper final {
+                prevalidated_block_helper(database& db, const prevalidated_block& block): _db(db) {
+                    _db._prevalidated_block = &block;
+                }
+
+                ~prevalidated_block_helper() {
+                    _db._prevalidated_block = nullptr;
+                }
+
+                database &_db;
+            };
+
             /**
              * Empty pending_transactions, call callback,
              * then reset pending_transactions after callback is done.
@@ -139,6 +154,19 @@ namespace golos {
                  callback();
              }
 
+             /**
+              * Use results of the stateless validation of the block while callback is applying it
+              */
+             template <typename Lambda>
+             void with_prevalidated_block(
+                 database& db,
+                 const prevalidated_block& block,
+                 Lambda callback
+             ) {
+                 prevalidated_block_helper restorer(db, block);
+                 callback();
+             }
+
         }
     }
 } // golos::chain::detail
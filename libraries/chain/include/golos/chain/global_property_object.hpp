@@ -196,3 +196,12 @@ FC_REFLECT((golos::chain::dynamic_global_property_object),
                 (transit_witnesses)
 )
 CHAINBASE_SET_INDEX_TYPE(golos::chain::dynamic_global_property_object, golos::chain::dynamic_global_property_index)
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::dynamic_global_property_object,
+    (id)(head_block_number)(head_block_id)(time)(current_witness)(total_pow)(num_pow_witnesses)
+    (virtual_supply)(current_supply)(confidential_supply)(current_sbd_supply)(confidential_sbd_supply)
+    (total_vesting_fund_steem)(total_vesting_shares)(total_reward_fund_steem)(total_reward_shares2)
+    (sbd_interest_rate)(sbd_print_rate)(is_forced_min_price)(average_block_size)(maximum_block_size)
+    (current_aslot)(recent_slots_filled)(participation_count)(last_irreversible_block_num)
+    (max_virtual_bandwidth)(current_reserve_ratio)(vote_regeneration_per_day)(custom_ops_bandwidth_multiplier)
+    (transit_block_num)(transit_witnesses))
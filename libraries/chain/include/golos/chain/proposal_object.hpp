@@ -142,4 +142,13 @@ namespace golos { namespace chain {
 } } // golos::chain
 
 CHAINBASE_SET_INDEX_TYPE(golos::chain::proposal_object, golos::chain::proposal_index);
-CHAINBASE_SET_INDEX_TYPE(golos::chain::required_approval_object, golos::chain::required_approval_index);
\ No newline at end of file
+CHAINBASE_SET_INDEX_TYPE(golos::chain::required_approval_object, golos::chain::required_approval_index);
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::proposal_object,
+    (id)(author)(title)(memo)(expiration_time)(review_period_time)(proposed_operations)
+    (required_active_approvals)(available_active_approvals)(required_owner_approvals)
+    (available_owner_approvals)(required_posting_approvals)(available_posting_approvals)
+    (available_key_approvals))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::required_approval_object,
+    (id)(account)(proposal))
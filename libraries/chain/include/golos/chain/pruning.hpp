@@ -0,0 +1,89 @@
+#pragma once
+
+#include <golos/chain/database.hpp>
+
+#include <fc/time.hpp>
+
+#include <algorithm>
+
+namespace golos {
+    namespace chain {
+
+        /**
+         * Limits pruning of old objects of plugins.
+         *
+         * Objects older than depth blocks are removed when the whole range of bucket_size blocks becomes old,
+         *   so pruning runs once per bucket instead of each block. Objects are still removed one by one:
+         *   each removing touches all indexes of the object and is recorded in the undo session,
+         *   so the time of pruning in one block is limited by the budget, the rest is removed in next blocks.
+         *   At least one object is removed in each call, so pruning goes on even if the budget is always spent.
+         *   The zero budget means no limit.
+         */
+        class block_pruner final {
+        public:
+            static constexpr uint32_t default_bucket_size = 1;
+            static constexpr uint32_t default_budget_ms = 10;
+
+            block_pruner(
+                uint32_t depth = UINT32_MAX,
+                uint32_t bucket_size = default_bucket_size,
+                fc::microseconds budget = fc::milliseconds(default_budget_ms))
+                : depth(depth),
+                  bucket_size(std::max(bucket_size, uint32_t(1))),
+                  budget(budget) {
+            }
+
+            /**
+             * @return the last block of the last bucket, which objects can be removed, or 0 if there is no such bucket
+             */
+            uint32_t get_prune_block(const database& db) const {
+                const auto head_block_num = db.head_block_num();
+                if (depth > head_block_num) {
+                    return 0;
+                }
+                const auto end = (head_block_num - depth + 1) / bucket_size * bucket_size;
+                return end ? end - 1 : 0;
+            }
+
+            /**
+             * Start the budget of the current block
+             */
+            void start() {
+                deadline = budget.count() > 0 ? fc::time_point::now() + budget : fc::time_point::maximum();
+            }
+
+            bool is_exceeded() const {
+                return fc::time_point::now() > deadline;
+            }
+
+            /**
+             * Remove objects of pruned blocks in the order of the index by blocks
+             * @return false if the budget was spent before all objects were removed
+             */
+            template <typename Index, typename Tag, typename Object>
+            bool remove_objects(database& db, uint32_t Object::*block) const {
+                const auto prune_block = get_prune_block(db);
+                const auto& idx = db.get_index<Index>().indices().template get<Tag>();
+                bool has_removed = false;
+                for (auto itr = idx.begin(); itr != idx.end() && (*itr).*block <= prune_block;) {
+                    if (has_removed && is_exceeded()) {
+                        return false;
+                    }
+                    const auto& object = *itr;
+                    ++itr;
+                    db.remove(object);
+                    has_removed = true;
+                }
+                return true;
+            }
+
+            uint32_t depth;
+            uint32_t bucket_size;
+            fc::microseconds budget;
+
+        private:
+            fc::time_point deadline = fc::time_point::maximum();
+        };
+
+    }
+}
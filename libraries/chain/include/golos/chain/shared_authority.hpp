@@ -1,6 +1,7 @@
 #pragma once
 
 #include <golos/protocol/authority.hpp>
+#include <golos/chain/state_snapshot_reflect.hpp>
 #include <boost/interprocess/managed_mapped_file.hpp>
 
 namespace golos {
@@ -110,3 +111,6 @@ namespace golos {
 
 FC_REFLECT_TYPENAME((golos::chain::shared_authority::account_authority_map))
 FC_REFLECT((golos::chain::shared_authority), (weight_threshold)(account_auths)(key_auths))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::shared_authority,
+    (weight_threshold)(account_auths)(key_auths))
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <golos/protocol/types.hpp>
+
+#include <chainbase/chainbase.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/filesystem.hpp>
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace golos { namespace chain {
+
+    using golos::protocol::chain_id_type;
+    using golos::protocol::block_id_type;
+
+    /**
+     * Snapshot of the chainbase state: all core and plugin indexes, which allows to start a node
+     *   without replaying of the whole block log.
+     *
+     * File format:
+     *   - magic bytes;
+     *   - header (state_snapshot_header);
+     *   - chunks of records, each chunk belongs to one section (index) and is compressed separately;
+     *   - table of sections (state_snapshot_section) and its offset in the end of file.
+     *
+     * Sections are written and loaded by several threads, so chunks of different sections are interleaved.
+     *
+     * Object ids are renumbered to go in a row without gaps (with keeping of their order),
+     *   references to other objects (object_id<T> members) are renumbered too.
+     */
+    constexpr uint32_t state_snapshot_version = 2;
+
+    struct state_snapshot_header final {
+        uint32_t version = state_snapshot_version;
+        chain_id_type chain_id;
+        uint32_t block_num = 0;
+        block_id_type block_id;
+        fc::time_point_sec block_time;
+        uint32_t sections_count = 0;
+    };
+
+    struct state_snapshot_section final {
+        uint16_t type_id = 0;
+        std::string name;
+        fc::sha256 layout;          ///< hash of the object structure, see state_snapshot_reflector
+        int64_t first_id = 0;       ///< id of the first record, next ones go in a row
+        uint64_t records_count = 0;
+        uint64_t data_size = 0;     ///< size of uncompressed records in bytes
+        fc::sha256 checksum;        ///< hash of uncompressed records
+    };
+
+    /**
+     * Map of object ids from the state to the snapshot ids
+     */
+    class state_snapshot_id_map final {
+    public:
+        /**
+         * @param ids sorted ids of all objects of the index
+         */
+        void add(uint16_t type_id, std::vector<int64_t> ids);
+
+        int64_t first_id(uint16_t type_id) const;
+
+        int64_t get(uint16_t type_id, int64_t id) const;
+
+    private:
+        struct table_type final {
+            int64_t first_id = 0;
+            std::vector<int64_t> ids; ///< empty if the ids already go in a row
+        };
+
+        std::unordered_map<uint16_t, table_type> _tables;
+    };
+
+    /**
+     * Interning of strings in a section: the string is written once, and next occurrences refer to it by number.
+     *
+     * Packed string starts with a tag: string_literal (it's not interned), string_new (it's interned and
+     *   gets the next number) or string_first_ref + number of the interned string.
+     */
+    enum state_snapshot_string_tag: uint32_t {
+        string_literal = 0,
+        string_new = 1,
+        string_first_ref = 2
+    };
+
+    class state_snapshot_string_writer final {
+    public:
+        /// Long strings (posts, metadata) are rarely repeated, so they aren't interned
+        static constexpr std::size_t max_interned_size = 256;
+
+        /**
+         * @return tag of string (see state_snapshot_string_tag)
+         */
+        uint32_t put(const char* data, std::size_t size);
+
+    private:
+        std::unordered_map<std::string, uint32_t> _items;
+    };
+
+    class state_snapshot_string_reader final {
+    public:
+        void add(std::string item);
+
+        const std::string& get(uint32_t tag) const;
+
+    private:
+        std::vector<std::string> _items;
+    };
+
+    /**
+     * Thread-safe writer of the snapshot file
+     */
+    class state_snapshot_writer final {
+    public:
+        state_snapshot_writer(const fc::path& path, const state_snapshot_header& header);
+
+        /**
+         * Compress the chunk of records and append it to the file
+         */
+        void write_chunk(uint16_t section_num, const char* data, std::size_t size);
+
+        void close(const std::vector<state_snapshot_section>& sections);
+
+    private:
+        void write(const char* data, std::size_t size);
+
+        template <typename T>
+        void write_blob(const T& value);
+
+        std::mutex _mutex;
+        std::ofstream _out;
+    };
+
+    /**
+     * Writer of one section, it's used only by one thread
+     */
+    class state_snapshot_section_writer final {
+    public:
+        /// Max size of uncompressed chunk, bigger chunks compress better, but require more memory for each thread
+        static constexpr std::size_t chunk_size = 1024 * 1024;
+
+        state_snapshot_section_writer(state_snapshot_writer& out, uint16_t section_num, state_snapshot_section& section);
+
+        /**
+         * Start the record, its data should be appended to the returned buffer
+         */
+        std::vector<char>& begin_record();
+
+        void end_record();
+
+        state_snapshot_string_writer& strings();
+
+        void finish();
+
+    private:
+        /**
+         * Write the first size bytes of the buffer as a chunk
+         */
+        void flush(std::size_t size);
+
+        state_snapshot_writer& _out;
+        uint16_t _section_num;
+        state_snapshot_section& _section;
+        std::vector<char> _buffer;
+        std::size_t _record_pos = 0;
+        fc::sha256::encoder _encoder;
+        state_snapshot_string_writer _strings;
+    };
+
+    struct state_snapshot_chunk final {
+        uint16_t section_num = 0;
+        uint32_t size = 0;          ///< size of uncompressed data
+        std::vector<char> data;
+
+        /**
+         * Decompress data of chunk
+         */
+        void unpack(std::vector<char>& result) const;
+    };
+
+    class state_snapshot_reader final {
+    public:
+        explicit state_snapshot_reader(const fc::path& path);
+
+        const state_snapshot_header& header() const;
+
+        const std::vector<state_snapshot_section>& sections() const;
+
+        /**
+         * Read the next chunk of records
+         * @return false if there are no more chunks
+         */
+        bool read_chunk(state_snapshot_chunk& chunk);
+
+    private:
+        void read(char* data, std::size_t size);
+
+        template <typename T>
+        void read_blob(T& value);
+
+        std::ifstream _in;
+        state_snapshot_header _header;
+        std::vector<state_snapshot_section> _sections;
+        uint64_t _data_end = 0;
+    };
+
+    /**
+     * Loader of records of one section, it's used only by one thread
+     */
+    class abstract_state_snapshot_loader {
+    public:
+        virtual ~abstract_state_snapshot_loader() = default;
+
+        virtual void load(const char* data, uint32_t size) = 0;
+    };
+
+    /**
+     * Serializer of the index to the state snapshot, it's registered for each index (see add_core_index())
+     */
+    class abstract_state_snapshot_index {
+    public:
+        virtual ~abstract_state_snapshot_index() = default;
+
+        virtual uint16_t type_id() const = 0;
+
+        virtual std::string name(const chainbase::database& db) const = 0;
+
+        virtual fc::sha256 layout() const = 0;
+
+        virtual std::size_t size(const chainbase::database& db) const = 0;
+
+        virtual std::vector<int64_t> ids(const chainbase::database& db) const = 0;
+
+        virtual void write(
+            const chainbase::database& db, const state_snapshot_id_map& id_map, state_snapshot_section_writer& out
+        ) const = 0;
+
+        virtual std::unique_ptr<abstract_state_snapshot_loader> create_loader(
+            chainbase::database& db, const state_snapshot_section& section) const = 0;
+    };
+
+} } // golos::chain
+
+FC_REFLECT((golos::chain::state_snapshot_header),
+    (version)(chain_id)(block_num)(block_id)(block_time)(sections_count))
+
+FC_REFLECT((golos::chain::state_snapshot_section),
+    (type_id)(name)(layout)(first_id)(records_count)(data_size)(checksum))
@@ -0,0 +1,519 @@
+#pragma once
+
+#include <golos/chain/state_snapshot.hpp>
+#include <golos/chain/steem_object_types.hpp>
+#include <golos/chain/database_exceptions.hpp>
+
+#include <boost/interprocess/containers/deque.hpp>
+#include <boost/interprocess/containers/flat_map.hpp>
+#include <boost/interprocess/containers/flat_set.hpp>
+#include <boost/interprocess/containers/vector.hpp>
+
+#include <fc/io/raw.hpp>
+
+namespace golos { namespace chain {
+
+    namespace detail {
+        namespace bip = boost::interprocess;
+
+        struct snapshot_pack_context final {
+            const state_snapshot_id_map& id_map;
+            state_snapshot_string_writer& strings;
+        };
+
+        struct snapshot_unpack_context final {
+            state_snapshot_string_reader strings;
+        };
+
+        /**
+         * Stream which appends data to the buffer, it allows to pack the record in one pass
+         */
+        class snapshot_buffer_stream final {
+        public:
+            explicit snapshot_buffer_stream(std::vector<char>& buffer)
+                : _buffer(buffer) {
+            }
+
+            bool write(const char* data, std::size_t size) {
+                _buffer.insert(_buffer.end(), data, data + size);
+                return true;
+            }
+
+            bool put(char c) {
+                _buffer.push_back(c);
+                return true;
+            }
+
+        private:
+            std::vector<char>& _buffer;
+        };
+
+        // Declarations go first to make all overloads visible from the generic functions
+
+        template <typename Stream, typename T>
+        void snapshot_pack(Stream& s, const T& v, snapshot_pack_context& ctx);
+
+        template <typename Stream, typename T>
+        void snapshot_pack(Stream& s, const object_id<T>& v, snapshot_pack_context& ctx);
+
+        template <typename Stream>
+        void snapshot_pack(Stream& s, const shared_string& v, snapshot_pack_context& ctx);
+
+        template <typename Stream>
+        void snapshot_pack(Stream& s, const account_name_type& v, snapshot_pack_context& ctx);
+
+        template <typename Stream, typename A>
+        void snapshot_pack(Stream& s, const bip::vector<char, A>& v, snapshot_pack_context& ctx);
+
+        template <typename Stream, typename T, typename A>
+        void snapshot_pack(Stream& s, const bip::vector<T, A>& v, snapshot_pack_context& ctx);
+
+        template <typename Stream, typename T, typename A>
+        void snapshot_pack(Stream& s, const bip::deque<T, A>& v, snapshot_pack_context& ctx);
+
+        template <typename Stream, typename T, typename C, typename A>
+        void snapshot_pack(Stream& s, const bip::flat_set<T, C, A>& v, snapshot_pack_context& ctx);
+
+        template <typename Stream, typename K, typename V, typename C, typename A>
+        void snapshot_pack(Stream& s, const bip::flat_map<K, V, C, A>& v, snapshot_pack_context& ctx);
+
+        template <typename Stream, typename T>
+        void snapshot_unpack(Stream& s, T& v, snapshot_unpack_context& ctx);
+
+        template <typename Stream, typename T>
+        void snapshot_unpack(Stream& s, object_id<T>& v, snapshot_unpack_context& ctx);
+
+        template <typename Stream>
+        void snapshot_unpack(Stream& s, shared_string& v, snapshot_unpack_context& ctx);
+
+        template <typename Stream>
+        void snapshot_unpack(Stream& s, account_name_type& v, snapshot_unpack_context& ctx);
+
+        template <typename Stream, typename A>
+        void snapshot_unpack(Stream& s, bip::vector<char, A>& v, snapshot_unpack_context& ctx);
+
+        template <typename Stream, typename T, typename A>
+        void snapshot_unpack(Stream& s, bip::vector<T, A>& v, snapshot_unpack_context& ctx);
+
+        template <typename Stream, typename T, typename A>
+        void snapshot_unpack(Stream& s, bip::deque<T, A>& v, snapshot_unpack_context& ctx);
+
+        template <typename Stream, typename T, typename C, typename A>
+        void snapshot_unpack(Stream& s, bip::flat_set<T, C, A>& v, snapshot_unpack_context& ctx);
+
+        template <typename Stream, typename K, typename V, typename C, typename A>
+        void snapshot_unpack(Stream& s, bip::flat_map<K, V, C, A>& v, snapshot_unpack_context& ctx);
+
+        template <typename T>
+        std::string snapshot_layout(const T*);
+
+        template <typename T>
+        std::string snapshot_layout(const object_id<T>*);
+
+        inline std::string snapshot_layout(const shared_string*);
+
+        inline std::string snapshot_layout(const account_name_type*);
+
+        template <typename A>
+        std::string snapshot_layout(const bip::vector<char, A>*);
+
+        template <typename T, typename A>
+        std::string snapshot_layout(const bip::vector<T, A>*);
+
+        template <typename T, typename A>
+        std::string snapshot_layout(const bip::deque<T, A>*);
+
+        template <typename T, typename C, typename A>
+        std::string snapshot_layout(const bip::flat_set<T, C, A>*);
+
+        template <typename K, typename V, typename C, typename A>
+        std::string snapshot_layout(const bip::flat_map<K, V, C, A>*);
+
+        // Kinds of types: reflected for the snapshot, plain values, types serialized by fc::raw
+
+        using snapshot_reflected_kind = std::integral_constant<int, 0>;
+        using snapshot_plain_kind = std::integral_constant<int, 1>;
+        using snapshot_fc_kind = std::integral_constant<int, 2>;
+
+        template <typename T>
+        using snapshot_kind = std::integral_constant<int,
+            state_snapshot_reflector<T>::is_defined::value ? snapshot_reflected_kind::value :
+            std::is_arithmetic<T>::value || std::is_enum<T>::value ? snapshot_plain_kind::value :
+            snapshot_fc_kind::value>;
+
+        template <typename T, typename Member>
+        using snapshot_member_type = typename std::decay<decltype(std::declval<const T&>().*std::declval<Member>())>::type;
+
+        template <typename Stream>
+        void snapshot_pack_string(Stream& s, const char* data, std::size_t size, snapshot_pack_context& ctx) {
+            auto tag = ctx.strings.put(data, size);
+            fc::raw::pack(s, fc::unsigned_int(tag));
+            if (tag < string_first_ref) {
+                fc::raw::pack(s, fc::unsigned_int(size));
+                s.write(data, size);
+            }
+        }
+
+        template <typename Stream, typename Assign>
+        void snapshot_unpack_string(Stream& s, snapshot_unpack_context& ctx, Assign&& assign) {
+            fc::unsigned_int tag;
+            fc::raw::unpack(s, tag);
+            if (tag.value >= string_first_ref) {
+                const auto& item = ctx.strings.get(tag.value);
+                assign(item.data(), item.size());
+                return;
+            }
+
+            fc::unsigned_int size;
+            fc::raw::unpack(s, size);
+            std::string item(size.value, '\0');
+            if (size.value) {
+                s.read(&item[0], size.value);
+            }
+            assign(item.data(), item.size());
+            if (tag.value == string_new) {
+                ctx.strings.add(std::move(item));
+            }
+        }
+
+        template <typename Stream, typename T>
+        void snapshot_pack_value(Stream& s, const T& v, snapshot_pack_context& ctx, snapshot_reflected_kind) {
+            state_snapshot_reflector<T>::visit([&](const char*, auto member) {
+                snapshot_pack(s, v.*member, ctx);
+            });
+        }
+
+        template <typename Stream, typename T>
+        void snapshot_pack_value(Stream& s, const T& v, snapshot_pack_context&, snapshot_plain_kind) {
+            s.write(reinterpret_cast<const char*>(&v), sizeof(v));
+        }
+
+        template <typename Stream, typename T>
+        void snapshot_pack_value(Stream& s, const T& v, snapshot_pack_context&, snapshot_fc_kind) {
+            fc::raw::pack(s, v);
+        }
+
+        template <typename Stream, typename T>
+        void snapshot_pack(Stream& s, const T& v, snapshot_pack_context& ctx) {
+            snapshot_pack_value(s, v, ctx, snapshot_kind<T>());
+        }
+
+        template <typename Stream, typename T>
+        void snapshot_pack(Stream& s, const object_id<T>& v, snapshot_pack_context& ctx) {
+            int64_t id = ctx.id_map.get(T::type_id, v._id);
+            s.write(reinterpret_cast<const char*>(&id), sizeof(id));
+        }
+
+        template <typename Stream>
+        void snapshot_pack(Stream& s, const shared_string& v, snapshot_pack_context& ctx) {
+            snapshot_pack_string(s, v.data(), v.size(), ctx);
+        }
+
+        template <typename Stream>
+        void snapshot_pack(Stream& s, const account_name_type& v, snapshot_pack_context& ctx) {
+            auto name = std::string(v);
+            snapshot_pack_string(s, name.data(), name.size(), ctx);
+        }
+
+        template <typename Stream, typename A>
+        void snapshot_pack(Stream& s, const bip::vector<char, A>& v, snapshot_pack_context&) {
+            fc::raw::pack(s, fc::unsigned_int(v.size()));
+            s.write(v.data(), v.size());
+        }
+
+        template <typename Stream, typename T, typename A>
+        void snapshot_pack(Stream& s, const bip::vector<T, A>& v, snapshot_pack_context& ctx) {
+            fc::raw::pack(s, fc::unsigned_int(v.size()));
+            for (const auto& item: v) {
+                snapshot_pack(s, item, ctx);
+            }
+        }
+
+        template <typename Stream, typename T, typename A>
+        void snapshot_pack(Stream& s, const bip::deque<T, A>& v, snapshot_pack_context& ctx) {
+            fc::raw::pack(s, fc::unsigned_int(v.size()));
+            for (const auto& item: v) {
+                snapshot_pack(s, item, ctx);
+            }
+        }
+
+        template <typename Stream, typename T, typename C, typename A>
+        void snapshot_pack(Stream& s, const bip::flat_set<T, C, A>& v, snapshot_pack_context& ctx) {
+            fc::raw::pack(s, fc::unsigned_int(v.size()));
+            for (const auto& item: v) {
+                snapshot_pack(s, item, ctx);
+            }
+        }
+
+        template <typename Stream, typename K, typename V, typename C, typename A>
+        void snapshot_pack(Stream& s, const bip::flat_map<K, V, C, A>& v, snapshot_pack_context& ctx) {
+            fc::raw::pack(s, fc::unsigned_int(v.size()));
+            for (const auto& item: v) {
+                snapshot_pack(s, item.first, ctx);
+                snapshot_pack(s, item.second, ctx);
+            }
+        }
+
+        template <typename Stream, typename T>
+        void snapshot_unpack_value(Stream& s, T& v, snapshot_unpack_context& ctx, snapshot_reflected_kind) {
+            state_snapshot_reflector<T>::visit([&](const char*, auto member) {
+                snapshot_unpack(s, v.*member, ctx);
+            });
+        }
+
+        template <typename Stream, typename T>
+        void snapshot_unpack_value(Stream& s, T& v, snapshot_unpack_context&, snapshot_plain_kind) {
+            s.read(reinterpret_cast<char*>(&v), sizeof(v));
+        }
+
+        template <typename Stream, typename T>
+        void snapshot_unpack_value(Stream& s, T& v, snapshot_unpack_context&, snapshot_fc_kind) {
+            fc::raw::unpack(s, v);
+        }
+
+        template <typename Stream, typename T>
+        void snapshot_unpack(Stream& s, T& v, snapshot_unpack_context& ctx) {
+            snapshot_unpack_value(s, v, ctx, snapshot_kind<T>());
+        }
+
+        template <typename Stream, typename T>
+        void snapshot_unpack(Stream& s, object_id<T>& v, snapshot_unpack_context&) {
+            s.read(reinterpret_cast<char*>(&v._id), sizeof(v._id));
+        }
+
+        template <typename Stream>
+        void snapshot_unpack(Stream& s, shared_string& v, snapshot_unpack_context& ctx) {
+            snapshot_unpack_string(s, ctx, [&](const char* data, std::size_t size) {
+                v.assign(data, size);
+            });
+        }
+
+        template <typename Stream>
+        void snapshot_unpack(Stream& s, account_name_type& v, snapshot_unpack_context& ctx) {
+            snapshot_unpack_string(s, ctx, [&](const char* data, std::size_t size) {
+                v = std::string(data, size);
+            });
+        }
+
+        template <typename Stream, typename A>
+        void snapshot_unpack(Stream& s, bip::vector<char, A>& v, snapshot_unpack_context&) {
+            fc::unsigned_int size;
+            fc::raw::unpack(s, size);
+            v.resize(size.value);
+            if (size.value) {
+                s.read(v.data(), size.value);
+            }
+        }
+
+        template <typename Stream, typename T, typename A>
+        void snapshot_unpack(Stream& s, bip::vector<T, A>& v, snapshot_unpack_context& ctx) {
+            fc::unsigned_int size;
+            fc::raw::unpack(s, size);
+            v.clear();
+            v.resize(size.value);
+            for (auto& item: v) {
+                snapshot_unpack(s, item, ctx);
+            }
+        }
+
+        template <typename Stream, typename T, typename A>
+        void snapshot_unpack(Stream& s, bip::deque<T, A>& v, snapshot_unpack_context& ctx) {
+            fc::unsigned_int size;
+            fc::raw::unpack(s, size);
+            v.clear();
+            v.resize(size.value);
+            for (auto& item: v) {
+                snapshot_unpack(s, item, ctx);
+            }
+        }
+
+        template <typename Stream, typename T, typename C, typename A>
+        void snapshot_unpack(Stream& s, bip::flat_set<T, C, A>& v, snapshot_unpack_context& ctx) {
+            fc::unsigned_int size;
+            fc::raw::unpack(s, size);
+            v.clear();
+            v.reserve(size.value);
+            for (uint32_t i = 0; i < size.value; ++i) {
+                T item;
+                snapshot_unpack(s, item, ctx);
+                v.insert(v.end(), std::move(item));
+            }
+        }
+
+        template <typename Stream, typename K, typename V, typename C, typename A>
+        void snapshot_unpack(Stream& s, bip::flat_map<K, V, C, A>& v, snapshot_unpack_context& ctx) {
+            fc::unsigned_int size;
+            fc::raw::unpack(s, size);
+            v.clear();
+            v.reserve(size.value);
+            for (uint32_t i = 0; i < size.value; ++i) {
+                K key;
+                V value;
+                snapshot_unpack(s, key, ctx);
+                snapshot_unpack(s, value, ctx);
+                v.emplace_hint(v.end(), std::move(key), std::move(value));
+            }
+        }
+
+        template <typename T>
+        std::string snapshot_layout_value(snapshot_reflected_kind) {
+            std::string result = "{";
+            state_snapshot_reflector<T>::visit([&](const char* name, auto member) {
+                using member_type = snapshot_member_type<T, decltype(member)>;
+                result += name;
+                result += ':';
+                result += snapshot_layout(static_cast<const member_type*>(nullptr));
+                result += ';';
+            });
+            result += '}';
+            return result;
+        }
+
+        template <typename T>
+        std::string snapshot_layout_value(snapshot_plain_kind) {
+            return "p" + std::to_string(sizeof(T));
+        }
+
+        template <typename T>
+        std::string snapshot_layout_value(snapshot_fc_kind) {
+            return "r" + std::to_string(sizeof(T));
+        }
+
+        template <typename T>
+        std::string snapshot_layout(const T*) {
+            return snapshot_layout_value<T>(snapshot_kind<T>());
+        }
+
+        template <typename T>
+        std::string snapshot_layout(const object_id<T>*) {
+            return "id";
+        }
+
+        inline std::string snapshot_layout(const shared_string*) {
+            return "string";
+        }
+
+        inline std::string snapshot_layout(const account_name_type*) {
+            return "name";
+        }
+
+        template <typename A>
+        std::string snapshot_layout(const bip::vector<char, A>*) {
+            return "bytes";
+        }
+
+        template <typename T, typename A>
+        std::string snapshot_layout(const bip::vector<T, A>*) {
+            return "[" + snapshot_layout(static_cast<const T*>(nullptr)) + "]";
+        }
+
+        template <typename T, typename A>
+        std::string snapshot_layout(const bip::deque<T, A>*) {
+            return "[" + snapshot_layout(static_cast<const T*>(nullptr)) + "]";
+        }
+
+        template <typename T, typename C, typename A>
+        std::string snapshot_layout(const bip::flat_set<T, C, A>*) {
+            return "[" + snapshot_layout(static_cast<const T*>(nullptr)) + "]";
+        }
+
+        template <typename K, typename V, typename C, typename A>
+        std::string snapshot_layout(const bip::flat_map<K, V, C, A>*) {
+            return "[" + snapshot_layout(static_cast<const K*>(nullptr)) + ":" +
+                snapshot_layout(static_cast<const V*>(nullptr)) + "]";
+        }
+
+        template <typename MultiIndexType>
+        class state_snapshot_loader final: public abstract_state_snapshot_loader {
+        public:
+            using object_type = typename MultiIndexType::value_type;
+
+            state_snapshot_loader(chainbase::database& db, const state_snapshot_section& section)
+                : _db(db),
+                  _section(section) {
+            }
+
+            void load(const char* data, uint32_t size) override {
+                _db.create<object_type>([&](object_type& o) {
+                    // ids of snapshot go in a row, so they should be the same as the ids assigned by chainbase
+                    auto next_id = o.id;
+                    fc::datastream<const char*> ds(data, size);
+                    snapshot_unpack(ds, o, _ctx);
+                    GOLOS_ASSERT(ds.remaining() == 0, state_snapshot_exception,
+                        "Record of ${name} has ${n} unread bytes", ("name", _section.name)("n", ds.remaining()));
+                    GOLOS_ASSERT(o.id == next_id, state_snapshot_exception,
+                        "Object of ${name} has id ${id}, but ${next_id} is expected",
+                        ("name", _section.name)("id", o.id._id)("next_id", next_id._id));
+                });
+            }
+
+        private:
+            chainbase::database& _db;
+            const state_snapshot_section& _section;
+            snapshot_unpack_context _ctx;
+        };
+
+    } // detail
+
+    template <typename MultiIndexType>
+    class state_snapshot_index final: public abstract_state_snapshot_index {
+    public:
+        using object_type = typename MultiIndexType::value_type;
+
+        static_assert(state_snapshot_reflector<object_type>::is_defined::value,
+            "Object should be declared with GOLOS_STATE_SNAPSHOT_REFLECT to be stored in the state snapshot");
+
+        uint16_t type_id() const override {
+            return object_type::type_id;
+        }
+
+        std::string name(const chainbase::database& db) const override {
+            return db.get_index<MultiIndexType>().name();
+        }
+
+        fc::sha256 layout() const override {
+            return fc::sha256::hash(detail::snapshot_layout(static_cast<const object_type*>(nullptr)));
+        }
+
+        std::size_t size(const chainbase::database& db) const override {
+            return db.get_index<MultiIndexType>().indices().size();
+        }
+
+        std::vector<int64_t> ids(const chainbase::database& db) const override {
+            // the first index of chainbase container is ordered by id
+            const auto& idx = db.get_index<MultiIndexType>().indices();
+            std::vector<int64_t> result;
+            result.reserve(idx.size());
+            for (const auto& o: idx) {
+                result.push_back(o.id._id);
+            }
+            return result;
+        }
+
+        void write(
+            const chainbase::database& db, const state_snapshot_id_map& id_map, state_snapshot_section_writer& out
+        ) const override {
+            detail::snapshot_pack_context ctx{id_map, out.strings()};
+            for (const auto& o: db.get_index<MultiIndexType>().indices()) {
+                detail::snapshot_buffer_stream s(out.begin_record());
+                detail::snapshot_pack(s, o, ctx);
+                out.end_record();
+            }
+        }
+
+        std::unique_ptr<abstract_state_snapshot_loader> create_loader(
+            chainbase::database& db, const state_snapshot_section& section
+        ) const override {
+            GOLOS_ASSERT(db.get_index<MultiIndexType>().indices().empty(), state_snapshot_exception,
+                "Index ${name} should be empty before loading from snapshot", ("name", section.name));
+
+            // fresh index starts from 0, skip id 0 if it was absent in the original state
+            for (int64_t i = 0; i < section.first_id; ++i) {
+                db.remove(db.create<object_type>([](object_type&) {}));
+            }
+
+            return std::make_unique<detail::state_snapshot_loader<MultiIndexType>>(db, section);
+        }
+    };
+
+} } // golos::chain
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/stringize.hpp>
+
+#include <type_traits>
+
+namespace golos { namespace chain {
+
+    /**
+     * Full list of object members, which are stored in the state snapshot.
+     *
+     * It is declared separately from FC_REFLECT, because FC_REFLECT of objects is used by API and
+     *   CyberWay genesis, and it can skip some members. Snapshot should keep all of them.
+     */
+    template <typename T>
+    struct state_snapshot_reflector final {
+        using is_defined = std::false_type;
+    };
+
+} } // golos::chain
+
+#define GOLOS_STATE_SNAPSHOT_VISIT_MEMBER(r, visitor, elem) \
+    visitor(BOOST_PP_STRINGIZE(elem), &type::elem);
+
+/**
+ * Declare members of a chainbase object (or a nested structure), which are stored in the state snapshot.
+ * Should be used in the global namespace, like FC_REFLECT:
+ *
+ *   GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::account_object, (id)(name)...)
+ */
+#define GOLOS_STATE_SNAPSHOT_REFLECT(TYPE, MEMBERS) \
+    namespace golos { namespace chain { \
+        template <> \
+        struct state_snapshot_reflector<TYPE> final { \
+            using type = TYPE; \
+            using is_defined = std::true_type; \
+            \
+            template <typename Visitor> \
+            static void visit(Visitor&& visitor) { \
+                BOOST_PP_SEQ_FOR_EACH(GOLOS_STATE_SNAPSHOT_VISIT_MEMBER, visitor, MEMBERS) \
+            } \
+        }; \
+    } }
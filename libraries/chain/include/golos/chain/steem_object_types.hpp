@@ -10,6 +10,8 @@
 #include <golos/protocol/types.hpp>
 #include <golos/protocol/authority.hpp>
 
+#include <golos/chain/state_snapshot_reflect.hpp>
+
 
 namespace golos { namespace chain {
 
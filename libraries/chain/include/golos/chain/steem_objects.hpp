@@ -513,3 +513,28 @@ CHAINBASE_SET_INDEX_TYPE(golos::chain::escrow_object, golos::chain::escrow_index
 FC_REFLECT((golos::chain::decline_voting_rights_request_object),
         (id)(account)(effective_date))
 CHAINBASE_SET_INDEX_TYPE(golos::chain::decline_voting_rights_request_object, golos::chain::decline_voting_rights_request_index)
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::convert_request_object,
+    (id)(owner)(requestid)(amount)(conversion_date))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::escrow_object,
+    (id)(escrow_id)(from)(to)(agent)(ratification_deadline)(escrow_expiration)(sbd_balance)(steem_balance)
+    (pending_fee)(to_approved)(agent_approved)(disputed))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::savings_withdraw_object,
+    (id)(from)(to)(memo)(request_id)(amount)(complete))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::liquidity_reward_balance_object,
+    (id)(owner)(steem_volume)(sbd_volume)(weight)(last_update))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::feed_history_object,
+    (id)(current_median_history)(price_history))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::limit_order_object,
+    (id)(created)(expiration)(seller)(orderid)(for_sale)(sell_price))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::withdraw_vesting_route_object,
+    (id)(from_account)(to_account)(percent)(auto_vest))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::decline_voting_rights_request_object,
+    (id)(account)(effective_date))
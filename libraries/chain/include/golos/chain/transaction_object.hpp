@@ -53,3 +53,6 @@ namespace golos {
 
 FC_REFLECT((golos::chain::transaction_object), (id)(packed_trx)(trx_id)(expiration))
 CHAINBASE_SET_INDEX_TYPE(golos::chain::transaction_object, golos::chain::transaction_index)
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::transaction_object,
+    (id)(packed_trx)(trx_id)(expiration))
@@ -6,6 +6,7 @@
 #include <golos/chain/steem_object_types.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
 
 namespace golos { namespace chain {
 
@@ -165,6 +166,7 @@ namespace golos { namespace chain {
 
     struct by_vote_name;
     struct by_name;
+    struct by_hashed_name;
     struct by_pow;
     struct by_work;
     struct by_schedule_time;
@@ -184,6 +186,10 @@ namespace golos { namespace chain {
             ordered_unique<
                 tag<by_name>,
                 member<witness_object, account_name_type, &witness_object::owner>>,
+            hashed_unique<
+                tag<by_hashed_name>,
+                member<witness_object, account_name_type, &witness_object::owner>,
+                golos::protocol::string_hash>,
             ordered_non_unique<
                 tag<by_pow>,
                 member<witness_object, uint64_t, &witness_object::pow_worker>>,
@@ -262,3 +268,17 @@ FC_REFLECT(
 CHAINBASE_SET_INDEX_TYPE(golos::chain::witness_vote_object, golos::chain::witness_vote_index)
 
 CHAINBASE_SET_INDEX_TYPE(golos::chain::witness_schedule_object, golos::chain::witness_schedule_index)
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::witness_object,
+    (id)(owner)(created)(url)(total_missed)(last_aslot)(last_confirmed_block_num)(pow_worker)(signing_key)
+    (props)(sbd_exchange_rate)(last_sbd_exchange_update)(votes)(schedule)(virtual_last_update)
+    (virtual_position)(virtual_scheduled_time)(last_work)(running_version)(hardfork_version_vote)
+    (hardfork_time_vote)(transit_to_cyberway_vote))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::witness_vote_object,
+    (id)(witness)(account))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::chain::witness_schedule_object,
+    (id)(current_virtual_time)(next_shuffle_block_num)(current_shuffled_witnesses)(num_scheduled_witnesses)
+    (top19_weight)(timeshare_weight)(miner_weight)(witness_pay_normalization_factor)(median_props)
+    (majority_version))
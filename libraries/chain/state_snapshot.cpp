@@ -0,0 +1,584 @@
+#include <golos/chain/state_snapshot.hpp>
+#include <golos/chain/database.hpp>
+#include <golos/chain/database_exceptions.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <thread>
+
+namespace golos { namespace chain {
+
+    static const char state_snapshot_magic[] = {'G', 'O', 'L', 'O', 'S', 'S', 'N', 'P'};
+
+    namespace {
+
+        /**
+         * Distribute tasks between threads to make their loads close (the biggest task goes first)
+         * @return number of thread for each task
+         */
+        std::vector<uint32_t> assign_to_threads(uint32_t threads, const std::vector<uint64_t>& weights) {
+            std::vector<std::size_t> order(weights.size());
+            for (std::size_t i = 0; i < order.size(); ++i) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                return weights[a] > weights[b];
+            });
+
+            std::vector<uint64_t> loads(threads, 0);
+            std::vector<uint32_t> result(weights.size(), 0);
+            for (auto i: order) {
+                auto thread = std::min_element(loads.begin(), loads.end()) - loads.begin();
+                result[i] = thread;
+                loads[thread] += weights[i] + 1;
+            }
+            return result;
+        }
+
+        /**
+         * Run tasks in threads, tasks of one thread are run in their order
+         */
+        template <typename Task>
+        void run_in_threads(uint32_t threads, const std::vector<uint32_t>& assignment, Task&& task) {
+            std::mutex mutex;
+            std::exception_ptr error;
+
+            std::vector<std::thread> pool;
+            pool.reserve(threads);
+            for (uint32_t t = 0; t < threads; ++t) {
+                pool.emplace_back([&, t]() {
+                    try {
+                        for (std::size_t i = 0; i < assignment.size(); ++i) {
+                            if (assignment[i] == t) {
+                                task(i);
+                            }
+                        }
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                    }
+                });
+            }
+            for (auto& thread: pool) {
+                thread.join();
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        /**
+         * Bounded queue of chunks for a loading thread
+         */
+        class chunk_queue final {
+        public:
+            static constexpr std::size_t max_size = 16;
+
+            bool push(state_snapshot_chunk&& chunk) {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cond.wait(lock, [&]() { return _closed || _chunks.size() < max_size; });
+                if (_closed) {
+                    return false;
+                }
+                _chunks.push_back(std::move(chunk));
+                _cond.notify_all();
+                return true;
+            }
+
+            bool pop(state_snapshot_chunk& chunk) {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cond.wait(lock, [&]() { return _closed || !_chunks.empty(); });
+                if (_chunks.empty()) {
+                    return false;
+                }
+                chunk = std::move(_chunks.front());
+                _chunks.pop_front();
+                _cond.notify_all();
+                return true;
+            }
+
+            void close() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _closed = true;
+                _cond.notify_all();
+            }
+
+            /**
+             * Drop queued chunks, it's used on error to unblock the reading thread
+             */
+            void abort() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _closed = true;
+                _chunks.clear();
+                _cond.notify_all();
+            }
+
+        private:
+            std::mutex _mutex;
+            std::condition_variable _cond;
+            std::deque<state_snapshot_chunk> _chunks;
+            bool _closed = false;
+        };
+
+    } // anonymous namespace
+
+    void state_snapshot_id_map::add(uint16_t type_id, std::vector<int64_t> ids) {
+        table_type table;
+        // keep id 0 unused, if it was unused in the original state
+        table.first_id = (ids.empty() || ids.front() == 0) ? 0 : 1;
+
+        bool is_dense = true;
+        for (std::size_t i = 0; i < ids.size() && is_dense; ++i) {
+            is_dense = (ids[i] == table.first_id + int64_t(i));
+        }
+        if (!is_dense) {
+            table.ids = std::move(ids);
+        }
+        _tables[type_id] = std::move(table);
+    }
+
+    int64_t state_snapshot_id_map::first_id(uint16_t type_id) const {
+        auto itr = _tables.find(type_id);
+        if (itr == _tables.end()) {
+            return 0;
+        }
+        return itr->second.first_id;
+    }
+
+    int64_t state_snapshot_id_map::get(uint16_t type_id, int64_t id) const {
+        auto itr = _tables.find(type_id);
+        if (itr == _tables.end() || itr->second.ids.empty()) {
+            return id;
+        }
+
+        const auto& ids = itr->second.ids;
+        auto id_itr = std::lower_bound(ids.begin(), ids.end(), id);
+        if (id_itr == ids.end() || *id_itr != id) {
+            // reference to the removed object, nothing to remap
+            return id;
+        }
+        return itr->second.first_id + (id_itr - ids.begin());
+    }
+
+    uint32_t state_snapshot_string_writer::put(const char* data, std::size_t size) {
+        if (size > max_interned_size) {
+            return string_literal;
+        }
+
+        auto res = _items.emplace(std::string(data, size), uint32_t(_items.size()));
+        if (res.second) {
+            return string_new;
+        }
+        return string_first_ref + res.first->second;
+    }
+
+    void state_snapshot_string_reader::add(std::string item) {
+        _items.push_back(std::move(item));
+    }
+
+    const std::string& state_snapshot_string_reader::get(uint32_t tag) const {
+        auto num = tag - string_first_ref;
+        GOLOS_ASSERT(num < _items.size(), state_snapshot_exception,
+            "Reference to unknown string ${num} in state snapshot", ("num", num));
+        return _items[num];
+    }
+
+    state_snapshot_writer::state_snapshot_writer(const fc::path& path, const state_snapshot_header& header) {
+        _out.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        _out.open(path.generic_string(), std::ios::out | std::ios::binary | std::ios::trunc);
+        write(state_snapshot_magic, sizeof(state_snapshot_magic));
+        write_blob(header);
+    }
+
+    void state_snapshot_writer::write(const char* data, std::size_t size) {
+        _out.write(data, size);
+    }
+
+    template <typename T>
+    void state_snapshot_writer::write_blob(const T& value) {
+        auto data = fc::raw::pack(value);
+        uint32_t size = data.size();
+        write(reinterpret_cast<const char*>(&size), sizeof(size));
+        write(data.data(), data.size());
+    }
+
+    void state_snapshot_writer::write_chunk(uint16_t section_num, const char* data, std::size_t size) {
+        // compression is done by the calling thread, the file is locked only for writing
+        uLongf packed_size = compressBound(size);
+        std::vector<char> packed(packed_size);
+        auto res = compress2(
+            reinterpret_cast<Bytef*>(packed.data()), &packed_size,
+            reinterpret_cast<const Bytef*>(data), size, Z_BEST_SPEED);
+        GOLOS_ASSERT(res == Z_OK, state_snapshot_exception, "Failed to compress chunk of state snapshot");
+
+        // incompressible data is stored as is
+        const char* stored = packed.data();
+        uint32_t stored_size = packed_size;
+        if (stored_size >= size) {
+            stored = data;
+            stored_size = size;
+        }
+
+        uint32_t data_size = size;
+        std::lock_guard<std::mutex> lock(_mutex);
+        write(reinterpret_cast<const char*>(&section_num), sizeof(section_num));
+        write(reinterpret_cast<const char*>(&data_size), sizeof(data_size));
+        write(reinterpret_cast<const char*>(&stored_size), sizeof(stored_size));
+        write(stored, stored_size);
+    }
+
+    void state_snapshot_writer::close(const std::vector<state_snapshot_section>& sections) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint64_t sections_pos = _out.tellp();
+        write_blob(sections);
+        write(reinterpret_cast<const char*>(&sections_pos), sizeof(sections_pos));
+        _out.flush();
+        _out.close();
+    }
+
+    state_snapshot_section_writer::state_snapshot_section_writer(
+        state_snapshot_writer& out, uint16_t section_num, state_snapshot_section& section
+    ) : _out(out),
+        _section_num(section_num),
+        _section(section) {
+        _section.records_count = 0;
+        _section.data_size = 0;
+        _buffer.reserve(chunk_size);
+    }
+
+    std::vector<char>& state_snapshot_section_writer::begin_record() {
+        // place for size of record
+        _record_pos = _buffer.size();
+        _buffer.resize(_record_pos + sizeof(uint32_t));
+        return _buffer;
+    }
+
+    void state_snapshot_section_writer::end_record() {
+        uint32_t size = _buffer.size() - _record_pos - sizeof(uint32_t);
+        std::memcpy(_buffer.data() + _record_pos, &size, sizeof(size));
+        _section.records_count++;
+        if (_buffer.size() > chunk_size) {
+            // the record doesn't fit the chunk, so it starts the next one
+            GOLOS_ASSERT(_record_pos > 0, state_snapshot_exception,
+                "Record of ${size} bytes doesn't fit a chunk of state snapshot", ("size", size));
+            flush(_record_pos);
+        }
+        if (_buffer.size() >= chunk_size) {
+            flush(_buffer.size());
+        }
+    }
+
+    state_snapshot_string_writer& state_snapshot_section_writer::strings() {
+        return _strings;
+    }
+
+    void state_snapshot_section_writer::flush(std::size_t size) {
+        if (size == 0) {
+            return;
+        }
+        _encoder.write(_buffer.data(), size);
+        _section.data_size += size;
+        _out.write_chunk(_section_num, _buffer.data(), size);
+        _buffer.erase(_buffer.begin(), _buffer.begin() + size);
+    }
+
+    void state_snapshot_section_writer::finish() {
+        flush(_buffer.size());
+        _section.checksum = _encoder.result();
+    }
+
+    void state_snapshot_chunk::unpack(std::vector<char>& result) const {
+        result.resize(size);
+        if (data.size() == size) {
+            std::copy(data.begin(), data.end(), result.begin());
+            return;
+        }
+
+        uLongf result_size = size;
+        auto res = uncompress(
+            reinterpret_cast<Bytef*>(result.data()), &result_size,
+            reinterpret_cast<const Bytef*>(data.data()), data.size());
+        GOLOS_ASSERT(res == Z_OK && result_size == size, state_snapshot_exception,
+            "Failed to decompress chunk of state snapshot");
+    }
+
+    state_snapshot_reader::state_snapshot_reader(const fc::path& path) {
+        GOLOS_ASSERT(fc::exists(path), state_snapshot_exception,
+            "State snapshot ${path} doesn't exist", ("path", path));
+
+        _in.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        _in.open(path.generic_string(), std::ios::in | std::ios::binary);
+
+        char magic[sizeof(state_snapshot_magic)];
+        read(magic, sizeof(magic));
+        GOLOS_ASSERT(!std::memcmp(magic, state_snapshot_magic, sizeof(magic)), state_snapshot_exception,
+            "File ${path} is not a state snapshot", ("path", path));
+
+        read_blob(_header);
+        GOLOS_ASSERT(_header.version == state_snapshot_version, state_snapshot_exception,
+            "Unsupported version ${version} of state snapshot, expected ${expected}",
+            ("version", _header.version)("expected", state_snapshot_version));
+
+        // table of sections is in the end of file
+        auto data_pos = _in.tellg();
+        _in.seekg(-std::streamoff(sizeof(_data_end)), std::ios::end);
+        read(reinterpret_cast<char*>(&_data_end), sizeof(_data_end));
+        _in.seekg(_data_end);
+        read_blob(_sections);
+        GOLOS_ASSERT(_sections.size() == _header.sections_count, state_snapshot_exception,
+            "State snapshot has ${n} sections, but ${expected} are expected",
+            ("n", _sections.size())("expected", _header.sections_count));
+        _in.seekg(data_pos);
+    }
+
+    void state_snapshot_reader::read(char* data, std::size_t size) {
+        _in.read(data, size);
+    }
+
+    template <typename T>
+    void state_snapshot_reader::read_blob(T& value) {
+        uint32_t size = 0;
+        read(reinterpret_cast<char*>(&size), sizeof(size));
+        std::vector<char> data(size);
+        read(data.data(), data.size());
+        value = fc::raw::unpack<T>(data);
+    }
+
+    const state_snapshot_header& state_snapshot_reader::header() const {
+        return _header;
+    }
+
+    const std::vector<state_snapshot_section>& state_snapshot_reader::sections() const {
+        return _sections;
+    }
+
+    bool state_snapshot_reader::read_chunk(state_snapshot_chunk& chunk) {
+        if (uint64_t(_in.tellg()) >= _data_end) {
+            return false;
+        }
+
+        uint32_t stored_size = 0;
+        read(reinterpret_cast<char*>(&chunk.section_num), sizeof(chunk.section_num));
+        read(reinterpret_cast<char*>(&chunk.size), sizeof(chunk.size));
+        read(reinterpret_cast<char*>(&stored_size), sizeof(stored_size));
+        GOLOS_ASSERT(chunk.section_num < _sections.size() && stored_size <= chunk.size, state_snapshot_exception,
+            "Bad chunk of state snapshot");
+        const uint32_t max_size = state_snapshot_section_writer::chunk_size;
+        GOLOS_ASSERT(chunk.size <= max_size, state_snapshot_exception,
+            "Chunk of state snapshot has ${size} bytes, but the limit is ${limit}",
+            ("size", chunk.size)("limit", max_size));
+        chunk.data.resize(stored_size);
+        read(chunk.data.data(), stored_size);
+        return true;
+    }
+
+    void database::add_state_snapshot_index(std::unique_ptr<abstract_state_snapshot_index> index) {
+        auto type_id = index->type_id();
+        _state_snapshot_indexes[type_id] = std::move(index);
+    }
+
+    void database::set_state_snapshot_threads(uint32_t threads) {
+        _state_snapshot_threads = std::max<uint32_t>(1, threads);
+    }
+
+    void database::create_state_snapshot(const fc::path& snapshot) { try {
+        GOLOS_ASSERT(!_pending_tx_session.valid(), state_snapshot_exception,
+            "State snapshot can't be created with pending transactions");
+
+        auto start = fc::time_point::now();
+        wlog("Start creating state snapshot ${snapshot} in ${n} threads. Please wait, don't break application...",
+            ("snapshot", snapshot)("n", _state_snapshot_threads));
+
+        with_strong_read_lock([&]() {
+            std::vector<const abstract_state_snapshot_index*> indexes;
+            std::vector<uint64_t> weights;
+            for (const auto& index: _state_snapshot_indexes) {
+                indexes.push_back(index.second.get());
+                weights.push_back(index.second->size(*this));
+            }
+            auto assignment = assign_to_threads(_state_snapshot_threads, weights);
+
+            state_snapshot_header header;
+            header.chain_id = get_chain_id();
+            header.block_num = head_block_num();
+            header.block_id = head_block_id();
+            header.block_time = head_block_time();
+            header.sections_count = indexes.size();
+
+            // all references should be known before writing of any section
+            std::vector<std::vector<int64_t>> ids(indexes.size());
+            run_in_threads(_state_snapshot_threads, assignment, [&](std::size_t i) {
+                ids[i] = indexes[i]->ids(*this);
+            });
+            state_snapshot_id_map id_map;
+            for (std::size_t i = 0; i < indexes.size(); ++i) {
+                id_map.add(indexes[i]->type_id(), std::move(ids[i]));
+            }
+
+            std::vector<state_snapshot_section> sections(indexes.size());
+            for (std::size_t i = 0; i < indexes.size(); ++i) {
+                auto& section = sections[i];
+                section.type_id = indexes[i]->type_id();
+                section.name = indexes[i]->name(*this);
+                section.layout = indexes[i]->layout();
+                section.first_id = id_map.first_id(section.type_id);
+            }
+
+            state_snapshot_writer out(snapshot, header);
+            run_in_threads(_state_snapshot_threads, assignment, [&](std::size_t i) {
+                state_snapshot_section_writer section_out(out, i, sections[i]);
+                indexes[i]->write(*this, id_map, section_out);
+                section_out.finish();
+                ilog("Saved ${n} objects of ${name}", ("n", sections[i].records_count)("name", sections[i].name));
+            });
+            out.close(sections);
+
+            auto end = fc::time_point::now();
+            wlog("Done creating state snapshot at block ${block}, elapsed time ${t} sec",
+                ("block", header.block_num)("t", double((end - start).count()) / 1000000.0));
+        });
+    } FC_CAPTURE_AND_RETHROW((snapshot)) }
+
+    void database::load_state_snapshot(const fc::path& snapshot) { try {
+        auto start = fc::time_point::now();
+        wlog("Start loading state snapshot ${snapshot} in ${n} threads. Please wait, don't break application...",
+            ("snapshot", snapshot)("n", _state_snapshot_threads));
+
+        state_snapshot_reader in(snapshot);
+        const auto& header = in.header();
+        const auto& sections = in.sections();
+        GOLOS_ASSERT(header.chain_id == get_chain_id(), state_snapshot_exception,
+            "State snapshot is created for chain ${chain_id}, but current chain is ${current}",
+            ("chain_id", header.chain_id)("current", get_chain_id()));
+
+        // loaders are created in this thread, because they can touch indexes
+        std::vector<std::unique_ptr<abstract_state_snapshot_loader>> loaders(sections.size());
+        std::vector<uint64_t> weights(sections.size(), 0);
+        flat_set<uint16_t> loaded;
+        for (std::size_t i = 0; i < sections.size(); ++i) {
+            const auto& section = sections[i];
+            auto itr = _state_snapshot_indexes.find(section.type_id);
+            if (itr == _state_snapshot_indexes.end()) {
+                wlog("Skip section ${name} of state snapshot, its plugin is disabled", ("name", section.name));
+                continue;
+            }
+
+            GOLOS_ASSERT(itr->second->layout() == section.layout, state_snapshot_exception,
+                "Structure of ${name} in state snapshot differs from the current one", ("name", section.name));
+
+            loaders[i] = itr->second->create_loader(*this, section);
+            weights[i] = section.data_size;
+            loaded.insert(section.type_id);
+        }
+
+        for (const auto& index: _state_snapshot_indexes) {
+            if (!loaded.count(index.first)) {
+                wlog("State snapshot doesn't contain ${name}, it stays empty", ("name", index.second->name(*this)));
+            }
+        }
+
+        // each section is loaded by one thread, because objects should be created in the order of ids
+        auto threads = _state_snapshot_threads;
+        auto assignment = assign_to_threads(threads, weights);
+        std::vector<chunk_queue> queues(threads);
+        std::vector<uint64_t> records_count(sections.size(), 0);
+        std::vector<fc::sha256::encoder> encoders(sections.size());
+
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        auto set_error = [&](std::exception_ptr e) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = e;
+            }
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(threads);
+        for (uint32_t t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t]() {
+                try {
+                    state_snapshot_chunk chunk;
+                    std::vector<char> data;
+                    while (queues[t].pop(chunk)) {
+                        chunk.unpack(data);
+                        auto num = chunk.section_num;
+                        encoders[num].write(data.data(), data.size());
+
+                        fc::datastream<const char*> ds(data.data(), data.size());
+                        while (ds.remaining()) {
+                            uint32_t size = 0;
+                            fc::raw::unpack(ds, size);
+                            GOLOS_ASSERT(size <= ds.remaining(), state_snapshot_exception,
+                                "Record of ${name} is out of chunk", ("name", sections[num].name));
+                            loaders[num]->load(ds.pos(), size);
+                            ds.skip(size);
+                            records_count[num]++;
+                        }
+                    }
+                } catch (...) {
+                    set_error(std::current_exception());
+                    queues[t].abort();
+                }
+            });
+        }
+
+        try {
+            state_snapshot_chunk chunk;
+            while (in.read_chunk(chunk)) {
+                auto num = chunk.section_num;
+                if (!loaders[num]) {
+                    continue;
+                }
+                if (!queues[assignment[num]].push(std::move(chunk))) {
+                    break;
+                }
+                chunk = state_snapshot_chunk();
+            }
+        } catch (...) {
+            set_error(std::current_exception());
+        }
+
+        for (auto& queue: queues) {
+            queue.close();
+        }
+        for (auto& thread: pool) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        for (std::size_t i = 0; i < sections.size(); ++i) {
+            if (!loaders[i]) {
+                continue;
+            }
+            const auto& section = sections[i];
+            GOLOS_ASSERT(records_count[i] == section.records_count, state_snapshot_exception,
+                "Section ${name} of state snapshot contains ${n} records, but ${expected} are expected",
+                ("name", section.name)("n", records_count[i])("expected", section.records_count));
+            GOLOS_ASSERT(encoders[i].result() == section.checksum, state_snapshot_exception,
+                "Checksum mismatch in section ${name} of state snapshot", ("name", section.name));
+            ilog("Loaded ${n} objects of ${name}", ("n", section.records_count)("name", section.name));
+        }
+
+        GOLOS_ASSERT(head_block_num() == header.block_num && head_block_id() == header.block_id, state_snapshot_exception,
+            "Head block of loaded state doesn't match header of state snapshot");
+
+        set_revision(header.block_num);
+
+        auto end = fc::time_point::now();
+        wlog("Done loading state snapshot at block ${block}, elapsed time ${t} sec",
+            ("block", header.block_num)("t", double((end - start).count()) / 1000000.0));
+    } FC_CAPTURE_AND_RETHROW((snapshot)) }
+
+} } // golos::chain
@@ -0,0 +1,198 @@
+#include <golos/network/compact_block_pool.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <set>
+
+namespace golos {
+    namespace network {
+
+        compact_block_pool::compact_block_pool(uint32_t max_blocks_per_peer, fc::microseconds timeout)
+                : _max_blocks_per_peer(std::max<uint32_t>(max_blocks_per_peer, 1)),
+                  _timeout(timeout) {
+        }
+
+        void compact_block_pool::validate(const compact_block_message &compact_block) {
+            FC_ASSERT(compact_block.header.id() == compact_block.block_id,
+                    "Header of the compact block doesn't match its id ${id}", ("id", compact_block.block_id));
+
+            const auto &transaction_ids = compact_block.transaction_ids;
+            FC_ASSERT(transaction_ids.empty() == (compact_block.header.transaction_merkle_root == golos::protocol::checksum_type()),
+                    "Merkle root of the compact block ${id} doesn't match its transactions", ("id", compact_block.block_id));
+
+            std::set<transaction_id_type> unique_ids;
+            for (const auto &transaction_id : transaction_ids) {
+                FC_ASSERT(unique_ids.insert(transaction_id).second,
+                        "Compact block ${id} has the duplicate transaction ${trx}",
+                        ("id", compact_block.block_id)("trx", transaction_id));
+            }
+        }
+
+        compact_block_pool::result compact_block_pool::add(peer_key peer, const compact_block_message &compact_block,
+                const transaction_finder &find_transaction, fc::time_point now) {
+            remove_expired(now);
+
+            block_in_progress block;
+            block.compact_block = compact_block;
+            block.received_time = now;
+            block.transactions.reserve(compact_block.transaction_ids.size());
+            for (const auto &transaction_id : compact_block.transaction_ids) {
+                block.transactions.push_back(find_transaction(transaction_id));
+            }
+
+            return process(block_key(peer, compact_block.block_id), std::move(block), now);
+        }
+
+        compact_block_pool::result compact_block_pool::add_transactions(peer_key peer,
+                const block_transactions_message &transactions_message, fc::time_point now) {
+            remove_expired(now);
+
+            const block_key key(peer, transactions_message.block_id);
+            auto block_iter = _blocks.find(key);
+            if (block_iter == _blocks.end()) {
+                return result();
+            }
+
+            block_in_progress block = std::move(block_iter->second);
+            _blocks.erase(block_iter);
+
+            const auto &indexes = transactions_message.transaction_indexes;
+            const auto &transactions = transactions_message.transactions;
+            FC_ASSERT(indexes.size() == transactions.size(), "Invalid list of transactions of block ${id}",
+                    ("id", transactions_message.block_id));
+            for (size_t i = 0; i < indexes.size(); ++i) {
+                FC_ASSERT(indexes[i] < block.transactions.size(), "Invalid list of transactions of block ${id}",
+                        ("id", transactions_message.block_id));
+                block.transactions[indexes[i]] = transactions[i];
+            }
+
+            return process(key, std::move(block), now);
+        }
+
+        compact_block_pool::result compact_block_pool::process(const block_key &key, block_in_progress &&block,
+                fc::time_point now) {
+            const compact_block_message &compact_block = block.compact_block;
+            result res;
+
+            signed_block full_block;
+            static_cast<golos::protocol::signed_block_header &>(full_block) = compact_block.header;
+            full_block.transactions.reserve(block.transactions.size());
+            for (uint32_t i = 0; i < block.transactions.size(); ++i) {
+                if (block.transactions[i]) {
+                    full_block.transactions.push_back(*block.transactions[i]);
+                } else {
+                    res.missing_indexes.push_back(i);
+                }
+            }
+
+            if (res.missing_indexes.empty()) {
+                if (full_block.calculate_merkle_root() == compact_block.header.transaction_merkle_root) {
+                    message restored_block = block_message(full_block);
+                    FC_ASSERT(restored_block.id() == compact_block.item_hash,
+                            "Compact block ${id} doesn't match its item hash", ("id", compact_block.block_id));
+                    res.block = std::move(restored_block);
+                    return res;
+                }
+
+                FC_ASSERT(!block.all_transactions_requested, "Transactions of compact block ${id} don't match it",
+                        ("id", compact_block.block_id));
+
+                // the cached transaction can have the same id, but other signatures,
+                // so the block is restored only from transactions of the peer
+                wlog("compact block ${id} doesn't match cached transactions, requesting all its transactions",
+                        ("id", compact_block.block_id));
+                res.missing_indexes.resize(block.transactions.size());
+                std::iota(res.missing_indexes.begin(), res.missing_indexes.end(), 0);
+                block.all_transactions_requested = true;
+            }
+
+            block.received_time = now;
+            store(key, std::move(block));
+            return res;
+        }
+
+        void compact_block_pool::store(const block_key &key, block_in_progress &&block) {
+            const auto peer = key.first;
+            auto begin = _blocks.lower_bound(block_key(peer, block_id_type()));
+            auto end = begin;
+            auto oldest = _blocks.end();
+            std::size_t count = 0;
+            for (; end != _blocks.end() && end->first.first == peer; ++end) {
+                if (end->first != key) {
+                    ++count;
+                    if (oldest == _blocks.end() || end->second.received_time < oldest->second.received_time) {
+                        oldest = end;
+                    }
+                }
+            }
+
+            if (count >= _max_blocks_per_peer && oldest != _blocks.end()) {
+                wlog("too many compact blocks wait for transactions, dropping block ${id}",
+                        ("id", oldest->first.second));
+                _blocks.erase(oldest);
+            }
+
+            _blocks[key] = std::move(block);
+        }
+
+        void compact_block_pool::remove_peer(peer_key peer) {
+            auto begin = _blocks.lower_bound(block_key(peer, block_id_type()));
+            auto end = begin;
+            while (end != _blocks.end() && end->first.first == peer) {
+                ++end;
+            }
+            _blocks.erase(begin, end);
+        }
+
+        void compact_block_pool::remove_expired(fc::time_point now) {
+            const fc::time_point expiration_time = now - _timeout;
+            for (auto iter = _blocks.begin(); iter != _blocks.end();) {
+                if (iter->second.received_time < expiration_time) {
+                    iter = _blocks.erase(iter);
+                } else {
+                    ++iter;
+                }
+            }
+        }
+
+        std::size_t compact_block_pool::size() const {
+            return _blocks.size();
+        }
+
+        std::size_t compact_block_pool::size(peer_key peer) const {
+            std::size_t result = 0;
+            for (auto iter = _blocks.lower_bound(block_key(peer, block_id_type()));
+                 iter != _blocks.end() && iter->first.first == peer; ++iter) {
+                ++result;
+            }
+            return result;
+        }
+
+        compact_block_cache::compact_block_cache(std::size_t max_size)
+                : _max_size(std::max<std::size_t>(max_size, 1)) {
+        }
+
+        const compact_block_message &compact_block_cache::get(const block_message &block, const item_hash_t &item_hash) {
+            auto iter = std::find_if(_blocks.begin(), _blocks.end(), [&](const compact_block_message &compact_block) {
+                return compact_block.item_hash == item_hash;
+            });
+            if (iter != _blocks.end()) {
+                return *iter;
+            }
+
+            if (_blocks.size() >= _max_size) {
+                _blocks.pop_front();
+            }
+            _blocks.emplace_back(block.block, block.block_id, item_hash);
+            return _blocks.back();
+        }
+
+        std::size_t compact_block_cache::size() const {
+            return _blocks.size();
+        }
+
+    }
+} // golos::network
@@ -46,6 +46,10 @@ namespace golos {
         const core_message_type_enum check_firewall_reply_message::type = core_message_type_enum::check_firewall_reply_message_type;
         const core_message_type_enum get_current_connections_request_message::type = core_message_type_enum::get_current_connections_request_message_type;
         const core_message_type_enum get_current_connections_reply_message::type = core_message_type_enum::get_current_connections_reply_message_type;
+        const core_message_type_enum compact_block_message::type = core_message_type_enum::compact_block_message_type;
+        const core_message_type_enum fetch_block_transactions_message::type = core_message_type_enum::fetch_block_transactions_message_type;
+        const core_message_type_enum block_transactions_message::type = core_message_type_enum::block_transactions_message_type;
+        const core_message_type_enum block_push_offer_message::type = core_message_type_enum::block_push_offer_message_type;
 
     }
 } // golos::network
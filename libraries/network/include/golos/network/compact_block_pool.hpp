@@ -0,0 +1,108 @@
+#pragma once
+
+#include <golos/network/config.hpp>
+#include <golos/network/core_messages.hpp>
+#include <golos/network/message.hpp>
+
+#include <fc/optional.hpp>
+#include <fc/time.hpp>
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace golos {
+    namespace network {
+
+        /**
+         * Compact blocks received from peers, which wait for transactions missing in the message cache.
+         *
+         * A block is restored from cached transactions, and only the missing ones are requested from the peer.
+         * If cached transactions don't match the block (e.g. other signatures), all its transactions are requested.
+         *
+         * The number of blocks waiting for one peer is limited, the oldest block of the peer is dropped
+         *   on overflow, and it's fetched again after the timeout of the item request.
+         */
+        class compact_block_pool final {
+        public:
+            /// the peer, which sent the compact block, it's used only as the key
+            using peer_key = const void *;
+            using transaction_finder = std::function<fc::optional<signed_transaction>(const transaction_id_type &)>;
+
+            struct result {
+                /// the block_message of the restored block, if all its transactions are known
+                fc::optional<message> block;
+                /// indexes of transactions to request from the peer
+                std::vector<uint32_t> missing_indexes;
+            };
+
+            explicit compact_block_pool(
+                    uint32_t max_blocks_per_peer = GRAPHENE_NET_MAX_COMPACT_BLOCKS_PER_PEER,
+                    fc::microseconds timeout = fc::seconds(GRAPHENE_NET_COMPACT_BLOCK_TIMEOUT_SEC));
+
+            /**
+             * Check the compact block before storing anything for it
+             * @throw fc::exception if the header doesn't match the block id or the list of transactions
+             */
+            static void validate(const compact_block_message &compact_block);
+
+            /**
+             * Start restoring of the validated compact block received from the peer
+             */
+            result add(peer_key peer, const compact_block_message &compact_block,
+                    const transaction_finder &find_transaction, fc::time_point now);
+
+            /**
+             * Continue restoring of the block with transactions received from the peer
+             * @return empty result if the block isn't waited for (e.g. it has expired)
+             * @throw fc::exception if transactions don't match the block or the restored block doesn't match the item hash
+             */
+            result add_transactions(peer_key peer, const block_transactions_message &transactions, fc::time_point now);
+
+            void remove_peer(peer_key peer);
+
+            void remove_expired(fc::time_point now);
+
+            std::size_t size() const;
+
+            std::size_t size(peer_key peer) const;
+
+        private:
+            struct block_in_progress {
+                compact_block_message compact_block;
+                std::vector<fc::optional<signed_transaction>> transactions;
+                bool all_transactions_requested = false;
+                fc::time_point received_time;
+            };
+
+            using block_key = std::pair<peer_key, block_id_type>;
+
+            result process(const block_key &key, block_in_progress &&block, fc::time_point now);
+
+            void store(const block_key &key, block_in_progress &&block);
+
+            uint32_t _max_blocks_per_peer;
+            fc::microseconds _timeout;
+            std::map<block_key, block_in_progress> _blocks;
+        };
+
+        /**
+         * Compact forms of recent blocks sent to peers, so ids of transactions are calculated once per block
+         */
+        class compact_block_cache final {
+        public:
+            explicit compact_block_cache(std::size_t max_size = GRAPHENE_NET_COMPACT_BLOCK_CACHE_SIZE);
+
+            const compact_block_message &get(const block_message &block, const item_hash_t &item_hash);
+
+            std::size_t size() const;
+
+        private:
+            std::size_t _max_size;
+            std::deque<compact_block_message> _blocks;
+        };
+
+    }
+} // golos::network
@@ -81,6 +81,18 @@
 
 #define GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING      200
 
+/**
+ * During sync, blocks which fit into the buffer are striped across all syncing
+ * peers, but a peer isn't asked for less than this number of blocks at a time
+ */
+#define GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING      10
+
+/**
+ * Max size in bytes of sync blocks, which are received or requested,
+ * but aren't passed to the client yet, because earlier blocks are missing
+ */
+#define GRAPHENE_NET_MAX_SYNC_BLOCKS_BUFFER_SIZE             (256 * 1024 * 1024)
+
 /**
  * During normal operation, how many items will be fetched from each
  * peer at a time.  This will only come into play when the network
@@ -103,3 +115,27 @@
 #define GRAPHENE_NET_MIN_BLOCK_IDS_TO_PREFETCH               10000
 
 #define GRAPHENE_NET_MAX_TRX_PER_SECOND                      1000
+
+/**
+ * Compact blocks, which wait for missing transactions longer than this, are dropped,
+ * the block is fetched again after the timeout of the item request
+ */
+#define GRAPHENE_NET_COMPACT_BLOCK_TIMEOUT_SEC               30
+
+/**
+ * Max number of compact blocks, which wait for missing transactions from one peer,
+ * the oldest one is dropped when it's reached
+ */
+#define GRAPHENE_NET_MAX_COMPACT_BLOCKS_PER_PEER             4
+
+/**
+ * Number of recent blocks, which compact forms are kept to send them to several peers
+ */
+#define GRAPHENE_NET_COMPACT_BLOCK_CACHE_SIZE                8
+
+/**
+ * Max number of new blocks, which one peer can push without the inventory round-trip at once,
+ * one more block is allowed after each interval, blocks above the limit are fetched via the inventory
+ */
+#define GRAPHENE_NET_MAX_PUSHED_BLOCKS_PER_PEER              4
+#define GRAPHENE_NET_PUSHED_BLOCK_INTERVAL_SEC               3
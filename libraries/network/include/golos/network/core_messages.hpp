@@ -89,6 +89,10 @@ namespace golos {
             check_firewall_reply_message_type = 5015,
             get_current_connections_request_message_type = 5016,
             get_current_connections_reply_message_type = 5017,
+            compact_block_message_type = 5018,
+            fetch_block_transactions_message_type = 5019,
+            block_transactions_message_type = 5020,
+            block_push_offer_message_type = 5021,
             core_message_type_last = 5099
         };
 
@@ -122,6 +126,67 @@ namespace golos {
 
         };
 
+        /**
+         * Block, in which transactions are replaced by their ids.
+         * It's sent instead of the block_message to peers, which support compact blocks,
+         *   they restore the block from transactions received before, and fetch only the missing ones.
+         * The item hash is the id of the block_message, it's used to find the request or the inventory of the block
+         *   before restoring, and it's checked after restoring.
+         */
+        struct compact_block_message {
+            static const core_message_type_enum type;
+
+            compact_block_message() {
+            }
+
+            compact_block_message(const signed_block &blk, const block_id_type &id, const item_hash_t &hash)
+                    : header(blk), block_id(id), item_hash(hash) {
+                transaction_ids.reserve(blk.transactions.size());
+                for (const auto &trx : blk.transactions) {
+                    transaction_ids.push_back(trx.id());
+                }
+            }
+
+            golos::protocol::signed_block_header header;
+            block_id_type block_id;
+            item_hash_t item_hash;
+            std::vector<transaction_id_type> transaction_ids;
+        };
+
+        struct fetch_block_transactions_message {
+            static const core_message_type_enum type;
+
+            block_id_type block_id;
+            std::vector<uint32_t> transaction_indexes;
+
+            fetch_block_transactions_message() {
+            }
+
+            fetch_block_transactions_message(const block_id_type &block_id, std::vector<uint32_t> transaction_indexes)
+                    : block_id(block_id),
+                    transaction_indexes(std::move(transaction_indexes)) {
+            }
+        };
+
+        struct block_transactions_message {
+            static const core_message_type_enum type;
+
+            block_id_type block_id;
+            std::vector<uint32_t> transaction_indexes;
+            std::vector<signed_transaction> transactions;
+        };
+
+        /**
+         * It's sent before the first block, which the sender pushes to the peer without the inventory round-trip.
+         * The peer accepts pushed blocks only from nodes, which offered it, or to which it pushes blocks itself.
+         */
+        struct block_push_offer_message {
+            static const core_message_type_enum type;
+
+            block_push_offer_message() {
+            }
+        };
+
         struct item_ids_inventory_message {
             static const core_message_type_enum type;
 
@@ -444,10 +509,18 @@ FC_REFLECT_ENUM(golos::network::core_message_type_enum,
                 (check_firewall_reply_message_type)
                 (get_current_connections_request_message_type)
                 (get_current_connections_reply_message_type)
+                (compact_block_message_type)
+                (fetch_block_transactions_message_type)
+                (block_transactions_message_type)
+                (block_push_offer_message_type)
                 (core_message_type_last))
 
 FC_REFLECT((golos::network::trx_message), (trx))
 FC_REFLECT((golos::network::block_message), (block)(block_id))
+FC_REFLECT((golos::network::compact_block_message), (header)(block_id)(item_hash)(transaction_ids))
+FC_REFLECT((golos::network::fetch_block_transactions_message), (block_id)(transaction_indexes))
+FC_REFLECT((golos::network::block_transactions_message), (block_id)(transaction_indexes)(transactions))
+FC_REFLECT_EMPTY((golos::network::block_push_offer_message))
 
 FC_REFLECT((golos::network::item_id), (item_type)
         (item_hash))
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <fc/thread/thread.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace golos {
+    namespace network {
+
+        /**
+         * Threads, which read, decrypt and hash messages of connections.
+         *
+         * Connections share ownership of their threads, so the number of threads can be changed at runtime:
+         *   existing connections keep their threads, and a removed thread stops after its last connection is closed.
+         */
+        class io_thread_pool final {
+        public:
+            void resize(uint32_t thread_count);
+
+            uint32_t size() const;
+
+            /**
+             * @return the thread for a new connection in the round-robin order, or nullptr if the pool is empty
+             */
+            std::shared_ptr<fc::thread> next();
+
+        private:
+            std::vector<std::shared_ptr<fc::thread>> _threads;
+            uint32_t _next_thread = 0;
+        };
+
+    }
+} // golos::network
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <fc/network/tcp_socket.hpp>
+#include <fc/thread/thread.hpp>
 #include <golos/network/message.hpp>
 
 namespace golos {
@@ -36,7 +37,8 @@ namespace golos {
         /** receives incoming messages from a message_oriented_connection object */
         class message_oriented_connection_delegate {
         public:
-            virtual void on_message(message_oriented_connection *originating_connection, const message &received_message) = 0;
+            virtual void on_message(message_oriented_connection *originating_connection, const message &received_message,
+                    const message_hash_type &message_hash) = 0;
 
             virtual void on_connection_closed(message_oriented_connection *originating_connection) = 0;
         };
@@ -54,6 +56,13 @@ namespace golos {
 
             void bind(const fc::ip::endpoint &local_endpoint);
 
+            /**
+             * Read, decrypt and hash incoming messages, encrypt and write outgoing messages, and close the socket
+             *   in the given thread, the delegate is still called in the thread, which created the connection.
+             * Should be called before accept() or connect_to(), the null thread disables it.
+             */
+            void set_io_thread(const std::shared_ptr<fc::thread> &io_thread);
+
             void connect_to(const fc::ip::endpoint &remote_endpoint);
 
             void send_message(const message &message_to_send);
@@ -79,6 +79,14 @@ namespace golos {
             virtual bool handle_block(const golos::network::block_message &blk_msg, bool sync_mode,
                     std::vector<fc::uint160_t> &contained_transaction_message_ids) = 0;
 
+            /**
+             *  @brief Called when a sync block is received, but it can't be handled until earlier blocks are.
+             *         The delegate can start the stateless validation of the block in background.
+             *
+             *  This method shouldn't block the calling thread.
+             */
+            virtual void prefetch_sync_block(const golos::network::block_message &blk_msg) = 0;
+
             /**
              *  @brief Called when a new transaction comes in from the network
              *
@@ -28,6 +28,7 @@
 #include <golos/network/message_oriented_connection.hpp>
 #include <golos/network/stcp_socket.hpp>
 #include <golos/network/config.hpp>
+#include <golos/network/pushed_block_limiter.hpp>
 
 #include <boost/tuple/tuple.hpp>
 
@@ -65,7 +66,7 @@ namespace golos {
         class peer_connection_delegate {
         public:
             virtual void on_message(peer_connection *originating_peer,
-                    const message &received_message) = 0;
+                    const message &received_message, const message_hash_type &message_hash) = 0;
 
             virtual void on_connection_closed(peer_connection *originating_peer) = 0;
 
@@ -215,6 +216,11 @@ namespace golos {
             fc::optional<std::string> platform;
             fc::optional<uint32_t> bitness;
             fc::optional<golos::protocol::chain_id_type> chain_id;
+            bool supports_compact_blocks; /// peer can receive blocks as compact_block_message
+            bool supports_block_push; /// peer accepts new blocks, which it didn't request
+            bool block_push_offered_to_peer; /// we push new blocks to the peer
+            bool peer_offered_block_push; /// the peer pushes new blocks to us
+            pushed_block_limiter pushed_blocks; /// the rate of new blocks, which the peer pushes to us
 
             // for inbound connections, these fields record what the peer sent us in
             // its hello message.  For outbound, they record what we sent the peer
@@ -294,9 +300,13 @@ namespace golos {
 
             void accept_connection();
 
+            /// see message_oriented_connection::set_io_thread()
+            void set_io_thread(const std::shared_ptr<fc::thread> &io_thread);
+
             void connect_to(const fc::ip::endpoint &remote_endpoint, fc::optional<fc::ip::endpoint> local_endpoint = fc::optional<fc::ip::endpoint>());
 
-            void on_message(message_oriented_connection *originating_connection, const message &received_message) override;
+            void on_message(message_oriented_connection *originating_connection, const message &received_message,
+                    const message_hash_type &message_hash) override;
 
             void on_connection_closed(message_oriented_connection *originating_connection) override;
 
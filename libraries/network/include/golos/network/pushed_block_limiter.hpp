@@ -0,0 +1,48 @@
+#pragma once
+
+#include <golos/network/config.hpp>
+
+#include <fc/time.hpp>
+
+namespace golos {
+    namespace network {
+
+        enum class pushed_block_action {
+            process,
+            ignore, /// the block is fetched via the inventory
+            disconnect
+        };
+
+        /**
+         * Limits the rate of new blocks, which a peer pushes without the inventory round-trip.
+         *
+         * The peer can push up to the max number of blocks at once (e.g. blocks of a short fork),
+         *   and one more block is allowed after each interval, it's about one block per slot.
+         */
+        class pushed_block_limiter final {
+        public:
+            explicit pushed_block_limiter(
+                    uint32_t max_blocks = GRAPHENE_NET_MAX_PUSHED_BLOCKS_PER_PEER,
+                    fc::microseconds interval = fc::seconds(GRAPHENE_NET_PUSHED_BLOCK_INTERVAL_SEC));
+
+            /**
+             * Count the pushed block
+             * @return false if the limit is reached and the block should be ignored
+             */
+            bool allow(fc::time_point now);
+
+            /**
+             * Check the block, which the peer pushed without our request
+             * @param may_push_blocks true if the peer is configured, we push blocks to it, or it offered to push blocks to us
+             */
+            pushed_block_action check(bool may_push_blocks, fc::time_point now);
+
+        private:
+            uint32_t _max_blocks;
+            fc::microseconds _interval;
+            uint32_t _available_blocks;
+            fc::time_point _refill_time;
+        };
+
+    }
+} // golos::network
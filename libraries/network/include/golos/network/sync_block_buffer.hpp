@@ -0,0 +1,95 @@
+#pragma once
+
+#include <golos/network/config.hpp>
+#include <golos/network/core_messages.hpp>
+
+#include <fc/optional.hpp>
+
+#include <boost/container/deque.hpp>
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace golos {
+    namespace network {
+
+        /**
+         * Sync blocks, which are received, but can't be passed to the client yet, because earlier blocks are missing.
+         *
+         * The buffer is limited by the total size of its blocks, and optionally by their number.
+         * Requested blocks are counted at the running average block size, so requests stop before the buffer is full.
+         */
+        class sync_block_buffer final {
+        public:
+            using item_ids_type = boost::container::deque<item_hash_t>;
+            using is_requested_type = std::function<bool(const item_hash_t &)>;
+
+            /**
+             * @param max_count the limit of the number of blocks, 0 - not limited
+             */
+            explicit sync_block_buffer(uint64_t max_size = GRAPHENE_NET_MAX_SYNC_BLOCKS_BUFFER_SIZE, uint32_t max_count = 0);
+
+            void set_limits(uint64_t max_size, uint32_t max_count);
+
+            uint64_t get_max_size() const;
+
+            uint32_t get_max_count() const;
+
+            /**
+             * @return false if the block is already in the buffer
+             */
+            bool add(const block_message &block);
+
+            bool contains(const item_hash_t &block_id) const;
+
+            /**
+             * Remove the block from the buffer
+             * @return the removed block or empty value if it isn't in the buffer
+             */
+            fc::optional<block_message> take(const item_hash_t &block_id);
+
+            std::size_t count() const;
+
+            uint64_t size() const;
+
+            uint64_t average_block_size() const;
+
+            bool is_full() const;
+
+            /**
+             * Select blocks to request from idle syncing peers.
+             *
+             * Blocks, which fit into the free part of the buffer, are striped across all syncing peers,
+             *   so a slow peer delays only a small range of blocks.
+             * The lowest missing blocks of each peer are requested even if the buffer is full,
+             *   because blocks in the buffer can't be passed to the client without them.
+             *
+             * @param idle_peers ids of blocks, which each idle peer has, from the next block on its chain
+             * @param number_of_syncing_peers the number of idle and busy peers we sync with
+             * @param number_of_requested_blocks blocks, which are requested, but not received yet
+             * @param is_requested returns true if the block is requested, but not received yet
+             * @return ids of blocks to request from each idle peer
+             */
+            std::vector<std::vector<item_hash_t>> select_requests(
+                    const std::vector<const item_ids_type *> &idle_peers,
+                    uint32_t number_of_syncing_peers,
+                    std::size_t number_of_requested_blocks,
+                    const is_requested_type &is_requested,
+                    uint32_t max_blocks_per_peer = GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING) const;
+
+        private:
+            struct received_block {
+                block_message block;
+                uint64_t size;
+            };
+
+            uint64_t _max_size;
+            uint32_t _max_count;
+            std::unordered_map<item_hash_t, received_block> _blocks;
+            uint64_t _size = 0;
+            uint64_t _average_block_size = 0;
+        };
+
+    }
+} // golos::network
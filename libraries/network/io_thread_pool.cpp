@@ -0,0 +1,29 @@
+#include <golos/network/io_thread_pool.hpp>
+
+#include <string>
+
+namespace golos {
+    namespace network {
+
+        void io_thread_pool::resize(uint32_t thread_count) {
+            if (thread_count < _threads.size()) {
+                _threads.resize(thread_count);
+            }
+            while (_threads.size() < thread_count) {
+                _threads.push_back(std::make_shared<fc::thread>("p2p_io_" + std::to_string(_threads.size())));
+            }
+        }
+
+        uint32_t io_thread_pool::size() const {
+            return static_cast<uint32_t>(_threads.size());
+        }
+
+        std::shared_ptr<fc::thread> io_thread_pool::next() {
+            if (_threads.empty()) {
+                return std::shared_ptr<fc::thread>();
+            }
+            return _threads[_next_thread++ % _threads.size()];
+        }
+
+    }
+} // golos::network
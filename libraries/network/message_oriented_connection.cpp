@@ -50,6 +50,8 @@ namespace golos {
                 message_oriented_connection_delegate *_delegate;
                 stcp_socket _sock;
                 fc::future<void> _read_loop_done;
+                fc::future<void> _send_done; /// the last write in the io thread, waited on destroy, even if its sender is canceled
+                fc::future<void> _close_done; /// the last close in the io thread
                 uint64_t _bytes_received;
                 uint64_t _bytes_sent;
 
@@ -59,14 +61,21 @@ namespace golos {
 
                 bool _send_message_in_progress;
 
-#ifndef NDEBUG
-                fc::thread *_thread;
-#endif
+                fc::thread *_thread; /// the thread of the delegate
+                std::shared_ptr<fc::thread> _io_thread; /// the thread of all operations with the socket, if it's set
+                std::shared_ptr<bool> _is_alive; /// checked by tasks, which the read loop posts to the thread of the delegate
 
                 void read_loop();
 
                 void start_read_loop();
 
+                template<typename Function>
+                void call_delegate(Function &&function);
+
+                void write_message(const std::shared_ptr<char> &padded_message, size_t size_with_padding);
+
+                void cancel_io_task(fc::future<void> &task_done, const char *name);
+
             public:
                 fc::tcp_socket &get_socket();
 
@@ -76,6 +85,8 @@ namespace golos {
 
                 void bind(const fc::ip::endpoint &local_endpoint);
 
+                void set_io_thread(const std::shared_ptr<fc::thread> &io_thread);
+
                 message_oriented_connection_impl(message_oriented_connection *self,
                         message_oriented_connection_delegate *delegate = nullptr);
 
@@ -108,11 +119,9 @@ namespace golos {
                       _delegate(delegate),
                       _bytes_received(0),
                       _bytes_sent(0),
-                      _send_message_in_progress(false)
-#ifndef NDEBUG
-                    , _thread(&fc::thread::current())
-#endif
-            {
+                      _send_message_in_progress(false),
+                      _thread(&fc::thread::current()),
+                      _is_alive(std::make_shared<bool>(true)) {
             }
 
             message_oriented_connection_impl::~message_oriented_connection_impl() {
@@ -122,21 +131,20 @@ namespace golos {
 
             fc::tcp_socket &message_oriented_connection_impl::get_socket() {
                 VERIFY_CORRECT_THREAD();
+                // with the io thread, it's used here only to accept or to query the state of the socket
                 return _sock.get_socket();
             }
 
             void message_oriented_connection_impl::accept() {
                 VERIFY_CORRECT_THREAD();
                 _sock.accept();
-                assert(!_read_loop_done.valid()); // check to be sure we never launch two read loops
-                _read_loop_done = fc::async([=]() { read_loop(); }, "message read_loop");
+                start_read_loop();
             }
 
             void message_oriented_connection_impl::connect_to(const fc::ip::endpoint &remote_endpoint) {
                 VERIFY_CORRECT_THREAD();
                 _sock.connect_to(remote_endpoint);
-                assert(!_read_loop_done.valid()); // check to be sure we never launch two read loops
-                _read_loop_done = fc::async([=]() { read_loop(); }, "message read_loop");
+                start_read_loop();
             }
 
             void message_oriented_connection_impl::bind(const fc::ip::endpoint &local_endpoint) {
@@ -144,16 +152,47 @@ namespace golos {
                 _sock.bind(local_endpoint);
             }
 
+            void message_oriented_connection_impl::set_io_thread(const std::shared_ptr<fc::thread> &io_thread) {
+                VERIFY_CORRECT_THREAD();
+                assert(!_read_loop_done.valid()); // the read loop is already started in the current thread
+                _io_thread = io_thread;
+            }
+
+            void message_oriented_connection_impl::start_read_loop() {
+                VERIFY_CORRECT_THREAD();
+                assert(!_read_loop_done.valid()); // check to be sure we never launch two read loops
+                _connected_time = fc::time_point::now();
+                if (_io_thread) {
+                    _read_loop_done = _io_thread->async([=]() { read_loop(); }, "message read_loop");
+                } else {
+                    _read_loop_done = fc::async([=]() { read_loop(); }, "message read_loop");
+                }
+            }
+
+            template<typename Function>
+            void message_oriented_connection_impl::call_delegate(Function &&function) {
+                if (!_io_thread) {
+                    function();
+                    return;
+                }
+                // the task owns the function, because the read loop can be canceled before the task runs,
+                // and the connection can be destroyed, while the read loop waits for the thread of the delegate
+                std::shared_ptr<bool> is_alive = _is_alive;
+                _thread->async([is_alive, function]() {
+                    if (*is_alive) {
+                        function();
+                    }
+                }, "message_oriented_connection delegate").wait();
+            }
+
 
             void message_oriented_connection_impl::read_loop() {
-                VERIFY_CORRECT_THREAD();
+                // runs in the io thread, if it's set, so the state of the connection is changed only in call_delegate()
                 const int BUFFER_SIZE = 16;
                 const int LEFTOVER = BUFFER_SIZE - sizeof(message_header);
                 static_assert(BUFFER_SIZE >=
                               sizeof(message_header), "insufficient buffer");
 
-                _connected_time = fc::time_point::now();
-
                 fc::oexception exception_to_rethrow;
                 bool call_on_connection_closed = false;
 
@@ -162,7 +201,7 @@ namespace golos {
                     while (true) {
                         char buffer[BUFFER_SIZE];
                         _sock.read(buffer, BUFFER_SIZE);
-                        _bytes_received += BUFFER_SIZE;
+                        uint64_t bytes_received = BUFFER_SIZE;
                         memcpy((char *)&m, buffer, sizeof(message_header));
 
                         FC_ASSERT(m.size <=
@@ -177,15 +216,20 @@ namespace golos {
                                 buffer + sizeof(buffer), m.data.begin());
                         if (remaining_bytes_with_padding) {
                             _sock.read(&m.data[LEFTOVER], remaining_bytes_with_padding);
-                            _bytes_received += remaining_bytes_with_padding;
+                            bytes_received += remaining_bytes_with_padding;
                         }
                         m.data.resize(m.size); // truncate off the padding bytes
 
-                        _last_message_received_time = fc::time_point::now();
+                        message_hash_type message_hash = m.id();
+                        std::shared_ptr<const message> received = std::make_shared<message>(std::move(m));
 
                         try {
                             // message handling errors are warnings...
-                            _delegate->on_message(_self, m);
+                            call_delegate([this, received, message_hash, bytes_received]() {
+                                _bytes_received += bytes_received;
+                                _last_message_received_time = fc::time_point::now();
+                                _delegate->on_message(_self, *received, message_hash);
+                            });
                         }
                             /// Dedicated catches needed to distinguish from general fc::exception
                         catch (const fc::canceled_exception &e) {
@@ -226,7 +270,9 @@ namespace golos {
                 }
 
                 if (call_on_connection_closed) {
-                    _delegate->on_connection_closed(_self);
+                    call_delegate([this]() {
+                        _delegate->on_connection_closed(_self);
+                    });
                 }
 
                 if (exception_to_rethrow) {
@@ -271,24 +317,63 @@ namespace golos {
                     //pad the message we send to a multiple of 16 bytes
                     size_t size_with_padding =
                             16 * ((size_of_message_and_header + 15) / 16);
-                    std::unique_ptr<char[]> padded_message(new char[size_with_padding]);
+                    std::shared_ptr<char> padded_message(new char[size_with_padding], [](char *p) { delete[] p; });
                     memcpy(padded_message.get(), (char *)&message_to_send, sizeof(message_header));
                     memcpy(padded_message.get() +
                            sizeof(message_header), message_to_send.data.data(), message_to_send.size);
-                    _sock.write(padded_message.get(), size_with_padding);
-                    _sock.flush();
+                    if (_io_thread) {
+                        // the socket is used only in the io thread, so writes don't run concurrently with reads and closes,
+                        // the previous write can be still in progress, if its sender was canceled
+                        if (_send_done.valid() && !_send_done.ready()) {
+                            _send_done.wait();
+                        }
+                        _send_done = _io_thread->async([this, padded_message, size_with_padding]() {
+                            write_message(padded_message, size_with_padding);
+                        }, "message_oriented_connection send_message");
+                        fc::future<void> send_done = _send_done;
+                        send_done.wait();
+                    } else {
+                        write_message(padded_message, size_with_padding);
+                    }
                     _bytes_sent += size_with_padding;
                     _last_message_sent_time = fc::time_point::now();
                 } FC_RETHROW_EXCEPTIONS(warn, "unable to send message");
             }
 
+            void message_oriented_connection_impl::write_message(const std::shared_ptr<char> &padded_message,
+                    size_t size_with_padding) {
+                _sock.write(padded_message.get(), size_with_padding);
+                _sock.flush();
+            }
+
             void message_oriented_connection_impl::close_connection() {
                 VERIFY_CORRECT_THREAD();
-                _sock.close();
+                if (!_io_thread) {
+                    _sock.close();
+                    return;
+                }
+                if (!_close_done.valid() || _close_done.ready()) {
+                    _close_done = _io_thread->async([this]() { _sock.close(); }, "message_oriented_connection close_connection");
+                }
+                fc::future<void> close_done = _close_done;
+                close_done.wait();
+            }
+
+            void message_oriented_connection_impl::cancel_io_task(fc::future<void> &task_done, const char *name) {
+                try {
+                    task_done.cancel_and_wait("destroy_connection");
+                }
+                catch (const fc::exception &e) {
+                    wlog("Exception thrown while canceling message_oriented_connection's ${name}, ignoring: ${e}", ("name", name)("e", e));
+                }
+                catch (...) {
+                    wlog("Exception thrown while canceling message_oriented_connection's ${name}, ignoring", ("name", name));
+                }
             }
 
             void message_oriented_connection_impl::destroy_connection() {
                 VERIFY_CORRECT_THREAD();
+                *_is_alive = false;
 
                 fc::optional<fc::ip::endpoint> remote_endpoint;
                 if (_sock.get_socket().is_open()) {
@@ -301,15 +386,10 @@ namespace golos {
                             "The task calling send_message() should have been canceled already");
                 assert(!_send_message_in_progress);
 
-                try {
-                    _read_loop_done.cancel_and_wait(__FUNCTION__);
-                }
-                catch (const fc::exception &e) {
-                    wlog("Exception thrown while canceling message_oriented_connection's read_loop, ignoring: ${e}", ("e", e));
-                }
-                catch (...) {
-                    wlog("Exception thrown while canceling message_oriented_connection's read_loop, ignoring");
-                }
+                // tasks of the io thread use the connection, so they are finished before it's destroyed
+                cancel_io_task(_send_done, "send_message");
+                cancel_io_task(_close_done, "close_connection");
+                cancel_io_task(_read_loop_done, "read_loop");
             }
 
             uint64_t message_oriented_connection_impl::get_total_bytes_sent() const {
@@ -356,6 +436,10 @@ namespace golos {
             my->accept();
         }
 
+        void message_oriented_connection::set_io_thread(const std::shared_ptr<fc::thread> &io_thread) {
+            my->set_io_thread(io_thread);
+        }
+
         void message_oriented_connection::connect_to(const fc::ip::endpoint &remote_endpoint) {
             my->connect_to(remote_endpoint);
         }
@@ -22,10 +22,13 @@
  * THE SOFTWARE.
  */
 #include <sstream>
+#include <algorithm>
 #include <iomanip>
 #include <deque>
 #include <unordered_set>
 #include <list>
+#include <map>
+#include <numeric>
 #include <forward_list>
 #include <iostream>
 #include <boost/tuple/tuple.hpp>
@@ -64,6 +67,9 @@
 #include <golos/network/node.hpp>
 #include <golos/network/peer_connection.hpp>
 #include <golos/network/exceptions.hpp>
+#include <golos/network/compact_block_pool.hpp>
+#include <golos/network/sync_block_buffer.hpp>
+#include <golos/network/io_thread_pool.hpp>
 
 #include <fc/git_revision.hpp>
 
@@ -168,8 +174,15 @@ namespace golos {
 
                 message get_message(const message_hash_type &hash_of_message_to_lookup);
 
+                bool has_message(const message_hash_type &hash_of_message_to_lookup) const {
+                    return _message_cache.get<message_hash_index>().find(hash_of_message_to_lookup) !=
+                           _message_cache.get<message_hash_index>().end();
+                }
+
                 message_propagation_data get_message_propagation_data(const fc::uint160_t &hash_of_message_contents_to_lookup) const;
 
+                fc::optional<signed_transaction> find_transaction(const transaction_id_type &transaction_id) const;
+
                 size_t size() const {
                     return _message_cache.size();
                 }
@@ -216,6 +229,16 @@ namespace golos {
                 FC_THROW_EXCEPTION(fc::key_not_found_exception, "Requested message not in cache");
             }
 
+            fc::optional<signed_transaction> blockchain_tied_message_cache::find_transaction(const transaction_id_type &transaction_id) const {
+                auto range = _message_cache.get<message_contents_hash_index>().equal_range(transaction_id);
+                for (auto iter = range.first; iter != range.second; ++iter) {
+                    if (iter->message_body.msg_type == trx_message_type) {
+                        return iter->message_body.as<trx_message>().trx;
+                    }
+                }
+                return fc::optional<signed_transaction>();
+            }
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
             // This specifies configuration info for the local node.  It's stored as JSON
@@ -391,6 +414,8 @@ namespace golos {
 
                 bool handle_block(const golos::network::block_message &block_message, bool sync_mode, std::vector<fc::uint160_t> &contained_transaction_message_ids) override;
 
+                void prefetch_sync_block(const golos::network::block_message &block_message) override;
+
                 void handle_transaction(const golos::network::trx_message &transaction_message) override;
 
                 std::vector<item_hash_t> get_block_ids(const std::vector<item_hash_t> &blockchain_synopsis,
@@ -463,8 +488,7 @@ namespace golos {
                 typedef std::unordered_map<golos::network::block_id_type, fc::time_point> active_sync_requests_map;
 
                 active_sync_requests_map _active_sync_requests; /// list of sync blocks we've asked for from peers but have not yet received
-                std::list<golos::network::block_message> _new_received_sync_items; /// list of sync blocks we've just received but haven't yet tried to process
-                std::list<golos::network::block_message> _received_sync_items; /// list of sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
+                sync_block_buffer _received_sync_items; /// sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
                 // @}
 
                 fc::future<void> _process_backlog_of_sync_blocks_done;
@@ -545,6 +569,9 @@ namespace golos {
 
                 blockchain_tied_message_cache _message_cache; /// cache message we have received and might be required to provide to other peers via inventory requests
 
+                compact_block_pool _compact_blocks_in_progress; /// compact blocks, which wait for transactions missing in the message cache
+                compact_block_cache _compact_blocks_sent; /// compact forms of recent blocks sent to peers
+
                 fc::rate_limiting_group _rate_limiter;
 
                 uint32_t _last_reported_number_of_connections; // number of connections last reported to the client (to avoid sending duplicate messages)
@@ -589,9 +616,16 @@ namespace golos {
                 bool _node_is_shutting_down; // set to true when we begin our destructor, used to prevent us from starting new tasks while we're shutting down
 
                 unsigned _maximum_number_of_blocks_to_handle_at_one_time;
-                unsigned _maximum_number_of_sync_blocks_to_prefetch;
                 unsigned _maximum_blocks_per_peer_during_syncing;
 
+                /// new blocks are pushed without the inventory round-trip to this number of peers with the lowest latency
+                uint32_t _block_push_peer_count;
+                /// and to these peers (e.g. witness nodes)
+                std::set<fc::ip::endpoint> _block_push_endpoints;
+
+                /// threads, which read, decrypt and hash messages of connections, the p2p thread does it if they're empty
+                io_thread_pool _io_threads;
+
                 std::list<fc::future<void>> _handle_message_calls_in_progress;
                 std::set<message_hash_type> _message_ids_currently_being_processed;
 
@@ -660,7 +694,9 @@ namespace golos {
                 void parse_hello_user_data_for_peer(peer_connection *originating_peer, const fc::variant_object &user_data);
 
                 void on_message(peer_connection *originating_peer,
-                        const message &received_message) override;
+                        const message &received_message, const message_hash_type &message_hash) override;
+
+                peer_connection_ptr create_peer_connection();
 
                 void on_hello_message(peer_connection *originating_peer,
                         const hello_message &hello_message_received);
@@ -686,6 +722,21 @@ namespace golos {
                 void on_fetch_items_message(peer_connection *originating_peer,
                         const fetch_items_message &fetch_items_message_received);
 
+                void on_compact_block_message(peer_connection *originating_peer,
+                        const compact_block_message &compact_block_message_received);
+
+                void on_fetch_block_transactions_message(peer_connection *originating_peer,
+                        const fetch_block_transactions_message &fetch_block_transactions_message_received);
+
+                void on_block_transactions_message(peer_connection *originating_peer,
+                        const block_transactions_message &block_transactions_message_received);
+
+                void process_compact_block(peer_connection *originating_peer, const block_id_type &block_id,
+                        compact_block_pool::result &&result);
+
+                void on_block_push_offer_message(peer_connection *originating_peer,
+                        const block_push_offer_message &block_push_offer_message_received);
+
                 void on_item_not_available_message(peer_connection *originating_peer,
                         const item_not_available_message &item_not_available_message_received);
 
@@ -799,6 +850,12 @@ namespace golos {
 
                 void broadcast(const message &item_to_broadcast);
 
+                bool is_block_push_endpoint(peer_connection &peer) const;
+
+                bool may_push_blocks(peer_connection &peer) const;
+
+                void push_block_to_peers(const message &block_message_to_push, const message_hash_type &message_hash);
+
                 void sync_from(const item_id &current_head_block, const std::vector<uint32_t> &hard_fork_block_numbers);
 
                 bool is_connected() const;
@@ -864,7 +921,6 @@ namespace golos {
 #endif
 
 #define MAXIMUM_NUMBER_OF_BLOCKS_TO_HANDLE_AT_ONE_TIME 200
-#define MAXIMUM_NUMBER_OF_BLOCKS_TO_PREFETCH (10 * MAXIMUM_NUMBER_OF_BLOCKS_TO_HANDLE_AT_ONE_TIME)
 
             node_impl::node_impl(const std::string &user_agent) :
 #ifdef P2P_IN_DEDICATED_THREAD
@@ -898,8 +954,8 @@ namespace golos {
                     _average_network_usage_minute_counter(0),
                     _node_is_shutting_down(false),
                     _maximum_number_of_blocks_to_handle_at_one_time(MAXIMUM_NUMBER_OF_BLOCKS_TO_HANDLE_AT_ONE_TIME),
-                    _maximum_number_of_sync_blocks_to_prefetch(MAXIMUM_NUMBER_OF_BLOCKS_TO_PREFETCH),
-                    _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING) {
+                    _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING),
+                    _block_push_peer_count(0) {
                 _rate_limiter.set_actual_rate_time_constant(fc::seconds(2));
                 fc::rand_pseudo_bytes(&_node_id.data[0], (int)_node_id.size());
             }
@@ -1056,14 +1112,7 @@ namespace golos {
 
             bool node_impl::have_already_received_sync_item(const item_hash_t &item_hash) {
                 VERIFY_CORRECT_THREAD();
-                return std::find_if(_received_sync_items.begin(), _received_sync_items.end(),
-                        [&item_hash](const golos::network::block_message &message) {
-                            return message.block_id == item_hash;
-                        }) != _received_sync_items.end() ||
-                       std::find_if(_new_received_sync_items.begin(), _new_received_sync_items.end(),
-                               [&item_hash](const golos::network::block_message &message) {
-                                   return message.block_id == item_hash;
-                               }) != _new_received_sync_items.end();;
+                return _received_sync_items.contains(item_hash);
             }
 
             void node_impl::request_sync_item_from_peer(const peer_connection_ptr &peer, const item_hash_t &item_to_request) {
@@ -1101,41 +1150,35 @@ namespace golos {
 
                         {
                             ASSERT_TASK_NOT_PREEMPTED();
-                            std::set<item_hash_t> sync_items_to_request;
-
                             // for each idle peer that we're syncing with
+                            std::vector<peer_connection_ptr> idle_peers;
+                            std::vector<const sync_block_buffer::item_ids_type *> idle_peers_items;
+                            uint32_t number_of_syncing_peers = 0;
                             for (const peer_connection_ptr &peer : _active_connections) {
-                                if (peer->we_need_sync_items_from_peer &&
-                                    sync_item_requests_to_send.find(peer) ==
-                                    sync_item_requests_to_send.end() &&
-                                    // if we've already scheduled a request for this peer, don't consider scheduling another
-                                    peer->idle()) {
-                                    if (!peer->inhibit_fetching_sync_blocks) {
-                                        // loop through the items it has that we don't yet have on our blockchain
-                                        for (unsigned i = 0; i <
-                                                             peer->ids_of_items_to_get.size(); ++i) {
-                                            item_hash_t item_to_potentially_request = peer->ids_of_items_to_get[i];
-                                            // if we don't already have this item in our temporary storage and we haven't requested from another syncing peer
-                                            if (!have_already_received_sync_item(item_to_potentially_request) &&
-                                                // already got it, but for some reson it's still in our list of items to fetch
-                                                sync_items_to_request.find(item_to_potentially_request) ==
-                                                sync_items_to_request.end() &&
-                                                // we have already decided to request it from another peer during this iteration
-                                                _active_sync_requests.find(item_to_potentially_request) ==
-                                                _active_sync_requests.end()) // we've requested it in a previous iteration and we're still waiting for it to arrive
-                                            {
-                                                // then schedule a request from this peer
-                                                sync_item_requests_to_send[peer].push_back(item_to_potentially_request);
-                                                sync_items_to_request.insert(item_to_potentially_request);
-                                                if (sync_item_requests_to_send[peer].size() >=
-                                                    _maximum_blocks_per_peer_during_syncing) {
-                                                        break;
-                                                }
-                                            }
-                                        }
+                                if (peer->we_need_sync_items_from_peer && !peer->inhibit_fetching_sync_blocks) {
+                                    ++number_of_syncing_peers;
+                                    if (peer->idle()) {
+                                        idle_peers.push_back(peer);
+                                        idle_peers_items.push_back(&peer->ids_of_items_to_get);
                                     }
                                 }
                             }
+
+                            if (_received_sync_items.is_full()) {
+                                dlog("the buffer of sync blocks is full, requesting only the lowest missing blocks");
+                            }
+                            auto items_to_request = _received_sync_items.select_requests(
+                                    idle_peers_items, number_of_syncing_peers, _active_sync_requests.size(),
+                                    [this](const item_hash_t &item_hash) {
+                                        // we've requested it in a previous iteration and we're still waiting for it to arrive
+                                        return _active_sync_requests.find(item_hash) != _active_sync_requests.end();
+                                    },
+                                    _maximum_blocks_per_peer_during_syncing);
+                            for (size_t i = 0; i < idle_peers.size(); ++i) {
+                                if (!items_to_request[i].empty()) {
+                                    sync_item_requests_to_send[idle_peers[i]] = std::move(items_to_request[i]);
+                                }
+                            }
                         } // end non-preemptable section
 
                         // make all the requests we scheduled in the loop above
@@ -1881,9 +1924,9 @@ namespace golos {
                 }
             }
 
-            void node_impl::on_message(peer_connection *originating_peer, const message &received_message) {
+            void node_impl::on_message(peer_connection *originating_peer, const message &received_message,
+                    const message_hash_type &message_hash) {
                 VERIFY_CORRECT_THREAD();
-                message_hash_type message_hash = received_message.id();
                 dlog("handling message ${type} ${hash} size ${size} from peer ${endpoint}",
                         ("type", golos::network::core_message_type_enum(received_message.msg_type))("hash", message_hash)
                                 ("size", received_message.size)
@@ -1925,6 +1968,18 @@ namespace golos {
                     case core_message_type_enum::block_message_type:
                         process_block_message(originating_peer, received_message, message_hash);
                         break;
+                    case core_message_type_enum::compact_block_message_type:
+                        on_compact_block_message(originating_peer, received_message.as<compact_block_message>());
+                        break;
+                    case core_message_type_enum::fetch_block_transactions_message_type:
+                        on_fetch_block_transactions_message(originating_peer, received_message.as<fetch_block_transactions_message>());
+                        break;
+                    case core_message_type_enum::block_transactions_message_type:
+                        on_block_transactions_message(originating_peer, received_message.as<block_transactions_message>());
+                        break;
+                    case core_message_type_enum::block_push_offer_message_type:
+                        on_block_push_offer_message(originating_peer, received_message.as<block_push_offer_message>());
+                        break;
                     case core_message_type_enum::current_time_request_message_type:
                         on_current_time_request_message(originating_peer, received_message.as<current_time_request_message>());
                         break;
@@ -1990,6 +2045,8 @@ namespace golos {
                 }
 
                 user_data["chain_id"] = STEEMIT_CHAIN_ID;
+                user_data["compact_blocks"] = true;
+                user_data["block_push"] = true;
 
                 return user_data;
             }
@@ -2024,6 +2081,12 @@ namespace golos {
                 if (user_data.contains("chain_id")) {
                     originating_peer->chain_id = user_data["chain_id"].as<golos::protocol::chain_id_type>();
                 }
+                if (user_data.contains("compact_blocks")) {
+                    originating_peer->supports_compact_blocks = user_data["compact_blocks"].as_bool();
+                }
+                if (user_data.contains("block_push")) {
+                    originating_peer->supports_block_push = user_data["block_push"].as_bool();
+                }
             }
 
             void node_impl::on_hello_message(peer_connection *originating_peer, const hello_message &hello_message_received) {
@@ -2843,11 +2906,17 @@ namespace golos {
                         dlog("received item request for item ${id} from peer ${endpoint}, returning the item from my message cache",
                                 ("endpoint", originating_peer->get_remote_endpoint())
                                         ("id", requested_message.id()));
-                        reply_messages.push_back(requested_message);
                         if (fetch_items_message_received.item_type ==
                             block_message_type) {
                                 last_block_message_sent = requested_message;
+                                if (originating_peer->supports_compact_blocks) {
+                                    // the block is fresh, so the peer has probably received its transactions before
+                                    golos::network::block_message block = requested_message.as<golos::network::block_message>();
+                                    reply_messages.push_back(_compact_blocks_sent.get(block, item_hash));
+                                    continue;
+                                }
                         }
+                        reply_messages.push_back(requested_message);
                         continue;
                     }
                     catch (fc::key_not_found_exception &) {
@@ -2891,6 +2960,142 @@ namespace golos {
                 }
             }
 
+            void node_impl::on_compact_block_message(peer_connection *originating_peer, const compact_block_message &compact_block_message_received) {
+                VERIFY_CORRECT_THREAD();
+                const block_id_type &block_id = compact_block_message_received.block_id;
+
+                // nothing is stored for the block, which we didn't ask for or which has the invalid header
+                item_id block_message_item_id(golos::network::block_message_type, compact_block_message_received.item_hash);
+                if (originating_peer->items_requested_from_peer.find(block_message_item_id) ==
+                    originating_peer->items_requested_from_peer.end() &&
+                    originating_peer->sync_items_requested_from_peer.find(block_id) ==
+                    originating_peer->sync_items_requested_from_peer.end() &&
+                    originating_peer->inventory_peer_advertised_to_us.find(block_message_item_id) ==
+                    originating_peer->inventory_peer_advertised_to_us.end() &&
+                    !may_push_blocks(*originating_peer)) {
+                    wlog("received a compact block ${block_id} I didn't ask for from peer ${endpoint}, disconnecting from peer",
+                            ("endpoint", originating_peer->get_remote_endpoint())
+                                    ("block_id", block_id));
+                    fc::exception detailed_error(FC_LOG_MESSAGE(error, "You sent me a block that I didn't ask for, block_id: ${block_id}",
+                            ("block_id", block_id)));
+                    disconnect_from_peer(originating_peer, "You sent me a block that I didn't ask for", true, detailed_error);
+                    return;
+                }
+
+                compact_block_pool::result result;
+                try {
+                    compact_block_pool::validate(compact_block_message_received);
+                    result = _compact_blocks_in_progress.add(originating_peer, compact_block_message_received,
+                            [&](const transaction_id_type &transaction_id) {
+                                return _message_cache.find_transaction(transaction_id);
+                            },
+                            fc::time_point::now());
+                }
+                catch (const fc::exception &e) {
+                    wlog("received an invalid compact block ${block_id} from peer ${endpoint}: ${e}",
+                            ("block_id", block_id)
+                                    ("endpoint", originating_peer->get_remote_endpoint())
+                                    ("e", e.to_string()));
+                    disconnect_from_peer(originating_peer, "You sent me an invalid compact block", true, e);
+                    return;
+                }
+
+                dlog("received compact block ${id} with ${n} transactions from peer ${endpoint}",
+                        ("id", block_id)
+                                ("n", compact_block_message_received.transaction_ids.size())
+                                ("endpoint", originating_peer->get_remote_endpoint()));
+                process_compact_block(originating_peer, block_id, std::move(result));
+            }
+
+            void node_impl::on_fetch_block_transactions_message(peer_connection *originating_peer,
+                    const fetch_block_transactions_message &fetch_block_transactions_message_received) {
+                VERIFY_CORRECT_THREAD();
+                const block_id_type &block_id = fetch_block_transactions_message_received.block_id;
+
+                golos::network::block_message requested_block;
+                try {
+                    requested_block = _delegate->get_item(item_id(block_message_type, block_id)).as<golos::network::block_message>();
+                }
+                catch (fc::key_not_found_exception &) {
+                    dlog("received request for transactions of block ${id} from peer ${endpoint} but we don't have it",
+                            ("id", block_id)
+                                    ("endpoint", originating_peer->get_remote_endpoint()));
+                    return;
+                }
+
+                const auto &transactions = requested_block.block.transactions;
+                block_transactions_message reply;
+                reply.block_id = block_id;
+                reply.transaction_indexes.reserve(fetch_block_transactions_message_received.transaction_indexes.size());
+                reply.transactions.reserve(fetch_block_transactions_message_received.transaction_indexes.size());
+                for (uint32_t index : fetch_block_transactions_message_received.transaction_indexes) {
+                    if (index >= transactions.size()) {
+                        wlog("peer ${endpoint} requested transaction ${index} of block ${id}, which has only ${n} transactions",
+                                ("endpoint", originating_peer->get_remote_endpoint())
+                                        ("index", index)
+                                        ("id", block_id)
+                                        ("n", transactions.size()));
+                        return;
+                    }
+                    reply.transaction_indexes.push_back(index);
+                    reply.transactions.push_back(transactions[index]);
+                }
+                originating_peer->send_message(reply);
+            }
+
+            void node_impl::on_block_transactions_message(peer_connection *originating_peer,
+                    const block_transactions_message &block_transactions_message_received) {
+                VERIFY_CORRECT_THREAD();
+                const block_id_type &block_id = block_transactions_message_received.block_id;
+
+                compact_block_pool::result result;
+                try {
+                    result = _compact_blocks_in_progress.add_transactions(originating_peer,
+                            block_transactions_message_received, fc::time_point::now());
+                }
+                catch (const fc::exception &e) {
+                    wlog("received invalid transactions of block ${id} from peer ${endpoint}: ${e}",
+                            ("id", block_id)
+                                    ("endpoint", originating_peer->get_remote_endpoint())
+                                    ("e", e.to_string()));
+                    disconnect_from_peer(originating_peer, "You sent me an invalid list of block transactions", true, e);
+                    return;
+                }
+
+                if (!result.block && result.missing_indexes.empty()) {
+                    // the compact block has expired, the block will be fetched again
+                    dlog("received transactions of block ${id}, which we don't wait for, from peer ${endpoint}",
+                            ("id", block_id)
+                                    ("endpoint", originating_peer->get_remote_endpoint()));
+                    return;
+                }
+
+                process_compact_block(originating_peer, block_id, std::move(result));
+            }
+
+            void node_impl::process_compact_block(peer_connection *originating_peer, const block_id_type &block_id,
+                    compact_block_pool::result &&result) {
+                VERIFY_CORRECT_THREAD();
+                if (result.block) {
+                    // the block is handled as if it was received in the block_message
+                    process_block_message(originating_peer, *result.block, result.block->id());
+                    return;
+                }
+
+                dlog("requesting ${n} missing transactions of block ${id} from peer ${endpoint}",
+                        ("n", result.missing_indexes.size())
+                                ("id", block_id)
+                                ("endpoint", originating_peer->get_remote_endpoint()));
+                originating_peer->send_message(fetch_block_transactions_message(block_id, std::move(result.missing_indexes)));
+            }
+
+            void node_impl::on_block_push_offer_message(peer_connection *originating_peer,
+                    const block_push_offer_message &block_push_offer_message_received) {
+                VERIFY_CORRECT_THREAD();
+                dlog("peer ${endpoint} will push new blocks to us", ("endpoint", originating_peer->get_remote_endpoint()));
+                originating_peer->peer_offered_block_push = true;
+            }
+
             void node_impl::on_item_not_available_message(peer_connection *originating_peer, const item_not_available_message &item_not_available_message_received) {
                 VERIFY_CORRECT_THREAD();
                 const item_id &requested_item = item_not_available_message_received.requested_item;
@@ -3053,6 +3258,8 @@ namespace golos {
                 _closing_connections.erase(originating_peer_ptr);
                 _handshaking_connections.erase(originating_peer_ptr);
                 _terminating_connections.erase(originating_peer_ptr);
+
+                _compact_blocks_in_progress.remove_peer(originating_peer);
                 if (_active_connections.find(originating_peer_ptr) !=
                     _active_connections.end()) {
                     _active_connections.erase(originating_peer_ptr);
@@ -3280,7 +3487,7 @@ namespace golos {
 
                 dlog("Leaving send_sync_block_to_node_delegate");
 
-                if (// _suspend_fetching_sync_blocks && <-- you can use this if "maximum_number_of_blocks_to_handle_at_one_time" == "maximum_number_of_sync_blocks_to_prefetch"
+                if (// _suspend_fetching_sync_blocks && <-- you can use this if the buffer of sync blocks is limited by "maximum_number_of_blocks_to_handle_at_one_time"
                         !_node_is_shutting_down &&
                         (!_process_backlog_of_sync_blocks_done.valid() ||
                          _process_backlog_of_sync_blocks_done.ready())) {
@@ -3331,63 +3538,60 @@ namespace golos {
                 std::map<peer_connection_ptr, fc::oexception> peers_with_rejected_block;
 
                 do {
-                    std::copy(std::make_move_iterator(_new_received_sync_items.begin()),
-                            std::make_move_iterator(_new_received_sync_items.end()),
-                            std::front_inserter(_received_sync_items));
-                    _new_received_sync_items.clear();
-                    dlog("currently ${count} sync items to consider", ("count", _received_sync_items.size()));
+                    dlog("currently ${count} sync items to consider", ("count", _received_sync_items.count()));
 
                     block_processed_this_iteration = false;
-                    for (auto received_block_iter = _received_sync_items.begin();
-                         received_block_iter != _received_sync_items.end();
-                         ++received_block_iter) {
 
-                        // find out if this block is the next block on the active chain or one of the forks
-                        bool potential_first_block = false;
-                        for (const peer_connection_ptr &peer : _active_connections) {
-                            ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
-                            if (!peer->ids_of_items_to_get.empty() &&
-                                peer->ids_of_items_to_get.front() ==
-                                received_block_iter->block_id) {
-                                potential_first_block = true;
-                                peer->ids_of_items_to_get.pop_front();
-                                peer->ids_of_items_being_processed.insert(received_block_iter->block_id);
+                    // the next block on the active chain or one of the forks is the first item to get from some peer
+                    fc::optional<golos::network::block_message> received_block;
+                    for (const peer_connection_ptr &peer : _active_connections) {
+                        ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+                        if (!peer->ids_of_items_to_get.empty()) {
+                            received_block = _received_sync_items.take(peer->ids_of_items_to_get.front());
+                            if (received_block) {
+                                break;
                             }
                         }
+                    }
+                    if (!received_block) {
+                        break;
+                    }
 
-                        // if it is, process it, remove it from all sync peers lists
-                        if (potential_first_block) {
-                            // we can get into an interesting situation near the end of synchronization.  We can be in
-                            // sync with one peer who is sending us the last block on the chain via a regular inventory
-                            // message, while at the same time still be synchronizing with a peer who is sending us the
-                            // block through the sync mechanism.  Further, we must request both blocks because
-                            // we don't know they're the same (for the peer in normal operation, it has only told us the
-                            // message id, for the peer in the sync case we only known the block_id).
-                            if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
-                                    received_block_iter->block_id) ==
-                                _most_recent_blocks_accepted.end()) {
-                                golos::network::block_message block_message_to_process = *received_block_iter;
-                                _received_sync_items.erase(received_block_iter);
-                                _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process]() {
-                                    send_sync_block_to_node_delegate(block_message_to_process);
-                                }, "send_sync_block_to_node_delegate"));
-                                ++blocks_processed;
-                                block_processed_this_iteration = true;
-                            } else
-                                dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
-
-                            break; // start iterating _received_sync_items from the beginning
-                        } // end if potential_first_block
-                    } // end for each block in _received_sync_items
+                    golos::network::block_message block_message_to_process = std::move(*received_block);
+
+                    // remove it from all sync peers lists
+                    for (const peer_connection_ptr &peer : _active_connections) {
+                        ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+                        if (!peer->ids_of_items_to_get.empty() &&
+                            peer->ids_of_items_to_get.front() ==
+                            block_message_to_process.block_id) {
+                            peer->ids_of_items_to_get.pop_front();
+                            peer->ids_of_items_being_processed.insert(block_message_to_process.block_id);
+                        }
+                    }
+
+                    // we can get into an interesting situation near the end of synchronization.  We can be in
+                    // sync with one peer who is sending us the last block on the chain via a regular inventory
+                    // message, while at the same time still be synchronizing with a peer who is sending us the
+                    // block through the sync mechanism.  Further, we must request both blocks because
+                    // we don't know they're the same (for the peer in normal operation, it has only told us the
+                    // message id, for the peer in the sync case we only known the block_id).
+                    if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
+                            block_message_to_process.block_id) ==
+                        _most_recent_blocks_accepted.end()) {
+                        _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process]() {
+                            send_sync_block_to_node_delegate(block_message_to_process);
+                        }, "send_sync_block_to_node_delegate"));
+                        ++blocks_processed;
+                        block_processed_this_iteration = true;
+                    } else
+                        dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
 
                     if (_handle_message_calls_in_progress.size() >=
                         _maximum_number_of_blocks_to_handle_at_one_time) {
                         dlog("stopping processing sync block backlog because we have ${count} blocks in progress",
                                 ("count", _handle_message_calls_in_progress.size()));
-                        //ulog("stopping processing sync block backlog because we have ${count} blocks in progress, total on hand: ${received}",
-                        //     ("count", _handle_message_calls_in_progress.size())("received", _received_sync_items.size()));
-                        if (_received_sync_items.size() >=
-                            _maximum_number_of_sync_blocks_to_prefetch) {
+                        if (_received_sync_items.is_full()) {
                                 _suspend_fetching_sync_blocks = true;
                         }
                         break;
@@ -3414,9 +3618,16 @@ namespace golos {
                 VERIFY_CORRECT_THREAD();
                 dlog("received a sync block from peer ${endpoint}", ("endpoint", originating_peer->get_remote_endpoint()));
 
-                // add it to the front of _received_sync_items, then process _received_sync_items to try to
+                // start validation of signatures and etc in background, while the block waits for its turn
+                try {
+                    _delegate->prefetch_sync_block(block_message_to_process);
+                } catch (const fc::exception &e) {
+                    wlog("Failed to prefetch sync block: ${e}", ("e", e.to_detail_string()));
+                }
+
+                // add it to _received_sync_items, then process _received_sync_items to try to
                 // pass as many messages as possible to the client.
-                _new_received_sync_items.push_front(block_message_to_process);
+                _received_sync_items.add(block_message_to_process);
                 trigger_process_backlog_of_sync_blocks();
             }
 
@@ -3618,6 +3829,38 @@ namespace golos {
                     }
                 }
 
+                const pushed_block_action push_action = originating_peer->pushed_blocks.check(
+                        may_push_blocks(*originating_peer), fc::time_point::now());
+                if (push_action == pushed_block_action::ignore) {
+                    // the block will be fetched via the inventory, if it's valid
+                    wlog("ignoring block ${block_id} pushed by peer ${endpoint}, the peer pushes blocks too often",
+                            ("block_id", block_message_to_process.block_id)
+                                    ("endpoint", originating_peer->get_remote_endpoint()));
+                    return;
+                }
+
+                if (push_action == pushed_block_action::process) {
+                    // the peer pushed a new block without the inventory round-trip,
+                    // remember it as offered to not advertise the block back
+                    item_id block_message_item_id(golos::network::block_message_type, message_hash);
+                    originating_peer->inventory_peer_advertised_to_us.insert(
+                            peer_connection::timestamped_item_id(block_message_item_id, fc::time_point::now()));
+
+                    if (_message_cache.has_message(message_hash) ||
+                        _message_ids_currently_being_processed.find(message_hash) !=
+                        _message_ids_currently_being_processed.end() ||
+                        originating_peer->we_need_sync_items_from_peer) {
+                        dlog("ignoring block ${block_id} pushed by peer ${endpoint}, we already have it or we are syncing with the peer",
+                                ("block_id", block_message_to_process.block_id)
+                                        ("endpoint", originating_peer->get_remote_endpoint()));
+                        return;
+                    }
+
+                    _items_to_fetch.get<item_id_index>().erase(block_message_item_id);
+                    process_block_during_normal_operation(originating_peer, block_message_to_process, message_hash);
+                    return;
+                }
+
                 // if we get here, we didn't request the message, we must have a misbehaving peer
                 wlog("received a block ${block_id} I didn't ask for from peer ${endpoint}, disconnecting from peer",
                         ("endpoint", originating_peer->get_remote_endpoint())
@@ -3729,7 +3972,7 @@ namespace golos {
                     } else {
                         // we're not connected to them, so we need to set up a connection to them
                         // to test.
-                        peer_connection_ptr peer_for_testing(peer_connection::make_shared(this));
+                        peer_connection_ptr peer_for_testing(create_peer_connection());
                         peer_for_testing->firewall_check_state = new firewall_check_state_data;
                         peer_for_testing->firewall_check_state->endpoint_to_test = check_firewall_message_received.endpoint_to_check;
                         peer_for_testing->firewall_check_state->expected_node_id = check_firewall_message_received.node_id;
@@ -4231,7 +4474,7 @@ namespace golos {
             void node_impl::accept_loop() {
                 VERIFY_CORRECT_THREAD();
                 while (!_accept_loop_complete.canceled()) {
-                    peer_connection_ptr new_peer(peer_connection::make_shared(this));
+                    peer_connection_ptr new_peer(create_peer_connection());
 
                     try {
                         _tcp_server.accept(new_peer->get_socket());
@@ -4258,6 +4501,16 @@ namespace golos {
                 }
             } // accept_loop()
 
+            peer_connection_ptr node_impl::create_peer_connection() {
+                VERIFY_CORRECT_THREAD();
+                peer_connection_ptr new_peer(peer_connection::make_shared(this));
+                std::shared_ptr<fc::thread> io_thread = _io_threads.next();
+                if (io_thread) {
+                    new_peer->set_io_thread(io_thread);
+                }
+                return new_peer;
+            }
+
             void node_impl::send_hello_message(const peer_connection_ptr &peer) {
                 VERIFY_CORRECT_THREAD();
                 peer->negotiation_status = peer_connection::connection_negotiation_status::hello_sent;
@@ -4647,7 +4900,7 @@ namespace golos {
                             ("endpoint", remote_endpoint));
 
                 dlog("node_impl::connect_to_endpoint(${endpoint})", ("endpoint", remote_endpoint));
-                peer_connection_ptr new_peer(peer_connection::make_shared(this));
+                peer_connection_ptr new_peer(create_peer_connection());
                 new_peer->set_remote_endpoint(remote_endpoint);
                 initiate_connect_to(new_peer);
             }
@@ -4733,8 +4986,8 @@ namespace golos {
 
                 ilog("--------- MEMORY USAGE ------------");
                 ilog("node._active_sync_requests size: ${size}", ("size", _active_sync_requests.size()));
-                ilog("node._received_sync_items size: ${size}", ("size", _received_sync_items.size()));
-                ilog("node._new_received_sync_items size: ${size}", ("size", _new_received_sync_items.size()));
+                ilog("node._received_sync_items size: ${size}, ${bytes} bytes",
+                        ("size", _received_sync_items.count())("bytes", _received_sync_items.size()));
                 ilog("node._items_to_fetch size: ${size}", ("size", _items_to_fetch.size()));
                 ilog("node._new_inventory size: ${size}", ("size", _new_inventory.size()));
                 ilog("node._message_cache size: ${size}", ("size", _message_cache.size()));
@@ -4920,10 +5173,88 @@ namespace golos {
                 message_hash_type hash_of_item_to_broadcast = item_to_broadcast.id();
 
                 _message_cache.cache_message(item_to_broadcast, hash_of_item_to_broadcast, propagation_data, hash_of_message_contents);
+                if (item_to_broadcast.msg_type == golos::network::block_message_type) {
+                    push_block_to_peers(item_to_broadcast, hash_of_item_to_broadcast);
+                }
                 _new_inventory.insert(item_id(item_to_broadcast.msg_type, hash_of_item_to_broadcast));
                 trigger_advertise_inventory_loop();
             }
 
+            bool node_impl::is_block_push_endpoint(peer_connection &peer) const {
+                if (_block_push_endpoints.empty()) {
+                    return false;
+                }
+                // the remote endpoint of inbound connections has a random port
+                fc::optional<fc::ip::endpoint> endpoint_for_connecting = peer.get_endpoint_for_connecting();
+                fc::optional<fc::ip::endpoint> remote_endpoint = peer.get_remote_endpoint();
+                return (endpoint_for_connecting && _block_push_endpoints.count(*endpoint_for_connecting)) ||
+                       (remote_endpoint && _block_push_endpoints.count(*remote_endpoint));
+            }
+
+            /**
+             * New blocks, which we didn't request, are accepted only from the configured peers,
+             *   the peers we push blocks to, and the peers which offered to push blocks to us
+             */
+            bool node_impl::may_push_blocks(peer_connection &peer) const {
+                return peer.block_push_offered_to_peer || peer.peer_offered_block_push || is_block_push_endpoint(peer);
+            }
+
+            void node_impl::push_block_to_peers(const message &block_message_to_push, const message_hash_type &message_hash) {
+                VERIFY_CORRECT_THREAD();
+                if (_block_push_peer_count == 0 && _block_push_endpoints.empty()) {
+                    return;
+                }
+
+                item_id block_message_item_id(golos::network::block_message_type, message_hash);
+                std::vector<peer_connection_ptr> peers_to_push;
+                std::vector<peer_connection_ptr> measured_peers;
+                for (const peer_connection_ptr &peer : _active_connections) {
+                    // the peer has the block or will get it via sync
+                    if (!peer->supports_block_push ||
+                        peer->peer_needs_sync_items_from_us ||
+                        peer->inventory_peer_advertised_to_us.find(block_message_item_id) !=
+                        peer->inventory_peer_advertised_to_us.end() ||
+                        peer->inventory_advertised_to_peer.find(block_message_item_id) !=
+                        peer->inventory_advertised_to_peer.end()) {
+                        continue;
+                    }
+                    if (is_block_push_endpoint(*peer)) {
+                        peers_to_push.push_back(peer);
+                    } else if (peer->round_trip_delay.count() > 0) {
+                        measured_peers.push_back(peer);
+                    }
+                }
+
+                size_t lowest_latency_count = std::min<size_t>(_block_push_peer_count, measured_peers.size());
+                std::partial_sort(measured_peers.begin(), measured_peers.begin() + lowest_latency_count, measured_peers.end(),
+                        [](const peer_connection_ptr &a, const peer_connection_ptr &b) {
+                            return a->round_trip_delay < b->round_trip_delay;
+                        });
+                peers_to_push.insert(peers_to_push.end(), measured_peers.begin(), measured_peers.begin() + lowest_latency_count);
+
+                fc::optional<message> compact_block;
+                for (const peer_connection_ptr &peer : peers_to_push) {
+                    // the inventory isn't advertised to the peer, which has got the block
+                    peer->inventory_advertised_to_peer.insert(
+                            peer_connection::timestamped_item_id(block_message_item_id, fc::time_point::now()));
+                    dlog("pushing block ${id} to peer ${endpoint}", ("id", message_hash)("endpoint", peer->get_remote_endpoint()));
+                    if (!peer->block_push_offered_to_peer) {
+                        // the peer disconnects from nodes, which push blocks without the offer
+                        peer->send_message(block_push_offer_message());
+                        peer->block_push_offered_to_peer = true;
+                    }
+                    if (peer->supports_compact_blocks) {
+                        if (!compact_block) {
+                            golos::network::block_message block = block_message_to_push.as<golos::network::block_message>();
+                            compact_block = message(_compact_blocks_sent.get(block, message_hash));
+                        }
+                        peer->send_message(*compact_block);
+                    } else {
+                        peer->send_message(block_message_to_push);
+                    }
+                }
+            }
+
             void node_impl::broadcast(const message &item_to_broadcast) {
                 VERIFY_CORRECT_THREAD();
                 // this version is called directly from the client
@@ -4972,12 +5303,31 @@ namespace golos {
                 if (params.contains("maximum_number_of_blocks_to_handle_at_one_time")) {
                     _maximum_number_of_blocks_to_handle_at_one_time = params["maximum_number_of_blocks_to_handle_at_one_time"].as<uint32_t>();
                 }
+                if (params.contains("maximum_sync_blocks_buffer_size")) {
+                    _received_sync_items.set_limits(params["maximum_sync_blocks_buffer_size"].as<uint64_t>(),
+                            _received_sync_items.get_max_count());
+                }
                 if (params.contains("maximum_number_of_sync_blocks_to_prefetch")) {
-                    _maximum_number_of_sync_blocks_to_prefetch = params["maximum_number_of_sync_blocks_to_prefetch"].as<uint32_t>();
+                    // the old limit of the buffer by the number of blocks, 0 - the buffer is limited only by the size
+                    _received_sync_items.set_limits(_received_sync_items.get_max_size(),
+                            params["maximum_number_of_sync_blocks_to_prefetch"].as<uint32_t>());
                 }
                 if (params.contains("maximum_blocks_per_peer_during_syncing")) {
                     _maximum_blocks_per_peer_during_syncing = params["maximum_blocks_per_peer_during_syncing"].as<uint32_t>();
                 }
+                if (params.contains("io_thread_count")) {
+                    // existing connections keep their threads
+                    _io_threads.resize(params["io_thread_count"].as<uint32_t>());
+                }
+                if (params.contains("block_push_peer_count")) {
+                    _block_push_peer_count = params["block_push_peer_count"].as<uint32_t>();
+                }
+                if (params.contains("block_push_endpoints")) {
+                    _block_push_endpoints.clear();
+                    for (const std::string &endpoint : params["block_push_endpoints"].as<std::vector<std::string>>()) {
+                        _block_push_endpoints.insert(fc::ip::endpoint::from_string(endpoint));
+                    }
+                }
 
                 _desired_number_of_connections = std::min(_desired_number_of_connections, _maximum_number_of_connections);
 
@@ -4996,8 +5346,16 @@ namespace golos {
                 result["desired_number_of_connections"] = _desired_number_of_connections;
                 result["maximum_number_of_connections"] = _maximum_number_of_connections;
                 result["maximum_number_of_blocks_to_handle_at_one_time"] = _maximum_number_of_blocks_to_handle_at_one_time;
-                result["maximum_number_of_sync_blocks_to_prefetch"] = _maximum_number_of_sync_blocks_to_prefetch;
+                result["maximum_sync_blocks_buffer_size"] = _received_sync_items.get_max_size();
+                result["maximum_number_of_sync_blocks_to_prefetch"] = _received_sync_items.get_max_count();
                 result["maximum_blocks_per_peer_during_syncing"] = _maximum_blocks_per_peer_during_syncing;
+                result["io_thread_count"] = _io_threads.size();
+                result["block_push_peer_count"] = _block_push_peer_count;
+                std::vector<std::string> block_push_endpoints;
+                for (const fc::ip::endpoint &endpoint : _block_push_endpoints) {
+                    block_push_endpoints.push_back(std::string(endpoint));
+                }
+                result["block_push_endpoints"] = block_push_endpoints;
                 return result;
             }
 
@@ -5412,6 +5770,12 @@ namespace golos {
                 INVOKE_AND_COLLECT_STATISTICS(handle_block, block_message, sync_mode, contained_transaction_message_ids);
             }
 
+            void statistics_gathering_node_delegate_wrapper::prefetch_sync_block(const golos::network::block_message &block_message) {
+                // this function doesn't need to block
+                ASSERT_TASK_NOT_PREEMPTED();
+                _node_delegate->prefetch_sync_block(block_message);
+            }
+
             void statistics_gathering_node_delegate_wrapper::handle_transaction(const golos::network::trx_message &transaction_message) {
                 INVOKE_AND_COLLECT_STATISTICS(handle_transaction, transaction_message);
             }
@@ -76,6 +76,10 @@ namespace golos {
                 their_state(their_connection_state::disconnected),
                 we_have_requested_close(false),
                 negotiation_status(connection_negotiation_status::disconnected),
+                supports_compact_blocks(false),
+                supports_block_push(false),
+                block_push_offered_to_peer(false),
+                peer_offered_block_push(false),
                 number_of_unfetched_item_ids(0),
                 peer_needs_sync_items_from_us(true),
                 we_need_sync_items_from_peer(true),
@@ -205,6 +209,11 @@ namespace golos {
             }
         }
 
+        void peer_connection::set_io_thread(const std::shared_ptr<fc::thread> &io_thread) {
+            VERIFY_CORRECT_THREAD();
+            _message_connection.set_io_thread(io_thread);
+        }
+
         void peer_connection::connect_to(const fc::ip::endpoint &remote_endpoint, fc::optional<fc::ip::endpoint> local_endpoint) {
             VERIFY_CORRECT_THREAD();
             try {
@@ -241,9 +250,10 @@ namespace golos {
             }
         } // connect_to()
 
-        void peer_connection::on_message(message_oriented_connection *originating_connection, const message &received_message) {
+        void peer_connection::on_message(message_oriented_connection *originating_connection, const message &received_message,
+                const message_hash_type &message_hash) {
             VERIFY_CORRECT_THREAD();
-            _node->on_message(this, received_message);
+            _node->on_message(this, received_message, message_hash);
         }
 
         void peer_connection::on_connection_closed(message_oriented_connection *originating_connection) {
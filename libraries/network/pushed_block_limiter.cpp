@@ -0,0 +1,44 @@
+#include <golos/network/pushed_block_limiter.hpp>
+
+#include <algorithm>
+
+namespace golos {
+    namespace network {
+
+        pushed_block_limiter::pushed_block_limiter(uint32_t max_blocks, fc::microseconds interval)
+                : _max_blocks(std::max<uint32_t>(max_blocks, 1)),
+                  _interval(std::max(interval, fc::microseconds(1))),
+                  _available_blocks(_max_blocks) {
+        }
+
+        bool pushed_block_limiter::allow(fc::time_point now) {
+            if (_available_blocks == _max_blocks) {
+                // the interval starts from the first block pushed after the limiter was full
+                _refill_time = now;
+            } else if (now > _refill_time) {
+                const auto intervals = (now - _refill_time).count() / _interval.count();
+                if (intervals >= _max_blocks - _available_blocks) {
+                    _available_blocks = _max_blocks;
+                    _refill_time = now;
+                } else {
+                    _available_blocks += static_cast<uint32_t>(intervals);
+                    _refill_time += fc::microseconds(intervals * _interval.count());
+                }
+            }
+
+            if (_available_blocks == 0) {
+                return false;
+            }
+            --_available_blocks;
+            return true;
+        }
+
+        pushed_block_action pushed_block_limiter::check(bool may_push_blocks, fc::time_point now) {
+            if (!may_push_blocks) {
+                return pushed_block_action::disconnect;
+            }
+            return allow(now) ? pushed_block_action::process : pushed_block_action::ignore;
+        }
+
+    }
+} // golos::network
@@ -0,0 +1,124 @@
+#include <golos/network/sync_block_buffer.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include <algorithm>
+#include <set>
+
+namespace golos {
+    namespace network {
+
+        sync_block_buffer::sync_block_buffer(uint64_t max_size, uint32_t max_count)
+                : _max_size(max_size),
+                  _max_count(max_count) {
+        }
+
+        void sync_block_buffer::set_limits(uint64_t max_size, uint32_t max_count) {
+            _max_size = max_size;
+            _max_count = max_count;
+        }
+
+        uint64_t sync_block_buffer::get_max_size() const {
+            return _max_size;
+        }
+
+        uint32_t sync_block_buffer::get_max_count() const {
+            return _max_count;
+        }
+
+        bool sync_block_buffer::add(const block_message &block) {
+            const uint64_t block_size = fc::raw::pack_size(block.block);
+            if (!_blocks.emplace(block.block_id, received_block{block, block_size}).second) {
+                return false;
+            }
+            _size += block_size;
+            _average_block_size = _average_block_size == 0
+                                  ? block_size
+                                  : (99 * _average_block_size + block_size) / 100;
+            return true;
+        }
+
+        bool sync_block_buffer::contains(const item_hash_t &block_id) const {
+            return _blocks.find(block_id) != _blocks.end();
+        }
+
+        fc::optional<block_message> sync_block_buffer::take(const item_hash_t &block_id) {
+            fc::optional<block_message> result;
+            auto iter = _blocks.find(block_id);
+            if (iter != _blocks.end()) {
+                result = std::move(iter->second.block);
+                _size -= iter->second.size;
+                _blocks.erase(iter);
+            }
+            return result;
+        }
+
+        std::size_t sync_block_buffer::count() const {
+            return _blocks.size();
+        }
+
+        uint64_t sync_block_buffer::size() const {
+            return _size;
+        }
+
+        uint64_t sync_block_buffer::average_block_size() const {
+            return _average_block_size;
+        }
+
+        bool sync_block_buffer::is_full() const {
+            return _size >= _max_size || (_max_count != 0 && _blocks.size() >= _max_count);
+        }
+
+        std::vector<std::vector<item_hash_t>> sync_block_buffer::select_requests(
+                const std::vector<const item_ids_type *> &idle_peers,
+                uint32_t number_of_syncing_peers,
+                std::size_t number_of_requested_blocks,
+                const is_requested_type &is_requested,
+                uint32_t max_blocks_per_peer) const {
+            std::vector<std::vector<item_hash_t>> result(idle_peers.size());
+
+            // received and requested blocks, which wait for the earlier blocks
+            uint64_t expected_size = _size + number_of_requested_blocks * _average_block_size;
+            uint64_t expected_count = _blocks.size() + number_of_requested_blocks;
+            auto has_free_space = [&]() {
+                return expected_size < _max_size && (_max_count == 0 || expected_count < _max_count);
+            };
+
+            uint64_t blocks_per_peer = max_blocks_per_peer;
+            if (number_of_syncing_peers != 0) {
+                uint64_t free_blocks = uint64_t(max_blocks_per_peer) * number_of_syncing_peers;
+                if (_average_block_size != 0) {
+                    free_blocks = expected_size < _max_size ? (_max_size - expected_size) / _average_block_size : 0;
+                }
+                if (_max_count != 0) {
+                    free_blocks = std::min<uint64_t>(free_blocks, expected_count < _max_count ? _max_count - expected_count : 0);
+                }
+                blocks_per_peer = free_blocks / number_of_syncing_peers;
+            }
+            blocks_per_peer = std::max<uint64_t>(blocks_per_peer, GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING);
+            blocks_per_peer = std::min<uint64_t>(blocks_per_peer, max_blocks_per_peer);
+
+            std::set<item_hash_t> selected_blocks;
+            for (std::size_t i = 0; i < idle_peers.size(); ++i) {
+                const item_ids_type &item_ids = *idle_peers[i];
+                std::vector<item_hash_t> &requests = result[i];
+                for (std::size_t j = 0; j < item_ids.size(); ++j) {
+                    // the lowest blocks are requested even if the buffer is full, otherwise it can't be drained
+                    if (j >= GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING &&
+                        (!has_free_space() || requests.size() >= blocks_per_peer)) {
+                        break;
+                    }
+                    const item_hash_t &block_id = item_ids[j];
+                    if (contains(block_id) || is_requested(block_id) || !selected_blocks.insert(block_id).second) {
+                        continue;
+                    }
+                    requests.push_back(block_id);
+                    expected_size += _average_block_size;
+                    ++expected_count;
+                }
+            }
+            return result;
+        }
+
+    }
+} // golos::network
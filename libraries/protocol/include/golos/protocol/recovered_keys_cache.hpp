@@ -0,0 +1,86 @@
+#pragma once
+
+#include <golos/protocol/types.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace golos { namespace protocol {
+
+    /**
+     * Bounded thread-safe cache of public keys recovered from signatures.
+     *
+     * The same transaction is verified several times: on receiving from network, in the block
+     *   and on restoring of pending transactions after each block. Recovering of key is the most
+     *   expensive part of these checks, so its results are reused.
+     *
+     * The cache is split into shards to reduce lock contention. Each shard keeps two generations
+     *   of entries: when the current generation is full, it replaces the previous one,
+     *   and entries found in the previous generation are moved back to the current.
+     */
+    class recovered_keys_cache final {
+    public:
+        static recovered_keys_cache& instance();
+
+        /**
+         * Set the maximum number of cached keys, 0 disables the cache
+         */
+        void set_max_size(std::size_t max_size);
+
+        std::size_t max_size() const;
+
+        bool is_enabled() const;
+
+        bool find(const digest_type& digest, const signature_type& signature, public_key_type& key);
+
+        void insert(const digest_type& digest, const signature_type& signature, const public_key_type& key);
+
+        /**
+         * Return cached key or recover it from the signature
+         */
+        public_key_type get(const digest_type& digest, const signature_type& signature);
+
+        void clear();
+
+        std::size_t size() const;
+
+        uint64_t hits() const;
+
+        uint64_t misses() const;
+
+    private:
+        recovered_keys_cache();
+
+        struct key_type final {
+            digest_type digest;
+            signature_type signature;
+
+            bool operator==(const key_type& other) const {
+                return digest == other.digest && signature == other.signature;
+            }
+        };
+
+        struct key_hash final {
+            std::size_t operator()(const key_type& key) const;
+        };
+
+        using generation_type = std::unordered_map<key_type, public_key_type, key_hash>;
+
+        struct shard_type final {
+            mutable std::mutex mutex;
+            generation_type current;
+            generation_type previous;
+        };
+
+        static constexpr std::size_t shard_count = 16;
+
+        shard_type& get_shard(const key_type& key);
+
+        shard_type _shards[shard_count];
+        std::atomic<std::size_t> _max_shard_size;
+        std::atomic<uint64_t> _hits;
+        std::atomic<uint64_t> _misses;
+    };
+
+} } // golos::protocol
@@ -6,6 +6,7 @@
 #include <fc/container/flat_fwd.hpp>
 #include <fc/io/varint.hpp>
 #include <fc/io/enum_type.hpp>
+#include <fc/crypto/city.hpp>
 #include <fc/crypto/sha224.hpp>
 #include <fc/crypto/ripemd160.hpp>
 #include <fc/crypto/elliptic.hpp>
@@ -98,6 +99,15 @@ namespace golos {
             }
         };
 
+        /**
+         * Hash of names for hashed indexes, the same bytes as compared by string_less
+         */
+        struct string_hash {
+            std::size_t operator()(const fc::fixed_string<> &a) const {
+                return fc::city_hash_size_t((const char *)&a, sizeof(a));
+            }
+        };
+
         typedef fc::ripemd160 block_id_type;
         typedef fc::ripemd160 checksum_type;
         typedef fc::ripemd160 transaction_id_type;
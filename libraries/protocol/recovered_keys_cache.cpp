@@ -0,0 +1,131 @@
+#include <golos/protocol/recovered_keys_cache.hpp>
+
+#include <cstring>
+
+namespace golos { namespace protocol {
+
+    recovered_keys_cache::recovered_keys_cache()
+        : _max_shard_size(0),
+          _hits(0),
+          _misses(0) {
+    }
+
+    recovered_keys_cache& recovered_keys_cache::instance() {
+        static recovered_keys_cache cache;
+        return cache;
+    }
+
+    std::size_t recovered_keys_cache::key_hash::operator()(const key_type& key) const {
+        // digest is already a good hash, the signature is mixed to distinguish multisig transactions
+        std::size_t digest_part;
+        std::size_t signature_part;
+        std::memcpy(&digest_part, key.digest.data(), sizeof(digest_part));
+        std::memcpy(&signature_part, key.signature.data() + 1, sizeof(signature_part));
+        return digest_part ^ signature_part;
+    }
+
+    recovered_keys_cache::shard_type& recovered_keys_cache::get_shard(const key_type& key) {
+        auto byte = static_cast<unsigned char>(key.digest.data()[sizeof(std::size_t)]);
+        return _shards[byte % shard_count];
+    }
+
+    void recovered_keys_cache::set_max_size(std::size_t max_size) {
+        // each shard keeps two generations
+        _max_shard_size = (max_size + shard_count * 2 - 1) / (shard_count * 2);
+        if (!max_size) {
+            clear();
+        }
+    }
+
+    std::size_t recovered_keys_cache::max_size() const {
+        return _max_shard_size * shard_count * 2;
+    }
+
+    bool recovered_keys_cache::is_enabled() const {
+        return _max_shard_size != 0;
+    }
+
+    bool recovered_keys_cache::find(const digest_type& digest, const signature_type& signature, public_key_type& key) {
+        if (!is_enabled()) {
+            return false;
+        }
+
+        key_type k{digest, signature};
+        auto& shard = get_shard(k);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto itr = shard.current.find(k);
+        if (itr != shard.current.end()) {
+            key = itr->second;
+            ++_hits;
+            return true;
+        }
+
+        itr = shard.previous.find(k);
+        if (itr != shard.previous.end()) {
+            key = itr->second;
+            shard.previous.erase(itr);
+            if (shard.current.size() >= _max_shard_size) {
+                shard.previous = std::move(shard.current);
+                shard.current = generation_type();
+            }
+            shard.current.emplace(std::move(k), key);
+            ++_hits;
+            return true;
+        }
+
+        ++_misses;
+        return false;
+    }
+
+    void recovered_keys_cache::insert(const digest_type& digest, const signature_type& signature, const public_key_type& key) {
+        if (!is_enabled()) {
+            return;
+        }
+
+        key_type k{digest, signature};
+        auto& shard = get_shard(k);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        if (shard.current.size() >= _max_shard_size) {
+            shard.previous = std::move(shard.current);
+            shard.current = generation_type();
+        }
+        shard.current.emplace(std::move(k), key);
+    }
+
+    public_key_type recovered_keys_cache::get(const digest_type& digest, const signature_type& signature) {
+        public_key_type key;
+        if (!find(digest, signature, key)) {
+            key = fc::ecc::public_key(signature, digest);
+            insert(digest, signature, key);
+        }
+        return key;
+    }
+
+    void recovered_keys_cache::clear() {
+        for (auto& shard: _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.current.clear();
+            shard.previous.clear();
+        }
+    }
+
+    std::size_t recovered_keys_cache::size() const {
+        std::size_t result = 0;
+        for (auto& shard: _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            result += shard.current.size() + shard.previous.size();
+        }
+        return result;
+    }
+
+    uint64_t recovered_keys_cache::hits() const {
+        return _hits;
+    }
+
+    uint64_t recovered_keys_cache::misses() const {
+        return _misses;
+    }
+
+} } // golos::protocol
@@ -64,3 +64,6 @@ namespace golos {
 
 FC_REFLECT((golos::plugins::account_by_key::key_lookup_object), (id)(key)(account))
 CHAINBASE_SET_INDEX_TYPE(golos::plugins::account_by_key::key_lookup_object, golos::plugins::account_by_key::key_lookup_index)
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::account_by_key::key_lookup_object,
+    (id)(key)(account))
@@ -0,0 +1,399 @@
+#include <golos/plugins/account_history/history_store.hpp>
+#include <golos/protocol/exceptions.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+namespace golos { namespace plugins { namespace account_history { namespace detail {
+
+    struct stored_account_head final {
+        account_name_type account;
+        uint32_t sequence = 0;
+        uint64_t record = 0;
+    };
+
+    struct stored_account_heads final {
+        uint64_t records_count = 0;
+        std::vector<stored_account_head> heads;
+    };
+
+} } } } // golos::plugins::account_history::detail
+
+FC_REFLECT(
+    (golos::plugins::account_history::detail::stored_account_head),
+    (account)(sequence)(record))
+
+FC_REFLECT(
+    (golos::plugins::account_history::detail::stored_account_heads),
+    (records_count)(heads))
+
+namespace golos { namespace plugins { namespace account_history {
+
+    namespace detail {
+        using read_write_mutex = boost::shared_mutex;
+        using read_lock = boost::shared_lock<read_write_mutex>;
+        using write_lock = boost::unique_lock<read_write_mutex>;
+
+        constexpr auto npos = stored_account_operation::npos;
+
+        /// Records are packed into slots of the fixed size to have random access by number
+        constexpr std::size_t record_size = 64;
+
+        /// The file grows at least by this number of records, and at most doubles
+        constexpr uint64_t min_records_growth = 16 * 1024;
+
+        uint32_t invert_lowest_one(uint32_t n) {
+            return n & (n - 1);
+        }
+
+        /**
+         * Sequence of the record, which is referenced by the skip link, it's chosen to find any record in O(log(N))
+         */
+        uint32_t get_skip_sequence(uint32_t sequence) {
+            if (sequence < 2) {
+                return 0;
+            }
+            return (sequence & 1)
+                ? invert_lowest_one(invert_lowest_one(sequence - 1)) + 1
+                : invert_lowest_one(sequence);
+        }
+
+        class account_history_store_impl final {
+        public:
+            struct account_head final {
+                uint32_t sequence = 0;
+                uint64_t record = 0;
+            };
+
+            void open(const fc::path& dir) {
+                close();
+
+                boost::filesystem::create_directories(dir);
+                _records_path = (dir / "accounts.dat").string();
+                _heads_path = (dir / "accounts.heads").string();
+
+                if (!boost::filesystem::exists(_records_path)) {
+                    std::ofstream(_records_path, std::ios::out|std::ios::binary);
+                }
+                auto size = boost::filesystem::file_size(_records_path);
+                if (size % record_size) {
+                    size -= size % record_size;
+                    boost::filesystem::resize_file(_records_path, size);
+                }
+                if (size > 0) {
+                    _records.open(_records_path, boost::iostreams::mapped_file::readwrite);
+                }
+                _records_count = size / record_size;
+
+                // the unused end of the file is left after the crash, records of blocks are never empty
+                uint64_t begin = 0;
+                while (begin < _records_count) {
+                    auto middle = begin + (_records_count - begin) / 2;
+                    if (get_record(middle).block != 0) {
+                        begin = middle + 1;
+                    } else {
+                        _records_count = middle;
+                    }
+                }
+
+                load_heads();
+            }
+
+            void close() {
+                if (_records.is_open()) {
+                    save_heads();
+                    set_capacity(_records_count);
+                }
+                _records.close();
+                _records_count = 0;
+                _records_path.clear();
+                _heads.clear();
+            }
+
+            bool is_open() const {
+                return !_records_path.empty();
+            }
+
+            uint64_t records_count() const {
+                return _records_count;
+            }
+
+            uint32_t head_block_num() const {
+                auto count = records_count();
+                return count ? get_record(count - 1).block : 0;
+            }
+
+            void truncate(uint32_t block_num) {
+                if (block_num > head_block_num()) {
+                    return;
+                }
+
+                // records are ordered by blocks
+                uint64_t begin = 0;
+                uint64_t end = records_count();
+                while (begin < end) {
+                    auto middle = begin + (end - begin) / 2;
+                    if (get_record(middle).block < block_num) {
+                        begin = middle + 1;
+                    } else {
+                        end = middle;
+                    }
+                }
+
+                ilog("Truncate account history store from block ${b}", ("b", block_num));
+
+                // heads will be reconstructed
+                boost::filesystem::remove_all(_heads_path);
+                resize_records(begin);
+                load_heads();
+            }
+
+            void append_block(uint32_t block_num, std::vector<stored_account_operation> ops) {
+                FC_ASSERT(block_num > head_block_num(),
+                    "Block ${b} is already in account history store", ("b", block_num));
+
+                auto record = records_count();
+                resize_records(record + ops.size());
+
+                for (auto& op: ops) {
+                    op.block = block_num;
+
+                    auto itr = _heads.find(std::string(op.account));
+                    if (itr == _heads.end()) {
+                        FC_ASSERT(op.sequence == 0,
+                            "Wrong sequence ${s} of the first operation of ${a}", ("s", op.sequence)("a", op.account));
+                        op.prev = npos;
+                        op.skip = npos;
+                        itr = _heads.emplace(std::string(op.account), account_head()).first;
+                    } else {
+                        FC_ASSERT(op.sequence == itr->second.sequence + 1,
+                            "Wrong sequence ${s} of operation of ${a}, expected ${e}",
+                            ("s", op.sequence)("a", op.account)("e", itr->second.sequence + 1));
+                        op.prev = itr->second.record;
+                        op.skip = find_record(itr->second, get_skip_sequence(op.sequence));
+                    }
+
+                    put_record(record, op);
+                    itr->second.sequence = op.sequence;
+                    itr->second.record = record;
+                    ++record;
+                }
+            }
+
+            uint32_t next_sequence(const account_name_type& account) const {
+                auto itr = _heads.find(std::string(account));
+                if (itr == _heads.end()) {
+                    return 0;
+                }
+                return itr->second.sequence + 1;
+            }
+
+            void visit(
+                const account_name_type& account, uint32_t from,
+                const std::function<bool(const stored_account_operation&)>& visitor
+            ) const {
+                auto itr = _heads.find(std::string(account));
+                if (itr == _heads.end()) {
+                    return;
+                }
+
+                auto record = find_record(itr->second, std::min(from, itr->second.sequence));
+                while (record != npos) {
+                    auto op = get_record(record);
+                    if (!visitor(op)) {
+                        break;
+                    }
+                    record = op.prev;
+                }
+            }
+
+        private:
+            stored_account_operation get_record(uint64_t record) const {
+                GOLOS_CHECK_DATABASE(record < records_count(),
+                    database_corrupted::reading_data_beyond_end_of_file,
+                    "Reading data beyond end of file", ("record", record)("count", records_count()));
+
+                stored_account_operation op;
+                fc::datastream<const char*> ds(_records.const_data() + record * record_size, record_size);
+                fc::raw::unpack(ds, op);
+                return op;
+            }
+
+            void put_record(uint64_t record, const stored_account_operation& op) {
+                auto* ptr = _records.data() + record * record_size;
+                std::memset(ptr, 0, record_size);
+                fc::datastream<char*> ds(ptr, record_size);
+                fc::raw::pack(ds, op);
+            }
+
+            /**
+             * The file grows geometrically to not remap it on each block, the truncated records are cut off
+             */
+            void resize_records(uint64_t count) {
+                const auto capacity = records_capacity();
+                if (count < _records_count) {
+                    set_capacity(count);
+                } else if (count > capacity) {
+                    set_capacity(std::max(count, capacity + std::max(capacity, min_records_growth)));
+                }
+                _records_count = count;
+            }
+
+            uint64_t records_capacity() const {
+                return _records.is_open() ? _records.size() / record_size : 0;
+            }
+
+            void set_capacity(uint64_t count) {
+                const auto size = count * record_size;
+                if (size == (_records.is_open() ? _records.size() : 0)) {
+                    return;
+                }
+                if (size == 0) {
+                    _records.close();
+                    boost::filesystem::resize_file(_records_path, 0);
+                } else if (!_records.is_open()) {
+                    boost::filesystem::resize_file(_records_path, size);
+                    _records.open(_records_path, boost::iostreams::mapped_file::readwrite);
+                } else {
+                    _records.resize(size);
+                }
+            }
+
+            /**
+             * Walk from the head of account to the record with the required sequence by prev and skip links
+             */
+            uint64_t find_record(const account_head& head, uint32_t sequence) const {
+                auto record = head.record;
+                auto current = head.sequence;
+                while (current > sequence) {
+                    auto op = get_record(record);
+                    int64_t skip = get_skip_sequence(current);
+                    int64_t skip_prev = get_skip_sequence(current - 1);
+                    if (op.skip != npos &&
+                        (skip == sequence || (skip > sequence && !(skip_prev < skip - 2 && skip_prev >= sequence)))
+                    ) {
+                        record = op.skip;
+                        current = skip;
+                    } else {
+                        record = op.prev;
+                        current--;
+                    }
+                }
+                return record;
+            }
+
+            void load_heads() {
+                _heads.clear();
+
+                uint64_t record = 0;
+                const auto count = records_count();
+
+                if (boost::filesystem::exists(_heads_path)) {
+                    try {
+                        std::ifstream in(_heads_path, std::ios::in|std::ios::binary);
+                        std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+                        auto heads = fc::raw::unpack<stored_account_heads>(data);
+                        if (heads.records_count <= count) {
+                            for (const auto& head: heads.heads) {
+                                _heads[std::string(head.account)] = {head.sequence, head.record};
+                            }
+                            record = heads.records_count;
+                        }
+                    } catch (const fc::exception& e) {
+                        wlog("Failed to load heads of account history store: ${e}", ("e", e.to_string()));
+                        _heads.clear();
+                    }
+                }
+
+                if (record < count) {
+                    ilog("Reconstructing heads of account history store from record ${r}", ("r", record));
+                }
+                for (; record < count; ++record) {
+                    auto op = get_record(record);
+                    _heads[std::string(op.account)] = {op.sequence, record};
+                }
+            }
+
+            void save_heads() const {
+                stored_account_heads heads;
+                heads.records_count = records_count();
+                heads.heads.reserve(_heads.size());
+                for (const auto& head: _heads) {
+                    heads.heads.push_back({head.first, head.second.sequence, head.second.record});
+                }
+
+                auto data = fc::raw::pack(heads);
+                std::ofstream out(_heads_path, std::ios::out|std::ios::binary|std::ios::trunc);
+                out.write(data.data(), data.size());
+            }
+
+            std::string _records_path;
+            std::string _heads_path;
+            boost::iostreams::mapped_file _records;
+            uint64_t _records_count = 0;
+            std::unordered_map<std::string, account_head> _heads;
+
+        public:
+            mutable read_write_mutex mutex;
+        };
+    } // detail
+
+    account_history_store::account_history_store()
+        : my(std::make_unique<detail::account_history_store_impl>()) {
+    }
+
+    account_history_store::~account_history_store() = default;
+
+    void account_history_store::open(const fc::path& dir) { try {
+        detail::write_lock lock(my->mutex);
+        my->open(dir);
+    } FC_LOG_AND_RETHROW() }
+
+    void account_history_store::close() {
+        detail::write_lock lock(my->mutex);
+        my->close();
+    }
+
+    bool account_history_store::is_open() const {
+        detail::read_lock lock(my->mutex);
+        return my->is_open();
+    }
+
+    uint32_t account_history_store::head_block_num() const {
+        detail::read_lock lock(my->mutex);
+        return my->head_block_num();
+    }
+
+    void account_history_store::truncate(uint32_t block_num) {
+        detail::write_lock lock(my->mutex);
+        my->truncate(block_num);
+    }
+
+    void account_history_store::append_block(uint32_t block_num, std::vector<stored_account_operation> ops) {
+        detail::write_lock lock(my->mutex);
+        my->append_block(block_num, std::move(ops));
+    }
+
+    uint32_t account_history_store::next_sequence(const account_name_type& account) const {
+        detail::read_lock lock(my->mutex);
+        return my->next_sequence(account);
+    }
+
+    void account_history_store::visit(
+        const account_name_type& account, uint32_t from,
+        std::function<bool(const stored_account_operation&)> visitor
+    ) const {
+        detail::read_lock lock(my->mutex);
+        my->visit(account, from, visitor);
+    }
+
+} } } // golos::plugins::account_history
@@ -29,7 +29,8 @@
 namespace golos { namespace plugins { namespace account_history {
 
     enum account_object_types {
-        account_history_object_type = (ACCOUNT_HISTORY_SPACE_ID << 8)
+        account_history_object_type = (ACCOUNT_HISTORY_SPACE_ID << 8),
+        account_history_head_object_type = (ACCOUNT_HISTORY_SPACE_ID << 8) + 1
     };
 
     enum operation_direction : uint8_t {
@@ -102,6 +103,37 @@ static_assert(protocol::operation::count() >= 0 && protocol::operation::count()
                 composite_key_compare<std::less<account_name_type>, std::greater<uint32_t>>>>,
         allocator<account_history_object>>;
 
+
+    /**
+     * The last sequence of the account history, it isn't removed with old operations,
+     *   so sequences are assigned without search of the last operation of account
+     */
+    class account_history_head_object final: public object<account_history_head_object_type, account_history_head_object> {
+    public:
+        template <typename Constructor, typename Allocator>
+        account_history_head_object(Constructor&& c, allocator <Allocator> a) {
+            c(*this);
+        }
+
+        id_type id;
+
+        account_name_type account;
+        uint32_t sequence = 0;
+    };
+
+    using account_history_head_id_type = object_id<account_history_head_object>;
+
+    using account_history_head_index = multi_index_container<
+        account_history_head_object,
+        indexed_by<
+            ordered_unique<
+                tag<by_id>,
+                member<account_history_head_object, account_history_head_id_type, &account_history_head_object::id>>,
+            ordered_unique<
+                tag<by_account>,
+                member<account_history_head_object, account_name_type, &account_history_head_object::account>>>,
+        allocator<account_history_head_object>>;
+
 } } } // golos::plugins::account_history
 
 FC_REFLECT_ENUM(golos::plugins::account_history::operation_direction, (any)(sender)(receiver)(dual))
@@ -112,3 +144,13 @@ FC_REFLECT((golos::plugins::account_history::account_history_query),
 CHAINBASE_SET_INDEX_TYPE(
     golos::plugins::account_history::account_history_object,
     golos::plugins::account_history::account_history_index)
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::account_history::account_history_object,
+    (id)(account)(block)(sequence)(op_tag)(dir)(op))
+
+CHAINBASE_SET_INDEX_TYPE(
+    golos::plugins::account_history::account_history_head_object,
+    golos::plugins::account_history::account_history_head_index)
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::account_history::account_history_head_object,
+    (id)(account)(sequence))
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <golos/plugins/account_history/history_object.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace golos { namespace plugins { namespace account_history {
+
+    struct stored_account_operation final {
+        static constexpr uint64_t npos = uint64_t(-1);
+
+        account_name_type account;
+        uint32_t block = 0;
+        uint32_t sequence = 0;
+        uint8_t op_tag = 0;
+        operation_direction dir = operation_direction::any;
+        uint64_t op = 0;            ///< position of operation in operation_history::history_store
+        uint64_t prev = npos;       ///< number of the previous record of the account
+        uint64_t skip = npos;       ///< number of the earlier record of the account, see get_skip_sequence()
+    };
+
+    namespace detail { class account_history_store_impl; }
+
+    /**
+     * Append-only on-disk index of irreversible account operations, it's stored with operation_history::history_store.
+     *
+     * Records are kept in the file accounts.dat in the order of blocks. Records of each account are linked to
+     *   the previous one, and also have a skip link to the earlier record, so the record with the required sequence
+     *   is found in O(log(N)) steps (like skip lists of blocks in Bitcoin).
+     *
+     * Heads of accounts are kept in memory, they are saved to the file accounts.heads on close,
+     *   and reconstructed by scanning of records on open.
+     */
+    class account_history_store final {
+    public:
+        account_history_store();
+
+        ~account_history_store();
+
+        void open(const fc::path& dir);
+
+        void close();
+
+        bool is_open() const;
+
+        /**
+         * @return number of the last block in store, or 0 if it is empty
+         */
+        uint32_t head_block_num() const;
+
+        /**
+         * Remove records of blocks starting from block_num
+         */
+        void truncate(uint32_t block_num);
+
+        /**
+         * Append records of the block, their sequences should follow the last sequences of accounts
+         */
+        void append_block(uint32_t block_num, std::vector<stored_account_operation> ops);
+
+        /**
+         * @return sequence of the next operation of the account
+         */
+        uint32_t next_sequence(const account_name_type& account) const;
+
+        /**
+         * Visit operations of the account in the reverse order starting from the sequence from,
+         *   visiting stops when the visitor returns false
+         */
+        void visit(
+            const account_name_type& account, uint32_t from,
+            std::function<bool(const stored_account_operation&)> visitor) const;
+
+    private:
+        std::unique_ptr<detail::account_history_store_impl> my;
+    };
+
+} } } // golos::plugins::account_history
+
+FC_REFLECT(
+    (golos::plugins::account_history::stored_account_operation),
+    (account)(block)(sequence)(op_tag)(dir)(op)(prev)(skip))
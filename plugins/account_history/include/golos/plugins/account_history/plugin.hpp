@@ -42,7 +42,7 @@ namespace golos { namespace plugins { namespace account_history {
 
     using history_operations = std::map<uint32_t, applied_operation>;
 
-    DEFINE_API_ARGS(get_account_history, msg_pack, history_operations)
+    DEFINE_STREAMED_API_ARGS(get_account_history, msg_pack, history_operations)
 
    /**
     *  This plugin is designed to track a range of operations by account so that one node
@@ -85,6 +85,9 @@ namespace golos { namespace plugins { namespace account_history {
              *        filter_ops - blacklist. if skipped = empty list (nothing blacklisted)
              *        dir - direction of operation in relation to account: any, sender, receiver, dual. Experimental
              *    }
+             *
+             *  Filtered queries check at most 100000 irreversible operations starting from `from`,
+             *    so the result can have less than limit operations, even if the account has more of them.
              */
             (get_account_history)
         )
@@ -1,16 +1,21 @@
 #include <golos/chain/database.hpp>
 #include <golos/chain/operation_notification.hpp>
+#include <golos/chain/pruning.hpp>
 #include <golos/protocol/exceptions.hpp>
 #include <golos/plugins/account_history/plugin.hpp>
 #include <golos/plugins/account_history/history_object.hpp>
+#include <golos/plugins/account_history/history_store.hpp>
 #include <golos/plugins/operation_history/history_object.hpp>
 #include <golos/plugins/json_rpc/api_helper.hpp>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <map>
 #include <queue>
 
 #define ACCOUNT_HISTORY_MAX_LIMIT 10000
 #define ACCOUNT_HISTORY_DEFAULT_LIMIT 100
+#define ACCOUNT_HISTORY_MAX_SCANNED_OPERATIONS 100000
 #define GOLOS_OP_NAMESPACE "golos::protocol::"
 
 
@@ -44,69 +49,173 @@ if (options.count(name)) { \
         }
     };
 
-    struct operation_visitor final {
-        operation_visitor(
-            golos::chain::database& db,
-            const golos::chain::operation_notification& op_note,
-            std::string op_account,
-            operation_direction dir)
-            : db(db),
-              note(op_note),
-              account(op_account),
-              dir(dir) {
+    /**
+     * Operation of the account, which waits for the end of block to be added to the history
+     */
+    struct account_operation final {
+        account_name_type account;
+        uint32_t block = 0;
+        operation_direction dir = operation_direction::any;
+        uint8_t op_tag = 0;
+        operation_id_type op;
+    };
+
+    struct plugin::plugin_impl final {
+    public:
+        plugin_impl(): db(appbase::app().get_plugin<chain::plugin>().db()) {
         }
 
-        using result_type = void;
+        ~plugin_impl() = default;
 
-        golos::chain::database& db;
-        const golos::chain::operation_notification& note;
-        std::string account;
-        operation_direction dir;
+        void erase_old_blocks() {
+            pruner.start();
+            pruner.remove_objects<account_history_index, by_location>(db, &account_history_object::block);
+        }
 
-        template<typename Op>
-        void operator()(Op &&) const {
-            const auto& idx = db.get_index<account_history_index>().indices().get<by_account>();
+        void on_pre_apply_block(const signed_block& block) {
+            block_ops.clear();
+            is_applying_block = true;
+        }
+
+        void on_applied_block(const signed_block& block) {
+            flush_block_operations();
+            is_applying_block = false;
+        }
 
+        void flush_block_operations() {
+            if (!block_ops.empty()) {
+                append_operations(block_ops);
+                block_ops.clear();
+            }
+        }
+
+        struct account_sequence final {
+            uint32_t next = 0;
+            const account_history_head_object* head = nullptr;
+        };
+
+        account_sequence get_next_sequence(const account_name_type& account) const {
+            account_sequence result;
+
+            const auto& head_idx = db.get_index<account_history_head_index>().indices().get<by_account>();
+            auto head = head_idx.find(account);
+            if (head != head_idx.end()) {
+                result.next = head->sequence + 1;
+                result.head = &(*head);
+                return result;
+            }
+
+            // the state can be created before heads of accounts
+            const auto& idx = db.get_index<account_history_index>().indices().get<by_account>();
             auto itr = idx.lower_bound(std::make_tuple(account, uint32_t(-1)));
-            uint32_t sequence = 0;
             if (itr != idx.end() && itr->account == account) {
-                sequence = itr->sequence + 1;
+                result.next = itr->sequence + 1;
+            } else if (store) {
+                result.next = store->next_sequence(account);
             }
-
-            db.create<account_history_object>([&](account_history_object& history) {
-                history.block = note.block;
-                history.account = account;
-                history.sequence = sequence;
-                history.dir = dir;
-                history.op_tag = note.op.which();
-                history.op = operation_history::operation_id_type(note.db_id);
-            });
+            return result;
         }
-    };
 
-    struct plugin::plugin_impl final {
-    public:
-        plugin_impl(): db(appbase::app().get_plugin<chain::plugin>().db()) {
+        /**
+         * Add operations to the history, the last sequence of each account is read and updated only once
+         */
+        void append_operations(const std::vector<account_operation>& ops) {
+            std::map<account_name_type, account_sequence> sequences;
+            for (const auto& op: ops) {
+                auto itr = sequences.find(op.account);
+                if (itr == sequences.end()) {
+                    itr = sequences.emplace(op.account, get_next_sequence(op.account)).first;
+                }
+
+                db.create<account_history_object>([&](account_history_object& history) {
+                    history.block = op.block;
+                    history.account = op.account;
+                    history.sequence = itr->second.next;
+                    history.dir = op.dir;
+                    history.op_tag = op.op_tag;
+                    history.op = op.op;
+                });
+                ++itr->second.next;
+            }
+
+            for (const auto& s: sequences) {
+                if (s.second.head) {
+                    db.modify(*s.second.head, [&](account_history_head_object& head) {
+                        head.sequence = s.second.next - 1;
+                    });
+                } else {
+                    db.create<account_history_head_object>([&](account_history_head_object& head) {
+                        head.account = s.first;
+                        head.sequence = s.second.next - 1;
+                    });
+                }
+            }
         }
 
-        ~plugin_impl() = default;
+        /**
+         * Move account operations of the block, which operations were moved to the operation history store
+         */
+        void on_block_stored(uint32_t block_num, const operation_history::operation_positions& positions) {
+            check_store();
 
-        void erase_old_blocks() {
-            uint32_t head_block = db.head_block_num();
-            if (history_blocks <= head_block) {
-                uint32_t need_block = head_block - history_blocks;
-                const auto& idx = db.get_index<account_history_index>().indices().get<by_location>();
-                auto it = idx.begin();
-                while (it != idx.end() && it->block <= need_block) {
-                    auto next_it = it;
-                    ++next_it;
-                    db.remove(*it);
-                    it = next_it;
+            // the handler of operation history is called before the applied_block handler of this plugin
+            flush_block_operations();
+
+            const auto& idx = db.get_index<account_history_index>().indices().get<by_location>();
+            auto range = idx.equal_range(block_num);
+
+            // objects with equal blocks are kept in order of creation, so sequences of accounts go in a row
+            std::vector<stored_account_operation> ops;
+            for (auto itr = range.first; itr != range.second; ++itr) {
+                auto pos = positions.find(itr->op);
+                if (pos == positions.end()) {
+                    continue;
                 }
+                ops.emplace_back();
+                auto& op = ops.back();
+                op.account = itr->account;
+                op.block = itr->block;
+                op.sequence = itr->sequence;
+                op.op_tag = itr->op_tag;
+                op.dir = itr->dir;
+                op.op = pos->second;
+            }
+            store->append_block(block_num, std::move(ops));
+
+            for (auto itr = range.first; itr != range.second;) {
+                const auto& op = *itr;
+                ++itr;
+                db.remove(op);
+            }
+        }
+
+        /**
+         * Cut the store to the operation history store, which is cut to the state on the first operation
+         *   (its handler is called before this one)
+         */
+        void check_store() {
+            if (store && !is_store_checked) {
+                store->truncate(op_store->head_block_num() + 1);
+                is_store_checked = true;
+            }
+        }
+
+        /**
+         * Remove objects of stored blocks, they return to the state if the head block was popped
+         */
+        void remove_stored_blocks() {
+            const auto head_block_num = op_store->head_block_num();
+            const auto& idx = db.get_index<account_history_index>().indices().get<by_location>();
+            for (auto itr = idx.begin(); itr != idx.end() && itr->block <= head_block_num;) {
+                const auto& op = *itr;
+                ++itr;
+                db.remove(op);
             }
         }
 
         void on_operation(const golos::chain::operation_notification& note) {
+            check_store();
+
             if (!note.stored_in_db) {
                 return;
             }
@@ -114,14 +223,33 @@ if (options.count(name)) { \
             impacted_accounts impacted;
             operation_get_impacted_accounts(note.op, impacted);
 
+            std::vector<account_operation> ops;
             for (const auto& item : impacted) {
                 auto itr = tracked_accounts.lower_bound(item.first);
                 if (!tracked_accounts.size() ||
                     (itr != tracked_accounts.end() && itr->first <= item.first && item.first <= itr->second)
                 ) {
-                    note.op.visit(operation_visitor(db, note, item.first, item.second));
+                    ops.emplace_back();
+                    auto& op = ops.back();
+                    op.account = item.first;
+                    op.block = note.block;
+                    op.dir = item.second;
+                    op.op_tag = note.op.which();
+                    op.op = operation_id_type(note.db_id);
                 }
             }
+
+            // operations of the block are added at its end, operations of pending transactions are added at once;
+            //   the flag stays set if applying of the block failed, but the database resets its own one
+            if (is_applying_block && !db.is_applying_block()) {
+                is_applying_block = false;
+                block_ops.clear();
+            }
+            if (is_applying_block) {
+                block_ops.insert(block_ops.end(), ops.begin(), ops.end());
+            } else if (!ops.empty()) {
+                append_operations(ops);
+            }
         }
 
         ///////////////////////////////////////////////////////
@@ -130,10 +258,37 @@ if (options.count(name)) { \
             history_operations result;
             const auto& idx = db.get_index<account_history_index>().indices().get<by_account>();
             auto itr = idx.lower_bound(std::make_tuple(account, from));
-            auto end = idx.upper_bound(std::make_tuple(account, std::max(int64_t(0), int64_t(itr->sequence) - limit)));
+            if (store && (itr == idx.end() || itr->account != account)) {
+                // all operations of the account before from are irreversible
+                int64_t bottom = -1;
+                store->visit(account, from, [&](const stored_account_operation& op) {
+                    if (bottom < 0) {
+                        bottom = std::max(int64_t(0), int64_t(op.sequence) - limit);
+                    }
+                    if (op.sequence < bottom) {
+                        return false;
+                    }
+                    result[op.sequence] = op_store->get_operation(op.op);
+                    return true;
+                });
+                return result;
+            }
+
+            const auto bottom = std::max(int64_t(0), int64_t(itr->sequence) - limit);
+            auto end = idx.upper_bound(std::make_tuple(account, bottom));
             for (; itr != end; ++itr) {
                 result[itr->sequence] = db.get(itr->op);
             }
+
+            if (store && !result.empty() && result.begin()->first > bottom) {
+                store->visit(account, result.begin()->first - 1, [&](const stored_account_operation& op) {
+                    if (op.sequence < bottom) {
+                        return false;
+                    }
+                    result[op.sequence] = op_store->get_operation(op.op);
+                    return true;
+                });
+            }
             return result;
         }
 
@@ -235,6 +390,20 @@ if (options.count(name)) { \
                 if (next.itr != end && next.itr->op_tag == o && next.itr->dir == d)
                     itrs.push(next);
             }
+
+            // irreversible operations have lower sequences, the store has no index by operations, so they are scanned,
+            //   but not more than the fixed number of operations to bound the time of the query
+            if (store && result.size() <= limit) {
+                uint32_t scanned = 0;
+                store->visit(account, from, [&](const stored_account_operation& op) {
+                    if (select_ops.count(op.op_tag) &&
+                        (dir == operation_direction::any || op.dir == dir || op.dir == operation_direction::dual)
+                    ) {
+                        result[op.sequence] = op_store->get_operation(op.op);
+                    }
+                    return result.size() <= limit && ++scanned < ACCOUNT_HISTORY_MAX_SCANNED_OPERATIONS;
+                });
+            }
             return result;
         }
 
@@ -242,7 +411,12 @@ if (options.count(name)) { \
         fc::flat_map<std::string, op_tag_type> op_name2tag;
         fc::flat_map<std::string, std::string> tracked_accounts;
         golos::chain::database& db;
-        uint32_t history_blocks = UINT32_MAX;
+        golos::chain::block_pruner pruner;
+        std::unique_ptr<account_history_store> store;
+        const operation_history::history_store* op_store = nullptr;
+        bool is_store_checked = false;
+        std::vector<account_operation> block_ops;
+        bool is_applying_block = false;
     };
 
     DEFINE_API(plugin, get_account_history) {
@@ -539,16 +713,24 @@ if (options.count(name)) { \
         ilog("account_history plugin: plugin_initialize() begin");
         pimpl = std::make_unique<plugin_impl>();
 
+        pimpl->db.pre_apply_block.connect([&](const signed_block& block) {
+            pimpl->on_pre_apply_block(block);
+        });
+        pimpl->db.applied_block.connect([&](const signed_block& block) {
+            pimpl->on_applied_block(block);
+        });
+
+        // options are declared by the operation_history plugin
         if (options.count("history-blocks")) {
-            uint32_t history_blocks = options.at("history-blocks").as<uint32_t>();
-            pimpl->history_blocks = history_blocks;
+            pimpl->pruner = golos::chain::block_pruner(
+                options.at("history-blocks").as<uint32_t>(),
+                options.at("history-prune-bucket-size").as<uint32_t>(),
+                fc::milliseconds(options.at("history-prune-budget-ms").as<uint32_t>()));
             pimpl->db.applied_block.connect([&](const signed_block& block){
                 pimpl->erase_old_blocks();
             });
-        } else {
-            pimpl->history_blocks = UINT32_MAX;
         }
-        ilog("account_history: history-blocks ${s}", ("s", pimpl->history_blocks));
+        ilog("account_history: history-blocks ${s}", ("s", pimpl->pruner.depth));
 
         // this is worked, because the appbase initialize required plugins at first
         pimpl->db.pre_apply_operation.connect([&](operation_notification& note) {
@@ -556,6 +738,25 @@ if (options.count(name)) { \
         });
 
         add_plugin_index<account_history_index>(pimpl->db);
+        add_plugin_index<account_history_head_index>(pimpl->db);
+
+        auto& op_history = appbase::app().get_plugin<operation_history::plugin>();
+        if (op_history.store()) {
+            auto dir = options.at("history-store-dir").as<boost::filesystem::path>();
+            if (dir.is_relative()) {
+                dir = appbase::app().data_dir() / dir;
+            }
+            pimpl->op_store = op_history.store();
+            pimpl->store = std::make_unique<account_history_store>();
+            pimpl->store->open(dir);
+
+            op_history.on_block_stored.connect([&](uint32_t block_num, const operation_history::operation_positions& positions) {
+                pimpl->on_block_stored(block_num, positions);
+            });
+            pimpl->db.applied_block.connect([&](const signed_block& block) {
+                pimpl->remove_stored_blocks();
+            });
+        }
 
         using pairstring = std::pair<std::string, std::string>;
         fc::flat_map<std::string, std::string> ranges;
@@ -621,6 +822,9 @@ if (options.count(name)) { \
     }
 
     void plugin::plugin_shutdown() {
+        if (pimpl->store) {
+            pimpl->store->close();
+        }
     }
 
     fc::flat_map<std::string, std::string> plugin::tracked_accounts() const {
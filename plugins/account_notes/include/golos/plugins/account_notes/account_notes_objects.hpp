@@ -102,3 +102,9 @@ CHAINBASE_SET_INDEX_TYPE(
 CHAINBASE_SET_INDEX_TYPE(
     golos::plugins::account_notes::account_note_stats_object,
     golos::plugins::account_notes::account_note_stats_index)
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::account_notes::account_note_object,
+    (id)(account)(key)(value))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::account_notes::account_note_stats_object,
+    (id)(account)(note_count))
@@ -0,0 +1,226 @@
+#include <golos/plugins/block_info/block_info_store.hpp>
+#include <golos/protocol/config.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <thread>
+
+namespace golos {
+namespace plugins {
+namespace block_info {
+
+namespace detail {
+    using read_write_mutex = boost::shared_mutex;
+    using read_lock = boost::shared_lock<read_write_mutex>;
+    using write_lock = boost::unique_lock<read_write_mutex>;
+
+    /// The file grows by this number of records to not remap it on each block
+    constexpr uint32_t records_per_growth = 64 * 1024;
+
+    constexpr auto record_size = block_info_store::record_size;
+
+    class block_info_store_impl final {
+    public:
+        void open(const fc::path& file) {
+            close();
+
+            path = file.string();
+            boost::filesystem::create_directories(boost::filesystem::path(path).parent_path());
+            if (!boost::filesystem::exists(path)) {
+                std::ofstream(path, std::ios::out|std::ios::binary);
+            }
+
+            // the empty file can't be mapped
+            const auto min_size = uint64_t(records_per_growth) * record_size;
+            if (boost::filesystem::file_size(path) < min_size) {
+                boost::filesystem::resize_file(path, min_size);
+            }
+            mapped_file.open(path, boost::iostreams::mapped_file::readwrite);
+        }
+
+        void close() {
+            mapped_file.close();
+            path.clear();
+        }
+
+        bool is_open() const {
+            return mapped_file.is_open();
+        }
+
+        uint32_t capacity() const {
+            return mapped_file.is_open() ? mapped_file.size() / record_size : 0;
+        }
+
+        void reserve(uint32_t block_num) {
+            if (block_num <= capacity()) {
+                return;
+            }
+            const auto count = (block_num / records_per_growth + 1) * uint64_t(records_per_growth);
+            mapped_file.resize(count * record_size);
+        }
+
+        void put(uint32_t block_num, const block_info& info) {
+            FC_ASSERT(block_num > 0, "Block number should be greater than 0");
+            reserve(block_num);
+            put_record(block_num, info);
+        }
+
+        void truncate(uint32_t last_block_num) {
+            const auto count = (last_block_num / records_per_growth + 1) * uint64_t(records_per_growth);
+            if (count < capacity()) {
+                mapped_file.resize(count * record_size);
+            }
+            if (last_block_num < capacity()) {
+                std::memset(mapped_file.data() + uint64_t(last_block_num) * record_size, 0,
+                    uint64_t(capacity() - last_block_num) * record_size);
+            }
+        }
+
+        block_info get(uint32_t block_num) const {
+            block_info info;
+            if (block_num == 0 || block_num > capacity()) {
+                return info;
+            }
+            fc::datastream<const char*> ds(mapped_file.const_data() + uint64_t(block_num - 1) * record_size, record_size);
+            fc::raw::unpack(ds, info);
+            return info;
+        }
+
+        void rebuild(const golos::chain::block_log& log, uint32_t threads) {
+            const auto& head = log.head();
+            if (!head.valid()) {
+                return;
+            }
+
+            const auto last = head->block_num();
+            reserve(last);
+
+            for (uint32_t first = 1; first <= last;) {
+                if (get(first).block_size != 0) {
+                    ++first;
+                    continue;
+                }
+                auto end = first + 1;
+                for (; end <= last && get(end).block_size == 0; ++end) {
+                }
+
+                ilog("Rebuilding block info from block ${f} to ${l}", ("f", first)("l", end - 1));
+                rebuild_range(log, first, end, threads);
+                first = end;
+            }
+        }
+
+    private:
+        void put_record(uint32_t block_num, const block_info& info) {
+            auto* ptr = mapped_file.data() + uint64_t(block_num - 1) * record_size;
+            std::memset(ptr, 0, record_size);
+            fc::datastream<char*> ds(ptr, record_size);
+            fc::raw::pack(ds, info);
+        }
+
+        void rebuild_range(const golos::chain::block_log& log, uint32_t first, uint32_t end, uint32_t threads) {
+            threads = std::max<uint32_t>(1, std::min(threads, end - first));
+
+            // records are independent, so each thread fills its own blocks
+            std::vector<std::exception_ptr> errors(threads);
+            std::vector<std::thread> pool;
+            pool.reserve(threads);
+            for (uint32_t t = 0; t < threads; ++t) {
+                pool.emplace_back([&, t]() {
+                    try {
+                        for (auto block_num = first + t; block_num < end; block_num += threads) {
+                            log.read_serialized_block(block_num, [&](const char* data, std::size_t size) {
+                                fc::datastream<const char*> ds(data, size);
+                                golos::protocol::signed_block_header header;
+                                fc::raw::unpack(ds, header);
+
+                                block_info info;
+                                info.block_id = header.id();
+                                info.block_size = size;
+                                info.aslot = (header.timestamp - STEEMIT_GENESIS_TIME).to_seconds() / STEEMIT_BLOCK_INTERVAL;
+                                put_record(block_num, info);
+                            });
+                        }
+                    } catch (...) {
+                        errors[t] = std::current_exception();
+                    }
+                });
+            }
+            for (auto& thread: pool) {
+                thread.join();
+            }
+            for (const auto& error: errors) {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+
+            // the average size depends on sizes of all previous blocks
+            uint32_t average_block_size = get(first - 1).average_block_size;
+            for (auto block_num = first; block_num < end; ++block_num) {
+                auto info = get(block_num);
+                average_block_size = (99 * average_block_size + info.block_size) / 100;
+                info.average_block_size = average_block_size;
+                put_record(block_num, info);
+            }
+        }
+
+        std::string path;
+        boost::iostreams::mapped_file mapped_file;
+
+    public:
+        mutable read_write_mutex mutex;
+    };
+} // detail
+
+block_info_store::block_info_store()
+    : my(std::make_unique<detail::block_info_store_impl>()) {
+}
+
+block_info_store::~block_info_store() = default;
+
+void block_info_store::open(const fc::path& file) { try {
+    detail::write_lock lock(my->mutex);
+    my->open(file);
+} FC_LOG_AND_RETHROW() }
+
+void block_info_store::close() {
+    detail::write_lock lock(my->mutex);
+    my->close();
+}
+
+bool block_info_store::is_open() const {
+    detail::read_lock lock(my->mutex);
+    return my->is_open();
+}
+
+void block_info_store::put(uint32_t block_num, const block_info& info) {
+    detail::write_lock lock(my->mutex);
+    my->put(block_num, info);
+}
+
+block_info block_info_store::get(uint32_t block_num) const {
+    detail::read_lock lock(my->mutex);
+    return my->get(block_num);
+}
+
+void block_info_store::truncate(uint32_t last_block_num) {
+    detail::write_lock lock(my->mutex);
+    my->truncate(last_block_num);
+}
+
+void block_info_store::rebuild(const golos::chain::block_log& log, uint32_t threads) { try {
+    detail::write_lock lock(my->mutex);
+    my->rebuild(log, threads);
+} FC_LOG_AND_RETHROW() }
+
+} } } // golos::plugins::block_info
@@ -11,8 +11,10 @@ struct block_info {
     uint32_t block_size = 0;
     uint32_t average_block_size = 0;
     uint64_t aslot = 0;
-    uint32_t last_irreversible_block_num = 0;
-    uint32_t num_pow_witnesses = 0;
+
+    /// Values of the chain state are unknown for blocks, which were rebuilt from the block log
+    fc::optional<uint32_t> last_irreversible_block_num;
+    fc::optional<uint32_t> num_pow_witnesses;
 };
 
 struct block_with_info {
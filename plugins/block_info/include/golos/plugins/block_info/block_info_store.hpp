@@ -0,0 +1,54 @@
+#pragma once
+
+#include <golos/plugins/block_info/block_info.hpp>
+#include <golos/chain/block_log.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <memory>
+
+namespace golos {
+namespace plugins {
+namespace block_info {
+
+namespace detail { class block_info_store_impl; }
+
+/**
+ * Memory-mapped file of block infos with fixed-size records, the record of the block N is at (N - 1) * record_size,
+ *   so any range of blocks is read in O(1). Blocks without info have empty records.
+ */
+class block_info_store final {
+public:
+    static constexpr std::size_t record_size = 48;
+
+    block_info_store();
+
+    ~block_info_store();
+
+    void open(const fc::path& file);
+
+    void close();
+
+    bool is_open() const;
+
+    void put(uint32_t block_num, const block_info& info);
+
+    block_info get(uint32_t block_num) const;
+
+    /**
+     * Remove records of blocks after the given one, e.g. the block log and the chain state were wiped on resync.
+     */
+    void truncate(uint32_t last_block_num);
+
+    /**
+     * Fill infos of blocks of the block log, which have no records (e.g. the plugin was disabled before).
+     * Ids and sizes are read in several threads, average block sizes and absolute slots are calculated from them.
+     * The last irreversible block and the number of POW witnesses depend on the chain state, they are left unknown.
+     */
+    void rebuild(const golos::chain::block_log& log, uint32_t threads);
+
+private:
+    std::unique_ptr<detail::block_info_store_impl> my;
+};
+
+} } } // golos::plugins::block_info
@@ -45,8 +45,7 @@ public:
 
     ~plugin();
 
-    void set_program_options(boost::program_options::options_description &cli, boost::program_options::options_description &cfg) override {
-    }
+    void set_program_options(boost::program_options::options_description &cli, boost::program_options::options_description &cfg) override;
 
     void plugin_initialize(const boost::program_options::variables_map &options) override;
 
@@ -1,6 +1,7 @@
 #include <golos/chain/database.hpp>
 
 #include <golos/plugins/block_info/plugin.hpp>
+#include <golos/plugins/block_info/block_info_store.hpp>
 
 #include <golos/protocol/types.hpp>
 #include <golos/protocol/exceptions.hpp>
@@ -9,6 +10,8 @@
 #include <golos/plugins/json_rpc/plugin.hpp>
 #include <golos/plugins/json_rpc/api_helper.hpp>
 
+#include <thread>
+
 namespace golos {
 namespace plugins {
 namespace block_info {
@@ -37,8 +40,9 @@ public:
     }
 // protected:
     boost::signals2::scoped_connection applied_block_conn_;
+    block_info_store store_;
+    uint32_t rebuild_threads_ = 0;
 private:
-    std::vector<block_info> block_info_;
 
     golos::chain::database & db_;
 };
@@ -48,12 +52,12 @@ std::vector<block_info> plugin::plugin_impl::get_block_info(uint32_t start_block
 
     GOLOS_CHECK_PARAM(start_block_num, GOLOS_CHECK_VALUE_GT(start_block_num, 0));
     GOLOS_CHECK_LIMIT_PARAM(count, 10000);
-    uint32_t n = std::min(uint32_t(block_info_.size()),
+    uint32_t n = std::min(database().head_block_num() + 1,
     start_block_num + count);
 
     for (uint32_t block_num = start_block_num;
         block_num < n; block_num++) {
-        result.emplace_back(block_info_[block_num]);
+        result.emplace_back(store_.get(block_num));
     }
 
     return result;
@@ -66,13 +70,14 @@ std::vector<block_with_info> plugin::plugin_impl::get_blocks_with_info(
 
     GOLOS_CHECK_PARAM(start_block_num, GOLOS_CHECK_VALUE_GT(start_block_num, 0));
     GOLOS_CHECK_LIMIT_PARAM(count, 10000);
-    uint32_t n = std::min( uint32_t( block_info_.size() ), start_block_num + count );
+    uint32_t n = std::min( db.head_block_num() + 1, start_block_num + count );
 
     uint64_t total_size = 0;
     for (uint32_t block_num = start_block_num;
          block_num < n; block_num++) {
+        auto info = store_.get(block_num);
         uint64_t new_size =
-                total_size + block_info_[block_num].block_size;
+                total_size + info.block_size;
         if ((new_size > 8 * 1024 * 1024) &&
             (block_num != start_block_num)) {
                 break;
@@ -80,7 +85,7 @@ std::vector<block_with_info> plugin::plugin_impl::get_blocks_with_info(
         total_size = new_size;
         result.emplace_back();
         result.back().block = *db.fetch_block_by_number(block_num);
-        result.back().info = block_info_[block_num];
+        result.back().info = info;
     }
 
     return result;
@@ -90,11 +95,7 @@ void plugin::plugin_impl::on_applied_block(const protocol::signed_block &b) {
     uint32_t block_num = b.block_num();
     const auto &db = appbase::app().get_plugin<chain::plugin>().db();
 
-    while (block_num >= block_info_.size()) {
-        block_info_.emplace_back();
-    }
-
-    block_info &info = block_info_[block_num];
+    block_info info;
     const dynamic_global_property_object &dgpo = db.get_dynamic_global_properties();
 
     info.block_id = b.id();
@@ -103,7 +104,9 @@ void plugin::plugin_impl::on_applied_block(const protocol::signed_block &b) {
     info.aslot = dgpo.current_aslot;
     info.last_irreversible_block_num = dgpo.last_irreversible_block_num;
     info.num_pow_witnesses = dgpo.num_pow_witnesses;
-    return;
+
+    // the block of the switched fork is overwritten
+    store_.put(block_num, info);
 }
 
 DEFINE_API ( plugin, get_block_info ) {
@@ -139,12 +142,36 @@ plugin::plugin() {
 plugin::~plugin() {
 }
 
+void plugin::set_program_options(
+    boost::program_options::options_description &cli,
+    boost::program_options::options_description &cfg
+) {
+    cfg.add_options() (
+        "block-info-rebuild-threads", boost::program_options::value<uint32_t>()->default_value(0),
+        "number of threads to fill the block info of blocks from the block log, which were applied without "
+        "this plugin. 0 - number of CPU cores"
+    );
+}
+
 void plugin::plugin_initialize(const boost::program_options::variables_map &options) {
 
-    auto &db = appbase::app().get_plugin<chain::plugin>().db();
+    auto &chain_plugin = appbase::app().get_plugin<chain::plugin>();
+    auto &db = chain_plugin.db();
+
+    // the store is written and truncated on startup, it can be used only by the node, which applies blocks
+    GOLOS_ASSERT(!chain_plugin.is_read_only(), golos::unsupported_operation,
+        "block_info plugin can't be used in read-only mode");
 
     my.reset(new plugin_impl);
 
+    my->rebuild_threads_ = options.at("block-info-rebuild-threads").as<uint32_t>();
+    if (!my->rebuild_threads_) {
+        my->rebuild_threads_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // info is kept next to the block log and survives restarts
+    my->store_.open(appbase::app().data_dir() / "blockchain" / "block_info.index");
+
     my->applied_block_conn_ = db.applied_block.connect([this](const protocol::signed_block &b) {
         on_applied_block(b);
     });
@@ -153,9 +180,15 @@ void plugin::plugin_initialize(const boost::program_options::variables_map &opti
 }
 
 void plugin::plugin_startup() {
+    // the block log is opened on startup of the chain plugin, it and the state can be wiped there (on resync),
+    //   so records of blocks after the head are removed, and then they are filled from the block log
+    auto& db = my->database();
+    my->store_.truncate(db.head_block_num());
+    my->store_.rebuild(db.get_block_log(), my->rebuild_threads_);
 }
 
 void plugin::plugin_shutdown() {
+    my->store_.close();
 }
 
 } } } // golos::plugin::block_info
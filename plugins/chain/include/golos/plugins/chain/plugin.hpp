@@ -5,6 +5,7 @@
 #include <golos/protocol/types.hpp>
 #include <golos/protocol/block.hpp>
 #include <golos/chain/database.hpp>
+#include <golos/chain/block_notification_bus.hpp>
 #include <golos/plugins/json_rpc/plugin.hpp>
 
 #include <boost/signals2.hpp>
@@ -41,6 +42,11 @@ namespace golos { namespace plugins { namespace chain {
 
                 bool accept_block(const protocol::signed_block &block, bool currently_syncing = false, uint32_t skip = 0);
 
+                /**
+                 * Start stateless validation of the block, which will be passed to accept_block() later
+                 */
+                void prefetch_block(const protocol::signed_block &block, const protocol::block_id_type &block_id, uint32_t skip = 0);
+
                 void accept_transaction(const protocol::signed_transaction &trx);
 
                 bool block_is_on_preferred_chain(const protocol::block_id_type &block_id);
@@ -83,6 +89,17 @@ namespace golos { namespace plugins { namespace chain {
 
                 const golos::chain::database &db() const;
 
+                /**
+                 * Stream of irreversible blocks with their operations for plugins, which don't need the chain state
+                 */
+                golos::chain::block_notification_bus &notification_bus();
+
+                /**
+                 * Shared memory is opened in read-only mode, it's updated by another node,
+                 *   and this node only serves API requests
+                 */
+                bool is_read_only() const;
+
                 // Emitted when the blockchain is syncing/live.
                 // This is to synchronize plugins that have the chain plugin as an optional dependency.
                 boost::signals2::signal<void()> on_sync;
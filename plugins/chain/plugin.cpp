@@ -2,6 +2,7 @@
 #include <golos/chain/database_exceptions.hpp>
 #include <golos/chain/comment_object.hpp>
 #include <golos/protocol/protocol.hpp>
+#include <golos/protocol/recovered_keys_cache.hpp>
 #include <golos/protocol/types.hpp>
 
 #include <fc/io/json.hpp>
@@ -9,6 +10,8 @@
 
 #include <iostream>
 #include <future>
+#include <mutex>
+#include <thread>
 
 namespace golos { namespace plugins { namespace chain {
 
@@ -26,6 +29,7 @@ namespace golos { namespace plugins { namespace chain {
         bool force_replay = false;
         bool resync = false;
         bool readonly = false;
+        bfs::path read_only_block_log_dir;
         bool check_locks = false;
         bool validate_invariants = false;
 
@@ -33,6 +37,10 @@ namespace golos { namespace plugins { namespace chain {
         bfs::path serialize_state_path;
         long serialize_delay_sec = 0;
 
+        bfs::path create_snapshot_path;
+        bfs::path load_snapshot_path;
+        uint32_t snapshot_threads = 0;
+
         uint32_t flush_interval = 0;
         flat_map<uint32_t, block_id_type> loaded_checkpoints;
 
@@ -57,8 +65,21 @@ namespace golos { namespace plugins { namespace chain {
 
         golos::chain::database db;
 
+        golos::chain::block_notification_bus notification_bus{db};
+        bool async_plugin_notifications = false;
+        uint32_t plugin_notification_queue_size = 0;
+
         bool single_write_thread = false;
 
+        uint32_t block_prevalidation_threads = 0;
+
+        std::size_t recovered_keys_cache_size = 0;
+        uint64_t recovered_keys_cache_lookups = 0;
+
+        // blocks from the p2p sync backlog, which are prevalidated before they reach accept_block()
+        std::mutex prefetched_blocks_mutex;
+        std::map<protocol::block_id_type, std::future<golos::chain::prevalidated_block_ptr>> prefetched_blocks;
+
         golos::chain::database::store_metadata_modes store_account_metadata;
         std::vector<std::string> accounts_to_store_metadata;
         bool store_memo_in_savings_withdraws = true;
@@ -87,11 +108,14 @@ namespace golos { namespace plugins { namespace chain {
 
         void check_time_in_block(const protocol::signed_block& block);
         bool accept_block(const protocol::signed_block& block, bool currently_syncing, uint32_t skip);
+        void prefetch_block(const protocol::signed_block& block, const protocol::block_id_type& block_id, uint32_t skip);
+        golos::chain::prevalidated_block_ptr get_prefetched_block(const protocol::signed_block& block);
         void accept_transaction(const protocol::signed_transaction& trx);
         void wipe_db(const bfs::path& data_dir, bool wipe_block_log);
         void replay_db(const bfs::path& data_dir, bool force_replay);
 
         void on_block (const protocol::signed_block& b);
+        void log_recovered_keys_cache_stats();
         void transit_to_cyberway();
         void start_transit_to_cyberway(uint32_t, uint32_t);
     };
@@ -110,6 +134,23 @@ namespace golos { namespace plugins { namespace chain {
             ++itr;
             db.remove(vote);
         }
+
+        if (n % 10000 == 0) {
+            log_recovered_keys_cache_stats();
+        }
+    }
+
+    void plugin::impl::log_recovered_keys_cache_stats() {
+        const auto& cache = protocol::recovered_keys_cache::instance();
+        auto hits = cache.hits();
+        auto misses = cache.misses();
+        if (!cache.is_enabled() || hits + misses == recovered_keys_cache_lookups) {
+            return;
+        }
+        recovered_keys_cache_lookups = hits + misses;
+
+        ilog("Recovered keys cache: ${size} keys, ${hits} hits, ${misses} misses",
+            ("size", cache.size())("hits", hits)("misses", misses));
     }
 
     void plugin::impl::start_transit_to_cyberway(uint32_t n, uint32_t skip) {
@@ -161,6 +202,8 @@ namespace golos { namespace plugins { namespace chain {
     }
 
     bool plugin::impl::accept_block(const protocol::signed_block& block, bool currently_syncing, uint32_t skip) {
+        GOLOS_ASSERT(!readonly, golos::unsupported_operation, "Blocks can't be accepted in read-only mode");
+
         if (currently_syncing && block.block_num() % 10000 == 0) {
             ilog("Syncing Blockchain --- Got block: #${n} time: ${t} producer: ${p}",
                 ("t", block.timestamp)("n", block.block_num())("p", block.witness));
@@ -168,7 +211,16 @@ namespace golos { namespace plugins { namespace chain {
 
         check_time_in_block(block);
 
-        skip = db.validate_block(block, skip);
+        auto prevalidated = get_prefetched_block(block);
+
+        auto push_block = [&]() {
+            if (prevalidated) {
+                return db.push_block(*prevalidated, skip);
+            }
+            return db.push_block(block, skip);
+        };
+
+        skip = prevalidated ? db.validate_block(*prevalidated, skip) : db.validate_block(block, skip);
 
         if (single_write_thread) {
             std::promise<bool> promise;
@@ -176,15 +228,65 @@ namespace golos { namespace plugins { namespace chain {
 
             io_service().post([&]{
                 try {
-                    promise.set_value(db.push_block(block, skip));
+                    promise.set_value(push_block());
                 } catch (...) {
                     promise.set_exception(std::current_exception());
                 }
             });
             return result.get(); // if an exception was, it will be thrown
         } else {
-            return db.push_block(block, skip);
+            return push_block();
+        }
+    }
+
+    void plugin::impl::prefetch_block(
+        const protocol::signed_block& block, const protocol::block_id_type& block_id, uint32_t skip
+    ) {
+        auto& prevalidator = db.get_block_prevalidator();
+        if (!prevalidator.is_started()) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(prefetched_blocks_mutex);
+        if (prefetched_blocks.size() >= prevalidator.queue_depth() * 4 || prefetched_blocks.count(block_id)) {
+            return;
         }
+        prefetched_blocks.emplace(block_id, prevalidator.prevalidate(block, skip));
+    }
+
+    golos::chain::prevalidated_block_ptr plugin::impl::get_prefetched_block(const protocol::signed_block& block) {
+        std::future<golos::chain::prevalidated_block_ptr> result;
+        {
+            std::lock_guard<std::mutex> lock(prefetched_blocks_mutex);
+            if (prefetched_blocks.empty()) {
+                return {};
+            }
+
+            auto block_num = block.block_num();
+            auto block_id = block.id();
+            for (auto itr = prefetched_blocks.begin(); itr != prefetched_blocks.end();) {
+                if (itr->first == block_id) {
+                    result = std::move(itr->second);
+                    itr = prefetched_blocks.erase(itr);
+                } else if (protocol::block_header::num_from_id(itr->first) <= block_num) {
+                    // blocks from other forks, they will never be requested
+                    itr = prefetched_blocks.erase(itr);
+                } else {
+                    ++itr;
+                }
+            }
+        }
+
+        if (!result.valid()) {
+            return {};
+        }
+
+        try {
+            return result.get();
+        } catch (const fc::exception& e) {
+            wlog("Failed to prevalidate block ${n}: ${e}", ("n", block.block_num())("e", e.to_detail_string()));
+        }
+        return {};
     }
 
     void plugin::impl::wipe_db(const bfs::path& data_dir, bool wipe_block_log) {
@@ -213,6 +315,8 @@ namespace golos { namespace plugins { namespace chain {
     };
 
     void plugin::impl::accept_transaction(const protocol::signed_transaction& trx) {
+        GOLOS_ASSERT(!readonly, golos::unsupported_operation, "Transactions can't be accepted in read-only mode");
+
         uint32_t skip = db.validate_transaction(trx, db.skip_apply_transaction);
 
         if (single_write_thread) {
@@ -247,6 +351,10 @@ namespace golos { namespace plugins { namespace chain {
         return my->db;
     }
 
+    golos::chain::block_notification_bus& plugin::notification_bus() {
+        return my->notification_bus;
+    }
+
     void plugin::set_program_options(bpo::options_description& cli, bpo::options_description& cfg) {
         cfg.add_options()
             (
@@ -285,6 +393,21 @@ namespace golos { namespace plugins { namespace chain {
             ) (
                 "single-write-thread", bpo::value<bool>()->default_value(false),
                 "push blocks and transactions from one thread"
+            ) (
+                "block-prevalidation-threads", bpo::value<uint32_t>()->default_value(0),
+                "number of threads for the stateless validation of blocks (signatures recovering, merkle root, etc) "
+                "on replay and sync. 0 - validate blocks in the write thread"
+            ) (
+                "async-plugin-notifications", bpo::value<bool>()->default_value(false),
+                "pass irreversible blocks to subscribed plugins in the separate thread, "
+                "so applying of blocks doesn't wait for them"
+            ) (
+                "plugin-notification-queue-size", bpo::value<uint32_t>()->default_value(1024),
+                "max number of irreversible blocks, which wait for subscribed plugins in the asynchronous mode"
+            ) (
+                "recovered-keys-cache-size", bpo::value<uint32_t>()->default_value(100000),
+                "maximum number of public keys recovered from transaction signatures, which are cached for "
+                "the next checks of the same transactions. 0 - disable cache"
             ) (
                 "clear-votes-before-block", bpo::value<uint32_t>()->default_value(0),
                 "remove votes before defined block, should speedup initial synchronization"
@@ -311,6 +434,15 @@ namespace golos { namespace plugins { namespace chain {
             ) (
                 "store-memo-in-savings-withdraws", bpo::value<bool>()->default_value(true),
                 "store memo for all savings withdraws"
+            ) (
+                "read-only", bpo::value<bool>()->default_value(false),
+                "open the shared memory of another node in read-only mode to serve API requests. "
+                "The node reads the block log of that node and doesn't accept blocks and transactions, "
+                "the state and the block log are updated by the node, which owns the shared memory"
+            ) (
+                "read-only-block-log-dir", bpo::value<bfs::path>(),
+                "the directory of the block log of the node, which owns the shared memory, in read-only mode "
+                "(abs path or relative to application data dir). Default: shared-file-dir"
             ) (
                 "serialize-state", bpo::value<std::string>(),
                 "The location of the file to serialize state to (abs path or relative to application data dir). "
@@ -336,6 +468,16 @@ namespace golos { namespace plugins { namespace chain {
             ) (
                 "validate-database-invariants", bpo::bool_switch()->default_value(false),
                 "Validate all supply invariants check out"
+            ) (
+                "create-snapshot", bpo::value<std::string>(),
+                "Save the state snapshot to the path after opening of the chain database, the node continues to work"
+            ) (
+                "load-snapshot", bpo::value<std::string>(),
+                "Clear chain database and load the state from the snapshot instead of replaying of all blocks. "
+                "The block log should contain the head block of the snapshot"
+            ) (
+                "snapshot-threads", bpo::value<uint32_t>()->default_value(0),
+                "Number of threads to create and load the state snapshot. 0 - number of CPU cores"
             );
     }
 
@@ -375,6 +517,13 @@ namespace golos { namespace plugins { namespace chain {
 
         my->single_write_thread = options.at("single-write-thread").as<bool>();
 
+        my->async_plugin_notifications = options.at("async-plugin-notifications").as<bool>();
+        my->plugin_notification_queue_size = options.at("plugin-notification-queue-size").as<uint32_t>();
+
+        my->block_prevalidation_threads = options.at("block-prevalidation-threads").as<uint32_t>();
+
+        my->recovered_keys_cache_size = options.at("recovered-keys-cache-size").as<uint32_t>();
+
         my->enable_plugins_on_push_transaction = options.at("enable-plugins-on-push-transaction").as<bool>();
 
         my->shared_memory_size = fc::parse_size(options.at("shared-file-size").as<std::string>());
@@ -388,6 +537,19 @@ namespace golos { namespace plugins { namespace chain {
             my->block_num_check_free_size = options.at("block-num-check-free-size").as<uint32_t>();
         }
 
+        my->readonly = options.at("read-only").as<bool>();
+        if (my->readonly) {
+            FC_ASSERT(!options.at("replay-blockchain").as<bool>() && !options.at("force-replay-blockchain").as<bool>()
+                && !options.at("resync-blockchain").as<bool>() && !options.count("load-snapshot"),
+                "Chain database can't be replayed, resynced or loaded from snapshot in read-only mode");
+
+            my->read_only_block_log_dir = my->shared_memory_dir;
+            if (options.count("read-only-block-log-dir")) {
+                auto dir = options.at("read-only-block-log-dir").as<bfs::path>();
+                my->read_only_block_log_dir = dir.is_relative() ? appbase::app().data_dir() / dir : dir;
+            }
+        }
+
         my->replay = options.at("replay-blockchain").as<bool>();
         my->replay_if_corrupted = options.at("replay-if-corrupted").as<bool>();
         my->force_replay = options.at("force-replay-blockchain").as<bool>();
@@ -406,6 +568,23 @@ namespace golos { namespace plugins { namespace chain {
         }
         my->serialize_state = serialize;
 
+        auto get_path = [&](const std::string& name) {
+            bfs::path result;
+            if (options.count(name)) {
+                auto p = bfs::path(options.at(name).as<std::string>());
+                if (!p.empty()) {
+                    result = p.is_relative() ? appbase::app().data_dir() / p : p;
+                }
+            }
+            return result;
+        };
+        my->create_snapshot_path = get_path("create-snapshot");
+        my->load_snapshot_path = get_path("load-snapshot");
+        my->snapshot_threads = options.at("snapshot-threads").as<uint32_t>();
+        if (!my->snapshot_threads) {
+            my->snapshot_threads = std::thread::hardware_concurrency();
+        }
+
         if (options.count("serialize-delay-sec")) {
             my->serialize_delay_sec = options.at("serialize-delay-sec").as<long>();
         }
@@ -486,15 +665,45 @@ namespace golos { namespace plugins { namespace chain {
 
         my->db.enable_plugins_on_push_transaction(my->enable_plugins_on_push_transaction);
 
+        my->db.get_block_prevalidator().start(my->block_prevalidation_threads);
+        my->notification_bus.start(my->async_plugin_notifications, my->plugin_notification_queue_size);
+        my->db.set_state_snapshot_threads(my->snapshot_threads);
+
+        protocol::recovered_keys_cache::instance().set_max_size(my->recovered_keys_cache_size);
+
+        if (my->readonly) {
+            ilog("Opening shared memory from ${path} in read-only mode", ("path", my->shared_memory_dir.generic_string()));
+            my->db.open(my->read_only_block_log_dir, my->shared_memory_dir, STEEMIT_INIT_SUPPLY, my->shared_memory_size,
+                chainbase::database::read_only);
+
+            if (!my->create_snapshot_path.empty()) {
+                my->db.create_state_snapshot(my->create_snapshot_path);
+            }
+
+            ilog("Started in read-only mode on blockchain with ${n} blocks", ("n", my->db.head_block_num()));
+            on_sync();
+            return;
+        }
+
         try {
-            ilog("Opening shared memory from ${path}", ("path", my->shared_memory_dir.generic_string()));
-            my->db.open(data_dir, my->shared_memory_dir, STEEMIT_INIT_SUPPLY, my->shared_memory_size, chainbase::database::read_write/*, my->validate_invariants*/);
+            if (!my->load_snapshot_path.empty()) {
+                wlog("Loading of state snapshot requested: deleting shared memory");
+                my->db.wipe(data_dir, my->shared_memory_dir, false);
+                my->db.open_from_state_snapshot(data_dir, my->shared_memory_dir, my->load_snapshot_path,
+                    my->shared_memory_size, chainbase::database::read_write);
+            } else {
+                ilog("Opening shared memory from ${path}", ("path", my->shared_memory_dir.generic_string()));
+                my->db.open(data_dir, my->shared_memory_dir, STEEMIT_INIT_SUPPLY, my->shared_memory_size, chainbase::database::read_write/*, my->validate_invariants*/);
+            }
             auto head_block_log = my->db.get_block_log().head();
             my->replay |= head_block_log && my->db.revision() != head_block_log->block_num();
 
             if (my->replay) {
                 my->replay_db(data_dir, my->force_replay);
             }
+        } catch (const golos::chain::state_snapshot_exception&) {
+            // broken snapshot shouldn't lead to the replay of all blocks
+            throw;
         } catch (const golos::chain::database_revision_exception&) {
             if (my->replay_if_corrupted) {
                 wlog("Error opening database, attempting to replay blockchain.");
@@ -526,12 +735,19 @@ namespace golos { namespace plugins { namespace chain {
             }
         }
 
+        if (!my->create_snapshot_path.empty()) {
+            my->db.create_state_snapshot(my->create_snapshot_path);
+        }
+
         ilog("Started on blockchain with ${n} blocks", ("n", my->db.head_block_num()));
         on_sync();
     }
 
     void plugin::plugin_shutdown() {
         ilog("closing chain database");
+        my->db.get_block_prevalidator().stop();
+        my->notification_bus.stop();
+        my->log_recovered_keys_cache_stats();
         my->db.close();
         ilog("database closed successfully");
     }
@@ -540,10 +756,18 @@ namespace golos { namespace plugins { namespace chain {
         return my->accept_block(block, currently_syncing, skip);
     }
 
+    void plugin::prefetch_block(const protocol::signed_block& block, const protocol::block_id_type& block_id, uint32_t skip) {
+        my->prefetch_block(block, block_id, skip);
+    }
+
     void plugin::accept_transaction(const protocol::signed_transaction& trx) {
         my->accept_transaction(trx);
     }
 
+    bool plugin::is_read_only() const {
+        return my->readonly;
+    }
+
     bool plugin::block_is_on_preferred_chain(const protocol::block_id_type& block_id) {
         // If it's not known, it's not preferred.
         if (!db().is_known_block(block_id)) {
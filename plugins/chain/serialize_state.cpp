@@ -7,6 +7,7 @@
 #include "../follow/include/golos/plugins/follow/follow_objects.hpp"
 #include <boost/filesystem/fstream.hpp>
 #include <fc/crypto/sha256.hpp>
+#include <unordered_map>
 
 #define ID_T unsigned_int
 
@@ -20,7 +21,7 @@ enum str_type {
 };
 struct str_info {
     std::vector<std::string> items;
-    std::map<std::string,uint32_t> ids;     // to get id fast
+    std::unordered_map<std::string,uint32_t> ids;   // to get id fast
 };
 
 static str_type _current_str_type = other;
@@ -28,14 +29,12 @@ static str_info _stats[str_type::_size];
 static str_info _accs_stats;
 
 uint32_t put_item(str_info& info, const std::string& s) {
-    uint32_t id = info.items.size();
-    if (info.ids.count(s)) {
-        id = info.ids[s];
-    } else {
-        info.ids[s] = id;
+    // single lookup, ids are assigned in order of first occurrence, so the output stays the same
+    auto res = info.ids.emplace(s, info.items.size());
+    if (res.second) {
         info.items.push_back(s);
     }
-    return id;
+    return res.first->second;
 }
 uint32_t put_str(const std::string& s) {
     return put_item(_stats[_current_str_type], s);
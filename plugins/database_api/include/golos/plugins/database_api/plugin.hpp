@@ -96,7 +96,7 @@ struct signed_block_api_object : public signed_block {
 
 ///               API,                                    args,                return
 DEFINE_API_ARGS(get_block_header,                 msg_pack, optional<block_header>)
-DEFINE_API_ARGS(get_block,                        msg_pack, optional<signed_block>)
+DEFINE_STREAMED_API_ARGS(get_block,               msg_pack, optional<signed_block>)
 DEFINE_API_ARGS(set_block_applied_callback,       msg_pack, void_type)
 DEFINE_API_ARGS(set_pending_transaction_callback, msg_pack, void_type)
 DEFINE_API_ARGS(get_config,                       msg_pack, variant_object)
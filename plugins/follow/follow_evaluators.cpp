@@ -165,8 +165,9 @@ namespace golos {
                     const auto& feed_idx = db().get_index<feed_index>().indices().get<by_feed>();
                     const auto& comment_idx = db().get_index<feed_index>().indices().get<by_comment>();
                     const auto& idx = db().get_index<follow_index>().indices().get<by_following_follower>();
-                    
-                    for (auto itr = idx.find(o.account); itr != idx.end() && itr->following == o.account; ++itr) {
+                    auto itr = _plugin->pull_to_feeds(o.account) ? idx.end() : idx.find(o.account);
+
+                    for (; itr != idx.end() && itr->following == o.account; ++itr) {
 
                         if (itr->what & (1 << blog)) {
                             uint32_t next_id = 0;
@@ -18,7 +18,7 @@ namespace golos {
                 std::vector<std::string> reblog_by;
                 std::vector<reblog_entry> reblog_entries;
                 time_point_sec reblog_on;
-                uint32_t entry_id = 0;
+                uint64_t entry_id = 0;
             };
 
             struct comment_feed_entry {
@@ -26,7 +26,7 @@ namespace golos {
                 std::vector<std::string> reblog_by;
                 std::vector<reblog_entry> reblog_entries;
                 time_point_sec reblog_on;
-                uint32_t entry_id = 0;
+                uint64_t entry_id = 0;
             };
 
             struct blog_entry {
@@ -147,6 +147,9 @@ namespace golos {
                 account_name_type account;
                 uint32_t follower_count = 0;
                 uint32_t following_count = 0;
+
+                /// Posts or reblogs of the account weren't copied to feeds, so its blog is always merged into feeds
+                bool has_pulled_entries = false;
             };
 
             typedef object_id<follow_count_object> follow_count_id_type;
@@ -273,9 +276,27 @@ CHAINBASE_SET_INDEX_TYPE(golos::plugins::follow::blog_object, golos::plugins::fo
 FC_REFLECT((golos::plugins::follow::reputation_object), (id)(account)(reputation))
 CHAINBASE_SET_INDEX_TYPE(golos::plugins::follow::reputation_object, golos::plugins::follow::reputation_index)
 
-FC_REFLECT((golos::plugins::follow::follow_count_object), (id)(account)(follower_count)(following_count))
+FC_REFLECT((golos::plugins::follow::follow_count_object), (id)(account)(follower_count)(following_count)(has_pulled_entries))
 CHAINBASE_SET_INDEX_TYPE(golos::plugins::follow::follow_count_object, golos::plugins::follow::follow_count_index)
 
 FC_REFLECT((golos::plugins::follow::blog_author_stats_object), (id)(blogger)(guest)(count))
 CHAINBASE_SET_INDEX_TYPE(golos::plugins::follow::blog_author_stats_object,
                          golos::plugins::follow::blog_author_stats_index);
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::follow::follow_object,
+    (id)(follower)(following)(what))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::follow::feed_object,
+    (id)(account)(reblogged_by)(first_reblogged_by)(first_reblogged_on)(comment)(reblogs)(account_feed_id))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::follow::blog_object,
+    (id)(account)(comment)(reblogged_on)(blog_feed_id)(reblog_title)(reblog_body)(reblog_json_metadata))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::follow::blog_author_stats_object,
+    (id)(blogger)(guest)(count))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::follow::reputation_object,
+    (id)(account)(reputation))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::follow::follow_count_object,
+    (id)(account)(follower_count)(following_count)(has_pulled_entries))
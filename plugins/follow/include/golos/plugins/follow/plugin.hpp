@@ -79,6 +79,27 @@ namespace golos { namespace plugins { namespace follow {
 
         uint32_t max_feed_size();
 
+        /**
+         * Posts and reblogs of authors with many followers aren't copied to feeds of followers,
+         *   they are merged into feeds from blogs of authors on reading.
+         * Authors stay pulled when they have fewer followers again, to not lose their entries, which weren't copied.
+         */
+        bool is_pulled_to_feeds(const account_name_type& author);
+
+        /**
+         * Check if the new post or reblog of the author isn't copied to feeds, and remember it for the author
+         */
+        bool pull_to_feeds(const account_name_type& author);
+
+        /**
+         * Visit entries of the feed from the newest one or from the given entry id, while visitors return true.
+         * Copied entries are passed as feed objects, entries merged from blogs of pulled authors as blog objects.
+         */
+        void visit_feed(
+            const account_name_type& account, uint64_t start_entry_id,
+            const std::function<bool(const feed_object&, uint64_t)>& pushed,
+            const std::function<bool(const blog_object&, uint64_t)>& pulled);
+
         void plugin_startup() override;
 
         void plugin_shutdown() override {}
@@ -8,7 +8,9 @@
 #include <golos/chain/operation_notification.hpp>
 #include <golos/chain/account_object.hpp>
 #include <golos/chain/comment_object.hpp>
+#include <algorithm>
 #include <memory>
+#include <set>
 #include <golos/plugins/json_rpc/plugin.hpp>
 #include <golos/plugins/json_rpc/api_helper.hpp>
 #include <golos/chain/index.hpp>
@@ -175,7 +177,8 @@ namespace golos {
 
                         const auto& idx = db.get_index<follow_index>().indices().get<by_following_follower>();
                         const auto& comment_idx = db.get_index<feed_index>().indices().get<by_comment>();
-                        auto itr = idx.find(op.author);
+                        // posts of popular authors are merged into feeds on reading
+                        auto itr = _plugin.pull_to_feeds(op.author) ? idx.end() : idx.find(op.author);
 
                         const auto& feed_idx = db.get_index<feed_index>().indices().get<by_feed>();
 
@@ -346,6 +349,203 @@ namespace golos {
                     }
                 }
 
+                bool is_pulled_to_feeds(const account_name_type& author) {
+                    if (push_max_followers_ == 0) {
+                        return false;
+                    }
+                    auto itr = database().find<follow_count_object, by_account>(author);
+                    return itr != nullptr && (itr->has_pulled_entries || itr->follower_count > push_max_followers_);
+                }
+
+                bool pull_to_feeds(const account_name_type& author) {
+                    if (!is_pulled_to_feeds(author)) {
+                        return false;
+                    }
+                    auto& db = database();
+                    const auto& count = db.get<follow_count_object, by_account>(author);
+                    if (!count.has_pulled_entries) {
+                        db.modify(count, [&](follow_count_object& c) {
+                            c.has_pulled_entries = true;
+                        });
+                    }
+                    return true;
+                }
+
+                time_point_sec get_entry_time(const feed_object& feed) {
+                    if (feed.first_reblogged_by != account_name_type()) {
+                        return feed.first_reblogged_on;
+                    }
+                    return database().get(feed.comment).created;
+                }
+
+                time_point_sec get_entry_time(const blog_object& entry) {
+                    if (entry.reblogged_on != time_point_sec()) {
+                        return entry.reblogged_on;
+                    }
+                    return database().get(entry.comment).created;
+                }
+
+                /**
+                 * Visits entries of the feed from the newest one, while the visitor returns true.
+                 * The visitor gets the feed_object of the pushed entry or the blog_object of the pulled one.
+                 *
+                 * Without pulled authors entries are visited by ids in the feed.
+                 * Otherwise pushed entries are merged with blogs of followed pulled authors by time,
+                 *   and ids of entries are their times in seconds in the high half and ids of their comments
+                 *   in the low half, because many entries can have the same time.
+                 */
+                template <typename Visitor>
+                void visit_feed(account_name_type account, uint64_t entry_id, Visitor&& visitor) {
+                    const auto& db = database();
+                    const auto& feed_idx = db.get_index<feed_index>().indices().get<by_feed>();
+
+                    if (push_max_followers_ == 0) {
+                        auto start = entry_id ? uint32_t(std::min<uint64_t>(entry_id, ~uint32_t(0))) : ~uint32_t(0);
+                        auto itr = feed_idx.lower_bound(boost::make_tuple(account, start));
+                        for (; itr != feed_idx.end() && itr->account == account; ++itr) {
+                            if (!visitor(*itr, itr->account_feed_id)) {
+                                break;
+                            }
+                        }
+                        return;
+                    }
+
+                    const auto start_id = entry_id ? entry_id : ~uint64_t(0);
+                    const auto start = time_point_sec(uint32_t(std::min<uint64_t>(start_id >> 32, ~uint32_t(0))));
+
+                    auto feed_itr = feed_idx.lower_bound(account);
+                    auto is_feed_end = [&]() {
+                        return feed_itr == feed_idx.end() || feed_itr->account != account;
+                    };
+                    // ids in the feed grow with time, so the time of entries decreases
+                    for (; !is_feed_end() && get_entry_time(*feed_itr) > start; ++feed_itr) {
+                    }
+
+                    const auto& blog_idx = db.get_index<blog_index>().indices().get<by_blog>();
+                    struct pulled_blog {
+                        decltype(blog_idx.begin()) itr;
+                        time_point_sec time;
+                    };
+                    std::vector<pulled_blog> blogs;
+
+                    auto next_blog_entry = [&](pulled_blog& pulled, const account_name_type& author) {
+                        for (; pulled.itr != blog_idx.end() && pulled.itr->account == author; ++pulled.itr) {
+                            pulled.time = get_entry_time(*pulled.itr);
+                            if (pulled.time <= start) {
+                                return true;
+                            }
+                        }
+                        return false;
+                    };
+
+                    const auto& follow_idx = db.get_index<follow_index>().indices().get<by_follower_following>();
+                    for (auto itr = follow_idx.lower_bound(account); itr != follow_idx.end() && itr->follower == account; ++itr) {
+                        if ((itr->what & (1 << blog)) && is_pulled_to_feeds(itr->following)) {
+                            pulled_blog pulled{blog_idx.lower_bound(itr->following), time_point_sec()};
+                            if (next_blog_entry(pulled, itr->following)) {
+                                blogs.push_back(pulled);
+                            }
+                        }
+                    }
+
+                    const auto& feed_comment_idx = db.get_index<feed_index>().indices().get<by_comment>();
+                    std::set<comment_object::id_type> pulled_comments;
+
+                    struct feed_item {
+                        const feed_object* feed;
+                        const blog_object* blog;
+                        uint64_t id;
+                    };
+                    std::vector<feed_item> items;
+
+                    while (true) {
+                        // all entries with the same time are collected and ordered by ids of their comments
+                        auto next = std::max_element(blogs.begin(), blogs.end(), [](const auto& l, const auto& r) {
+                            return l.time < r.time;
+                        });
+                        auto time = next != blogs.end() ? next->time : time_point_sec();
+                        if (!is_feed_end()) {
+                            time = std::max(time, get_entry_time(*feed_itr));
+                        } else if (next == blogs.end()) {
+                            break;
+                        }
+                        const auto time_id = uint64_t(time.sec_since_epoch()) << 32;
+
+                        items.clear();
+                        for (; !is_feed_end() && get_entry_time(*feed_itr) == time; ++feed_itr) {
+                            items.push_back({&*feed_itr, nullptr, time_id | uint32_t(feed_itr->comment._id)});
+                        }
+                        for (auto& pulled: blogs) {
+                            const auto author = pulled.itr->account;
+                            while (pulled.time == time) {
+                                const auto& entry = *pulled.itr;
+                                // the post can be already pushed by another author, or reblogged by several pulled authors
+                                if (feed_comment_idx.find(boost::make_tuple(entry.comment, account)) == feed_comment_idx.end() &&
+                                    pulled_comments.insert(entry.comment).second
+                                ) {
+                                    items.push_back({nullptr, &entry, time_id | uint32_t(entry.comment._id)});
+                                }
+                                ++pulled.itr;
+                                if (!next_blog_entry(pulled, author)) {
+                                    pulled.time = time_point_sec();
+                                    break;
+                                }
+                            }
+                        }
+                        blogs.erase(std::remove_if(blogs.begin(), blogs.end(), [&](const auto& pulled) {
+                            return pulled.time == time_point_sec();
+                        }), blogs.end());
+
+                        std::sort(items.begin(), items.end(), [](const auto& l, const auto& r) {
+                            return l.id > r.id;
+                        });
+                        for (const auto& item: items) {
+                            if (item.id > start_id) {
+                                continue;
+                            }
+                            if (!(item.feed ? visitor(*item.feed, item.id) : visitor(*item.blog, item.id))) {
+                                return;
+                            }
+                        }
+                    }
+                }
+
+                template <typename Entry>
+                void fill_reblogs(Entry& entry, const feed_object& feed) {
+                    if (feed.first_reblogged_by == account_name_type()) {
+                        return;
+                    }
+                    const auto& blog_idx = database().get_index<blog_index>().indices().get<by_comment>();
+                    entry.reblog_by.reserve(feed.reblogged_by.size());
+                    entry.reblog_entries.reserve(feed.reblogged_by.size());
+                    for (const auto& a : feed.reblogged_by) {
+                        entry.reblog_by.push_back(a);
+                        auto blog_itr = blog_idx.find(std::make_tuple(feed.comment, a));
+                        entry.reblog_entries.emplace_back(
+                            a,
+                            to_string(blog_itr->reblog_title),
+                            to_string(blog_itr->reblog_body),
+                            to_string(blog_itr->reblog_json_metadata)
+                        );
+                    }
+                    entry.reblog_on = feed.first_reblogged_on;
+                }
+
+                template <typename Entry>
+                void fill_reblogs(Entry& entry, const blog_object& reblog) {
+                    if (reblog.reblogged_on == time_point_sec()) {
+                        return;
+                    }
+                    entry.reblog_by.push_back(reblog.account);
+                    entry.reblog_entries.emplace_back(
+                        reblog.account,
+                        to_string(reblog.reblog_title),
+                        to_string(reblog.reblog_body),
+                        to_string(reblog.reblog_json_metadata)
+                    );
+                    entry.reblog_on = reblog.reblogged_on;
+                }
+
                 std::vector<follow_api_object> get_followers(
                         account_name_type account,
                         account_name_type start,
@@ -360,7 +560,7 @@ namespace golos {
 
                 std::vector<feed_entry> get_feed_entries(
                         account_name_type account,
-                        uint32_t start_entry_id = 0,
+                        uint64_t start_entry_id = 0,
                         uint32_t limit = 500);
 
                 std::vector<blog_entry> get_blog_entries(
@@ -370,7 +570,7 @@ namespace golos {
 
                 std::vector<comment_feed_entry> get_feed(
                         account_name_type account,
-                        uint32_t start_entry_id = 0,
+                        uint64_t start_entry_id = 0,
                         uint32_t limit = 500);
 
                 std::vector<comment_blog_entry> get_blog(
@@ -393,6 +593,8 @@ namespace golos {
 
                 uint32_t max_feed_size_ = 500;
 
+                uint32_t push_max_followers_ = 0;
+
                 std::shared_ptr<generic_custom_operation_interpreter<
                         follow::follow_plugin_operation>> _custom_operation_interpreter;
 
@@ -407,7 +609,10 @@ namespace golos {
                                                     boost::program_options::options_description& cfg) {
                 cfg.add_options()
                     ("follow-max-feed-size", boost::program_options::value<uint32_t>()->default_value(500),
-                        "Set the maximum size of cached feed for an account");
+                        "Set the maximum size of cached feed for an account")
+                    ("follow-feed-push-max-followers", boost::program_options::value<uint32_t>()->default_value(0),
+                        "Posts of authors with more followers aren't copied to feeds, they are merged into feeds on reading "
+                        "(ids of feed entries become their times with ids of their posts). 0 copies posts of all authors");
             }
 
             void plugin::plugin_initialize(const boost::program_options::variables_map& options) {
@@ -435,6 +640,10 @@ namespace golos {
                         pimpl->max_feed_size_ = feed_size;
                     }
 
+                    if (options.count("follow-feed-push-max-followers")) {
+                        pimpl->push_max_followers_ = options["follow-feed-push-max-followers"].as<uint32_t>();
+                    }
+
                     JSON_RPC_REGISTER_API ( name() ) ;
                 } FC_CAPTURE_AND_RETHROW()
             }
@@ -446,6 +655,34 @@ namespace golos {
                 return pimpl->max_feed_size_;
             }
 
+            bool plugin::is_pulled_to_feeds(const account_name_type& author) {
+                return pimpl->is_pulled_to_feeds(author);
+            }
+
+            bool plugin::pull_to_feeds(const account_name_type& author) {
+                return pimpl->pull_to_feeds(author);
+            }
+
+            void plugin::visit_feed(
+                const account_name_type& account, uint64_t start_entry_id,
+                const std::function<bool(const feed_object&, uint64_t)>& pushed,
+                const std::function<bool(const blog_object&, uint64_t)>& pulled
+            ) {
+                struct visitor {
+                    const std::function<bool(const feed_object&, uint64_t)>& pushed;
+                    const std::function<bool(const blog_object&, uint64_t)>& pulled;
+
+                    bool operator()(const feed_object& feed, uint64_t id) const {
+                        return pushed(feed, id);
+                    }
+
+                    bool operator()(const blog_object& blog, uint64_t id) const {
+                        return pulled(blog, id);
+                    }
+                };
+                pimpl->visit_feed(account, start_entry_id, visitor{pushed, pulled});
+            }
+
             plugin::~plugin() {
 
             }
@@ -518,93 +755,47 @@ namespace golos {
 
             std::vector<feed_entry> plugin::impl::get_feed_entries(
                     account_name_type account,
-                    uint32_t entry_id,
+                    uint64_t entry_id,
                     uint32_t limit) {
                 GOLOS_CHECK_LIMIT_PARAM(limit, 500);
 
-                if (entry_id == 0) {
-                    entry_id = ~0;
-                }
-
                 std::vector<feed_entry> result;
                 result.reserve(limit);
 
                 const auto& db = database();
-                const auto& feed_idx = db.get_index<feed_index>().indices().get<by_feed>();
-                auto itr = feed_idx.lower_bound(boost::make_tuple(account, entry_id));
-
-                while (itr != feed_idx.end() && itr->account == account && result.size() < limit) {
-                    const auto& comment = db.get(itr->comment);
+                visit_feed(account, entry_id, [&](const auto& object, uint64_t id) {
+                    const auto& comment = db.get(object.comment);
                     feed_entry entry;
                     entry.author = comment.author;
                     entry.permlink = to_string(comment.permlink);
-                    entry.entry_id = itr->account_feed_id;
-                    if (itr->first_reblogged_by != account_name_type()) {
-                        entry.reblog_by.reserve(itr->reblogged_by.size());
-                        entry.reblog_entries.reserve(itr->reblogged_by.size());
-                        for (const auto& a : itr->reblogged_by) {
-                            entry.reblog_by.push_back(a);
-                            const auto& blog_idx = db.get_index<blog_index>().indices().get<by_comment>();
-                            auto blog_itr = blog_idx.find(std::make_tuple(itr->comment, a));
-                            entry.reblog_entries.emplace_back(
-                                a,
-                                to_string(blog_itr->reblog_title),
-                                to_string(blog_itr->reblog_body),
-                                to_string(blog_itr->reblog_json_metadata)
-                            );
-                        }
-                        entry.reblog_on = itr->first_reblogged_on;
-                    }
+                    entry.entry_id = id;
+                    fill_reblogs(entry, object);
                     result.push_back(entry);
-
-                    ++itr;
-                }
+                    return result.size() < limit;
+                });
 
                 return result;
             }
 
             std::vector<comment_feed_entry> plugin::impl::get_feed(
                     account_name_type account,
-                    uint32_t entry_id,
+                    uint64_t entry_id,
                     uint32_t limit) {
                 GOLOS_CHECK_LIMIT_PARAM(limit, 500);
 
-                if (entry_id == 0) {
-                    entry_id = ~0;
-                }
-
                 std::vector<comment_feed_entry> result;
                 result.reserve(limit);
 
                 const auto& db = database();
-                const auto& feed_idx = db.get_index<feed_index>().indices().get<by_feed>();
-                auto itr = feed_idx.lower_bound(boost::make_tuple(account, entry_id));
-
-                while (itr != feed_idx.end() && itr->account == account && result.size() < limit) {
-                    const auto& comment = db.get(itr->comment);
+                visit_feed(account, entry_id, [&](const auto& object, uint64_t id) {
+                    const auto& comment = db.get(object.comment);
                     comment_feed_entry entry;
                     entry.comment = helper->create_comment_api_object(comment);
-                    entry.entry_id = itr->account_feed_id;
-                    if (itr->first_reblogged_by != account_name_type()) {
-                        entry.reblog_by.reserve(itr->reblogged_by.size());
-                        entry.reblog_entries.reserve(itr->reblogged_by.size());
-                        for (const auto& a : itr->reblogged_by) {
-                            entry.reblog_by.push_back(a);
-                            const auto& blog_idx = db.get_index<blog_index>().indices().get<by_comment>();
-                            auto blog_itr = blog_idx.find(std::make_tuple(itr->comment, a));
-                            entry.reblog_entries.emplace_back(
-                                a,
-                                to_string(blog_itr->reblog_title),
-                                to_string(blog_itr->reblog_body),
-                                to_string(blog_itr->reblog_json_metadata)
-                            );
-                        }
-                        entry.reblog_on = itr->first_reblogged_on;
-                    }
+                    entry.entry_id = id;
+                    fill_reblogs(entry, object);
                     result.push_back(entry);
-
-                    ++itr;
-                }
+                    return result.size() < limit;
+                });
 
                 return result;
             }
@@ -779,7 +970,7 @@ namespace golos {
             DEFINE_API(plugin, get_feed_entries){
                 PLUGIN_API_VALIDATE_ARGS(
                     (account_name_type, account)
-                    (uint32_t,          entry_id)
+                    (uint64_t,          entry_id)
                     (uint32_t,          limit)
                 )
                 return pimpl->database().with_weak_read_lock([&]() {
@@ -790,7 +981,7 @@ namespace golos {
             DEFINE_API(plugin, get_feed) {
                 PLUGIN_API_VALIDATE_ARGS(
                     (account_name_type, account)
-                    (uint32_t,          entry_id)
+                    (uint64_t,          entry_id)
                     (uint32_t,          limit)
                 )
                 return pimpl->database().with_weak_read_lock([&]() {
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <golos/protocol/asset.hpp>
+#include <golos/protocol/types.hpp>
+#include <golos/protocol/version.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/optional.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/safe.hpp>
+#include <fc/variant.hpp>
+
+#include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace golos { namespace plugins { namespace json_rpc {
+
+    /**
+     * Types, which are written through fc::variant.
+     *
+     * Reflected types are written member by member, so reflected types with own to_variant()
+     *   should specialize this trait, otherwise their JSON will differ from the one of fc::json.
+     * E.g. fc::safe (share_type) is reflected with its value member, but it is written as the plain number.
+     */
+    template <typename T>
+    struct json_write_as_variant: std::integral_constant<bool,
+        !fc::reflector<T>::is_defined::value || fc::reflector<T>::is_enum::value> {
+    };
+
+    template <typename T> struct json_write_as_variant<fc::safe<T>>: std::true_type {};
+    template <> struct json_write_as_variant<golos::protocol::asset>: std::true_type {};
+    template <> struct json_write_as_variant<golos::protocol::version>: std::true_type {};
+    template <> struct json_write_as_variant<golos::protocol::hardfork_version>: std::true_type {};
+    template <> struct json_write_as_variant<golos::protocol::public_key_type>: std::true_type {};
+    template <> struct json_write_as_variant<golos::protocol::extended_public_key_type>: std::true_type {};
+    template <> struct json_write_as_variant<golos::protocol::extended_private_key_type>: std::true_type {};
+
+    /**
+     * Writes JSON of reflected types directly into the string buffer without building of the fc::variant tree.
+     *
+     * The output is the same as of fc::json::to_string(fc::variant(value)):
+     *   - integers greater than 0xffffffff are written as strings;
+     *   - optional members of objects are skipped when they are empty;
+     *   - maps are written as arrays of [key, value] pairs.
+     * Values of not reflected types (e.g. operations, assets, time points) are small,
+     *   they are written through fc::variant.
+     */
+    class json_writer final {
+    public:
+        explicit json_writer(std::size_t reserve = 4096) {
+            buffer_.reserve(reserve);
+        }
+
+        template <typename T>
+        json_writer& write(const T& value) {
+            write_value(value);
+            return *this;
+        }
+
+        const std::string& str() const {
+            return buffer_;
+        }
+
+        std::string release() {
+            return std::move(buffer_);
+        }
+
+    private:
+        template <typename T>
+        void write_value(const T& value) {
+            write_value(value, std::integral_constant<bool, json_write_as_variant<T>::value>());
+        }
+
+        template <typename T>
+        void write_value(const T& value, std::true_type /* as variant */) {
+            buffer_ += fc::json::to_string(fc::variant(value));
+        }
+
+        template <typename T>
+        void write_value(const T& value, std::false_type /* as variant */) {
+            buffer_ += '{';
+            bool first = true;
+            fc::reflector<T>::visit(member_visitor<T>(*this, value, first));
+            buffer_ += '}';
+        }
+
+        void write_value(bool value) {
+            buffer_ += value ? "true" : "false";
+        }
+
+        void write_value(int8_t value)   { write_integer(value); }
+        void write_value(int16_t value)  { write_integer(value); }
+        void write_value(int32_t value)  { write_integer(value); }
+        void write_value(int64_t value)  { write_integer(value); }
+        void write_value(uint8_t value)  { write_integer(value); }
+        void write_value(uint16_t value) { write_integer(value); }
+        void write_value(uint32_t value) { write_integer(value); }
+        void write_value(uint64_t value) { write_integer(value); }
+
+        void write_value(const std::string& value) {
+            write_string(value);
+        }
+
+        void write_value(const fc::variant& value) {
+            buffer_ += fc::json::to_string(value);
+        }
+
+        template <typename T>
+        void write_value(const fc::optional<T>& value) {
+            if (value.valid()) {
+                write_value(*value);
+            } else {
+                buffer_ += "null";
+            }
+        }
+
+        template <typename A, typename B>
+        void write_value(const std::pair<A, B>& value) {
+            buffer_ += '[';
+            write_value(value.first);
+            buffer_ += ',';
+            write_value(value.second);
+            buffer_ += ']';
+        }
+
+        // fc writes bytes as a hex string
+        void write_value(const std::vector<char>& value) {
+            buffer_ += fc::json::to_string(fc::variant(value));
+        }
+
+        template <typename T, typename... A>
+        void write_value(const std::vector<T, A...>& value) {
+            write_array(value);
+        }
+
+        template <typename T, typename... A>
+        void write_value(const std::deque<T, A...>& value) {
+            write_array(value);
+        }
+
+        template <typename T, typename... A>
+        void write_value(const std::set<T, A...>& value) {
+            write_array(value);
+        }
+
+        template <typename T, typename... A>
+        void write_value(const boost::container::flat_set<T, A...>& value) {
+            write_array(value);
+        }
+
+        template <typename K, typename V, typename... A>
+        void write_value(const std::map<K, V, A...>& value) {
+            write_array(value);
+        }
+
+        template <typename K, typename V, typename... A>
+        void write_value(const boost::container::flat_map<K, V, A...>& value) {
+            write_array(value);
+        }
+
+        template <typename Container>
+        void write_array(const Container& value) {
+            buffer_ += '[';
+            bool first = true;
+            for (const auto& item: value) {
+                if (!first) {
+                    buffer_ += ',';
+                }
+                first = false;
+                write_value(item);
+            }
+            buffer_ += ']';
+        }
+
+        template <typename T>
+        void write_integer(T value) {
+            // the same as the default formatting of fc::json
+            if (value > T(0) && uint64_t(value) > 0xffffffff) {
+                buffer_ += '"';
+                buffer_ += std::to_string(value);
+                buffer_ += '"';
+            } else {
+                buffer_ += std::to_string(value);
+            }
+        }
+
+        void write_string(const std::string& value) {
+            static const char hex[] = "0123456789abcdef";
+
+            buffer_ += '"';
+            for (const char c: value) {
+                switch (c) {
+                    case '"':  buffer_ += "\\\""; break;
+                    case '\\': buffer_ += "\\\\"; break;
+                    case '\b': buffer_ += "\\b"; break;
+                    case '\f': buffer_ += "\\f"; break;
+                    case '\n': buffer_ += "\\n"; break;
+                    case '\r': buffer_ += "\\r"; break;
+                    case '\t': buffer_ += "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            buffer_ += "\\u00";
+                            buffer_ += hex[(c >> 4) & 0xf];
+                            buffer_ += hex[c & 0xf];
+                        } else {
+                            buffer_ += c;
+                        }
+                }
+            }
+            buffer_ += '"';
+        }
+
+        template <typename Class>
+        class member_visitor final {
+        public:
+            member_visitor(json_writer& writer, const Class& value, bool& first)
+                : writer_(writer),
+                  value_(value),
+                  first_(first) {
+            }
+
+            template <typename Member, class Base, Member (Base::*member)>
+            void operator()(const char* name) const {
+                write_member(name, value_.*member);
+            }
+
+        private:
+            template <typename Member>
+            void write_member(const char* name, const fc::optional<Member>& value) const {
+                if (value.valid()) {
+                    write_member(name, *value);
+                }
+            }
+
+            template <typename Member>
+            void write_member(const char* name, const Member& value) const {
+                if (!first_) {
+                    writer_.buffer_ += ',';
+                }
+                first_ = false;
+                writer_.write_string(name);
+                writer_.buffer_ += ':';
+                writer_.write_value(value);
+            }
+
+            json_writer& writer_;
+            const Class& value_;
+            bool& first_;
+        };
+
+        std::string buffer_;
+    };
+
+} } } // golos::plugins::json_rpc
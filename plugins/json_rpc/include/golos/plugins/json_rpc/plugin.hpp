@@ -2,6 +2,7 @@
 
 #include <appbase/application.hpp>
 #include <golos/plugins/json_rpc/utility.hpp>
+#include <golos/plugins/json_rpc/json_writer.hpp>
 #include <fc/variant.hpp>
 #include <fc/io/json.hpp>
 #include <fc/reflect/variant.hpp>
@@ -114,6 +115,9 @@ namespace golos {
 
                 void call(const string &body, response_handler_type);
 
+                // Call the request, which is already parsed from JSON
+                void call(const fc::variant &request, response_handler_type);
+
             private:
                 class impl;
 
@@ -137,6 +141,19 @@ namespace golos {
                         /*api_method_signature{ fc::variant( Args() ), fc::variant( Ret() ) }*/ //);
                     }
 
+                    template<typename Plugin, typename Method, typename Args, typename Ret>
+                    void operator()(Plugin &plugin, const std::string &method_name, Method method, Args *args,
+                                    streamed_result<Ret> *ret) {
+                        _json_rpc_plugin.add_api_method(_api_name, method_name,
+                                                        [&plugin, method](msg_pack &args) -> fc::variant {
+                                                            auto result = (plugin.*method)(args);
+                                                            if (args.valid()) {
+                                                                args.raw_result(json_writer().write(result.value()).release());
+                                                            }
+                                                            return fc::variant();
+                                                        });
+                    }
+
                 private:
                     std::string _api_name;
                     json_rpc::plugin &_json_rpc_plugin;
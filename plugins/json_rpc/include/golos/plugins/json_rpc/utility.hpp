@@ -1,6 +1,7 @@
 #pragma once
 
 #include <type_traits>
+#include <utility>
 
 #include <fc/reflect/reflect.hpp>
 #include <boost/preprocessor/seq/for_each.hpp>
@@ -12,6 +13,11 @@
 typedef arg_type api_name ## _args;                         \
 typedef return_type api_name ## _return;
 
+// The result of the method is written to JSON by json_writer without building of the fc::variant
+#define DEFINE_STREAMED_API_ARGS(api_name, arg_type, return_type)  \
+typedef arg_type api_name ## _args;                                  \
+typedef golos::plugins::json_rpc::streamed_result<return_type> api_name ## _return;
+
 #define DECLARE_API_METHOD_HELPER(r, data, method) \
 BOOST_PP_CAT( method, _return ) method( BOOST_PP_CAT( method, _args )& );
 
@@ -72,6 +78,9 @@ namespace golos { namespace plugins { namespace json_rpc {
                 // Pass result to remote connection
                 void result(fc::optional<fc::variant> result);
 
+                // Set result, which is already serialized to JSON, it replaces the result passed to connection
+                void raw_result(std::string result);
+
                 void unsafe_result(fc::optional<fc::variant> result);
 
                 fc::optional<fc::variant> result() const;
@@ -123,6 +132,24 @@ namespace golos { namespace plugins { namespace json_rpc {
             struct void_type {
             };
 
+            /**
+             * Result of the method, which is declared by DEFINE_STREAMED_API_ARGS.
+             * It is the value itself for callers of the method, and the json_rpc plugin writes it directly to JSON.
+             */
+            template <typename T>
+            struct streamed_result final: public T {
+                using value_type = T;
+
+                streamed_result() = default;
+
+                streamed_result(T value): T(std::move(value)) {
+                }
+
+                const T& value() const {
+                    return *this;
+                }
+            };
+
 } } } // golos::plugins::json_rpc
 
 FC_REFLECT((golos::plugins::json_rpc::void_type),)
@@ -4,6 +4,10 @@
 #include <golos/protocol/exceptions.hpp>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <atomic>
 
 #include <fc/log/logger_config.hpp>
 #include <fc/exception/exception.hpp>
@@ -34,6 +38,8 @@ namespace golos {
                 fc::optional<fc::variant> result;
                 fc::optional<json_rpc_error> error;
                 fc::variant id;
+                // the result of a streamed method, it is written as is instead of the result
+                fc::optional<std::string> raw_result;
             };
 
             struct msg_pack::impl final {
@@ -108,6 +114,12 @@ namespace golos {
                 }
             }
 
+            void msg_pack::raw_result(std::string result) {
+                // Pimpl can absent in case if msg_pack delegated its handlers to other msg_pack (see move constructor)
+                FC_ASSERT(valid(), "The msg_pack delegated its handlers");
+                pimpl->response.raw_result = std::move(result);
+            }
+
             fc::optional<fc::variant> msg_pack::result() const {
                 // Pimpl can absent in case if msg_pack delegated its handlers to other msg_pack (see move constructor)
                 if (valid()) {
@@ -120,6 +132,7 @@ namespace golos {
                 // Pimpl can absent in case if msg_pack delegated its handlers to other msg_pack (see move constructor)
                 FC_ASSERT(valid(), "The msg_pack delegated its handlers");
                 pimpl->response.error = json_rpc_error(code, std::move(message), std::move(data));
+                pimpl->response.raw_result.reset();
                 try {
                     pimpl->handler(pimpl->response);
                 } catch (const websocketpp::exception &) {
@@ -152,6 +165,37 @@ namespace golos {
                 }
 
                 ~impl() {
+                    stop_batch_threads();
+                }
+
+                static std::string to_json(const json_rpc_response &response) {
+                    if (!response.raw_result.valid()) {
+                        return fc::json::to_string(response);
+                    }
+
+                    // the same order of members as in the reflection of json_rpc_response
+                    std::string json;
+                    json.reserve(response.raw_result->size() + 64);
+                    json += "{\"jsonrpc\":";
+                    json += fc::json::to_string(response.jsonrpc);
+                    json += ",\"result\":";
+                    json += *response.raw_result;
+                    json += ",\"id\":";
+                    json += fc::json::to_string(response.id);
+                    json += '}';
+                    return json;
+                }
+
+                static std::string to_json(const vector<json_rpc_response> &responses) {
+                    std::string json = "[";
+                    for (const auto &response: responses) {
+                        if (json.size() > 1) {
+                            json += ',';
+                        }
+                        json += to_json(response);
+                    }
+                    json += ']';
+                    return json;
                 }
 
                 void add_api_method(const string &api_name, const string &method_name,
@@ -344,12 +388,16 @@ namespace golos {
                 }
 
                 void rpc(vector<fc::variant> messages, response_handler_type response_handler) {
+                    if (batch_work && messages.size() > 1) {
+                        return parallel_rpc(std::move(messages), std::move(response_handler));
+                    }
+
                     auto responses = std::make_shared<vector<json_rpc_response>>();
 
                     responses->reserve(messages.size());
 
                     std::function<void()> next_handler = [response_handler, responses]{
-                        response_handler(fc::json::to_string(*responses.get()));
+                        response_handler(to_json(*responses.get()));
                     };
 
                     for (auto it = messages.rbegin(); messages.rend() != it; ++it) {
@@ -368,38 +416,97 @@ namespace golos {
                     next_handler();
                 }
 
+                struct batch_state final {
+                    batch_state(std::size_t size, response_handler_type handler)
+                        : responses(size),
+                          pending(size),
+                          response_handler(std::move(handler)) {
+                    }
+
+                    vector<json_rpc_response> responses;
+                    std::atomic<std::size_t> pending;
+                    response_handler_type response_handler;
+                };
+
+                // Calls of the batch are independent, so they are executed in the thread pool,
+                //   and the response is sent when the last of them completes
+                void parallel_rpc(vector<fc::variant> messages, response_handler_type response_handler) {
+                    auto batch = std::make_shared<batch_state>(messages.size(), std::move(response_handler));
+
+                    for (std::size_t i = 0; i < messages.size(); ++i) {
+                        batch_ios.post([this, batch, i, v = std::move(messages[i])]() {
+                            msg_pack msg([batch, i](json_rpc_response &response) {
+                                batch->responses[i] = response;
+                                if (--batch->pending == 0) {
+                                    batch->response_handler(to_json(batch->responses));
+                                }
+                            });
+
+                            this->rpc(v, msg);
+                        });
+                    }
+                }
+
+                void start_batch_threads(uint32_t thread_pool_size) {
+                    if (thread_pool_size == 0) {
+                        return;
+                    }
+
+                    batch_work = std::make_unique<boost::asio::io_service::work>(batch_ios);
+                    for (uint32_t i = 0; i < thread_pool_size; ++i) {
+                        batch_threads.create_thread([this]() { batch_ios.run(); });
+                    }
+                }
+
+                void stop_batch_threads() {
+                    if (!batch_work) {
+                        return;
+                    }
+
+                    // threads exit after queued calls are executed, so responses of all batches are sent
+                    batch_work.reset();
+                    batch_threads.join_all();
+                }
+
+                static void send_error(
+                    const response_handler_type &response_handler,
+                    int32_t code, const std::string& msg, fc::optional<fc::variant> d = fc::optional<fc::variant>()
+                ) {
+                    json_rpc_response response;
+                    response.error = json_rpc_error(code, msg, d);
+                    response_handler(fc::json::to_string(response));
+                }
+
                 void call(const string &message, response_handler_type response_handler) {
-                    auto send_error = [response_handler](int32_t code, const std::string& msg, fc::optional<fc::variant> d = fc::optional<fc::variant>()) {
-                        json_rpc_response response;
-                        response.error = json_rpc_error(code, msg, d);
-                        response_handler(fc::json::to_string(response));
-                    };
+                    fc::variant v;
 
                     try {
-                        fc::variant v;
+                        v = fc::json::from_string(message);
+                    } catch (const fc::exception& e) {
+                        return send_error(response_handler, JSON_RPC_PARSE_ERROR, "Invalid JSON-structure", e);
+                    }
 
-                        try {
-                            v = fc::json::from_string(message);
-                        } catch (const fc::exception& e) {
-                            return send_error(JSON_RPC_PARSE_ERROR, "Invalid JSON-structure", e);
-                        }
+                    call(v, std::move(response_handler));
+                }
 
+                void call(const fc::variant &v, response_handler_type response_handler) {
+                    try {
                         if (v.is_array()) {
                             vector<fc::variant> messages = v.as<vector<fc::variant>>();
 
                             if(messages.size() == 0) {
-                                return send_error(JSON_RPC_INVALID_REQUEST, "Array of requests must be non-empty");
+                                return send_error(response_handler, JSON_RPC_INVALID_REQUEST, "Array of requests must be non-empty");
                             }
                             rpc(messages, response_handler);
                         } else {
                             msg_pack msg([response_handler](json_rpc_response &response){
-                                    response_handler(fc::json::to_string(response));
+                                    response_handler(to_json(response));
                                     });
 
                             rpc(v, msg);
                         }
                     } catch (const fc::exception &e) {
-                        return send_error(JSON_RPC_INTERNAL_ERROR, e.to_string(), e);
+                        return send_error(response_handler, JSON_RPC_INTERNAL_ERROR, e.to_string(), e);
                     }
                 }
 
@@ -428,7 +535,12 @@ namespace golos {
                 vector<string> _methods;
                 map<string, map<string, api_method_signature> > _method_sigs;
                 uint64_t _log_rpc_calls_slower_msec = UINT64_MAX;
+                uint32_t _batch_thread_pool_size = 0;
             private:
+                boost::asio::io_service batch_ios;
+                std::unique_ptr<boost::asio::io_service::work> batch_work;
+                boost::thread_group batch_threads;
+
                 // This is a reindex which allows to get parent plugin by method
                 // unordered_map[method] -> plugin
                 // For example:
@@ -448,6 +560,9 @@ namespace golos {
                 cfg.add_options() (
                     "log-rpc-calls-slower-msec", bpo::value<uint64_t>()->default_value(UINT64_MAX),
                     "Maximal milliseconds of RPC call or dump it as too slow. If not set, do not dump"
+                ) (
+                    "rpc-batch-thread-pool-size", bpo::value<uint32_t>()->default_value(0),
+                    "Number of threads to execute calls of a batch request in parallel. If 0, calls are executed sequentially"
                 );
             }
 
@@ -456,17 +571,20 @@ namespace golos {
                 pimpl = std::make_unique<impl>();
                 pimpl->initialize();
                 pimpl->_log_rpc_calls_slower_msec = options.at("log-rpc-calls-slower-msec").as<uint64_t>();
+                pimpl->_batch_thread_pool_size = options.at("rpc-batch-thread-pool-size").as<uint32_t>();
                 ilog("json_rpc plugin: plugin_initialize() end");
             }
 
             void plugin::plugin_startup() {
                 ilog("json_rpc plugin: plugin_startup() begin");
                 std::sort(pimpl->_methods.begin(), pimpl->_methods.end());
+                pimpl->start_batch_threads(pimpl->_batch_thread_pool_size);
                 ilog("json_rpc plugin: plugin_startup() end");
             }
 
             void plugin::plugin_shutdown() {
                 ilog("json_rpc plugin: plugin_shutdown() begin");
+                pimpl->stop_batch_threads();
 
                 ilog("json_rpc plugin: plugin_shutdown() end");
             }
@@ -479,6 +597,10 @@ namespace golos {
             void plugin::call(const string &message, response_handler_type response_handler) {
                 pimpl->call(message, response_handler);
             }
+
+            void plugin::call(const fc::variant &request, response_handler_type response_handler) {
+                pimpl->call(request, response_handler);
+            }
         }
     }
 } // golos::plugins::json_rpc
@@ -214,3 +214,10 @@ CHAINBASE_SET_INDEX_TYPE(golos::plugins::market_history::bucket_object, golos::p
 
 FC_REFLECT((golos::plugins::market_history::order_history_object),(id)(time)(op))
 CHAINBASE_SET_INDEX_TYPE(golos::plugins::market_history::order_history_object, golos::plugins::market_history::order_history_index)
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::market_history::bucket_object,
+    (id)(open)(seconds)(high_steem)(high_sbd)(low_steem)(low_sbd)(open_steem)(open_sbd)(close_steem)
+    (close_sbd)(steem_volume)(sbd_volume))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::market_history::order_history_object,
+    (id)(time)(op))
@@ -37,6 +37,8 @@ public:
     clarifications<int64_t> vote_rshares;
     clarifications<bool> not_deleted_comments;
     clarifications<asset> transfer_golos_amounts;
+    clarifications<bool> existing_follow_accounts;
+    bool has_follow_index = false;
 private:
     class operation_dump_plugin_impl;
 
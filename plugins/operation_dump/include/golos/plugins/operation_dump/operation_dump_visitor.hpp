@@ -16,6 +16,35 @@ using namespace golos::plugins::follow;
 #define TAGS_NUMBER 15
 #define TAG_MAX_LENGTH 512
 
+/**
+ * Parse operations of the follow plugin in the same way as the follow plugin does it
+ */
+inline std::vector<follow_plugin_operation> parse_follow_operations(const custom_json_operation& op) {
+    std::vector<follow_plugin_operation> fpops;
+
+    auto v = fc::json::from_string(op.json);
+    try {
+        if (v.is_array() && v.size() > 0 && v.get_array()[0].is_array()) {
+            fc::from_variant(v, fpops);
+        } else {
+            fpops.emplace_back();
+            fc::from_variant(v, fpops[0]);
+        }
+    } catch (...) {
+        // Normal cases failed, try this strange case from follow-plugin
+        try {
+            auto fop = v.as<follow_operation>();
+            fpops.emplace_back(fop);
+        } catch (...) {
+        }
+    }
+    return fpops;
+}
+
+/**
+ * Writes operations of irreversible blocks to dump buffers, it doesn't access the chain state,
+ *   the values from the state are collected as clarifications when operations are applied
+ */
 class operation_dump_visitor {
 public:
     using result_type = void;
@@ -25,10 +54,8 @@ public:
     const signed_block& _block;
     uint16_t& _op_in_block;
 
-    database& _db;
-
-    operation_dump_visitor(operation_dump_plugin& plugin, const signed_block& block, uint16_t& op_in_block, database& db)
-            : _plugin(plugin), _block(block), _op_in_block(op_in_block), _db(db) {
+    operation_dump_visitor(operation_dump_plugin& plugin, const signed_block& block, uint16_t& op_in_block)
+            : _plugin(plugin), _block(block), _op_in_block(op_in_block) {
     }
 
     void id_hash_pack(dump_buffer& b, const std::string& id) {
@@ -172,36 +199,17 @@ public:
             return;
         }
 
-        if (!_db.has_index<follow_index>()) {
+        if (!_plugin.has_follow_index) {
             return;
         }
 
-        std::vector<follow_plugin_operation> fpops;
-
-        auto v = fc::json::from_string(op.json);
-        try {
-            if (v.is_array() && v.size() > 0 && v.get_array()[0].is_array()) {
-                fc::from_variant(v, fpops);
-            } else {
-                fpops.emplace_back();
-                fc::from_variant(v, fpops[0]);
-            }
-        } catch (...) {
-            // Normal cases failed, try this strange case from follow-plugin
-            try {
-                auto fop = v.as<follow_operation>();
-                fpops.emplace_back(fop);
-            } catch (...) {
-            }
-        }
-
-        for (const follow_plugin_operation& fpop : fpops) {
+        for (const follow_plugin_operation& fpop : parse_follow_operations(op)) {
             fpop.visit(*this);
         }
     }
 
     auto operator()(const follow_operation& op) -> result_type {
-        if (!_db.find_account(op.follower) || !_db.find_account(op.following)) {
+        if (!pop_clarification(_plugin.existing_follow_accounts)) {
             return;
         }
 
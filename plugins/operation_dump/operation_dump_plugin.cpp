@@ -4,12 +4,12 @@
 #include <golos/plugins/chain/plugin.hpp>
 #include <appbase/application.hpp>
 
+#include <mutex>
+
 namespace golos { namespace plugins { namespace operation_dump {
 
 namespace bfs = boost::filesystem;
 
-using block_operations = std::map<uint32_t, std::vector<operation>>;
-
 struct post_operation_clarifier {
     operation_dump_plugin& _plugin;
     golos::chain::database& _db;
@@ -53,6 +53,22 @@ struct post_operation_clarifier {
 
         add_clarification(_plugin.transfer_golos_amounts, golos_amount);
     }
+
+    result_type operator()(const custom_json_operation& op) const {
+        if (op.id != "follow" || !_plugin.has_follow_index) {
+            return;
+        }
+
+        for (const follow_plugin_operation& fpop : parse_follow_operations(op)) {
+            fpop.visit(*this);
+        }
+    }
+
+    result_type operator()(const follow_operation& op) const {
+        auto exist = _db.find_account(op.follower) && _db.find_account(op.following);
+
+        add_clarification(_plugin.existing_follow_accounts, exist);
+    }
 };
 
 class operation_dump_plugin::operation_dump_plugin_impl final {
@@ -65,48 +81,47 @@ public:
     }
 
     void erase_block(uint32_t block_num) {
-        virtual_ops.erase(block_num);
         _plugin.vote_rshares.erase(block_num);
         _plugin.not_deleted_comments.erase(block_num);
         _plugin.transfer_golos_amounts.erase(block_num);
+        _plugin.existing_follow_accounts.erase(block_num);
     }
 
-    void on_block(const signed_block& block) {
-        auto lib = _db.last_non_undoable_block_num();
-
-        for (auto block_num = start_block; block_num <= lib; ++block_num) {
-            auto block = _db.get_block_log().read_block_by_num(block_num);
-            if (!block) {
-               return;
-            }
+    /**
+     * Irreversible blocks come from the notification bus, possibly in its thread, so the state isn't accessed
+     */
+    void on_irreversible_block(const block_notification& note) {
+        const auto& block = note.block;
+        const auto block_num = note.block_num;
 
+        {
+            std::lock_guard<std::mutex> lock(clarifications_mutex);
             try {
                 uint16_t op_in_block = 0;
 
-                operation_dump_visitor op_visitor(_plugin, *block, op_in_block, _db);
+                operation_dump_visitor op_visitor(_plugin, block, op_in_block);
 
-                for (const auto& trx : block->transactions) {
+                for (const auto& trx : block.transactions) {
                     for (const auto& op : trx.operations) {
                         op.visit(op_visitor);
                         ++op_in_block;
                     }
                 }
 
-                for (const auto& op : virtual_ops[block_num]) {
-                    op.visit(op_visitor);
-                    ++op_in_block;
+                for (const auto& vop : note.operations) {
+                    if (is_virtual_operation(vop.op)) {
+                        vop.op.visit(op_visitor);
+                        ++op_in_block;
+                    }
                 }
             } catch (...) {
                 erase_block(block_num);
-                start_block = block_num+1;
                 throw;
             }
 
             erase_block(block_num);
         }
 
-        start_block = lib+1;
-
         for (auto& it : _plugin.buffers) {
             bfs::create_directories(operation_dump_dir);
             dump_file file(operation_dump_dir / it.first);
@@ -119,15 +134,13 @@ public:
     }
 
     void on_operation(const operation_notification& note) {
-        if (is_virtual_operation(note.op)) {
-            virtual_ops[note.block].push_back(note.op);
-            // remove ops if there were forks and rollbacks
-            auto itr = virtual_ops.find(note.block);
-            ++itr;
-            virtual_ops.erase(itr, virtual_ops.end());
-        } else if (!_db.is_generating() && !_db.is_producing()) {
-            note.op.visit(post_operation_clarifier(_plugin, _db, note.block));
+        // operations of pending transactions are applied again in the block
+        if (!_db.is_applying_block() || is_virtual_operation(note.op)) {
+            return;
         }
+
+        std::lock_guard<std::mutex> lock(clarifications_mutex);
+        note.op.visit(post_operation_clarifier(_plugin, _db, note.block));
     }
 
     operation_dump_plugin& _plugin;
@@ -136,9 +149,10 @@ public:
 
     bfs::path operation_dump_dir;
 
-    uint32_t start_block = 1;
+    // clarifications are added in the write thread and read in the thread of the notification bus
+    std::mutex clarifications_mutex;
 
-    block_operations virtual_ops;
+    boost::signals2::scoped_connection irreversible_block_conn;
 };
 
 operation_dump_plugin::operation_dump_plugin() = default;
@@ -169,8 +183,9 @@ void operation_dump_plugin::plugin_initialize(const bpo::variables_map& options)
         my->operation_dump_dir = odd;
     }
 
-    my->_db.applied_block.connect([&](const signed_block& b) {
-        my->on_block(b);
+    auto& bus = appbase::app().get_plugin<golos::plugins::chain::plugin>().notification_bus();
+    my->irreversible_block_conn = bus.on_irreversible_block.connect([&](const block_notification& note) {
+        my->on_irreversible_block(note);
     });
 
     my->_db.post_apply_operation.connect([&](const operation_notification& note) {
@@ -180,6 +195,9 @@ void operation_dump_plugin::plugin_initialize(const bpo::variables_map& options)
 
 void operation_dump_plugin::plugin_startup() {
     ilog("Starting up operation dump plugin");
+
+    // indexes of plugins are registered on their initialization
+    has_follow_index = my->_db.has_index<follow_index>();
 }
 
 void operation_dump_plugin::plugin_shutdown() {
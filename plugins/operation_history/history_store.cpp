@@ -0,0 +1,510 @@
+#include <golos/plugins/operation_history/history_store.hpp>
+#include <golos/protocol/exceptions.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+namespace golos { namespace plugins { namespace operation_history {
+
+    namespace detail {
+        using read_write_mutex = boost::shared_mutex;
+        using read_lock = boost::shared_lock<read_write_mutex>;
+        using write_lock = boost::unique_lock<read_write_mutex>;
+
+        using golos::protocol::transaction_id_type;
+
+        uint32_t get_segment(uint64_t pos) {
+            return uint32_t(pos >> 32);
+        }
+
+        uint32_t get_offset(uint64_t pos) {
+            return uint32_t(pos);
+        }
+
+        uint64_t make_pos(uint32_t segment, uint32_t offset) {
+            return (uint64_t(segment) << 32) | offset;
+        }
+
+        /**
+         * Memory-mapped file, which can be empty (boost can't map empty files).
+         *
+         * The file grows geometrically to not remap it on each block, so it can be bigger than its data,
+         *   the unused end is cut off on close.
+         */
+        class mapped_file final {
+        public:
+            static constexpr std::size_t min_growth = 1024 * 1024;
+
+            ~mapped_file() {
+                close();
+            }
+
+            void open(const std::string& path) {
+                close();
+                _path = path;
+                if (!boost::filesystem::exists(_path)) {
+                    std::ofstream(_path, std::ios::out|std::ios::binary);
+                }
+                _size = boost::filesystem::file_size(_path);
+                if (_size > 0) {
+                    _file.open(_path, boost::iostreams::mapped_file::readwrite);
+                }
+            }
+
+            void close() {
+                if (!_path.empty()) {
+                    set_capacity(_size);
+                }
+                _file.close();
+                _size = 0;
+            }
+
+            std::size_t size() const {
+                return _size;
+            }
+
+            const char* data() const {
+                return _file.const_data();
+            }
+
+            char* data() {
+                return _file.data();
+            }
+
+            /**
+             * Set the size of data, the truncated data is cut off right away, because it's rare
+             */
+            void resize(std::size_t size) {
+                if (size == _size) {
+                    return;
+                }
+                const auto capacity = this->capacity();
+                if (size < _size) {
+                    set_capacity(size);
+                } else if (size > capacity) {
+                    set_capacity(std::max(size, capacity + std::max(capacity, min_growth)));
+                }
+                _size = size;
+            }
+
+            const std::string& path() const {
+                return _path;
+            }
+
+        private:
+            std::size_t capacity() const {
+                return _file.is_open() ? _file.size() : 0;
+            }
+
+            void set_capacity(std::size_t capacity) {
+                if (capacity == this->capacity()) {
+                    return;
+                }
+                if (capacity == 0) {
+                    _file.close();
+                    boost::filesystem::resize_file(_path, 0);
+                } else if (!_file.is_open()) {
+                    boost::filesystem::resize_file(_path, capacity);
+                    _file.open(_path, boost::iostreams::mapped_file::readwrite);
+                } else {
+                    _file.resize(capacity);
+                }
+            }
+
+            std::string _path;
+            std::size_t _size = 0;
+            boost::iostreams::mapped_file _file;
+        };
+
+        struct transaction_entry final {
+            uint64_t key = 0;       ///< 0 for empty entries
+            uint32_t block = 0;
+            uint32_t reserved = 0;
+        };
+
+        struct transaction_table_header final {
+            uint64_t capacity = 0;
+            uint64_t count = 0;
+        };
+
+        class history_store_impl final {
+        public:
+            static constexpr uint64_t initial_transaction_capacity = 1 << 20;
+
+            void open(const fc::path& dir) {
+                close();
+
+                boost::filesystem::create_directories(dir);
+                _dir = dir;
+
+                _blocks.open((dir / "blocks.idx").string());
+                _blocks.resize(_blocks.size() - _blocks.size() % sizeof(uint64_t));
+
+                // the unused end of the file is left after the crash, ends of blocks only grow,
+                //   so the trailing zero ends are either unused or belong to blocks without operations
+                const auto* blocks = reinterpret_cast<const uint64_t*>(_blocks.data());
+                auto count = _blocks.size() / sizeof(uint64_t);
+                while (count > 0 && blocks[count - 1] == 0) {
+                    --count;
+                }
+                _blocks.resize(count * sizeof(uint64_t));
+
+                _transactions.open((dir / "transactions.idx").string());
+                const auto transactions_size = sizeof(transaction_table_header) +
+                    sizeof(transaction_entry) * header().capacity;
+                if (_transactions.size() < sizeof(transaction_table_header) || _transactions.size() < transactions_size) {
+                    // the table isn't used for anything except the search of transactions, so it is just recreated
+                    _transactions.resize(0);
+                } else {
+                    _transactions.resize(transactions_size);
+                }
+
+                open_segments();
+            }
+
+            void close() {
+                _blocks.close();
+                _transactions.close();
+                _segments.clear();
+            }
+
+            bool is_open() const {
+                return !_dir.empty();
+            }
+
+            uint32_t head_block_num() const {
+                return _blocks.size() / sizeof(uint64_t);
+            }
+
+            void truncate(uint32_t block_num) {
+                if (block_num > head_block_num()) {
+                    return;
+                }
+
+                ilog("Truncate history store from block ${b}", ("b", block_num));
+
+                // stale entries of transaction table are skipped on search, because they refer to removed blocks
+                const auto new_head = block_num - 1;
+                _blocks.resize(new_head * sizeof(uint64_t));
+
+                resize_segments();
+            }
+
+            std::vector<uint64_t> append_block(uint32_t block_num, const std::vector<stored_operation>& ops) {
+                const auto head = head_block_num();
+                FC_ASSERT(block_num > head, "Block ${b} is already in history store", ("b", block_num)("head", head));
+
+                std::vector<std::vector<char>> records;
+                records.reserve(ops.size());
+
+                uint64_t total_size = 0;
+                for (const auto& op: ops) {
+                    records.push_back(fc::raw::pack(op));
+                    total_size += sizeof(uint32_t) + records.back().size();
+                }
+                FC_ASSERT(total_size < history_store::segment_size, "Too big block ${b}", ("b", block_num));
+
+                auto end = get_end(head);
+                auto segment = get_segment(end);
+                auto offset = get_offset(end);
+                if (head == 0 || offset + total_size > history_store::segment_size) {
+                    segment = head == 0 ? 0 : segment + 1;
+                    offset = 0;
+                    add_segment(segment);
+                }
+
+                std::vector<uint64_t> result;
+                result.reserve(ops.size());
+
+                auto& file = _segments[segment];
+                file->resize(offset + total_size);
+                auto* ptr = file->data() + offset;
+                for (const auto& record: records) {
+                    result.push_back(make_pos(segment, offset));
+
+                    const uint32_t size = record.size();
+                    std::memcpy(ptr, &size, sizeof(size));
+                    std::memcpy(ptr + sizeof(size), record.data(), size);
+
+                    ptr += sizeof(size) + size;
+                    offset += sizeof(size) + size;
+                }
+
+                // blocks without operations have the same end as the previous one
+                end = make_pos(segment, offset);
+                const auto prev_end = head ? get_end(head) : make_pos(segment, 0);
+                _blocks.resize(block_num * sizeof(uint64_t));
+                auto* blocks = reinterpret_cast<uint64_t*>(_blocks.data());
+                for (auto num = head + 1; num < block_num; ++num) {
+                    blocks[num - 1] = prev_end;
+                }
+                blocks[block_num - 1] = end;
+
+                transaction_id_type last_trx_id;
+                for (const auto& op: ops) {
+                    if (op.trx_id != transaction_id_type() && op.trx_id != last_trx_id) {
+                        add_transaction(op.trx_id, block_num);
+                        last_trx_id = op.trx_id;
+                    }
+                }
+
+                return result;
+            }
+
+            std::vector<stored_operation> get_block(uint32_t block_num) const {
+                std::vector<stored_operation> result;
+                if (block_num == 0 || block_num > head_block_num()) {
+                    return result;
+                }
+
+                const auto end = get_end(block_num);
+                const auto prev_end = get_end(block_num - 1);
+                auto pos = get_segment(prev_end) == get_segment(end) ? prev_end : make_pos(get_segment(end), 0);
+
+                while (pos < end) {
+                    result.emplace_back();
+                    pos = read_record(pos, result.back());
+                }
+                return result;
+            }
+
+            stored_operation get_operation(uint64_t pos) const {
+                stored_operation result;
+                read_record(pos, result);
+                return result;
+            }
+
+            fc::optional<stored_operation> find_transaction(const transaction_id_type& id) const {
+                const auto capacity = header().capacity;
+                if (!capacity) {
+                    return {};
+                }
+
+                const auto key = get_key(id);
+                const auto* entries = get_entries();
+                const auto head = head_block_num();
+                for (auto i = key % capacity; entries[i].key != 0; i = (i + 1) % capacity) {
+                    if (entries[i].key != key || entries[i].block > head) {
+                        continue;
+                    }
+                    for (auto& op: get_block(entries[i].block)) {
+                        if (op.trx_id == id) {
+                            return std::move(op);
+                        }
+                    }
+                }
+                return {};
+            }
+
+        private:
+            std::string get_segment_path(uint32_t segment) const {
+                std::ostringstream name;
+                name << "ops-" << std::setw(6) << std::setfill('0') << segment << ".dat";
+                return (_dir / name.str()).string();
+            }
+
+            void add_segment(uint32_t segment) {
+                FC_ASSERT(segment == _segments.size());
+                _segments.push_back(std::make_unique<mapped_file>());
+                _segments.back()->open(get_segment_path(segment));
+                _segments.back()->resize(0);
+            }
+
+            void open_segments() {
+                for (uint32_t segment = 0; boost::filesystem::exists(get_segment_path(segment)); ++segment) {
+                    _segments.push_back(std::make_unique<mapped_file>());
+                    _segments.back()->open(get_segment_path(segment));
+                }
+                resize_segments();
+            }
+
+            /**
+             * Remove data after the end of the last block, it can be left after the truncation or the crash
+             */
+            void resize_segments() {
+                const auto head = head_block_num();
+                const auto end = get_end(head);
+                const auto count = head ? get_segment(end) + 1 : 0;
+
+                GOLOS_CHECK_DATABASE(count <= _segments.size(),
+                    database_corrupted::reading_data_beyond_end_of_file,
+                    "Segment of history store is lost", ("segment", count - 1));
+
+                while (_segments.size() > count) {
+                    auto path = _segments.back()->path();
+                    _segments.pop_back();
+                    boost::filesystem::remove_all(path);
+                }
+
+                if (count) {
+                    auto& file = _segments.back();
+                    GOLOS_CHECK_DATABASE(get_offset(end) <= file->size(),
+                        database_corrupted::reading_data_beyond_end_of_file,
+                        "Segment of history store is truncated", ("segment", count - 1));
+                    file->resize(get_offset(end));
+                }
+            }
+
+            uint64_t get_end(uint32_t block_num) const {
+                if (block_num == 0) {
+                    return 0;
+                }
+                return reinterpret_cast<const uint64_t*>(_blocks.data())[block_num - 1];
+            }
+
+            uint64_t read_record(uint64_t pos, stored_operation& op) const {
+                const auto segment = get_segment(pos);
+                const auto offset = get_offset(pos);
+                GOLOS_CHECK_DATABASE(segment < _segments.size() && offset + sizeof(uint32_t) <= _segments[segment]->size(),
+                    database_corrupted::reading_data_beyond_end_of_file,
+                    "Reading data beyond end of file", ("segment", segment)("offset", offset));
+
+                const auto* ptr = _segments[segment]->data() + offset;
+                uint32_t size;
+                std::memcpy(&size, ptr, sizeof(size));
+                GOLOS_CHECK_DATABASE(offset + sizeof(size) + size <= _segments[segment]->size(),
+                    database_corrupted::reading_data_beyond_end_of_file,
+                    "Reading data beyond end of file", ("segment", segment)("offset", offset)("size", size));
+
+                fc::datastream<const char*> ds(ptr + sizeof(size), size);
+                fc::raw::unpack(ds, op);
+                return make_pos(segment, offset + sizeof(size) + size);
+            }
+
+            static uint64_t get_key(const transaction_id_type& id) {
+                uint64_t key;
+                std::memcpy(&key, id.data(), sizeof(key));
+                return key ? key : 1;
+            }
+
+            const transaction_table_header& header() const {
+                static const transaction_table_header empty;
+                if (_transactions.size() < sizeof(transaction_table_header)) {
+                    return empty;
+                }
+                return *reinterpret_cast<const transaction_table_header*>(_transactions.data());
+            }
+
+            const transaction_entry* get_entries() const {
+                return reinterpret_cast<const transaction_entry*>(_transactions.data() + sizeof(transaction_table_header));
+            }
+
+            void resize_transactions(uint64_t capacity) {
+                std::vector<transaction_entry> entries;
+                if (header().capacity) {
+                    const auto* begin = get_entries();
+                    std::copy_if(begin, begin + header().capacity, std::back_inserter(entries), [](const auto& e) {
+                        return e.key != 0;
+                    });
+                }
+
+                _transactions.resize(0);
+                _transactions.resize(sizeof(transaction_table_header) + sizeof(transaction_entry) * capacity);
+                std::memset(_transactions.data(), 0, _transactions.size());
+
+                auto& table = *reinterpret_cast<transaction_table_header*>(_transactions.data());
+                table.capacity = capacity;
+                for (const auto& e: entries) {
+                    add_transaction(e.key, e.block);
+                }
+            }
+
+            void add_transaction(const transaction_id_type& id, uint32_t block_num) {
+                auto capacity = header().capacity;
+                if (!capacity) {
+                    resize_transactions(initial_transaction_capacity);
+                } else if ((header().count + 1) * 2 > capacity) {
+                    resize_transactions(capacity * 2);
+                }
+                add_transaction(get_key(id), block_num);
+            }
+
+            void add_transaction(uint64_t key, uint32_t block_num) {
+                auto& table = *reinterpret_cast<transaction_table_header*>(_transactions.data());
+                auto* entries = reinterpret_cast<transaction_entry*>(_transactions.data() + sizeof(table));
+                auto i = key % table.capacity;
+                for (; entries[i].key != 0; i = (i + 1) % table.capacity) {
+                    if (entries[i].key == key && entries[i].block == block_num) {
+                        return;
+                    }
+                }
+                entries[i].key = key;
+                entries[i].block = block_num;
+                ++table.count;
+            }
+
+            fc::path _dir;
+            mapped_file _blocks;
+            mapped_file _transactions;
+            std::vector<std::unique_ptr<mapped_file>> _segments;
+
+        public:
+            mutable read_write_mutex mutex;
+        };
+    } // detail
+
+    history_store::history_store()
+        : my(std::make_unique<detail::history_store_impl>()) {
+    }
+
+    history_store::~history_store() = default;
+
+    void history_store::open(const fc::path& dir) { try {
+        detail::write_lock lock(my->mutex);
+        my->open(dir);
+    } FC_LOG_AND_RETHROW() }
+
+    void history_store::close() {
+        detail::write_lock lock(my->mutex);
+        my->close();
+    }
+
+    bool history_store::is_open() const {
+        detail::read_lock lock(my->mutex);
+        return my->is_open();
+    }
+
+    uint32_t history_store::head_block_num() const {
+        detail::read_lock lock(my->mutex);
+        return my->head_block_num();
+    }
+
+    void history_store::truncate(uint32_t block_num) {
+        detail::write_lock lock(my->mutex);
+        my->truncate(block_num);
+    }
+
+    std::vector<uint64_t> history_store::append_block(uint32_t block_num, const std::vector<stored_operation>& ops) {
+        detail::write_lock lock(my->mutex);
+        return my->append_block(block_num, ops);
+    }
+
+    std::vector<stored_operation> history_store::get_block(uint32_t block_num) const {
+        detail::read_lock lock(my->mutex);
+        return my->get_block(block_num);
+    }
+
+    stored_operation history_store::get_operation(uint64_t pos) const {
+        detail::read_lock lock(my->mutex);
+        return my->get_operation(pos);
+    }
+
+    fc::optional<stored_operation> history_store::find_transaction(
+        const golos::protocol::transaction_id_type& id
+    ) const {
+        detail::read_lock lock(my->mutex);
+        return my->find_transaction(id);
+    }
+
+} } } // golos::plugins::operation_history
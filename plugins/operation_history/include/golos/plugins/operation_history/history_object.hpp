@@ -90,3 +90,5 @@ CHAINBASE_SET_INDEX_TYPE(
     golos::plugins::operation_history::operation_object,
     golos::plugins::operation_history::operation_index)
 
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::operation_history::operation_object,
+    (id)(trx_id)(block)(trx_in_block)(op_in_trx)(virtual_op)(timestamp)(serialized_op))
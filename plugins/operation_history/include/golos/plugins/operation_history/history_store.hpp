@@ -0,0 +1,87 @@
+#pragma once
+
+#include <golos/protocol/types.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/optional.hpp>
+#include <fc/time.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace golos { namespace plugins { namespace operation_history {
+
+    struct stored_operation final {
+        golos::protocol::transaction_id_type trx_id;
+        uint32_t block = 0;
+        uint32_t trx_in_block = 0;
+        uint16_t op_in_trx = 0;
+        uint32_t virtual_op = 0;
+        fc::time_point_sec timestamp;
+        std::vector<char> serialized_op;
+    };
+
+    namespace detail { class history_store_impl; }
+
+    /**
+     * Append-only on-disk store of irreversible operations, it allows to keep in the shared memory
+     *   only operations of reversible blocks.
+     *
+     * Files:
+     *   - ops-NNNNNN.dat: segments of operations, each record is [uint32 size][stored_operation],
+     *     operations of one block are always in one segment;
+     *   - blocks.idx: position of the end of operations for each block starting from the first one;
+     *   - transactions.idx: hash table with linear probing, which maps the transaction id to the block number.
+     *
+     * Position of operation consists of the segment number (high 32 bits) and the offset in it (low 32 bits).
+     *
+     * Files are memory-mapped, so records are read without copying of segments into memory.
+     */
+    class history_store final {
+    public:
+        static constexpr uint64_t segment_size = 1024 * 1024 * 1024;
+
+        history_store();
+
+        ~history_store();
+
+        void open(const fc::path& dir);
+
+        void close();
+
+        bool is_open() const;
+
+        /**
+         * @return number of the last block in store, or 0 if it is empty
+         */
+        uint32_t head_block_num() const;
+
+        /**
+         * Remove operations of blocks starting from block_num
+         */
+        void truncate(uint32_t block_num);
+
+        /**
+         * Append operations of the block, block_num should be greater than head_block_num()
+         * @return positions of operations
+         */
+        std::vector<uint64_t> append_block(uint32_t block_num, const std::vector<stored_operation>& ops);
+
+        std::vector<stored_operation> get_block(uint32_t block_num) const;
+
+        stored_operation get_operation(uint64_t pos) const;
+
+        /**
+         * Find any operation of the transaction
+         */
+        fc::optional<stored_operation> find_transaction(const golos::protocol::transaction_id_type& id) const;
+
+    private:
+        std::unique_ptr<detail::history_store_impl> my;
+    };
+
+} } } // golos::plugins::operation_history
+
+FC_REFLECT(
+    (golos::plugins::operation_history::stored_operation),
+    (trx_id)(block)(trx_in_block)(op_in_trx)(virtual_op)(timestamp)(serialized_op))
@@ -34,6 +34,7 @@
 #include <golos/plugins/json_rpc/plugin.hpp>
 #include <golos/plugins/operation_history/applied_operation.hpp>
 #include <golos/plugins/operation_history/history_object.hpp>
+#include <golos/plugins/operation_history/history_store.hpp>
 
 
 namespace golos { namespace plugins { namespace operation_history {
@@ -48,9 +49,12 @@ namespace golos { namespace plugins { namespace operation_history {
     using plugins::json_rpc::msg_pack_transfer;
 
     DEFINE_API_ARGS(get_block_with_virtual_ops, msg_pack, annotated_signed_block)
-    DEFINE_API_ARGS(get_ops_in_block, msg_pack, std::vector<applied_operation>)
+    DEFINE_STREAMED_API_ARGS(get_ops_in_block, msg_pack, std::vector<applied_operation>)
     DEFINE_API_ARGS(get_transaction,  msg_pack, annotated_signed_transaction)
 
+    /// Positions of operations in history_store
+    using operation_positions = fc::flat_map<operation_id_type, uint64_t>;
+
     /**
      *  This plugin is designed to track operations so that one node
      *  doesn't need to hold the full operation history in memory.
@@ -88,6 +92,18 @@ namespace golos { namespace plugins { namespace operation_history {
 
             (get_transaction)
         )
+
+        /**
+         * Store of irreversible operations, nullptr if all operations are kept in the shared memory
+         */
+        const history_store* store() const;
+
+        /**
+         * Emitted when operations of the irreversible block are moved to the store,
+         *   before they are removed from the shared memory.
+         */
+        boost::signals2::signal<void(uint32_t, const operation_positions&)> on_block_stored;
+
     private:
         struct plugin_impl;
 
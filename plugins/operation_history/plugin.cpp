@@ -4,8 +4,10 @@
 #include <golos/plugins/json_rpc/api_helper.hpp>
 #include <golos/protocol/exceptions.hpp>
 #include <golos/chain/operation_notification.hpp>
+#include <golos/chain/pruning.hpp>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
 
 #define STEEM_NAMESPACE_PREFIX "golos::protocol::"
 #define OPERATION_POSTFIX "_operation"
@@ -92,27 +94,84 @@ namespace golos { namespace plugins { namespace operation_history {
 
     struct plugin::plugin_impl final {
     public:
-        plugin_impl(): database(appbase::app().get_plugin<chain::plugin>().db()) {
+        plugin_impl(plugin& self)
+            : self(self),
+              database(appbase::app().get_plugin<chain::plugin>().db()) {
         }
 
         ~plugin_impl() = default;
 
         void erase_old_blocks() {
-            uint32_t head_block = database.head_block_num();
-            if (history_blocks <= head_block) {
-                uint32_t need_block = head_block - history_blocks;
-                const auto& idx = database.get_index<operation_index>().indices().get<by_location>();
-                auto it = idx.begin();
-                while (it != idx.end() && it->block <= need_block) {
-                    auto next_it = it;
-                    ++next_it;
-                    database.remove(*it);
-                    it = next_it;
+            pruner.start();
+            pruner.remove_objects<operation_index, by_location>(database, &operation_object::block);
+        }
+
+        /**
+         * The state can be replayed from scratch, so the store should be cut to it before the first operation
+         */
+        void check_store() {
+            if (store && !is_store_checked) {
+                store->truncate(database.get_dynamic_global_properties().last_irreversible_block_num + 1);
+                is_store_checked = true;
+            }
+        }
+
+        /**
+         * Move operations of irreversible blocks from the shared memory to the store
+         */
+        void move_irreversible_blocks() {
+            check_store();
+
+            const auto lib = database.get_dynamic_global_properties().last_irreversible_block_num;
+
+            const auto& idx = database.get_index<operation_index>().indices().get<by_location>();
+            std::vector<stored_operation> ops;
+            operation_positions positions;
+
+            for (auto itr = idx.begin(); itr != idx.end() && itr->block <= lib;) {
+                const auto block_num = itr->block;
+                const auto end = idx.lower_bound(block_num + 1);
+
+                // operations of stored block can return to the state if the head block was popped
+                if (block_num > store->head_block_num()) {
+                    ops.clear();
+                    for (auto op_itr = itr; op_itr != end; ++op_itr) {
+                        ops.emplace_back();
+                        auto& op = ops.back();
+                        op.trx_id = op_itr->trx_id;
+                        op.block = op_itr->block;
+                        op.trx_in_block = op_itr->trx_in_block;
+                        op.op_in_trx = op_itr->op_in_trx;
+                        op.virtual_op = op_itr->virtual_op;
+                        op.timestamp = op_itr->timestamp;
+                        op.serialized_op.assign(op_itr->serialized_op.begin(), op_itr->serialized_op.end());
+                    }
+
+                    auto op_pos = store->append_block(block_num, ops);
+
+                    positions.clear();
+                    auto pos_itr = op_pos.begin();
+                    for (auto op_itr = itr; op_itr != end; ++op_itr, ++pos_itr) {
+                        positions.emplace(op_itr->id, *pos_itr);
+                    }
+                    self.on_block_stored(block_num, positions);
+                }
+
+                while (itr != end) {
+                    const auto& op = *itr;
+                    ++itr;
+                    database.remove(op);
                 }
             }
         }
 
+        bool is_stored(uint32_t block_num) const {
+            return store && block_num <= store->head_block_num();
+        }
+
         void on_operation(golos::chain::operation_notification& note) {
+            check_store();
+
             if (filter_content) {
                 note.op.visit(operation_visitor_filter(database, note, ops_list, blacklist, start_block));
             } else {
@@ -129,10 +188,24 @@ namespace golos { namespace plugins { namespace operation_history {
                 return result;
             }
             result = annotated_signed_block(*sb);
+            result._virtual_operations = block_operations();
+
+            if (is_stored(block_num)) {
+                for (auto& stored: store->get_block(block_num)) {
+                    if (stored.virtual_op != 0) {
+                        block_operation op;
+                        op.trx_in_block = stored.trx_in_block;
+                        op.op_in_trx = stored.op_in_trx;
+                        op.virtual_op = stored.virtual_op;
+                        op.op = fc::raw::unpack<protocol::operation>(stored.serialized_op);
+                        (*result._virtual_operations).push_back(op);
+                    }
+                }
+                return result;
+            }
 
             const auto& idx = database.get_index<operation_index>().indices().get<by_location>();
             auto itr = idx.lower_bound(block_num);
-            result._virtual_operations = block_operations();
             for (; itr != idx.end() && itr->block == block_num; ++itr) {
                 if (itr->virtual_op != 0) {
                     block_operation op;
@@ -151,9 +224,18 @@ namespace golos { namespace plugins { namespace operation_history {
             uint32_t block_num,
             bool only_virtual
         ) {
+            std::vector<applied_operation> result;
+            if (is_stored(block_num)) {
+                for (auto& stored: store->get_block(block_num)) {
+                    if (!only_virtual || stored.virtual_op != 0) {
+                        result.emplace_back(stored);
+                    }
+                }
+                return result;
+            }
+
             const auto& idx = database.get_index<operation_index>().indices().get<by_location>();
             auto itr = idx.lower_bound(block_num);
-            std::vector<applied_operation> result;
             for (; itr != idx.end() && itr->block == block_num; ++itr) {
                 applied_operation operation(*itr);
                 if (!only_virtual || operation.virtual_op != 0) {
@@ -163,26 +245,39 @@ namespace golos { namespace plugins { namespace operation_history {
             return result;
         }
 
+        annotated_signed_transaction get_transaction(uint32_t block_num, uint32_t trx_in_block) {
+            auto blk = database.fetch_block_by_number(block_num);
+            FC_ASSERT(blk.valid());
+            FC_ASSERT(blk->transactions.size() > trx_in_block);
+            annotated_signed_transaction result = blk->transactions[trx_in_block];
+            result.block_num = block_num;
+            result.transaction_num = trx_in_block;
+            return result;
+        }
+
         annotated_signed_transaction get_transaction(transaction_id_type id) {
             const auto &idx = database.get_index<operation_index>().indices().get<by_transaction_id>();
             auto itr = idx.lower_bound(id);
             if (itr != idx.end() && itr->trx_id == id) {
-                auto blk = database.fetch_block_by_number(itr->block);
-                FC_ASSERT(blk.valid());
-                FC_ASSERT(blk->transactions.size() > itr->trx_in_block);
-                annotated_signed_transaction result = blk->transactions[itr->trx_in_block];
-                result.block_num = itr->block;
-                result.transaction_num = itr->trx_in_block;
-                return result;
+                return get_transaction(itr->block, itr->trx_in_block);
+            }
+            if (store) {
+                auto stored = store->find_transaction(id);
+                if (stored.valid()) {
+                    return get_transaction(stored->block, stored->trx_in_block);
+                }
             }
             GOLOS_THROW_MISSING_OBJECT("transaction", id);
         }
 
         bool filter_content = false;
         uint32_t start_block = 0;
-        uint32_t history_blocks = UINT32_MAX;
+        golos::chain::block_pruner pruner;
         bool blacklist = true;
         fc::flat_set<std::string> ops_list;
+        std::unique_ptr<history_store> store;
+        bool is_store_checked = false;
+        plugin& self;
         golos::chain::database& database;
     };
 
@@ -234,13 +329,27 @@ namespace golos { namespace plugins { namespace operation_history {
             "history-blocks",
             boost::program_options::value<uint32_t>(),
             "Defines depth of history for recording stats."
+        ) (
+            "history-prune-bucket-size",
+            boost::program_options::value<uint32_t>()->default_value(uint32_t(golos::chain::block_pruner::default_bucket_size)),
+            "Old history is removed once per this number of blocks, when all blocks of the range are older "
+            "than history-blocks. It doesn't lower the cost of removing, which is limited by history-prune-budget-ms."
+        ) (
+            "history-prune-budget-ms",
+            boost::program_options::value<uint32_t>()->default_value(uint32_t(golos::chain::block_pruner::default_budget_ms)),
+            "Max time of removing of old history in one block, the rest is removed in next blocks. 0 - not limited."
+        ) (
+            "history-store-dir",
+            boost::program_options::value<boost::filesystem::path>(),
+            "Directory of the on-disk store of irreversible history (absolute or relative to the data dir). "
+            "If it is set, only operations of reversible blocks are kept in the shared memory."
         );
     }
 
     void plugin::plugin_initialize(const boost::program_options::variables_map& options) {
         ilog("operation_history plugin: plugin_initialize() begin");
 
-        pimpl = std::make_unique<plugin_impl>();
+        pimpl = std::make_unique<plugin_impl>(*this);
 
         pimpl->database.pre_apply_operation.connect([&](golos::chain::operation_notification& note){
             pimpl->on_operation(note);
@@ -290,15 +399,32 @@ namespace golos { namespace plugins { namespace operation_history {
         ilog("operation_history: start_block ${s}", ("s", pimpl->start_block));
 
         if (options.count("history-blocks")) {
-            uint32_t history_blocks = options.at("history-blocks").as<uint32_t>();
-            pimpl->history_blocks = history_blocks;
+            pimpl->pruner = golos::chain::block_pruner(
+                options.at("history-blocks").as<uint32_t>(),
+                options.at("history-prune-bucket-size").as<uint32_t>(),
+                fc::milliseconds(options.at("history-prune-budget-ms").as<uint32_t>()));
             pimpl->database.applied_block.connect([&](const signed_block& block){
                 pimpl->erase_old_blocks();
             });
-        } else {
-            pimpl->history_blocks = UINT32_MAX;
         }
-        ilog("operation_history: history-blocks ${s}", ("s", pimpl->history_blocks));
+        ilog("operation_history: history-blocks ${s}", ("s", pimpl->pruner.depth));
+
+        if (options.count("history-store-dir")) {
+            // the store is written and truncated on opening, it can be used only by the node, which applies blocks
+            GOLOS_CHECK_OPTION(!appbase::app().get_plugin<chain::plugin>().is_read_only(),
+                "history-store-dir can't be used in read-only mode");
+
+            auto dir = options.at("history-store-dir").as<boost::filesystem::path>();
+            if (dir.is_relative()) {
+                dir = appbase::app().data_dir() / dir;
+            }
+            pimpl->store = std::make_unique<history_store>();
+            pimpl->store->open(dir);
+            pimpl->database.applied_block.connect([&](const signed_block& block){
+                pimpl->move_irreversible_blocks();
+            });
+            ilog("operation_history: history-store-dir ${d}", ("d", dir.string()));
+        }
 
         JSON_RPC_REGISTER_API(name());
         ilog("operation_history plugin: plugin_initialize() end");
@@ -319,6 +445,13 @@ namespace golos { namespace plugins { namespace operation_history {
     }
 
     void plugin::plugin_shutdown() {
+        if (pimpl->store) {
+            pimpl->store->close();
+        }
+    }
+
+    const history_store* plugin::store() const {
+        return pimpl->store.get();
     }
 
 } } } // golos::plugins::operation_history
@@ -47,11 +47,15 @@ namespace golos {
 
                     chain_id_type get_chain_id() const;
 
+                    uint32_t get_block_skip_flags() const;
+
                     // node_delegate interface
                     virtual bool has_item(const item_id &) override;
 
                     virtual bool handle_block(const block_message &, bool, std::vector<fc::uint160_t> &) override;
 
+                    virtual void prefetch_sync_block(const block_message &) override;
+
                     virtual void handle_transaction(const trx_message &) override;
 
                     virtual void handle_message(const message &) override;
@@ -88,6 +92,10 @@ namespace golos {
                     vector<fc::ip::endpoint> seeds;
                     string user_agent;
                     uint32_t max_connections = 0;
+                    uint32_t block_push_peers = 0;
+                    uint32_t sync_blocks_buffer_size = 0;
+                    uint32_t io_threads = 0;
+                    vector<string> block_push_nodes;
                     bool force_validate = false;
                     bool block_producer = false;
 
@@ -133,9 +141,7 @@ namespace golos {
                             // you can help the network code out by throwing a block_older_than_undo_history exception.
                             // when the network code sees that, it will stop trying to push blocks from that chain, but
                             // leave that peer connected so that they can get sync blocks from us
-                            bool result = chain.accept_block(blk_msg.block, sync_mode, (block_producer | force_validate)
-                                                                                       ? database::skip_nothing
-                                                                                       : database::skip_transaction_signatures);
+                            bool result = chain.accept_block(blk_msg.block, sync_mode, get_block_skip_flags());
 
                             if (!sync_mode) {
                                 fc::microseconds latency = fc::time_point::now() - blk_msg.block.timestamp;
@@ -159,6 +165,16 @@ namespace golos {
                     } FC_CAPTURE_AND_RETHROW((blk_msg)(sync_mode))
                 }
 
+                void p2p_plugin_impl::prefetch_sync_block(const block_message &blk_msg) {
+                    chain.prefetch_block(blk_msg.block, blk_msg.block_id, get_block_skip_flags());
+                }
+
+                uint32_t p2p_plugin_impl::get_block_skip_flags() const {
+                    return (block_producer | force_validate)
+                           ? database::skip_nothing
+                           : database::skip_transaction_signatures;
+                }
+
                 void p2p_plugin_impl::handle_transaction(const trx_message &trx_msg) {
                     try {
                         chain.accept_transaction(trx_msg.trx);
@@ -443,7 +459,15 @@ namespace golos {
                     ("seed-node", boost::program_options::value<vector<string>>()->composing(),
                         "The IP address and port of a remote peer to sync with. Deprecated in favor of p2p-seed-node.")
                     ("p2p-seed-node", boost::program_options::value<vector<string>>()->composing(),
-                        "The IP address and port of a remote peer to sync with.");
+                        "The IP address and port of a remote peer to sync with.")
+                    ("p2p-block-push-peers", boost::program_options::value<uint32_t>()->default_value(0),
+                        "Number of peers with the lowest latency, to which new blocks are pushed without the inventory round-trip.")
+                    ("p2p-block-push-node", boost::program_options::value<vector<string>>()->composing(),
+                        "The IP address and port of a remote peer (e.g. a witness node), to which new blocks are always pushed, and from which pushed blocks are accepted.")
+                    ("p2p-sync-blocks-buffer-size", boost::program_options::value<uint32_t>()->default_value(256),
+                        "Max size in megabytes of blocks, which are downloaded from peers during sync, but wait for earlier blocks.")
+                    ("p2p-io-threads", boost::program_options::value<uint32_t>()->default_value(0),
+                        "Number of threads, which read, decrypt and encrypt messages of peers. If 0, it's done in the P2P thread.");
                 cli.add_options()
                     ("force-validate", boost::program_options::bool_switch()->default_value(false),
                         "Force validation of all transactions. Deprecated in favor of p2p-force-validate")
@@ -490,6 +514,24 @@ namespace golos {
                     }
                 }
 
+                my->block_push_peers = options.at("p2p-block-push-peers").as<uint32_t>();
+                my->sync_blocks_buffer_size = options.at("p2p-sync-blocks-buffer-size").as<uint32_t>();
+                my->io_threads = options.at("p2p-io-threads").as<uint32_t>();
+
+                if (options.count("p2p-block-push-node")) {
+                    for (const string &endpoint_string : options.at("p2p-block-push-node").as<vector<string>>()) {
+                        try {
+                            auto eps = appbase::app().resolve_string_to_ip_endpoints(endpoint_string);
+                            for (auto& ep: eps) {
+                                my->block_push_nodes.push_back(string(fc::ip::endpoint(ep.address().to_string(), ep.port())));
+                            }
+                        } catch (const fc::exception &e) {
+                            wlog("caught exception ${e} while adding block push node ${endpoint}",
+                                 ("e", e.to_detail_string())("endpoint", endpoint_string));
+                        }
+                    }
+                }
+
                 my->force_validate = options.at("p2p-force-validate").as<bool>();
 
                 if (!my->force_validate && options.at("force-validate").as<bool>()) {
@@ -499,11 +541,21 @@ namespace golos {
             }
 
             void p2p_plugin::plugin_startup() {
+                if (my->chain.is_read_only()) {
+                    ilog("P2P is disabled, because chain database is opened in read-only mode");
+                    return;
+                }
+
                 my->p2p_thread.async([this] {
                     my->node.reset(new golos::network::node(my->user_agent));
                     my->node->load_configuration(app().data_dir() / "p2p");
                     my->node->set_node_delegate(&(*my));
 
+                    if (my->io_threads) {
+                        ilog("Setting p2p io threads to ${n}", ("n", my->io_threads));
+                        my->node->set_advanced_node_parameters(fc::variant_object("io_thread_count", fc::variant(my->io_threads)));
+                    }
+
                     if (my->endpoint) {
                         ilog("Configuring P2P to listen at ${ep}", ("ep", my->endpoint));
                         my->node->listen_on_endpoint(*my->endpoint, true);
@@ -522,6 +574,19 @@ namespace golos {
                         my->node->set_advanced_node_parameters(node_param);
                     }
 
+                    ilog("Setting p2p sync blocks buffer size to ${n} MB", ("n", my->sync_blocks_buffer_size));
+                    my->node->set_advanced_node_parameters(fc::variant_object("maximum_sync_blocks_buffer_size",
+                            fc::variant(uint64_t(my->sync_blocks_buffer_size) * 1024 * 1024)));
+
+                    if (my->block_push_peers || !my->block_push_nodes.empty()) {
+                        ilog("Pushing new blocks to ${n} lowest-latency peers and to nodes ${nodes}",
+                             ("n", my->block_push_peers)("nodes", my->block_push_nodes));
+                        fc::mutable_variant_object node_param;
+                        node_param["block_push_peer_count"] = my->block_push_peers;
+                        node_param["block_push_endpoints"] = my->block_push_nodes;
+                        my->node->set_advanced_node_parameters(node_param);
+                    }
+
                     my->node->listen_to_p2p_network();
                     my->node->connect_to_p2p_network();
                     block_id_type block_id;
@@ -537,7 +602,9 @@ namespace golos {
 
             void p2p_plugin::plugin_shutdown() {
                 ilog("Shutting down P2P Plugin");
-                my->node->close();
+                if (my->node) {
+                    my->node->close();
+                }
                 my->p2p_thread.quit();
                 my->node.reset();
             }
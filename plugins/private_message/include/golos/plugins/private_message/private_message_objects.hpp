@@ -256,4 +256,17 @@ CHAINBASE_SET_INDEX_TYPE(
     golos::plugins::private_message::contact_object, golos::plugins::private_message::contact_index)
 
 CHAINBASE_SET_INDEX_TYPE(
-    golos::plugins::private_message::contact_size_object, golos::plugins::private_message::contact_size_index)
\ No newline at end of file
+    golos::plugins::private_message::contact_size_object, golos::plugins::private_message::contact_size_index)
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::private_message::message_object,
+    (id)(from)(to)(nonce)(from_memo_key)(to_memo_key)(checksum)(encrypted_message)(inbox_create_date)
+    (outbox_create_date)(receive_date)(read_date)(remove_date))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::private_message::settings_object,
+    (id)(owner)(ignore_messages_from_unknown_contact))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::private_message::contact_object,
+    (id)(owner)(contact)(type)(json_metadata)(size))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::private_message::contact_size_object,
+    (id)(owner)(type)(size))
@@ -1,5 +1,6 @@
 #include <golos/plugins/raw_block/plugin.hpp>
 #include <golos/chain/database.hpp>
+#include <golos/chain/block_log.hpp>
 #include <golos/protocol/types.hpp>
 #include <golos/protocol/exceptions.hpp>
 #include <golos/plugins/json_rpc/utility.hpp>
@@ -29,6 +30,25 @@ get_raw_block_r plugin::plugin_impl::get_raw_block(uint32_t block_num) {
     get_raw_block_r result;
     const auto &db = database();
 
+    // irreversible blocks are taken directly from the block log, only their headers are unpacked.
+    //   The block log is locked while the visitor is called, so the data is only copied there,
+    //   and it is encoded after the lock is released.
+    std::string serialized_block;
+    bool is_read = db.get_block_log().read_serialized_block(block_num, [&](const char* data, std::size_t size) {
+        fc::datastream<const char*> ds(data, size);
+        golos::protocol::signed_block_header header;
+        fc::raw::unpack(ds, header);
+
+        serialized_block.assign(data, size);
+        result.block_id = header.id();
+        result.previous = header.previous;
+        result.timestamp = header.timestamp;
+    });
+    if (is_read) {
+        result.raw_block = fc::base64_encode(serialized_block);
+        return result;
+    }
+
     auto block = db.fetch_block_by_number(block_num);
     if (!block.valid()) {
         return result;
@@ -1,6 +1,7 @@
 #include <boost/program_options/options_description.hpp>
 #include <golos/plugins/social_network/social_network.hpp>
 #include <golos/chain/index.hpp>
+#include <golos/chain/pruning.hpp>
 #include <golos/api/vote_state.hpp>
 #include <golos/chain/steem_objects.hpp>
 
@@ -16,6 +17,8 @@
 #include <diff_match_patch.h>
 #include <boost/locale/encoding_utf.hpp>
 
+#include <map>
+
 
 #ifndef DEFAULT_VOTE_LIMIT
 #  define DEFAULT_VOTE_LIMIT 10000
@@ -120,6 +123,17 @@ namespace golos { namespace plugins { namespace social_network {
 
         void on_block(const signed_block& b);
 
+        /**
+         * Clear fields of content older than the depth, starting from the position of the previous call
+         * @return false if the budget was spent
+         */
+        bool clear_content(uint32_t depth, uint32_t& position);
+
+        /**
+         * Check content from the block again, because its fields could be restored
+         */
+        void rewind_content_pruning(uint32_t block_num);
+
         comment_api_object create_comment_api_object(const comment_object& o) const;
 
         const comment_content_object& get_comment_content(const comment_id_type& comment) const;
@@ -137,6 +151,11 @@ namespace golos { namespace plugins { namespace social_network {
         golos::chain::database& db;
         std::unique_ptr<discussion_helper> helper;
         comment_depth_params depth_parameters;
+        golos::chain::block_pruner pruner;
+        // the block number of the next content to check for each depth of fields,
+        //   partially cleared content isn't walked again in each block
+        std::map<uint32_t, uint32_t> content_prune_positions;
+        uint32_t last_block_num = 0;
 
         // variables to temporarily store values through states of operation visitor
         asset author_gbg_payout_value{0, SBD_SYMBOL}; // part of author payout
@@ -330,6 +349,7 @@ namespace golos { namespace plugins { namespace social_network {
                             con.block_number = db.head_block_num();
                         }
                     });
+                    impl.rewind_content_pruning(comment_content->block_number);
                 } else {
                     // Creation case
                     db.create<comment_content_object>([&](comment_content_object& con) {
@@ -463,45 +483,95 @@ namespace golos { namespace plugins { namespace social_network {
     } FC_CAPTURE_AND_RETHROW() }
 
 
-    void social_network::impl::on_block(const signed_block& b) { try {
+    bool social_network::impl::clear_content(uint32_t depth, uint32_t& position) {
         const auto& dp = depth_parameters;
+        const auto head_block_num = db.head_block_num();
+        if (head_block_num <= depth) {
+            return true;
+        }
+        // content of these blocks is older than the depth
+        const auto end_block_num = head_block_num - depth;
 
-        if (dp.need_clear_content()) {
-            const auto& content_idx = db.get_index<comment_content_index>().indices().get<by_block_number>();
+        const auto& content_idx = db.get_index<comment_content_index>().indices().get<by_block_number>();
+        bool has_progress = false;
+        for (auto itr = content_idx.lower_bound(position); itr != content_idx.end();) {
+            auto& content = *itr;
+            if (content.block_number >= end_block_num) {
+                break;
+            }
+            position = content.block_number;
+            if (has_progress && pruner.is_exceeded()) {
+                return false;
+            }
+            ++itr;
+            has_progress = true;
 
-            auto head_block_num = db.head_block_num();
-            for (auto itr = content_idx.begin(); itr != content_idx.end();) {
-                auto& content = *itr;
-                ++itr;
+            auto* comment = db.find<comment_object, by_id>(content.comment);
+            if (nullptr == comment) {
+                db.remove(content);
+                continue;
+            }
 
-                auto* comment = db.find<comment_object, by_id>(content.comment);
-                if (nullptr == comment) {
-                    db.remove(content);
-                    continue;
+            if (comment->mode != archived) {
+                return true;
+            }
+
+            auto delta = head_block_num - content.block_number;
+            if (dp.should_delete_whole_content_object(delta)) {
+                db.remove(content);
+                continue;
+            }
+
+            bool clear_title = dp.has_comment_title_depth && delta > dp.comment_title_depth &&
+                !content.title.empty();
+            bool clear_body = dp.has_comment_body_depth && delta > dp.comment_body_depth &&
+                !content.body.empty();
+            bool clear_json_metadata = dp.has_comment_json_metadata_depth &&
+                delta > dp.comment_json_metadata_depth && !content.json_metadata.empty();
+
+            // partially cleared content stays in the index, it isn't modified again
+            if (!clear_title && !clear_body && !clear_json_metadata) {
+                continue;
+            }
+
+            db.modify(content, [&](comment_content_object& con) {
+                if (clear_title) {
+                    con.title.clear();
+                }
+
+                if (clear_body) {
+                    con.body.clear();
                 }
 
-                auto delta = head_block_num - content.block_number;
-                if (comment->mode == archived && dp.should_delete_part_of_content_object(delta)) {
-                    if (dp.should_delete_whole_content_object(delta)) {
-                        db.remove(content);
-                        continue;
-                    }
+                if (clear_json_metadata) {
+                    con.json_metadata.clear();
+                }
+            });
+        }
+        position = end_block_num;
+        return true;
+    }
 
-                    db.modify(content, [&](comment_content_object& con) {
-                        if (dp.has_comment_title_depth && delta > dp.comment_title_depth) {
-                            con.title.clear();
-                        }
+    void social_network::impl::rewind_content_pruning(uint32_t block_num) {
+        for (auto& position: content_prune_positions) {
+            position.second = std::min(position.second, block_num);
+        }
+    }
 
-                        if (dp.has_comment_body_depth && delta > dp.comment_body_depth) {
-                            con.body.clear();
-                        }
+    void social_network::impl::on_block(const signed_block& b) { try {
+        const auto& dp = depth_parameters;
 
-                        if (dp.has_comment_json_metadata_depth && delta > dp.comment_json_metadata_depth) {
-                            con.json_metadata.clear();
-                        }
-                    });
+        // content restored by switching of forks can be behind the positions
+        if (b.block_num() <= last_block_num) {
+            rewind_content_pruning(0);
+        }
+        last_block_num = b.block_num();
 
-                } else {
+        pruner.start();
+
+        if (dp.need_clear_content()) {
+            for (auto& position: content_prune_positions) {
+                if (!clear_content(position.first, position.second)) {
                     break;
                 }
             }
@@ -511,10 +581,16 @@ namespace golos { namespace plugins { namespace social_network {
             const auto& clu_idx = db.get_index<comment_last_update_index>().indices().get<by_block_number>();
 
             auto head_block_num = db.head_block_num();
+            bool has_progress = false;
             for (auto itr = clu_idx.begin(); itr != clu_idx.end();) {
                 auto& clu = *itr;
                 ++itr;
 
+                if (has_progress && pruner.is_exceeded()) {
+                    break;
+                }
+                has_progress = true;
+
                 auto* comment = db.find<comment_object, by_id>(clu.comment);
                 if (nullptr == comment) {
                     db.remove(clu);
@@ -626,6 +702,16 @@ namespace golos { namespace plugins { namespace social_network {
         if (options.count("set-content-storing-depth-null-after-update")) {
             params.set_null_after_update = options.at("set-content-storing-depth-null-after-update").as<bool>();
         }
+
+        if (params.has_comment_title_depth) {
+            pimpl->content_prune_positions.emplace(params.comment_title_depth, 0);
+        }
+        if (params.has_comment_body_depth) {
+            pimpl->content_prune_positions.emplace(params.comment_body_depth, 0);
+        }
+        if (params.has_comment_json_metadata_depth) {
+            pimpl->content_prune_positions.emplace(params.comment_json_metadata_depth, 0);
+        }
     }
 
     social_network::~social_network() = default;
@@ -21,9 +21,9 @@ namespace golos { namespace plugins { namespace tags {
         std::size_t tags_number_;
         std::size_t tag_max_length_;
 
-        void remove_stats(const tag_object& tag) const;
+        void remove_stats(const tag_object& tag, const comment_rank_object& rank) const;
 
-        void add_stats(const tag_object& tag) const;
+        void add_stats(const tag_object& tag, const comment_rank_object& rank) const;
 
         void remove_tag(const tag_object& tag) const;
 
@@ -31,7 +31,10 @@ namespace golos { namespace plugins { namespace tags {
 
         comment_date get_comment_last_update(const comment_object& comment) const;
 
-        void update_tag(const tag_object&, const comment_object&, double hot, double trending) const;
+        /** updates the rank of the comment and stats of all its tags */
+        void update_rank(const comment_object&, double hot, double trending) const;
+
+        const comment_rank_object& get_or_create_rank(const comment_object&, double hot, double trending) const;
 
         void create_tag(const std::string&, const tag_type, const comment_object&, double hot, double trending) const;
 
@@ -53,19 +53,17 @@ namespace golos { namespace plugins { namespace tags {
         tag_object_type = (TAG_SPACE_ID << 8),
         tag_stats_object_type = (TAG_SPACE_ID << 8) + 1,
         author_tag_stats_object_type = (TAG_SPACE_ID << 8) + 2,
-        language_object_type = (TAG_SPACE_ID << 8) + 3
+        language_object_type = (TAG_SPACE_ID << 8) + 3,
+        comment_rank_object_type = (TAG_SPACE_ID << 8) + 4
     };
 
     /**
      *  The purpose of the tag object is to allow the generation and listing of
-     *  all top level posts by a string tag.  The desired sort orders include:
+     *  all top level posts by a string tag.
      *
-     *  1. created - time of creation
-     *  2. maturing - about to receive a payout
-     *  3. active - last reply the post or any child of the post
-     *  4. netvotes - individual accounts voting for post minus accounts voting against it
-     *
-     *  When ever a comment is modified, all tag_objects for that comment are updated to match.
+     *  It contains only keys, which don't change after creation, so voting doesn't touch tag objects.
+     *  Values for sorting of discussions are the same for all tags of the comment, they are kept
+     *  in the single comment_rank_object.
      */
     class tag_object: public object<tag_object_type, tag_object> {
     public:
@@ -78,24 +76,6 @@ namespace golos { namespace plugins { namespace tags {
 
         tag_name_type name;
         tag_type type = tag_type::tag;
-        time_point_sec created;
-        time_point_sec active;
-        time_point_sec updated;
-        time_point_sec cashout;
-        int64_t net_rshares = 0;
-        int32_t net_votes = 0;
-        int32_t children = 0;
-        double hot = 0;
-        double trending = 0;
-
-        share_type promoted_balance = 0;
-
-        /**
-         *  Used to track the total rshares^2 of all children, this is used for indexing purposes. A discussion
-         *  that has a nested comment of high value should promote the entire discussion so that the comment can
-         *  be reviewed.
-         */
-        fc::uint128_t children_rshares2;
 
         account_object::id_type author;
         comment_object::id_type parent;
@@ -147,98 +127,159 @@ namespace golos { namespace plugins { namespace tags {
                     member<tag_object, tag_type, &tag_object::type>>,
                 composite_key_compare<
                     std::less<tag_name_type>,
-                    std::less<tag_type>>>,
+                    std::less<tag_type>>>>,
+        allocator<tag_object>>;
+
+    /**
+     *  Values for sorting of discussions, one object for the comment with tags.
+     *  The desired sort orders include:
+     *
+     *  1. created - time of creation
+     *  2. maturing - about to receive a payout
+     *  3. active - last reply the post or any child of the post
+     *  4. netvotes - individual accounts voting for post minus accounts voting against it
+     *
+     *  Tags exist only before the end of the cashout window, so the object is removed with the last tag of the comment.
+     */
+    class comment_rank_object: public object<comment_rank_object_type, comment_rank_object> {
+    public:
+        template<typename Constructor, typename Allocator>
+        comment_rank_object(Constructor&& c, allocator<Allocator> a) {
+            c(*this);
+        }
+
+        id_type id;
+
+        time_point_sec created;
+        time_point_sec active;
+        time_point_sec updated;
+        time_point_sec cashout;
+        int64_t net_rshares = 0;
+        int32_t net_votes = 0;
+        int32_t children = 0;
+        double hot = 0;
+        double trending = 0;
+
+        share_type promoted_balance = 0;
+
+        /**
+         *  Used to track the total rshares^2 of all children, this is used for indexing purposes. A discussion
+         *  that has a nested comment of high value should promote the entire discussion so that the comment can
+         *  be reviewed.
+         */
+        fc::uint128_t children_rshares2;
+
+        account_object::id_type author;
+        comment_object::id_type parent;
+        comment_object::id_type comment;
+
+        bool is_post() const {
+            return parent == comment_object::id_type();
+        }
+    };
+
+    using comment_rank_id_type = object_id<comment_rank_object>;
+
+    using comment_rank_index = multi_index_container<
+        comment_rank_object,
+        indexed_by<
+            ordered_unique<
+                tag<by_id>,
+                member<comment_rank_object, comment_rank_object::id_type, &comment_rank_object::id>>,
+            ordered_unique<
+                tag<by_comment>,
+                member<comment_rank_object, comment_object::id_type, &comment_rank_object::comment>>,
             ordered_non_unique<
                 tag<sort::by_created>,
                 composite_key<
-                    tag_object,
-                    member<tag_object, time_point_sec, &tag_object::created>,
-                    member<tag_object, tag_id_type, &tag_object::id> >,
+                    comment_rank_object,
+                    member<comment_rank_object, time_point_sec, &comment_rank_object::created>,
+                    member<comment_rank_object, comment_rank_id_type, &comment_rank_object::id> >,
                 composite_key_compare<
                     std::greater<time_point_sec>,
-                    std::less<tag_id_type>>>,
+                    std::less<comment_rank_id_type>>>,
             ordered_non_unique<
                 tag<sort::by_active>,
                 composite_key<
-                    tag_object,
-                    member<tag_object, time_point_sec, &tag_object::active>,
-                    member<tag_object, tag_id_type, &tag_object::id> >,
+                    comment_rank_object,
+                    member<comment_rank_object, time_point_sec, &comment_rank_object::active>,
+                    member<comment_rank_object, comment_rank_id_type, &comment_rank_object::id> >,
                 composite_key_compare<
                     std::greater<time_point_sec>,
-                    std::less<tag_id_type>>>,
+                    std::less<comment_rank_id_type>>>,
             ordered_non_unique<
                 tag<sort::by_updated>,
                 composite_key<
-                    tag_object,
-                    member<tag_object, time_point_sec, &tag_object::updated>,
-                    member<tag_object, tag_id_type, &tag_object::id> >,
+                    comment_rank_object,
+                    member<comment_rank_object, time_point_sec, &comment_rank_object::updated>,
+                    member<comment_rank_object, comment_rank_id_type, &comment_rank_object::id> >,
                 composite_key_compare<
                     std::greater<time_point_sec>,
-                    std::less<tag_id_type>>>,
+                    std::less<comment_rank_id_type>>>,
             ordered_non_unique<
                 tag<sort::by_promoted>,
                 composite_key<
-                    tag_object,
-                    member<tag_object, share_type, &tag_object::promoted_balance>,
-                    member<tag_object, tag_id_type, &tag_object::id> >,
+                    comment_rank_object,
+                    member<comment_rank_object, share_type, &comment_rank_object::promoted_balance>,
+                    member<comment_rank_object, comment_rank_id_type, &comment_rank_object::id> >,
                 composite_key_compare<
                     std::greater<share_type>,
-                    std::less<tag_id_type>>>,
+                    std::less<comment_rank_id_type>>>,
             ordered_non_unique<
                 tag<sort::by_net_rshares>,
                 composite_key<
-                    tag_object,
-                    member<tag_object, int64_t, &tag_object::net_rshares>,
-                    member<tag_object, tag_id_type, &tag_object::id> >,
+                    comment_rank_object,
+                    member<comment_rank_object, int64_t, &comment_rank_object::net_rshares>,
+                    member<comment_rank_object, comment_rank_id_type, &comment_rank_object::id> >,
                 composite_key_compare<
                     std::greater<int64_t>,
-                    std::less<tag_id_type>>>,
+                    std::less<comment_rank_id_type>>>,
             ordered_non_unique<
                 tag<sort::by_net_votes>,
                 composite_key<
-                    tag_object,
-                    member<tag_object, int32_t, &tag_object::net_votes>,
-                    member<tag_object, tag_id_type, &tag_object::id> >,
+                    comment_rank_object,
+                    member<comment_rank_object, int32_t, &comment_rank_object::net_votes>,
+                    member<comment_rank_object, comment_rank_id_type, &comment_rank_object::id> >,
                 composite_key_compare<
                     std::greater<int32_t>,
-                    std::less<tag_id_type>>>,
+                    std::less<comment_rank_id_type>>>,
             ordered_non_unique<
                 tag<sort::by_children>,
                 composite_key<
-                    tag_object,
-                    member<tag_object, int32_t, &tag_object::children>,
-                    member<tag_object, tag_id_type, &tag_object::id> >,
+                    comment_rank_object,
+                    member<comment_rank_object, int32_t, &comment_rank_object::children>,
+                    member<comment_rank_object, comment_rank_id_type, &comment_rank_object::id> >,
                 composite_key_compare<
                     std::greater<int32_t>,
-                    std::less<tag_id_type>>>,
+                    std::less<comment_rank_id_type>>>,
             ordered_non_unique<
                 tag<sort::by_hot>,
                 composite_key<
-                    tag_object,
-                    member<tag_object, double, &tag_object::hot>,
-                    member<tag_object, tag_id_type, &tag_object::id> >,
+                    comment_rank_object,
+                    member<comment_rank_object, double, &comment_rank_object::hot>,
+                    member<comment_rank_object, comment_rank_id_type, &comment_rank_object::id> >,
                 composite_key_compare<
                     std::greater<double>,
-                    std::less<tag_id_type>>>,
+                    std::less<comment_rank_id_type>>>,
             ordered_non_unique<
                 tag<sort::by_trending>,
                 composite_key<
-                    tag_object,
-                    member<tag_object, double, &tag_object::trending>,
-                    member<tag_object, tag_id_type, &tag_object::id> >,
+                    comment_rank_object,
+                    member<comment_rank_object, double, &comment_rank_object::trending>,
+                    member<comment_rank_object, comment_rank_id_type, &comment_rank_object::id> >,
                 composite_key_compare<
                     std::greater<double>,
-                    std::less<tag_id_type>>>,
+                    std::less<comment_rank_id_type>>>,
             ordered_non_unique<
                 tag<sort::by_cashout>,
                 composite_key<
-                    tag_object,
-                    member<tag_object, time_point_sec, &tag_object::cashout>,
-                    member<tag_object, tag_id_type, &tag_object::id> >,
+                    comment_rank_object,
+                    member<comment_rank_object, time_point_sec, &comment_rank_object::cashout>,
+                    member<comment_rank_object, comment_rank_id_type, &comment_rank_object::id> >,
                 composite_key_compare<
                     std::less<time_point_sec>,
-                    std::less<tag_id_type>>>>,
-        allocator<tag_object>>;
+                    std::less<comment_rank_id_type>>>>,
+        allocator<comment_rank_object>>;
 
 /**
      *  The purpose of this index is to quickly identify how popular various tags by maintaining various sums over
@@ -398,6 +439,9 @@ namespace golos { namespace plugins { namespace tags {
 CHAINBASE_SET_INDEX_TYPE(
     golos::plugins::tags::tag_object, golos::plugins::tags::tag_index)
 
+CHAINBASE_SET_INDEX_TYPE(
+    golos::plugins::tags::comment_rank_object, golos::plugins::tags::comment_rank_index)
+
 CHAINBASE_SET_INDEX_TYPE(
     golos::plugins::tags::tag_stats_object, golos::plugins::tags::tag_stats_index)
 
@@ -411,3 +455,18 @@ CHAINBASE_SET_INDEX_TYPE(
 
 FC_REFLECT((golos::plugins::tags::comment_metadata), (tags)(language))
 
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::tags::tag_object,
+    (id)(name)(type)(author)(parent)(comment))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::tags::comment_rank_object,
+    (id)(created)(active)(updated)(cashout)(net_rshares)(net_votes)(children)(hot)(trending)
+    (promoted_balance)(children_rshares2)(author)(parent)(comment))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::tags::tag_stats_object,
+    (id)(name)(type)(total_children_rshares2)(total_payout)(net_votes)(top_posts)(comments))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::tags::author_tag_stats_object,
+    (id)(author)(name)(type)(total_rewards)(total_posts))
+
+GOLOS_STATE_SNAPSHOT_REFLECT(golos::plugins::tags::language_object,
+    (id)(name))
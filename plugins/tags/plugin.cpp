@@ -12,6 +12,7 @@
 #include <golos/chain/operation_notification.hpp>
 #include <golos/protocol/exceptions.hpp>
 #include <golos/plugins/social_network/social_network.hpp>
+#include <algorithm>
 
 
 namespace golos { namespace plugins { namespace tags {
@@ -64,15 +65,23 @@ namespace golos { namespace plugins { namespace tags {
         template<typename DatabaseIndex, typename DiscussionIndex, typename Fill>
         std::vector<discussion> select_unordered_discussions(discussion_query&, Fill&&) const;
 
-        template<typename Iterator, typename Order, typename Select, typename Exit>
-        void select_discussions(
-            std::set<comment_object::id_type>& id_set,
-            std::vector<discussion>& result,
+        template<typename Visit, typename Fill>
+        std::vector<discussion> select_unordered_discussions(discussion_query&, Visit&&, Fill&&) const;
+
+        const tags::comment_rank_object& get_rank(const tags::comment_rank_object& rank) const {
+            return rank;
+        }
+
+        const tags::comment_rank_object& get_rank(const tags::tag_object& tag) const {
+            return database().get<tags::comment_rank_object, tags::by_comment>(tag.comment);
+        }
+
+        template<typename Select>
+        bool select_discussion(
+            const tags::comment_rank_object& rank,
             const discussion_query& query,
-            Iterator itr, Iterator etr,
             Select&& select,
-            Exit&& exit,
-            Order&& order
+            discussion& d
         ) const;
 
         template<typename DiscussionOrder, typename Selector>
@@ -205,6 +214,7 @@ namespace golos { namespace plugins { namespace tags {
             pimpl->on_operation(note);
         });
         add_plugin_index<tags::tag_index>(db);
+        add_plugin_index<tags::comment_rank_index>(db);
         add_plugin_index<tags::tag_stats_index>(db);
         add_plugin_index<tags::author_tag_stats_index>(db);
         add_plugin_index<tags::language_index>(db);
@@ -310,6 +320,27 @@ namespace golos { namespace plugins { namespace tags {
     std::vector<discussion> tags_plugin::impl::select_unordered_discussions(
         discussion_query& query,
         Fill&& fill
+    ) const {
+        const auto& idx = database().get_index<DatabaseIndex>().indices().template get<DiscussionIndex>();
+        return select_unordered_discussions(
+            query,
+            [&](const auto& account, auto&& select) {
+                for (auto itr = idx.lower_bound(account); itr != idx.end() && itr->account == account; ++itr) {
+                    if (!select(*itr)) {
+                        break;
+                    }
+                }
+            },
+            std::forward<Fill>(fill));
+    }
+
+    template<
+        typename Visit,
+        typename Fill>
+    std::vector<discussion> tags_plugin::impl::select_unordered_discussions(
+        discussion_query& query,
+        Visit&& visit,
+        Fill&& fill
     ) const {
         std::vector<discussion> result;
 
@@ -318,8 +349,6 @@ namespace golos { namespace plugins { namespace tags {
         }
 
         auto& db = database();
-        const auto& idx = db.get_index<DatabaseIndex>().indices().template get<DiscussionIndex>();
-        auto etr = idx.end();
         bool can_add = true;
 
         result.reserve(query.limit);
@@ -331,91 +360,71 @@ namespace golos { namespace plugins { namespace tags {
         }
 
         for (; query.select_authors.end() != aitr && result.size() < query.limit; ++aitr) {
-            auto itr = idx.lower_bound(*aitr);
-            for (; itr != etr && itr->account == *aitr && result.size() < query.limit; ++itr) {
-                if (id_set.count(itr->comment)) {
-                    continue;
+            visit(*aitr, [&](const auto& entry) {
+                if (id_set.count(entry.comment)) {
+                    return true;
                 }
-                id_set.insert(itr->comment);
+                id_set.insert(entry.comment);
 
                 if (query.has_start_comment() && !can_add) {
-                    can_add = (query.is_good_start(itr->comment));
+                    can_add = (query.is_good_start(entry.comment));
                     if (!can_add) {
-                        continue;
+                        return true;
                     }
                 }
 
-                const auto* comment = db.find(itr->comment);
+                const auto* comment = db.find(entry.comment);
                 if (!comment) {
-                    continue;
+                    return true;
                 }
 
                 if ((query.parent_author && *query.parent_author != comment->parent_author) ||
                     (query.parent_permlink && *query.parent_permlink != to_string(comment->parent_permlink))
                 ) {
-                    continue;
+                    return true;
                 }
 
                 discussion d = create_discussion(*comment);
                 if (!query.is_good_tags(d, tags_number, tag_max_length)) {
-                    continue;
+                    return true;
                 }
 
                 fill_discussion(d, query);
-                fill(d, *itr);
+                fill(d, entry);
                 result.push_back(std::move(d));
-            }
+                return result.size() < query.limit;
+            });
         }
         return result;
     }
 
-    template<
-        typename Iterator,
-        typename Order,
-        typename Select,
-        typename Exit>
-    void tags_plugin::impl::select_discussions(
-        std::set<comment_object::id_type>& id_set,
-        std::vector<discussion>& result,
+    template<typename Select>
+    bool tags_plugin::impl::select_discussion(
+        const tags::comment_rank_object& rank,
         const discussion_query& query,
-        Iterator itr, Iterator etr,
         Select&& select,
-        Exit&& exit,
-        Order&& order
+        discussion& d
     ) const {
-        auto& db = database();
-        for (; itr != etr && !exit(*itr); ++itr) {
-            if (id_set.count(itr->comment)) {
-                continue;
-            }
-            id_set.insert(itr->comment);
-
-            if (!query.is_good_parent(itr->parent) || !query.is_good_author(itr->author)) {
-                continue;
-            }
-
-            const auto* comment = db.find(itr->comment);
-            if (!comment) {
-                continue;
-            }
-
-            discussion d = create_discussion(*comment);
-            d.promoted = asset(itr->promoted_balance, SBD_SYMBOL);
+        if (!query.is_good_parent(rank.parent) || !query.is_good_author(rank.author)) {
+            return false;
+        }
 
-            if (!select(d) || !query.is_good_tags(d, tags_number, tag_max_length)) {
-                continue;
-            }
+        const auto* comment = database().find(rank.comment);
+        if (!comment) {
+            return false;
+        }
 
-            fill_discussion(d, query);
-            d.hot = itr->hot;
-            d.trending = itr->trending;
+        d = create_discussion(*comment);
+        d.promoted = asset(rank.promoted_balance, SBD_SYMBOL);
 
-            if (query.has_start_comment() && !query.is_good_start(d.id) && !order(query.start_comment, d)) {
-                continue;
-            }
-
-            result.push_back(std::move(d));
+        if (!select(d) || !query.is_good_tags(d, tags_number, tag_max_length)) {
+            return false;
         }
+
+        fill_discussion(d, query);
+        d.hot = rank.hot;
+        d.trending = rank.trending;
+        return true;
     }
 
     template<
@@ -425,7 +434,7 @@ namespace golos { namespace plugins { namespace tags {
         discussion_query& query,
         Selector&& selector
     ) const {
-        std::vector<discussion> unordered;
+        std::vector<discussion> result;
         auto& db = database();
 
         db.with_weak_read_lock([&]() {
@@ -435,97 +444,100 @@ namespace golos { namespace plugins { namespace tags {
                 return false;
             }
 
-            std::set<comment_object::id_type> id_set;
-            if (query.has_tags_selector()) { // seems to have a least complexity
-                const auto& idx = db.get_index<tags::tag_index>().indices().get<tags::by_tag>();
-                auto etr = idx.end();
-                unordered.reserve(query.select_tags.size() * query.limit);
+            const auto& idx = db.get_index<tags::comment_rank_index>().indices().get<DiscussionOrder>();
+
+            const tags::comment_rank_object* start = nullptr;
+            if (query.has_start_comment()) {
+                start = db.find<tags::comment_rank_object, tags::by_comment>(query.start_comment.id);
+                if (!start) {
+                    return false;
+                }
+            }
 
+            result.reserve(query.limit);
+            auto add = [&](const tags::comment_rank_object& rank) {
+                discussion d;
+                if (!select_discussion(rank, query, selector, d)) {
+                    return false;
+                }
+                result.push_back(std::move(d));
+                return true;
+            };
+
+            if (!query.has_tags_selector() && !query.has_author_selector() && !query.has_language_selector()) {
+                auto itr = start ? idx.iterator_to(*start) : idx.begin();
+                for (; itr != idx.end() && result.size() < query.limit; ++itr) {
+                    add(*itr);
+                }
+                return true;
+            }
+
+            // Ranks of all selected tags are merged in the order of the rank index,
+            //   and only discussions, which get to the result, are created.
+            std::vector<const tags::comment_rank_object*> candidates;
+            auto add_candidates = [&](auto itr, auto etr, auto&& is_end) {
+                for (; itr != etr && !is_end(*itr); ++itr) {
+                    const auto& rank = get_rank(*itr);
+                    if (query.is_good_parent(rank.parent) && query.is_good_author(rank.author)) {
+                        candidates.push_back(&rank);
+                    }
+                }
+            };
+
+            if (query.has_tags_selector()) { // seems to have a least complexity
+                const auto& tidx = db.get_index<tags::tag_index>().indices().get<tags::by_tag>();
                 for (auto& name: query.select_tags) {
-                    select_discussions(
-                        id_set, unordered, query, idx.lower_bound(std::make_tuple(name, tags::tag_type::tag)), etr,
-                        selector,
+                    add_candidates(
+                        tidx.lower_bound(std::make_tuple(name, tags::tag_type::tag)), tidx.end(),
                         [&](const tags::tag_object& tag){
                             return tag.name != name || tag.type != tags::tag_type::tag;
-                        },
-                        DiscussionOrder());
+                        });
                 }
             } else if (query.has_author_selector()) { // a more complexity
-                const auto& idx = db.get_index<tags::tag_index>().indices().get<tags::by_author_comment>();
-                auto etr = idx.end();
-                unordered.reserve(query.select_author_ids.size() * query.limit);
-
+                const auto& aidx = db.get_index<tags::tag_index>().indices().get<tags::by_author_comment>();
                 for (auto& id: query.select_author_ids) {
-                    select_discussions(
-                        id_set, unordered, query, idx.lower_bound(id), etr,
-                        selector,
+                    add_candidates(
+                        aidx.lower_bound(id), aidx.end(),
                         [&](const tags::tag_object& tag){
                             return tag.author != id;
-                        },
-                        DiscussionOrder());
+                        });
                 }
-            } else if (query.has_language_selector()) { // the most complexity
-                const auto& idx = db.get_index<tags::tag_index>().indices().get<tags::by_tag>();
-                auto etr = idx.end();
-                unordered.reserve(query.select_languages.size() * query.limit);
-
+            } else { // the most complexity
+                const auto& tidx = db.get_index<tags::tag_index>().indices().get<tags::by_tag>();
                 for (auto& name: query.select_languages) {
-                    select_discussions(
-                        id_set, unordered, query, idx.lower_bound(std::make_tuple(name, tags::tag_type::language)), etr,
-                        selector,
+                    add_candidates(
+                        tidx.lower_bound(std::make_tuple(name, tags::tag_type::language)), tidx.end(),
                         [&](const tags::tag_object& tag){
                             return tag.name != name || tag.type != tags::tag_type::language;
-                        },
-                        DiscussionOrder());
-                }
-            } else {
-                const auto& indices = db.get_index<tags::tag_index>().indices();
-                const auto& idx = indices.get<DiscussionOrder>();
-                auto itr = idx.begin();
-
-                if (query.has_start_comment()) {
-                    const auto& cidx = indices.get<tags::by_comment>();
-                    const auto citr = cidx.find(query.start_comment.id);
-                    if (citr == cidx.end()) {
-                        return false;
-                    }
-                    query.reset_start_comment();
-                    itr = idx.iterator_to(*citr);
+                        });
                 }
-
-                unordered.reserve(query.limit);
-
-                select_discussions(
-                    id_set, unordered, query, itr, idx.end(), selector,
-                    [&](const tags::tag_object& tag){
-                        return unordered.size() >= query.limit;
-                    },
-                    [&](const auto&, const auto&) {
-                        return true;
-                    });
             }
-            return true;
-        });
 
-        std::vector<discussion> result;
-        if (unordered.empty()) {
-            return result;
-        }
+            const auto& key = idx.key_extractor();
+            const auto comp = idx.key_comp();
+            auto less = [&](const tags::comment_rank_object* l, const tags::comment_rank_object* r) {
+                return comp(key(*l), key(*r));
+            };
 
-        auto it = unordered.begin();
-        const auto et = unordered.end();
-        std::sort(it, et, DiscussionOrder());
+            // the order is strict, so tags of the same comment become neighbors
+            std::sort(candidates.begin(), candidates.end(), less);
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
 
-        if (query.has_start_comment()) {
-            for (; et != it && it->id != query.start_comment.id; ++it);
-            if (et == it) {
-                return result;
+            auto itr = candidates.begin();
+            if (start) {
+                itr = std::lower_bound(candidates.begin(), candidates.end(), start, less);
+                if (itr == candidates.end() || *itr != start) {
+                    return false;
+                }
             }
-        }
 
-        for (uint32_t idx = 0; idx < query.limit && et != it; ++it, ++idx) {
-            result.push_back(std::move(*it));
-        }
+            for (; itr != candidates.end() && result.size() < query.limit; ++itr) {
+                if (!add(**itr) && *itr == start) {
+                    break;
+                }
+            }
+            return true;
+        });
 
         return result;
     }
@@ -557,6 +569,41 @@ namespace golos { namespace plugins { namespace tags {
         });
     }
 
+    struct feed_reblogs_filler final {
+        const golos::chain::database& db;
+
+        void operator()(discussion& d, const follow::feed_object& f) const {
+            d.reblogged_by.assign(f.reblogged_by.begin(), f.reblogged_by.end());
+            d.first_reblogged_by = f.first_reblogged_by;
+            d.first_reblogged_on = f.first_reblogged_on;
+            for (const auto& a : f.reblogged_by) {
+                const auto& blog_idx = db.get_index<follow::blog_index>().indices().get<follow::by_comment>();
+                auto blog_itr = blog_idx.find(std::make_tuple(f.comment, a));
+                d.reblog_entries.emplace_back(
+                    a,
+                    to_string(blog_itr->reblog_title),
+                    to_string(blog_itr->reblog_body),
+                    to_string(blog_itr->reblog_json_metadata)
+                );
+            }
+        }
+
+        void operator()(discussion& d, const follow::blog_object& b) const {
+            if (b.reblogged_on == time_point_sec()) {
+                return;
+            }
+            d.reblogged_by.push_back(b.account);
+            d.first_reblogged_by = b.account;
+            d.first_reblogged_on = b.reblogged_on;
+            d.reblog_entries.emplace_back(
+                b.account,
+                to_string(b.reblog_title),
+                to_string(b.reblog_body),
+                to_string(b.reblog_json_metadata)
+            );
+        }
+    };
+
     DEFINE_API(tags_plugin, get_discussions_by_feed) {
         PLUGIN_API_VALIDATE_ARGS(
             (discussion_query, query)
@@ -570,24 +617,22 @@ namespace golos { namespace plugins { namespace tags {
         GOLOS_ASSERT(db.has_index<follow::feed_index>(), golos::unsupported_api_method,
                 "Node is not running the follow plugin");
 
+        // the feed includes posts of popular authors, which are merged from their blogs
+        auto& follow_plugin = appbase::app().get_plugin<follow::plugin>();
+
         return db.with_weak_read_lock([&]() {
-            return pimpl->select_unordered_discussions<follow::feed_index, follow::by_feed>(
+            return pimpl->select_unordered_discussions(
                 query,
-                [&](discussion& d, const follow::feed_object& f) {
-                    d.reblogged_by.assign(f.reblogged_by.begin(), f.reblogged_by.end());
-                    d.first_reblogged_by = f.first_reblogged_by;
-                    d.first_reblogged_on = f.first_reblogged_on;
-                    for (const auto& a : f.reblogged_by) {
-                        const auto& blog_idx = db.get_index<follow::blog_index>().indices().get<follow::by_comment>();
-                        auto blog_itr = blog_idx.find(std::make_tuple(f.comment, a));
-                        d.reblog_entries.emplace_back(
-                            a,
-                            to_string(blog_itr->reblog_title),
-                            to_string(blog_itr->reblog_body),
-                            to_string(blog_itr->reblog_json_metadata)
-                        );
-                    }
-                });
+                [&](const account_name_type& account, auto&& select) {
+                    follow_plugin.visit_feed(account, 0,
+                        [&](const follow::feed_object& f, uint64_t) {
+                            return select(f);
+                        },
+                        [&](const follow::blog_object& b, uint64_t) {
+                            return select(b);
+                        });
+                },
+                feed_reblogs_filler{db});
         });
     }
 
@@ -920,14 +965,13 @@ namespace golos { namespace plugins { namespace tags {
 
     // Needed for correct work of golos::api::discussion_helper::set_pending_payout and etc api methods
     void fill_promoted(const golos::chain::database& db, discussion & d) {
-        if (!db.has_index<tags::tag_index>()) {
+        if (!db.has_index<tags::comment_rank_index>()) {
             return;
         }
 
-        const auto& cidx = db.get_index<tags::tag_index>().indices().get<tags::by_comment>();
-        auto itr = cidx.lower_bound(d.id);
-        if (itr != cidx.end() && itr->comment == d.id) {
-            d.promoted = asset(itr->promoted_balance, SBD_SYMBOL);
+        const auto* rank = db.find<tags::comment_rank_object, tags::by_comment>(d.id);
+        if (rank) {
+            d.promoted = asset(rank->promoted_balance, SBD_SYMBOL);
         } else {
             d.promoted = asset(0, SBD_SYMBOL);
         }
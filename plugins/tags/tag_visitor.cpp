@@ -60,7 +60,7 @@ namespace golos { namespace plugins { namespace tags {
           tag_max_length_(tag_max_length) {
     }
 
-    void operation_visitor::remove_stats(const tag_object& tag) const {
+    void operation_visitor::remove_stats(const tag_object& tag, const comment_rank_object& rank) const {
         const auto& idx = db_.get_index<tag_stats_index>().indices().get<by_tag>();
         auto itr = idx.find(std::make_tuple(tag.type, tag.name));
         if (itr == idx.end()) {
@@ -70,12 +70,12 @@ namespace golos { namespace plugins { namespace tags {
         bool need_remove = false;
         db_.modify(*itr, [&](tag_stats_object& s) {
             if (tag.parent == comment_object::id_type()) {
-                s.total_children_rshares2 -= tag.children_rshares2;
+                s.total_children_rshares2 -= rank.children_rshares2;
                 s.top_posts--;
             } else {
                 s.comments--;
             }
-            s.net_votes -= tag.net_votes;
+            s.net_votes -= rank.net_votes;
 
             need_remove = (s.top_posts == 0) && (s.comments == 0);
         });
@@ -105,15 +105,15 @@ namespace golos { namespace plugins { namespace tags {
         });
     }
 
-    void operation_visitor::add_stats(const tag_object& tag) const {
+    void operation_visitor::add_stats(const tag_object& tag, const comment_rank_object& rank) const {
         db_.modify(get_stats(tag), [&](tag_stats_object& s) {
             if (tag.parent == comment_object::id_type()) {
-                s.total_children_rshares2 += tag.children_rshares2;
+                s.total_children_rshares2 += rank.children_rshares2;
                 s.top_posts++;
             } else {
                 s.comments++;
             }
-            s.net_votes += tag.net_votes;
+            s.net_votes += rank.net_votes;
         });
     }
 
@@ -130,8 +130,18 @@ namespace golos { namespace plugins { namespace tags {
             }
         }
 
-        remove_stats(tag);
+        const auto comment = tag.comment;
+        const auto* rank = db_.find<comment_rank_object, by_comment>(comment);
+        if (rank) {
+            remove_stats(tag, *rank);
+        }
         db_.remove(tag);
+
+        const auto& comment_idx = db_.get_index<tag_index>().indices().get<by_comment>();
+        auto citr = comment_idx.lower_bound(comment);
+        if (rank && (citr == comment_idx.end() || citr->comment != comment)) {
+            db_.remove(*rank);
+        }
     }
 
     comment_date operation_visitor::get_comment_last_update(const comment_object& comment) const {
@@ -148,13 +158,22 @@ namespace golos { namespace plugins { namespace tags {
         return result;
     }
 
-    void operation_visitor::update_tag(
-        const tag_object& current, const comment_object& comment, double hot, double trending
-    ) const {
+    void operation_visitor::update_rank(const comment_object& comment, double hot, double trending) const {
+        const auto* rank = db_.find<comment_rank_object, by_comment>(comment.id);
+        if (!rank) {
+            return;
+        }
+
+        const auto& comment_idx = db_.get_index<tag_index>().indices().get<by_comment>();
+        const auto first = comment_idx.lower_bound(comment.id);
+        const auto last = comment_idx.upper_bound(comment.id);
         auto cashout_time = db_.calculate_discussion_payout_time(comment);
-        remove_stats(current);
 
-        db_.modify(current, [&](tag_object& obj) {
+        for (auto citr = first; citr != last; ++citr) {
+            remove_stats(*citr, *rank);
+        }
+
+        db_.modify(*rank, [&](comment_rank_object& obj) {
             obj.active = get_comment_last_update(comment).active;
             obj.cashout = cashout_time;
             obj.children = comment.children;
@@ -167,13 +186,19 @@ namespace golos { namespace plugins { namespace tags {
                 obj.promoted_balance = 0;
             }
         });
-        add_stats(current);
+
+        for (auto citr = first; citr != last; ++citr) {
+            add_stats(*citr, *rank);
+        }
     }
 
-    void operation_visitor::create_tag(
-        const std::string& name, const tag_type type, const comment_object& comment, double hot, double trending
+    const comment_rank_object& operation_visitor::get_or_create_rank(
+        const comment_object& comment, double hot, double trending
     ) const {
-        auto author = db_.get_account(comment.author).id;
+        const auto* rank = db_.find<comment_rank_object, by_comment>(comment.id);
+        if (rank) {
+            return *rank;
+        }
 
         comment_object::id_type parent;
         if (comment.parent_author.size()) {
@@ -182,11 +207,10 @@ namespace golos { namespace plugins { namespace tags {
 
         auto com_date = get_comment_last_update(comment);
 
-        const auto& tag_obj = db_.create<tag_object>([&](tag_object& obj) {
-            obj.name = name;
-            obj.type = type;
+        return db_.create<comment_rank_object>([&](comment_rank_object& obj) {
             obj.comment = comment.id;
             obj.parent = parent;
+            obj.author = db_.get_account(comment.author).id;
             obj.created = comment.created;
             obj.active = com_date.active;
             obj.updated = com_date.last_update;
@@ -195,12 +219,26 @@ namespace golos { namespace plugins { namespace tags {
             obj.children = comment.children;
             obj.net_rshares = comment.net_rshares.value;
             obj.children_rshares2 = comment.children_rshares2;
-            obj.author = author;
             obj.hot = hot;
             obj.trending = trending;
         });
+    }
 
-        add_stats(tag_obj);
+    void operation_visitor::create_tag(
+        const std::string& name, const tag_type type, const comment_object& comment, double hot, double trending
+    ) const {
+        const auto& rank = get_or_create_rank(comment, hot, trending);
+        const auto author = rank.author;
+
+        const auto& tag_obj = db_.create<tag_object>([&](tag_object& obj) {
+            obj.name = name;
+            obj.type = type;
+            obj.comment = comment.id;
+            obj.parent = rank.parent;
+            obj.author = author;
+        });
+
+        add_stats(tag_obj, rank);
 
         const auto& idx = db_.get_index<author_tag_stats_index>().indices().get<by_author_tag_posts>();
         auto itr = idx.lower_bound(std::make_tuple(author, type, name));
@@ -274,12 +312,11 @@ namespace golos { namespace plugins { namespace tags {
             }
         }
 
+        update_rank(comment, hot, trending);
+
         for (const auto& name : meta.tags) {
-            auto existing = existing_tags.find(name);
-            if (existing == existing_tags.end()) {
+            if (existing_tags.find(name) == existing_tags.end()) {
                 create_tag(name, tag_type::tag, comment, hot, trending);
-            } else {
-                update_tag(*existing->second, comment, hot, trending);
             }
         }
 
@@ -296,12 +333,8 @@ namespace golos { namespace plugins { namespace tags {
         const auto& comment = db_.get_comment(author, permlink);
         auto hot = calculate_hot(comment.net_rshares, comment.created);
         auto trending = calculate_trending(comment.net_rshares, comment.created);
-        const auto& comment_idx = db_.get_index<tag_index>().indices().get<by_comment>();
 
-        auto citr = comment_idx.lower_bound(comment.id);
-        for (; citr != comment_idx.end() && citr->comment == comment.id; ++citr) {
-            update_tag(*citr, comment, hot, trending);
-        }
+        update_rank(comment, hot, trending);
 
         if (comment.parent_author.size()) {
             update_tags(comment.parent_author, to_string(comment.parent_permlink));
@@ -341,15 +374,13 @@ namespace golos { namespace plugins { namespace tags {
 
                 auto c = db_.find_comment(acnt, perm);
                 if (c && c->parent_author.size() == 0) {
-                    const auto& comment_idx = db_.get_index<tag_index>().indices().get<by_comment>();
-                    auto citr = comment_idx.lower_bound(c->id);
-                    while (citr != comment_idx.end() && citr->comment == c->id) {
-                        db_.modify(*citr, [&](tag_object& t) {
-                            if (t.cashout != fc::time_point_sec::maximum()) {
-                                t.promoted_balance += op.amount.amount;
+                    const auto* rank = db_.find<comment_rank_object, by_comment>(c->id);
+                    if (rank) {
+                        db_.modify(*rank, [&](comment_rank_object& r) {
+                            if (r.cashout != fc::time_point_sec::maximum()) {
+                                r.promoted_balance += op.amount.amount;
                             }
                         });
-                        ++citr;
                     }
                 }
             }
@@ -0,0 +1,324 @@
+#pragma once
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace golos {
+    namespace plugins {
+        namespace webserver {
+
+            enum class request_priority {
+                low,
+                normal,
+                high
+            };
+
+            constexpr std::size_t request_priority_count = 3;
+
+            enum class reject_reason {
+                busy,
+                stopped
+            };
+
+            /**
+             * Executes requests in the small pool of workers in the order of their priorities.
+             *
+             * A request is prepared (parsed and classified) by a worker, so the io thread only queues it.
+             * Preparing doesn't need the database, and it continues while a block is pushed or generated.
+             *
+             * While a block is written, prepared requests are parked in queues instead of blocking workers
+             *   on the database lock, and workers are resumed when the lock is released.
+             * A request is parked no longer than the max park time, even if blocks are written back to back.
+             *
+             * The number of queued requests is limited, new requests are rejected when the limit is reached.
+             *
+             * Requests, which aren't executed when the scheduler is stopped, are cancelled, so their clients get responses.
+             */
+            class request_scheduler final {
+            public:
+                using clock_type = std::chrono::steady_clock;
+                using task_type = std::function<void()>;
+                using prepare_type = std::function<request_priority()>;
+                using is_busy_type = std::function<bool()>;
+
+                struct prepared_request final {
+                    request_priority priority;
+                    task_type task;
+                    // it's called instead of the task, if the scheduler is stopped before the task is executed
+                    task_type cancel;
+                };
+
+                using split_type = std::function<std::vector<prepared_request>()>;
+                using reject_type = std::function<void(reject_reason)>;
+
+                ~request_scheduler() {
+                    stop();
+                }
+
+                /**
+                 * @param max_queue_size the limit of queued requests, 0 - not limited
+                 * @param max_park_time the limit of waiting of a request for the end of block writes, 0 - not limited
+                 * @param is_busy returns true while a block is written, it can be empty
+                 */
+                void start(
+                    uint32_t thread_pool_size, uint32_t max_queue_size,
+                    std::chrono::milliseconds max_park_time, is_busy_type is_busy
+                ) {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        max_queue_size_ = max_queue_size;
+                        max_park_time_ = max_park_time;
+                        is_busy_ = std::move(is_busy);
+                        is_stopping_ = false;
+                    }
+                    for (uint32_t i = 0; i < thread_pool_size; ++i) {
+                        workers_.emplace_back([this]() { run(); });
+                    }
+                }
+
+                void stop() {
+                    std::deque<incoming_request> incoming;
+                    std::array<queue_type, request_priority_count> queues;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        is_stopping_ = true;
+                    }
+                    wakeup_.notify_all();
+                    for (auto &worker: workers_) {
+                        worker.join();
+                    }
+                    workers_.clear();
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        incoming.swap(incoming_);
+                        queues.swap(queues_);
+                        queue_size_ = 0;
+                    }
+                    for (auto &request: incoming) {
+                        if (request.reject) {
+                            execute([&]() { request.reject(reject_reason::stopped); }, "cancelling");
+                        }
+                    }
+                    for (auto &queue: queues) {
+                        for (auto &request: queue) {
+                            execute(request.cancel, "cancelling");
+                        }
+                    }
+                }
+
+                /**
+                 * Post the request, which is split into several requests by a worker, e.g. calls of a batch.
+                 * Each of them is counted by the limit of queued requests and parked as a separate request.
+                 *
+                 * @param reject is called, if the split requests don't fit into the queue, splitting fails,
+                 *   or the scheduler is stopped before splitting
+                 * @return false if the request is rejected because the queue is full or the scheduler is stopped
+                 */
+                bool post(split_type split, reject_type reject) {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if (is_stopping_ || (max_queue_size_ && queue_size_ >= max_queue_size_)) {
+                            return false;
+                        }
+                        incoming_.push_back({std::move(split), std::move(reject)});
+                        ++queue_size_;
+                    }
+                    wakeup_.notify_one();
+                    return true;
+                }
+
+                /**
+                 * @param prepare is called by a worker before queueing of the request by its priority
+                 * @return false if the request is rejected because the queue is full or the scheduler is stopped
+                 */
+                bool post(prepare_type prepare, task_type task, task_type cancel = task_type()) {
+                    return post([prepare, task, cancel]() {
+                        auto priority = request_priority::normal;
+                        try {
+                            priority = prepare();
+                        } catch (const fc::exception &e) {
+                            elog("Error on preparing of request: ${e}", ("e", e.to_detail_string()));
+                        } catch (const std::exception &e) {
+                            elog("Error on preparing of request: ${e}", ("e", e.what()));
+                        } catch (...) {
+                            elog("Unknown error on preparing of request");
+                        }
+                        return std::vector<prepared_request>{{priority, task, cancel}};
+                    }, [cancel](reject_reason) {
+                        if (cancel) {
+                            cancel();
+                        }
+                    });
+                }
+
+                bool post(request_priority priority, task_type task, task_type cancel = task_type()) {
+                    return post([priority]() { return priority; }, std::move(task), std::move(cancel));
+                }
+
+                /**
+                 * Resume parked requests, it's called when the write lock of the database is released
+                 */
+                void resume() {
+                    // the lock prevents losing of the notification by a worker, which is checking the database state
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    wakeup_.notify_all();
+                }
+
+            private:
+                struct incoming_request final {
+                    split_type split;
+                    reject_type reject;
+                };
+
+                struct queued_request final {
+                    task_type task;
+                    task_type cancel;
+                    clock_type::time_point parked_until;
+                };
+
+                static void execute(const task_type &task, const char *action) {
+                    if (!task) {
+                        return;
+                    }
+                    try {
+                        task();
+                    } catch (const fc::exception &e) {
+                        elog("Error on ${a} of request: ${e}", ("a", action)("e", e.to_detail_string()));
+                    } catch (const std::exception &e) {
+                        elog("Error on ${a} of request: ${e}", ("a", action)("e", e.what()));
+                    } catch (...) {
+                        elog("Unknown error on ${a} of request", ("a", action));
+                    }
+                }
+
+                using queue_type = std::deque<queued_request>;
+
+                /**
+                 * @return the queue of the request to execute or nullptr if all requests should be parked,
+                 *   in the last case the deadline is set to the end of parking of the oldest request
+                 */
+                queue_type *select_queue(clock_type::time_point &deadline) {
+                    deadline = clock_type::time_point::max();
+
+                    if (!is_busy_ || !is_busy_()) {
+                        for (auto itr = queues_.rbegin(); itr != queues_.rend(); ++itr) {
+                            if (!itr->empty()) {
+                                return &*itr;
+                            }
+                        }
+                        return nullptr;
+                    }
+
+                    // the front of a queue is its oldest request
+                    auto now = clock_type::now();
+                    for (auto itr = queues_.rbegin(); itr != queues_.rend(); ++itr) {
+                        if (itr->empty()) {
+                            continue;
+                        }
+                        const auto parked_until = itr->front().parked_until;
+                        if (parked_until <= now) {
+                            return &*itr;
+                        }
+                        deadline = std::min(deadline, parked_until);
+                    }
+                    return nullptr;
+                }
+
+                void run() {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    while (!is_stopping_) {
+                        if (!incoming_.empty()) {
+                            auto request = std::move(incoming_.front());
+                            incoming_.pop_front();
+                            lock.unlock();
+
+                            std::vector<prepared_request> requests;
+                            bool is_split = true;
+                            try {
+                                requests = request.split();
+                            } catch (const fc::exception &e) {
+                                elog("Error on preparing of request: ${e}", ("e", e.to_detail_string()));
+                                is_split = false;
+                            } catch (const std::exception &e) {
+                                elog("Error on preparing of request: ${e}", ("e", e.what()));
+                                is_split = false;
+                            } catch (...) {
+                                elog("Unknown error on preparing of request");
+                                is_split = false;
+                            }
+
+                            auto parked_until = clock_type::time_point::max();
+                            if (max_park_time_.count() != 0) {
+                                parked_until = clock_type::now() + max_park_time_;
+                            }
+
+                            lock.lock();
+                            --queue_size_;
+                            if (!is_split || (max_queue_size_ && queue_size_ + requests.size() > max_queue_size_)) {
+                                lock.unlock();
+                                execute([&]() { request.reject(reject_reason::busy); }, "rejecting");
+                                lock.lock();
+                                continue;
+                            }
+                            for (auto &prepared: requests) {
+                                queues_[static_cast<std::size_t>(prepared.priority)].push_back(
+                                    {std::move(prepared.task), std::move(prepared.cancel), parked_until});
+                            }
+                            queue_size_ += requests.size();
+                            if (requests.size() > 1) {
+                                // split requests can be executed by other workers
+                                wakeup_.notify_all();
+                            }
+                            continue;
+                        }
+
+                        clock_type::time_point deadline;
+                        auto queue = select_queue(deadline);
+                        if (queue == nullptr) {
+                            if (deadline == clock_type::time_point::max()) {
+                                wakeup_.wait(lock);
+                            } else {
+                                wakeup_.wait_until(lock, deadline);
+                            }
+                            continue;
+                        }
+
+                        auto task = std::move(queue->front().task);
+                        queue->pop_front();
+                        --queue_size_;
+                        lock.unlock();
+
+                        execute(task, "handling");
+
+                        lock.lock();
+                    }
+                }
+
+                uint32_t max_queue_size_ = 0;
+                std::chrono::milliseconds max_park_time_{0};
+                is_busy_type is_busy_;
+
+                std::mutex mutex_;
+                std::condition_variable wakeup_;
+                std::deque<incoming_request> incoming_;
+                std::array<queue_type, request_priority_count> queues_;
+                // the number of incoming and prepared requests
+                std::size_t queue_size_ = 0;
+                bool is_stopping_ = false;
+
+                std::vector<std::thread> workers_;
+            };
+
+        }
+    }
+} // golos::plugins::webserver
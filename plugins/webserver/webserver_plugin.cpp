@@ -1,4 +1,5 @@
 #include <golos/plugins/webserver/webserver_plugin.hpp>
+#include <golos/plugins/webserver/request_scheduler.hpp>
 
 #include <golos/plugins/chain/plugin.hpp>
 
@@ -6,6 +7,7 @@
 #include <fc/log/logger_config.hpp>
 #include <fc/io/json.hpp>
 #include <fc/network/resolve.hpp>
+#include <fc/variant_object.hpp>
 
 #include <boost/asio.hpp>
 #include <boost/optional.hpp>
@@ -20,6 +22,9 @@
 #include <websocketpp/logger/stub.hpp>
 #include <websocketpp/logger/syslog.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <thread>
 #include <memory>
 #include <iostream>
@@ -76,13 +81,75 @@ namespace golos {
 
             using websocket_server_type = websocketpp::server<asio_with_stub_log>;
 
+            using response_handler_type = plugins::json_rpc::plugin::response_handler_type;
+
+            /**
+             * Body of the request, which is parsed by a worker before queueing, and handlers of its responses
+             */
+            struct webserver_request final {
+                std::string body;
+                fc::optional<fc::variant> value;
+
+                // sends the response of API
+                response_handler_type send;
+                // sends the error, if API throws on parsing of the request
+                std::function<void(const fc::exception &)> send_error;
+                // sends the error, if the request isn't handled, the reason is "busy" or "stopped"
+                std::function<void(const std::string &)> reject;
+
+                void call(plugins::json_rpc::plugin &api) const {
+                    try {
+                        if (value.valid()) {
+                            api.call(*value, send);
+                        } else {
+                            api.call(body, send);
+                        }
+                    } catch (const fc::exception &e) {
+                        send_error(e);
+                    }
+                }
+            };
+
+            /**
+             * Responses of calls of the batch, which are executed as separate requests
+             */
+            struct batch_response final {
+                batch_response(std::size_t size, response_handler_type handler)
+                    : responses(size),
+                      pending(size),
+                      handler(std::move(handler)) {
+                }
+
+                // the response is sent, when the last call completes
+                void complete(std::size_t index, const std::string &response) {
+                    responses[index] = response;
+                    if (--pending != 0) {
+                        return;
+                    }
+
+                    std::string result = "[";
+                    for (std::size_t i = 0; i < responses.size(); ++i) {
+                        if (i != 0) {
+                            result += ',';
+                        }
+                        result += responses[i];
+                    }
+                    result += ']';
+                    handler(result);
+                }
+
+                std::vector<std::string> responses;
+                std::atomic<std::size_t> pending;
+                response_handler_type handler;
+            };
+
             struct webserver_plugin::webserver_plugin_impl final {
             public:
-                boost::thread_group& thread_pool = appbase::app().scheduler();
-                webserver_plugin_impl(thread_pool_size_t thread_pool_size) : thread_pool_work(this->thread_pool_ios) {
-                    for (uint32_t i = 0; i < thread_pool_size; ++i) {
-                        thread_pool.create_thread(boost::bind(&asio::io_service::run, &thread_pool_ios));
-                    }
+                webserver_plugin_impl(
+                    thread_pool_size_t thread_pool_size, uint32_t max_queue_size, std::chrono::milliseconds max_park_time
+                ) : thread_pool_size(thread_pool_size),
+                    max_queue_size(max_queue_size),
+                    max_park_time(max_park_time) {
                 }
 
                 void start_webserver();
@@ -93,6 +160,18 @@ namespace golos {
 
                 void handle_http_message(websocket_server_type *, connection_hdl);
 
+                void parse_request(webserver_request &request) const;
+
+                bool post_request(std::shared_ptr<webserver_request> request);
+
+                std::vector<request_scheduler::prepared_request> split_request(std::shared_ptr<webserver_request> request);
+
+                request_priority get_priority(const webserver_request &request) const;
+
+                request_priority get_priority(const fc::variant &request) const;
+
+                void set_priority(const std::string &value);
+
                 shared_ptr<std::thread> http_thread;
                 asio::io_service http_ios;
                 optional<tcp::endpoint> http_endpoint;
@@ -102,11 +181,17 @@ namespace golos {
                 asio::io_service ws_ios;
                 optional<tcp::endpoint> ws_endpoint;
                 websocket_server_type ws_server;
-                asio::io_service thread_pool_ios;
-                asio::io_service::work thread_pool_work;
+
+                thread_pool_size_t thread_pool_size;
+                uint32_t max_queue_size;
+                std::chrono::milliseconds max_park_time;
+                // priorities of APIs and their methods: "api" or "api.method"
+                map<string, request_priority> priorities;
+                request_scheduler scheduler;
 
                 plugins::json_rpc::plugin *api;
                 boost::signals2::connection chain_sync_con;
+                boost::signals2::scoped_connection block_write_con;
             };
 
             void webserver_plugin::webserver_plugin_impl::start_webserver() {
@@ -173,8 +258,7 @@ namespace golos {
                     http_server.stop_listening();
                 }
 
-                thread_pool_ios.stop();
-                thread_pool.join_all();
+                scheduler.stop();
 
                 if (ws_thread) {
                     ws_ios.stop();
@@ -189,60 +273,198 @@ namespace golos {
                 }
             }
 
+            void webserver_plugin::webserver_plugin_impl::parse_request(webserver_request &request) const {
+                try {
+                    request.value = fc::json::from_string(request.body);
+                } catch (const fc::exception &) {
+                    // json_rpc will respond with the parse error
+                }
+            }
+
+            bool webserver_plugin::webserver_plugin_impl::post_request(std::shared_ptr<webserver_request> request) {
+                // parsing is done by a worker to not delay reading of other requests in the io thread
+                return scheduler.post([request, this]() {
+                    parse_request(*request);
+                    return split_request(request);
+                }, [request](reject_reason reason) {
+                    request->reject(reason == reject_reason::busy ? "busy" : "stopped");
+                });
+            }
+
+            /**
+             * Calls of the batch are queued as separate requests, so they are counted by the limit of queued requests,
+             *   parked while a block is written, and executed in parallel by workers
+             */
+            std::vector<request_scheduler::prepared_request> webserver_plugin::webserver_plugin_impl::split_request(
+                std::shared_ptr<webserver_request> request
+            ) {
+                std::vector<request_scheduler::prepared_request> result;
+
+                if (!request->value.valid() || !request->value->is_array() || request->value->size() < 2) {
+                    result.push_back({get_priority(*request), [request, this]() {
+                        request->call(*api);
+                    }, [request]() {
+                        request->reject("stopped");
+                    }});
+                    return result;
+                }
+
+                const auto &calls = request->value->get_array();
+                auto batch = std::make_shared<batch_response>(calls.size(), request->send);
+                result.reserve(calls.size());
+                for (std::size_t i = 0; i < calls.size(); ++i) {
+                    const auto &call = calls[i];
+                    result.push_back({get_priority(call), [batch, i, &call, request, this]() {
+                        api->call(call, [batch, i](const std::string &response) {
+                            batch->complete(i, response);
+                        });
+                    }, [batch, i, &call, request]() {
+                        fc::mutable_variant_object error;
+                        error("code", JSON_RPC_INTERNAL_ERROR)("message", "Server is stopped");
+                        fc::mutable_variant_object response;
+                        response("jsonrpc", "2.0")("error", error);
+                        response("id", call.is_object() && call.get_object().contains("id") ? call["id"] : fc::variant());
+                        batch->complete(i, fc::json::to_string(response));
+                    }});
+                }
+                return result;
+            }
+
+            request_priority webserver_plugin::webserver_plugin_impl::get_priority(const webserver_request &request) const {
+                if (!request.value.valid()) {
+                    return request_priority::normal;
+                }
+                return get_priority(*request.value);
+            }
+
+            request_priority webserver_plugin::webserver_plugin_impl::get_priority(const fc::variant &request) const {
+                auto result = request_priority::normal;
+
+                if (request.is_array()) {
+                    // the batch of one call isn't split, so it gets the highest priority of its calls
+                    const auto &calls = request.get_array();
+                    if (!calls.empty()) {
+                        result = request_priority::low;
+                        for (const auto &call: calls) {
+                            result = std::max(result, get_priority(call));
+                        }
+                    }
+                    return result;
+                }
+
+                if (!request.is_object()) {
+                    return result;
+                }
+
+                const auto &object = request.get_object();
+                auto params = object.find("params");
+                if (params == object.end() || !params->value().is_array()) {
+                    return result;
+                }
+
+                const auto &args = params->value().get_array();
+                if (args.size() < 2 || !args[0].is_string() || !args[1].is_string()) {
+                    return result;
+                }
+
+                const auto &api_name = args[0].get_string();
+                auto itr = priorities.find(api_name + '.' + args[1].get_string());
+                if (itr == priorities.end()) {
+                    itr = priorities.find(api_name);
+                }
+                if (itr != priorities.end()) {
+                    result = itr->second;
+                }
+                return result;
+            }
+
+            void webserver_plugin::webserver_plugin_impl::set_priority(const std::string &value) {
+                auto pos = value.find('=');
+                FC_ASSERT(pos != std::string::npos && pos != 0,
+                    "webserver-api-priority should be in the form of api=priority or api.method=priority, got ${v}",
+                    ("v", value));
+
+                auto name = value.substr(0, pos);
+                auto priority = value.substr(pos + 1);
+                if (priority == "low") {
+                    priorities[name] = request_priority::low;
+                } else if (priority == "normal") {
+                    priorities[name] = request_priority::normal;
+                } else if (priority == "high") {
+                    priorities[name] = request_priority::high;
+                } else {
+                    FC_THROW("Unknown priority ${p} of ${n}, it should be low, normal or high", ("p", priority)("n", name));
+                }
+            }
+
             void webserver_plugin::webserver_plugin_impl::handle_ws_message(
                 websocket_server_type *server,
                 connection_hdl hdl,
                 websocket_server_type::message_ptr msg
             ) {
                 auto con = server->get_con_from_hdl(hdl);
-                thread_pool_ios.post([con, msg, this]() {
-                    try {
-                        if (msg->get_opcode() == websocketpp::frame::opcode::text) {
-                            api->call(msg->get_payload(), [con](const std::string &data){
-                                auto ec = con->send(data);
-                                if (ec) {
-                                    throw websocketpp::exception(ec);
-                                }
-                            });
-                        } else {
-                            con->send("error: string payload expected");
-                        }
-                    } catch (const fc::exception &e) {
-                        con->send("error calling API " + e.to_string());
+                if (msg->get_opcode() != websocketpp::frame::opcode::text) {
+                    con->send("error: string payload expected");
+                    return;
+                }
+
+                auto request = std::make_shared<webserver_request>();
+                request->body = msg->get_payload();
+                request->send = [con](const std::string &data) {
+                    auto ec = con->send(data);
+                    if (ec) {
+                        throw websocketpp::exception(ec);
                     }
-                });
+                };
+                request->send_error = [con](const fc::exception &e) {
+                    con->send("error calling API " + e.to_string());
+                };
+                request->reject = [con](const std::string &reason) {
+                    con->send("error: server is " + reason);
+                };
+
+                if (!post_request(request)) {
+                    request->reject("busy");
+                }
             }
 
             void webserver_plugin::webserver_plugin_impl::handle_http_message(websocket_server_type *server, connection_hdl hdl) {
                 auto con = server->get_con_from_hdl(hdl);
                 con->defer_http_response();
 
-                thread_pool_ios.post([con, this]() {
-                    auto body = con->get_request_body();
-
+                auto request = std::make_shared<webserver_request>();
+                request->body = con->get_request_body();
+                request->send = [con](const std::string &data) {
+                    // this lambda can be called from any thread in application
+                    //   for example, when task was delegated ( see msg_pack(msg_pack&&) )
+                    con->set_body(data);
+                    con->set_status(websocketpp::http::status_code::ok);
+                    con->send_http_response();
+                };
+                request->send_error = [con](const fc::exception &e) {
+                    // this case happens if exception was thrown on parsing request
+                    edump((e));
+                    con->set_body("Could not call API");
+                    con->set_status(websocketpp::http::status_code::not_found);
+                    // this sending response can't be merged with sending response from try-block
+                    //   because try-block can work from other thread,
+                    //   when catch-block happens in current thread on parsing request
                     try {
-                        api->call(body, [con](const std::string &data){
-                            // this lambda can be called from any thread in application
-                            //   for example, when task was delegated ( see msg_pack(msg_pack&&) )
-                            con->set_body(data);
-                            con->set_status(websocketpp::http::status_code::ok);
-                            con->send_http_response();
-                        });
-                    } catch (fc::exception &e) {
-                        // this case happens if exception was thrown on parsing request
-                        edump((e));
-                        con->set_body("Could not call API");
-                        con->set_status(websocketpp::http::status_code::not_found);
-                        // this sending response can't be merged with sending response from try-block
-                        //   because try-block can work from other thread,
-                        //   when catch-block happens in current thread on parsing request
-                        try {
-                            con->send_http_response();
-                        } catch (...) {
-                            // disable segfault
-                        }
+                        con->send_http_response();
+                    } catch (...) {
+                        // disable segfault
                     }
-                });
+                };
+                // the response is deferred, so it should be sent even if the request isn't handled
+                request->reject = [con](const std::string &reason) {
+                    con->set_body("Server is " + reason);
+                    con->set_status(websocketpp::http::status_code::service_unavailable);
+                    con->send_http_response();
+                };
+
+                if (!post_request(request)) {
+                    request->reject("busy");
+                }
             }
 
             webserver_plugin::webserver_plugin() {
@@ -259,15 +481,37 @@ namespace golos {
                         "Local websocket endpoint for webserver requests.")
                     ("rpc-endpoint", boost::program_options::value<string>(),
                         "Local http and websocket endpoint for webserver requests. Deprectaed in favor of webserver-http-endpoint and webserver-ws-endpoint")
-                    ("webserver-thread-pool-size", boost::program_options::value<thread_pool_size_t>()->default_value(256),
-                        "Number of threads used to handle queries. Default: 256.");
+                    ("webserver-thread-pool-size", boost::program_options::value<thread_pool_size_t>()->default_value(0),
+                        "Number of threads used to handle queries. Default: 0, the number of CPU cores.")
+                    ("webserver-max-queued-requests", boost::program_options::value<uint32_t>()->default_value(10000),
+                        "Maximal number of requests waiting for handling, new requests are rejected when it is reached. "
+                        "If 0, the number isn't limited.")
+                    ("webserver-max-park-time", boost::program_options::value<uint32_t>()->default_value(1000),
+                        "Maximal time in milliseconds of waiting of a request while blocks are pushed or generated, "
+                        "after it the request is handled without waiting for the end of block writes. "
+                        "If 0, the time isn't limited.")
+                    ("webserver-api-priority", boost::program_options::value<std::vector<string>>()->composing()->multitoken(),
+                        "Priority of handling of requests to API or its method: api=priority or api.method=priority, "
+                        "priority is low, normal or high. Default: normal.");
             }
 
             void webserver_plugin::plugin_initialize(const boost::program_options::variables_map &options) {
                 auto thread_pool_size = options.at("webserver-thread-pool-size").as<thread_pool_size_t>();
-                FC_ASSERT(thread_pool_size > 0, "webserver-thread-pool-size must be greater than 0");
-                ilog("configured with ${tps} thread pool size", ("tps", thread_pool_size));
-                my.reset(new webserver_plugin_impl(thread_pool_size));
+                if (thread_pool_size == 0) {
+                    thread_pool_size = std::max(std::thread::hardware_concurrency(), 1u);
+                }
+                auto max_queue_size = options.at("webserver-max-queued-requests").as<uint32_t>();
+                auto max_park_time = options.at("webserver-max-park-time").as<uint32_t>();
+                ilog("configured with ${tps} thread pool size, ${qs} max queued requests and ${pt} ms max park time",
+                    ("tps", thread_pool_size)("qs", max_queue_size)("pt", max_park_time));
+                my.reset(new webserver_plugin_impl(
+                    thread_pool_size, max_queue_size, std::chrono::milliseconds(max_park_time)));
+
+                if (options.count("webserver-api-priority")) {
+                    for (const auto &value: options.at("webserver-api-priority").as<std::vector<string>>()) {
+                        my->set_priority(value);
+                    }
+                }
 
                 if (options.count("webserver-http-endpoint")) {
                     auto http_endpoint = options.at("webserver-http-endpoint").as<string>();
@@ -316,6 +560,18 @@ namespace golos {
                 FC_ASSERT(my->api != nullptr, "Could not find API Register Plugin");
 
                 chain::plugin *chain = appbase::app().find_plugin<chain::plugin>();
+                if (chain != nullptr) {
+                    const auto &db = chain->db();
+                    my->scheduler.start(my->thread_pool_size, my->max_queue_size, my->max_park_time, [&db]() {
+                        return db.is_writing_block();
+                    });
+                    my->block_write_con = chain->db().block_write_unlocked.connect([this]() {
+                        my->scheduler.resume();
+                    });
+                } else {
+                    my->scheduler.start(my->thread_pool_size, my->max_queue_size, my->max_park_time, {});
+                }
+
                 if (chain != nullptr && chain->get_state() != appbase::abstract_plugin::started) {
                     ilog("Waiting for chain plugin to start");
                     my->chain_sync_con = chain->on_sync.connect([this]() {
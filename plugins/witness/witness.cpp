@@ -235,6 +235,8 @@ namespace golos {
                 try {
                     ilog("witness plugin:  plugin_startup() begin");
                     auto &d = pimpl->database();
+                    GOLOS_ASSERT(!pimpl->chain().is_read_only() || (pimpl->_witnesses.empty() && pimpl->_miners.empty()),
+                        golos::unsupported_operation, "Blocks can't be produced in read-only mode");
                     //Start NTP time client
                     golos::time::now();
 
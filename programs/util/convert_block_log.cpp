@@ -0,0 +1,131 @@
+#include <golos/chain/block_log.hpp>
+#include <golos/chain/compressed_block_file.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <iostream>
+
+using golos::chain::block_log;
+using golos::chain::compressed_block_file;
+
+namespace bpo = boost::program_options;
+
+/**
+ * Build the preset dictionary from blocks evenly sampled over the block log
+ */
+std::vector<char> build_dictionary(const block_log& input, uint32_t head_num, uint32_t samples) {
+    std::vector<char> dictionary;
+    if (!samples || !head_num) {
+        return dictionary;
+    }
+
+    const auto sample_size = std::max<std::size_t>(compressed_block_file::max_dictionary_size / samples, 1);
+    const auto step = std::max<uint32_t>(head_num / samples, 1);
+
+    for (uint32_t block_num = 1; block_num <= head_num; block_num += step) {
+        auto block = input.read_block_by_num(block_num);
+        if (!block) {
+            continue;
+        }
+        auto data = fc::raw::pack(*block);
+        data.resize(std::min(data.size(), sample_size));
+        dictionary.insert(dictionary.end(), data.begin(), data.end());
+        if (dictionary.size() >= compressed_block_file::max_dictionary_size) {
+            break;
+        }
+    }
+    return dictionary;
+}
+
+/**
+ * Size of the block log data on disk, the compressed format keeps the positions of chunks
+ *   and the uncompressed tail in secondary files
+ */
+uint64_t get_block_log_size(const boost::filesystem::path& path) {
+    uint64_t size = boost::filesystem::file_size(path);
+    for (const auto& suffix: {".chunks", ".tail"}) {
+        const boost::filesystem::path secondary_path = path.string() + suffix;
+        if (boost::filesystem::is_regular_file(secondary_path)) {
+            size += boost::filesystem::file_size(secondary_path);
+        }
+    }
+    return size;
+}
+
+int main(int argc, char** argv) {
+    try {
+        bpo::options_description options("Convert block log between plain and compressed formats");
+        options.add_options()
+            ("help,h", "Print this help message and exit")
+            ("input,i", bpo::value<std::string>(), "Path to the source block log")
+            ("output,o", bpo::value<std::string>(), "Path to the resulting block log")
+            ("chunk-size", bpo::value<uint32_t>()->default_value(compressed_block_file::default_chunk_size),
+                "Size of uncompressed chunk, bigger chunks compress better, but random reads are slower")
+            ("dictionary-samples", bpo::value<uint32_t>()->default_value(256),
+                "Number of blocks, which are sampled to build the compression dictionary (0 - without dictionary)")
+            ("decompress", bpo::bool_switch()->default_value(false), "Convert compressed block log to the plain format");
+
+        bpo::variables_map args;
+        bpo::store(bpo::parse_command_line(argc, argv, options), args);
+        bpo::notify(args);
+
+        if (args.count("help") || !args.count("input") || !args.count("output")) {
+            std::cerr << options << "\n";
+            return args.count("help") ? 0 : 1;
+        }
+
+        const boost::filesystem::path input_path = args["input"].as<std::string>();
+        const boost::filesystem::path output_path = args["output"].as<std::string>();
+        FC_ASSERT(boost::filesystem::absolute(input_path) != boost::filesystem::absolute(output_path),
+            "Output block log should differ from the input one");
+
+        block_log input;
+        input.open(input_path);
+        const auto head_num = input.head() ? input.head()->block_num() : 0;
+
+        if (args["decompress"].as<bool>()) {
+            compressed_block_file::remove(output_path.string());
+            boost::filesystem::remove_all(output_path.string() + ".index");
+        } else {
+            auto dictionary = build_dictionary(input, head_num, args["dictionary-samples"].as<uint32_t>());
+            ilog("Dictionary size: ${size}", ("size", dictionary.size()));
+            block_log::create_compressed(output_path, args["chunk-size"].as<uint32_t>(), dictionary);
+        }
+
+        block_log output;
+        output.open(output_path);
+        FC_ASSERT(!output.head(), "Output block log isn't empty");
+
+        input.set_sequential_access(true);
+        for (uint32_t block_num = 1; block_num <= head_num; ++block_num) {
+            auto block = input.read_block_by_num(block_num);
+            FC_ASSERT(block, "Block ${block_num} isn't found", ("block_num", block_num));
+            output.append(*block);
+
+            if (block_num % 100000 == 0) {
+                ilog("Converted ${block_num} of ${head_num} blocks", ("block_num", block_num)("head_num", head_num));
+            }
+        }
+        input.set_sequential_access(false);
+
+        output.close();
+        input.close();
+
+        ilog("Done, converted ${head_num} blocks: ${input} (${input_size} bytes) -> ${output} (${output_size} bytes)",
+            ("head_num", head_num)("input", input_path.string())("output", output_path.string())
+            ("input_size", get_block_log_size(input_path))
+            ("output_size", get_block_log_size(output_path)));
+    } catch (const fc::exception& e) {
+        edump((e.to_detail_string()));
+        return 1;
+    } catch (const std::exception& e) {
+        edump((std::string(e.what())));
+        return 1;
+    }
+
+    return 0;
+}
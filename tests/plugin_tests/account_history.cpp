@@ -63,6 +63,67 @@ BOOST_AUTO_TEST_CASE(account_history_blocks) {
     BOOST_CHECK_EQUAL(blocks.size(), HISTORY_BLOCKS);
 }
 
+BOOST_AUTO_TEST_CASE(account_history_sequence) {
+    BOOST_TEST_MESSAGE("Testing: account_history_sequence");
+    initialize({{"history-blocks", "1"}});
+    add_operations();
+
+    // all operations of bob are removed with old blocks
+    generate_blocks(5);
+    msg_pack mp;
+    mp.args = std::vector<fc::variant>({fc::variant("bob"), fc::variant(-1), fc::variant(10)});
+    BOOST_CHECK(ah_plugin->get_account_history(mp).empty());
+
+    // sequence continues after the last removed operation
+    transfer_operation op;
+    op.from = "bob";
+    op.to = "alice";
+    op.amount = ASSET("0.001 GOLOS");
+    signed_transaction tx;
+    GOLOS_CHECK_NO_THROW(push_tx_with_ops(tx, generate_private_key("bob"), op));
+    generate_block();
+
+    auto ops = ah_plugin->get_account_history(mp);
+    BOOST_REQUIRE_EQUAL(ops.size(), 1);
+    BOOST_CHECK_EQUAL(ops.begin()->first, 8);
+}
+
+BOOST_AUTO_TEST_CASE(account_history_failed_block) {
+    BOOST_TEST_MESSAGE("Testing: account_history_failed_block");
+    initialize();
+    add_operations();
+
+    transfer_operation op;
+    op.from = "bob";
+    op.to = "alice";
+
+    // the block fails in the middle of applying, after the pre_apply_block handler
+    signed_block block;
+    block.previous = db->head_block_id();
+    block.timestamp = db->get_slot_time(1);
+    block.witness = db->get_scheduled_witness(1);
+    op.amount = ASSET("1000000.000 GOLOS");
+    signed_transaction bad_tx;
+    sign_tx_with_ops(bad_tx, generate_private_key("bob"), op);
+    block.transactions.push_back(bad_tx);
+    BOOST_CHECK_THROW(db->push_block(block,
+        database::skip_witness_signature | database::skip_merkle_check |
+        database::skip_transaction_signatures | database::skip_authority_check), fc::exception);
+
+    // operations of pending transactions are added at once
+    msg_pack mp;
+    mp.args = std::vector<fc::variant>({fc::variant("bob"), fc::variant(-1), fc::variant(1)});
+    const auto last_sequence = ah_plugin->get_account_history(mp).rbegin()->first;
+
+    op.amount = ASSET("0.001 GOLOS");
+    signed_transaction tx;
+    GOLOS_CHECK_NO_THROW(push_tx_with_ops(tx, generate_private_key("bob"), op));
+
+    auto ops = ah_plugin->get_account_history(mp);
+    BOOST_REQUIRE(!ops.empty());
+    BOOST_CHECK_EQUAL(ops.rbegin()->first, last_sequence + 1);
+    BOOST_CHECK(ops.rbegin()->second.op.which() == operation(op).which());
+}
 
 ///////////////////////////////////////////////////////////////
 // filtering
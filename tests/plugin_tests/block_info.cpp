@@ -0,0 +1,124 @@
+#include <boost/test/unit_test.hpp>
+
+#include "database_fixture.hpp"
+
+#include <golos/plugins/block_info/plugin.hpp>
+#include <golos/plugins/block_info/block_info_store.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+using golos::plugins::json_rpc::msg_pack;
+using golos::plugins::block_info::block_info;
+using golos::plugins::block_info::block_info_store;
+namespace block_info_plugin = golos::plugins::block_info;
+
+struct block_info_fixture : public golos::chain::database_fixture {
+    block_info_fixture() {
+        initialize<block_info_plugin::plugin>({{"data-dir", app_dir.path().string()}});
+        bi_plugin = find_plugin<block_info_plugin::plugin>();
+        open_database();
+        startup();
+    }
+
+    std::vector<block_info> get_block_info(uint32_t start_block_num, uint32_t count) {
+        msg_pack mp;
+        mp.args = std::vector<fc::variant>({fc::variant(start_block_num), fc::variant(count)});
+        return bi_plugin->get_block_info(mp);
+    }
+
+    void generate_irreversible_blocks() {
+        const auto head_block_num = db->head_block_num();
+        while (db->last_non_undoable_block_num() < head_block_num) {
+            generate_block();
+        }
+    }
+
+    fc::temp_directory app_dir{golos::utilities::temp_directory_path()};
+    block_info_plugin::plugin* bi_plugin = nullptr;
+};
+
+BOOST_FIXTURE_TEST_SUITE(block_info_plugin_tests, block_info_fixture)
+
+BOOST_AUTO_TEST_CASE(block_info_of_applied_blocks) {
+    BOOST_TEST_MESSAGE("Testing: block_info_of_applied_blocks");
+
+    generate_blocks(5);
+
+    const auto head_block_num = db->head_block_num();
+    const auto infos = get_block_info(1, head_block_num + 10);
+    BOOST_REQUIRE_EQUAL(infos.size(), head_block_num);
+
+    const auto& dgpo = db->get_dynamic_global_properties();
+    const auto& head_info = infos.back();
+    BOOST_CHECK(head_info.block_id == db->head_block_id());
+    BOOST_CHECK_EQUAL(head_info.block_size, fc::raw::pack_size(*db->fetch_block_by_number(head_block_num)));
+    BOOST_CHECK_EQUAL(head_info.aslot, dgpo.current_aslot);
+    BOOST_REQUIRE(head_info.last_irreversible_block_num.valid());
+    BOOST_CHECK_EQUAL(*head_info.last_irreversible_block_num, dgpo.last_irreversible_block_num);
+    BOOST_REQUIRE(head_info.num_pow_witnesses.valid());
+    BOOST_CHECK_EQUAL(*head_info.num_pow_witnesses, dgpo.num_pow_witnesses);
+}
+
+BOOST_AUTO_TEST_CASE(block_info_rebuild) {
+    BOOST_TEST_MESSAGE("Testing: block_info_rebuild");
+
+    generate_blocks(5);
+    generate_irreversible_blocks();
+    const auto last_block_num = db->get_block_log().head()->block_num();
+    const auto applied_infos = get_block_info(1, last_block_num);
+
+    fc::temp_directory dir(golos::utilities::temp_directory_path());
+    block_info_store store;
+    store.open(dir.path() / "block_info.index");
+    store.rebuild(db->get_block_log(), 3);
+
+    for (uint32_t block_num = 1; block_num <= last_block_num; ++block_num) {
+        const auto& applied = applied_infos[block_num - 1];
+        const auto rebuilt = store.get(block_num);
+        BOOST_CHECK(rebuilt.block_id == applied.block_id);
+        BOOST_CHECK_EQUAL(rebuilt.block_size, applied.block_size);
+        BOOST_CHECK_EQUAL(rebuilt.aslot, applied.aslot);
+
+        // they can't be known without the chain state of the block
+        BOOST_CHECK(!rebuilt.last_irreversible_block_num.valid());
+        BOOST_CHECK(!rebuilt.num_pow_witnesses.valid());
+    }
+    BOOST_CHECK_EQUAL(store.get(last_block_num + 1).block_size, 0);
+
+    // blocks with records aren't rebuilt
+    auto info = store.get(1);
+    info.last_irreversible_block_num = 1;
+    store.put(1, info);
+    store.rebuild(db->get_block_log(), 3);
+    BOOST_CHECK(store.get(1).last_irreversible_block_num.valid());
+}
+
+BOOST_AUTO_TEST_CASE(block_info_truncate) {
+    BOOST_TEST_MESSAGE("Testing: block_info_truncate");
+
+    fc::temp_directory dir(golos::utilities::temp_directory_path());
+    block_info_store store;
+    store.open(dir.path() / "block_info.index");
+
+    block_info info;
+    info.block_size = 100;
+    const uint32_t far_block_num = 1000000;
+    store.put(10, info);
+    store.put(11, info);
+    store.put(far_block_num, info);
+
+    store.truncate(10);
+    BOOST_CHECK_EQUAL(store.get(10).block_size, 100);
+    BOOST_CHECK_EQUAL(store.get(11).block_size, 0);
+    BOOST_CHECK_EQUAL(store.get(far_block_num).block_size, 0);
+
+    // the wiped state has no blocks
+    store.truncate(0);
+    BOOST_CHECK_EQUAL(store.get(10).block_size, 0);
+
+    store.close();
+    store.open(dir.path() / "block_info.index");
+    BOOST_CHECK_EQUAL(store.get(10).block_size, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -8,6 +8,8 @@
 #include <golos/chain/account_object.hpp>
 #include <golos/plugins/chain/plugin.hpp>
 
+#include <mutex>
+
 using golos::protocol::comment_operation;
 using golos::protocol::vote_operation;
 using golos::protocol::public_key_type;
@@ -286,4 +288,68 @@ BOOST_AUTO_TEST_CASE(clear_votes_older_n_smaller_cashout) {
 
 BOOST_AUTO_TEST_SUITE_END() // clear_votes
 
+BOOST_AUTO_TEST_SUITE(notification_bus)
+
+struct received_blocks {
+    std::mutex mutex;
+    std::vector<uint32_t> blocks;
+    bool has_operations = true;
+
+    void on_block(const golos::chain::block_notification& note) {
+        std::lock_guard<std::mutex> lock(mutex);
+        blocks.push_back(note.block_num);
+        has_operations &= note.block.block_num() == note.block_num && !note.operations.empty();
+    }
+
+    std::size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return blocks.size();
+    }
+};
+
+void check_received_blocks(received_blocks& received, uint32_t first, uint32_t count) {
+    BOOST_CHECK_EQUAL(received.blocks.size(), count);
+    for (uint32_t i = 0; i < received.blocks.size(); ++i) {
+        BOOST_CHECK_EQUAL(received.blocks[i], first + i);
+    }
+    // producer_reward is in each block
+    BOOST_CHECK(received.has_operations);
+}
+
+BOOST_AUTO_TEST_CASE(sync_notifications) {
+    BOOST_TEST_MESSAGE("Testing: sync_notifications");
+    initialize();
+
+    received_blocks received;
+    boost::signals2::scoped_connection conn = ch_plugin->notification_bus().on_irreversible_block.connect(
+        [&](const golos::chain::block_notification& note) { received.on_block(note); });
+
+    auto first = db->last_non_undoable_block_num() + 1;
+    generate_blocks(5);
+    auto count = db->last_non_undoable_block_num() + 1 - first;
+    BOOST_CHECK_GT(count, 0);
+    check_received_blocks(received, first, count);
+}
+
+BOOST_AUTO_TEST_CASE(async_notifications) {
+    BOOST_TEST_MESSAGE("Testing: async_notifications");
+    initialize();
+
+    received_blocks received;
+    boost::signals2::scoped_connection conn = ch_plugin->notification_bus().on_irreversible_block.connect(
+        [&](const golos::chain::block_notification& note) { received.on_block(note); });
+    ch_plugin->notification_bus().start(true, 2);
+
+    auto first = db->last_non_undoable_block_num() + 1;
+    generate_blocks(10);
+    auto count = db->last_non_undoable_block_num() + 1 - first;
+
+    // stop waits for handling of queued blocks
+    ch_plugin->notification_bus().stop();
+    BOOST_CHECK(!ch_plugin->notification_bus().is_async());
+    check_received_blocks(received, first, count);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // notification_bus
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -37,6 +37,64 @@ struct follow_fixture : public golos::chain::database_fixture {
     }
 };
 
+struct follow_pull_fixture : public golos::chain::database_fixture {
+    follow_pull_fixture() : golos::chain::database_fixture() {
+        initialize<golos::plugins::follow::plugin>({{"follow-feed-push-max-followers", "1"}});
+        open_database();
+        startup();
+    }
+
+    void follow(
+        const std::string& follower, const fc::ecc::private_key& key, const std::string& following,
+        const std::set<std::string>& what = {"blog"}
+    ) {
+        follow_operation op;
+        op.follower = follower;
+        op.following = following;
+        op.what = what;
+
+        boost::container::vector<follow_plugin_operation> vec;
+        vec.push_back(op);
+
+        custom_binary_operation cop;
+        cop.required_posting_auths.insert(follower);
+        cop.id = "follow";
+        cop.data = fc::raw::pack(vec);
+
+        signed_transaction tx;
+        BOOST_CHECK_NO_THROW(push_tx_with_ops(tx, key, cop));
+    }
+
+    void post(const std::string& author, const fc::ecc::private_key& key, const std::string& permlink) {
+        comment_operation op;
+        op.author = author;
+        op.permlink = permlink;
+        op.parent_author = "";
+        op.parent_permlink = "ipsum";
+        op.title = "Lorem Ipsum";
+        op.body = "Lorem ipsum dolor sit amet";
+        op.json_metadata = "{}";
+
+        signed_transaction tx;
+        BOOST_CHECK_NO_THROW(push_tx_with_ops(tx, key, op));
+    }
+
+    std::vector<feed_entry> get_feed_entries(const std::string& account, uint64_t entry_id, uint32_t limit) {
+        auto* follow_plugin = appbase::app().find_plugin<golos::plugins::follow::plugin>();
+        msg_pack mp;
+        mp.args = std::vector<fc::variant>({fc::variant(account), fc::variant(entry_id), fc::variant(limit)});
+        return follow_plugin->get_feed_entries(mp);
+    }
+
+    std::vector<std::string> get_feed_permlinks(const std::string& account) {
+        std::vector<std::string> result;
+        for (const auto& entry: get_feed_entries(account, 0, 100)) {
+            result.push_back(entry.permlink);
+        }
+        return result;
+    }
+};
+
 
 BOOST_FIXTURE_TEST_SUITE(follow_plugin, follow_fixture)
 
@@ -199,4 +257,128 @@ BOOST_AUTO_TEST_CASE(reblog_apply) {
 
 }
 
+BOOST_FIXTURE_TEST_CASE(pulled_feed, follow_pull_fixture) {
+    BOOST_TEST_MESSAGE("Testing: pulled_feed");
+
+    ACTORS((alice)(bob)(carol));
+
+    generate_blocks(60 / STEEMIT_BLOCK_INTERVAL);
+
+    follow("alice", alice_private_key, "bob");
+    follow("carol", carol_private_key, "bob");
+    follow("alice", alice_private_key, "carol");
+    generate_block();
+
+    auto* follow_plugin = appbase::app().find_plugin<golos::plugins::follow::plugin>();
+    BOOST_CHECK(follow_plugin->is_pulled_to_feeds(account_name_type("bob")));
+    BOOST_CHECK(!follow_plugin->is_pulled_to_feeds(account_name_type("carol")));
+
+    post("bob", bob_private_key, "first");
+    generate_block();
+    post("carol", carol_private_key, "second");
+    generate_block();
+
+    BOOST_TEST_MESSAGE("--- posts of the pulled author aren't copied to feeds");
+    const auto& feed_idx = db->get_index<feed_index>().indices().get<by_feed>();
+    const account_name_type alice_name("alice");
+    auto itr = feed_idx.lower_bound(alice_name);
+    BOOST_REQUIRE(itr != feed_idx.end() && itr->account == alice_name);
+    BOOST_CHECK_EQUAL(std::string(db->get(itr->comment).author), "carol");
+    ++itr;
+    BOOST_CHECK(itr == feed_idx.end() || itr->account != alice_name);
+
+    BOOST_TEST_MESSAGE("--- posts of the pulled author are merged into feeds by time");
+    msg_pack mp;
+    mp.args = std::vector<fc::variant>({fc::variant("alice"), fc::variant(0), fc::variant(10)});
+    auto entries = follow_plugin->get_feed_entries(mp);
+    BOOST_REQUIRE_EQUAL(entries.size(), 2);
+    BOOST_CHECK_EQUAL(entries[0].author, "carol");
+    BOOST_CHECK_EQUAL(entries[1].author, "bob");
+    BOOST_CHECK_GT(entries[0].entry_id, entries[1].entry_id);
+
+    BOOST_TEST_MESSAGE("--- the next page starts from the entry id");
+    mp.args = std::vector<fc::variant>({fc::variant("alice"), fc::variant(entries[1].entry_id), fc::variant(10)});
+    entries = follow_plugin->get_feed_entries(mp);
+    BOOST_REQUIRE_EQUAL(entries.size(), 1);
+    BOOST_CHECK_EQUAL(entries[0].author, "bob");
+}
+
+BOOST_FIXTURE_TEST_CASE(pulled_feed_threshold_crossing, follow_pull_fixture) {
+    BOOST_TEST_MESSAGE("Testing: pulled_feed_threshold_crossing");
+
+    ACTORS((alice)(bob)(carol));
+
+    generate_blocks(60 / STEEMIT_BLOCK_INTERVAL);
+
+    auto* follow_plugin = appbase::app().find_plugin<golos::plugins::follow::plugin>();
+    const account_name_type carol_name("carol");
+
+    follow("alice", alice_private_key, "carol");
+    generate_block();
+    BOOST_CHECK(!follow_plugin->is_pulled_to_feeds(carol_name));
+
+    BOOST_TEST_MESSAGE("--- the post is copied to the feed while the author has few followers");
+    post("carol", carol_private_key, "pushed");
+    generate_blocks(STEEMIT_MIN_ROOT_COMMENT_INTERVAL.to_seconds() / STEEMIT_BLOCK_INTERVAL);
+
+    BOOST_TEST_MESSAGE("--- the author becomes pulled, its copied post stays in the feed once");
+    follow("bob", bob_private_key, "carol");
+    generate_block();
+    BOOST_CHECK(follow_plugin->is_pulled_to_feeds(carol_name));
+    BOOST_CHECK(get_feed_permlinks("alice") == std::vector<std::string>({"pushed"}));
+
+    post("carol", carol_private_key, "pulled");
+    generate_blocks(STEEMIT_MIN_ROOT_COMMENT_INTERVAL.to_seconds() / STEEMIT_BLOCK_INTERVAL);
+    BOOST_CHECK(get_feed_permlinks("alice") == std::vector<std::string>({"pulled", "pushed"}));
+
+    BOOST_TEST_MESSAGE("--- the author has few followers again, but its pulled post isn't lost");
+    follow("bob", bob_private_key, "carol", {});
+    generate_block();
+    BOOST_CHECK(follow_plugin->is_pulled_to_feeds(carol_name));
+    BOOST_CHECK(get_feed_permlinks("alice") == std::vector<std::string>({"pulled", "pushed"}));
+
+    post("carol", carol_private_key, "third");
+    generate_block();
+    BOOST_CHECK(get_feed_permlinks("alice") == std::vector<std::string>({"third", "pulled", "pushed"}));
+    BOOST_CHECK(get_feed_permlinks("bob").empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(pulled_feed_same_time_entries, follow_pull_fixture) {
+    BOOST_TEST_MESSAGE("Testing: pulled_feed_same_time_entries");
+
+    ACTORS((alice)(bob)(carol)(dave)(erin));
+
+    generate_blocks(60 / STEEMIT_BLOCK_INTERVAL);
+
+    // bob and dave are pulled, erin is pushed
+    follow("alice", alice_private_key, "bob");
+    follow("carol", carol_private_key, "bob");
+    follow("alice", alice_private_key, "dave");
+    follow("carol", carol_private_key, "dave");
+    follow("alice", alice_private_key, "erin");
+    generate_block();
+
+    post("bob", bob_private_key, "bob-post");
+    post("erin", erin_private_key, "erin-post");
+    post("dave", dave_private_key, "dave-post");
+    generate_block();
+
+    BOOST_TEST_MESSAGE("--- entries of the same time have different ids");
+    const auto entries = get_feed_entries("alice", 0, 10);
+    BOOST_REQUIRE_EQUAL(entries.size(), 3);
+    BOOST_CHECK_GT(entries[0].entry_id, entries[1].entry_id);
+    BOOST_CHECK_GT(entries[1].entry_id, entries[2].entry_id);
+
+    BOOST_TEST_MESSAGE("--- pages of one entry don't skip or repeat entries");
+    uint64_t entry_id = 0;
+    for (const auto& expected: entries) {
+        const auto page = get_feed_entries("alice", entry_id, 1);
+        BOOST_REQUIRE_EQUAL(page.size(), 1);
+        BOOST_CHECK_EQUAL(page[0].permlink, expected.permlink);
+        BOOST_CHECK_EQUAL(page[0].entry_id, expected.entry_id);
+        entry_id = page[0].entry_id - 1;
+    }
+    BOOST_CHECK(get_feed_entries("alice", entry_id, 1).empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -10,16 +10,32 @@
 
 #include "database_fixture.hpp"
 
+#include <chrono>
+#include <future>
+#include <thread>
+
 using namespace golos::chain;
 using namespace golos::protocol;
 
 typedef golos::plugins::json_rpc::plugin json_rpc_plugin;
 
+namespace test_plugin {
+    struct reward_object {
+        std::string account;
+        share_type amount;
+        fc::optional<share_type> bonus;
+    };
+} // namespace test_plugin
+
+FC_REFLECT((test_plugin::reward_object), (account)(amount)(bonus))
+
 namespace test_plugin {
 
     using golos::plugins::json_rpc::msg_pack;
 
     DEFINE_API_ARGS(throw_exception, msg_pack, std::string)
+    DEFINE_API_ARGS(delayed_echo, msg_pack, std::string)
+    DEFINE_STREAMED_API_ARGS(get_streamed, msg_pack, std::vector<std::string>)
 
     class testing_api final : public appbase::plugin<testing_api> {
     public:
@@ -47,7 +63,7 @@ namespace test_plugin {
 
         void plugin_shutdown() override { }
 
-        DECLARE_API((throw_exception))
+        DECLARE_API((throw_exception)(delayed_echo)(get_streamed))
     };
 
     DEFINE_API(testing_api, throw_exception) {
@@ -82,6 +98,17 @@ namespace test_plugin {
 
         throw "Internal error";
     }
+
+    DEFINE_API(testing_api, delayed_echo) {
+        auto value = args.args->at(0).get_string();
+        auto delay = args.args->at(1).as<uint32_t>();
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        return value;
+    }
+
+    DEFINE_API(testing_api, get_streamed) {
+        return std::vector<std::string>({"first", "second"});
+    }
 } // namespace test_plugin
 
 fc::variant call(json_rpc_plugin& plugin, const std::string& request) {
@@ -289,6 +316,178 @@ BOOST_FIXTURE_TEST_SUITE(json_rpc, database_fixture)
                 check_error_response(response, fc::variant(1u), JSON_RPC_INTERNAL_ERROR);
             });
 
+            BOOST_TEST_MESSAGE("--- streamed result");
+            BOOST_CHECK_NO_THROW({
+                auto response = call(rpc_plugin, "{\"id\":1, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                        "\"testing_api\",\"get_streamed\",[]]}").get_object();
+                BOOST_CHECK_EQUAL(response["jsonrpc"].get_string(), "2.0");
+                BOOST_CHECK_EQUAL(response["id"].as_string(), "1");
+                BOOST_CHECK(!response.contains("error"));
+                auto result = response["result"].as<std::vector<std::string>>();
+                BOOST_REQUIRE_EQUAL(result.size(), 2);
+                BOOST_CHECK_EQUAL(result[0], "first");
+                BOOST_CHECK_EQUAL(result[1], "second");
+            });
+
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(json_rpc_parallel_batch) {
+        try {
+            BOOST_TEST_MESSAGE("Testing: json_rpc_parallel_batch");
+
+            initialize();
+
+            auto &rpc_plugin  = appbase::app().register_plugin<json_rpc_plugin>();
+            auto &testing_api = appbase::app().register_plugin<test_plugin::testing_api>();
+
+            {
+                boost::program_options::options_description desc;
+                rpc_plugin.set_program_options(desc, desc);
+
+                const char* argv[] = {"test", "--rpc-batch-thread-pool-size", "4"};
+                boost::program_options::variables_map options;
+                boost::program_options::store(parse_command_line(3, (char**)argv, desc), options);
+                rpc_plugin.plugin_initialize(options);
+            }
+            {
+                boost::program_options::variables_map options;
+                testing_api.plugin_initialize(options);
+            }
+
+            open_database();
+
+            startup();
+            rpc_plugin.plugin_startup();
+            testing_api.plugin_startup();
+
+            // the response is sent from a thread of the pool, when the last call of the batch completes
+            auto call_batch = [&](const std::string& request) {
+                auto promise = std::make_shared<std::promise<std::string>>();
+                auto future = promise->get_future();
+                rpc_plugin.call(request, [promise](const std::string& str) {promise->set_value(str);});
+                BOOST_REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+                return fc::json::from_string(future.get());
+            };
+
+            BOOST_TEST_MESSAGE("--- responses are in the order of calls, while calls complete in the reverse order");
+            BOOST_CHECK_NO_THROW({
+                std::string request = "[";
+                const uint32_t count = 8;
+                for (uint32_t i = 0; i < count; ++i) {
+                    request += (i ? "," : "") + std::string("{\"id\":") + std::to_string(i) +
+                        ", \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                        "\"testing_api\",\"delayed_echo\",[\"" + std::to_string(i) + "\"," +
+                        std::to_string((count - i) * 20) + "]]}";
+                }
+                request += "]";
+
+                auto responses = call_batch(request).get_array();
+                BOOST_REQUIRE_EQUAL(responses.size(), count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    BOOST_CHECK_EQUAL(responses[i]["id"].as<uint32_t>(), i);
+                    BOOST_CHECK_EQUAL(responses[i]["result"].as_string(), std::to_string(i));
+                }
+            });
+
+            BOOST_TEST_MESSAGE("--- errors and results are mixed in one batch");
+            BOOST_CHECK_NO_THROW({
+                auto responses = call_batch("["
+                    "{\"id\":1, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                        "\"testing_api\",\"delayed_echo\",[\"first\",50]]},"
+                    "{\"id\":2, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                        "\"testing_api\",\"throw_exception\",[\"invalid_parameter\"]]},"
+                    "{\"id\":3, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                        "\"missing_api\",\"missing_method\"]},"
+                    "{\"id\":4, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                        "\"testing_api\",\"delayed_echo\",[\"fourth\",0]]},"
+                    "{\"id\":5, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                        "\"testing_api\",\"throw_exception\",[\"...\"]]}"
+                    "]").get_array();
+
+                BOOST_REQUIRE_EQUAL(responses.size(), 5);
+                BOOST_CHECK_EQUAL(responses[0]["id"].as_string(), "1");
+                BOOST_CHECK_EQUAL(responses[0]["result"].as_string(), "first");
+                check_error_response(responses[1], fc::variant(2u), SERVER_INVALID_PARAMETER, "invalid_parameter");
+                check_error_response(responses[2], fc::variant(3u), JSON_RPC_METHOD_NOT_FOUND);
+                BOOST_CHECK_EQUAL(responses[3]["id"].as_string(), "4");
+                BOOST_CHECK_EQUAL(responses[3]["result"].as_string(), "fourth");
+                BOOST_CHECK(!responses[3].get_object().contains("error"));
+                check_error_response(responses[4], fc::variant(5u), JSON_RPC_INTERNAL_ERROR);
+            });
+
+            BOOST_TEST_MESSAGE("--- calls, which are queued on shutdown, are executed and the response is sent");
+            {
+                std::string request = "[";
+                const uint32_t count = 16;
+                for (uint32_t i = 0; i < count; ++i) {
+                    request += (i ? "," : "") + std::string("{\"id\":") + std::to_string(i) +
+                        ", \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                        "\"testing_api\",\"delayed_echo\",[\"" + std::to_string(i) + "\",50]]}";
+                }
+                request += "]";
+
+                auto promise = std::make_shared<std::promise<std::string>>();
+                auto future = promise->get_future();
+                rpc_plugin.call(request, [promise](const std::string& str) {promise->set_value(str);});
+                rpc_plugin.plugin_shutdown();
+
+                BOOST_REQUIRE(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+                auto responses = fc::json::from_string(future.get()).get_array();
+                BOOST_REQUIRE_EQUAL(responses.size(), count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    BOOST_CHECK_EQUAL(responses[i]["result"].as_string(), std::to_string(i));
+                }
+            }
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(json_writer_test) {
+        try {
+            BOOST_TEST_MESSAGE("Testing: json_writer");
+
+            using golos::plugins::json_rpc::json_writer;
+
+            transfer_operation op;
+            op.from = "alice";
+            op.to = "bob";
+            op.amount = ASSET("1.000 GOLOS");
+            op.memo = "\"memo\"\n\t\\";
+
+            signed_transaction tx;
+            tx.ref_block_num = 65535;
+            tx.ref_block_prefix = 0xffffffff;
+            tx.expiration = fc::time_point_sec(1234567890);
+            tx.operations.push_back(op);
+            tx.signatures.emplace_back();
+
+            signed_block block;
+            block.timestamp = fc::time_point_sec(1234567890);
+            block.witness = "alice";
+            block.transactions.push_back(tx);
+
+            BOOST_TEST_MESSAGE("--- reflected objects");
+            BOOST_CHECK_EQUAL(json_writer().write(block).str(), fc::json::to_string(fc::variant(block)));
+
+            BOOST_TEST_MESSAGE("--- optional values");
+            fc::optional<signed_block> empty_block;
+            BOOST_CHECK_EQUAL(json_writer().write(empty_block).str(), fc::json::to_string(fc::variant(empty_block)));
+
+            BOOST_TEST_MESSAGE("--- reflected types with own to_variant");
+            test_plugin::reward_object reward;
+            reward.account = "alice";
+            reward.amount = 5000000000;
+            reward.bonus = share_type(-10);
+            BOOST_CHECK_EQUAL(json_writer().write(reward).str(), fc::json::to_string(fc::variant(reward)));
+            BOOST_CHECK_EQUAL(json_writer().write(reward.amount).str(), fc::json::to_string(fc::variant(reward.amount)));
+            std::vector<share_type> amounts = {0, 1, -1};
+            BOOST_CHECK_EQUAL(json_writer().write(amounts).str(), fc::json::to_string(fc::variant(amounts)));
+
+            BOOST_TEST_MESSAGE("--- maps and integers");
+            std::map<uint32_t, std::vector<int64_t>> values = {{1, {-1, 0, 0xffffffff, 0x100000000}}};
+            BOOST_CHECK_EQUAL(json_writer().write(values).str(), fc::json::to_string(fc::variant(values)));
         }
         FC_LOG_AND_RETHROW()
     }
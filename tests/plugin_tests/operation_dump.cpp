@@ -0,0 +1,73 @@
+#include <boost/test/unit_test.hpp>
+
+#include "database_fixture.hpp"
+
+#include <golos/plugins/operation_dump/operation_dump_plugin.hpp>
+#include <golos/plugins/operation_dump/operation_dump_container.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include <boost/filesystem.hpp>
+
+using golos::plugins::operation_dump::operation_dump_plugin;
+using golos::plugins::operation_dump::dump_header;
+
+struct operation_dump_fixture : public golos::chain::database_fixture {
+    operation_dump_fixture() {
+        initialize<operation_dump_plugin>({{"operation-dump-dir", dump_dir.path().string()}});
+        open_database();
+        startup();
+    }
+
+    uint64_t dump_size(const std::string& name) const {
+        const auto path = dump_dir.path() / name;
+        return boost::filesystem::exists(path) ? boost::filesystem::file_size(path) : 0;
+    }
+
+    void generate_irreversible_blocks() {
+        const auto head_block_num = db->head_block_num();
+        while (db->last_non_undoable_block_num() < head_block_num) {
+            generate_block();
+        }
+    }
+
+    fc::temp_directory dump_dir{golos::utilities::temp_directory_path()};
+};
+
+BOOST_FIXTURE_TEST_SUITE(operation_dump_plugin_tests, operation_dump_fixture)
+
+BOOST_AUTO_TEST_CASE(dump_irreversible_blocks) {
+    BOOST_TEST_MESSAGE("Testing: dump_irreversible_blocks");
+
+    ACTORS((alice)(bob));
+    generate_irreversible_blocks();
+    const auto transfers_size = dump_size("transfers");
+
+    // the block is dumped when it becomes irreversible
+    transfer("alice", "bob", 1000);
+    generate_block();
+    generate_irreversible_blocks();
+
+    BOOST_CHECK_GT(dump_size("transfers"), std::max<uint64_t>(transfers_size, sizeof(dump_header)));
+    BOOST_CHECK_GT(dump_size("account_metas"), sizeof(dump_header));
+}
+
+BOOST_AUTO_TEST_CASE(dump_irreversible_blocks_async) {
+    BOOST_TEST_MESSAGE("Testing: dump_irreversible_blocks_async");
+
+    auto& bus = ch_plugin->notification_bus();
+    bus.start(true, 2);
+
+    ACTORS((alice)(bob));
+    generate_block();
+    transfer("alice", "bob", 1000);
+    generate_block();
+    generate_irreversible_blocks();
+
+    // stop waits for handling of queued blocks
+    bus.stop();
+    BOOST_CHECK_GT(dump_size("transfers"), sizeof(dump_header));
+    BOOST_CHECK_GT(dump_size("account_metas"), sizeof(dump_header));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
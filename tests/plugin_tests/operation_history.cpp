@@ -2,6 +2,14 @@
 
 #include "database_fixture.hpp"
 
+#include <graphene/utilities/tempdir.hpp>
+
+#include <golos/plugins/operation_history/history_store.hpp>
+#include <golos/plugins/operation_history/history_object.hpp>
+#include <golos/chain/pruning.hpp>
+
+#include <boost/filesystem.hpp>
+
 #include <string>
 #include <cstdint>
 
@@ -9,6 +17,10 @@ using golos::chain::add_operations_database_fixture;
 using golos::plugins::operation_history::applied_operation;
 using golos::plugins::json_rpc::msg_pack;
 using golos::protocol::account_create_operation;
+using golos::chain::block_pruner;
+using golos::plugins::operation_history::operation_index;
+using golos::plugins::operation_history::operation_object;
+using golos::plugins::operation_history::by_location;
 
 static const std::string OPERATIONS = "account_create_operation,delete_comment_operation,vote,comment";
 
@@ -51,10 +63,120 @@ struct operation_history_fixture : public add_operations_database_fixture {
         }
         return _found_ops;
     }
+
+    /**
+     * Generate blocks with the transfer in each block
+     */
+    void generate_blocks_with_operations(uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i) {
+            fund("alice", 1);
+            generate_block();
+        }
+    }
+
+    std::size_t count_operations(uint32_t last_block) const {
+        const auto& idx = db->get_index<operation_index>().indices().get<by_location>();
+        return std::distance(idx.begin(), idx.upper_bound(last_block));
+    }
+
+    std::size_t count_operations() const {
+        return db->get_index<operation_index>().indices().size();
+    }
+
+    bool remove_operations(const block_pruner& pruner) {
+        return pruner.remove_objects<operation_index, by_location>(*db, &operation_object::block);
+    }
 };
 
 BOOST_FIXTURE_TEST_SUITE(operation_history_plugin, operation_history_fixture)
 
+BOOST_AUTO_TEST_CASE(history_pruning_by_buckets) {
+    BOOST_TEST_MESSAGE("Testing: history_pruning_by_buckets");
+    initialize();
+    ACTORS((alice))
+    generate_blocks_with_operations(10);
+
+    const uint32_t depth = 5;
+    const uint32_t bucket_size = 4;
+    block_pruner pruner(depth, bucket_size, fc::microseconds(0));
+
+    uint32_t removed_buckets = 0;
+    uint32_t last_prune_block = 0;
+    for (uint32_t i = 0; i < 3 * bucket_size; ++i) {
+        const auto head_block_num = db->head_block_num();
+        const auto prune_block = pruner.get_prune_block(*db);
+
+        // the last block of the last bucket, which all blocks are older than the depth
+        BOOST_CHECK_EQUAL((prune_block + 1) % bucket_size, 0);
+        BOOST_CHECK_LE(prune_block, head_block_num - depth);
+        BOOST_CHECK_GT(prune_block + bucket_size, head_block_num - depth);
+
+        const auto total = count_operations();
+        const auto old = count_operations(prune_block);
+        if (prune_block != last_prune_block) {
+            BOOST_CHECK_GT(old, 0);
+            ++removed_buckets;
+            last_prune_block = prune_block;
+        } else {
+            BOOST_CHECK_EQUAL(old, 0);
+        }
+
+        pruner.start();
+        BOOST_CHECK(remove_operations(pruner));
+        BOOST_CHECK_EQUAL(count_operations(prune_block), 0);
+        BOOST_CHECK_EQUAL(count_operations(), total - old);
+
+        generate_blocks_with_operations(1);
+    }
+    BOOST_CHECK_GE(removed_buckets, 2);
+}
+
+BOOST_AUTO_TEST_CASE(history_pruning_budget) {
+    BOOST_TEST_MESSAGE("Testing: history_pruning_budget");
+    initialize();
+    ACTORS((alice))
+    generate_blocks_with_operations(100);
+
+    const uint32_t depth = 10;
+
+    BOOST_TEST_MESSAGE("--- the rest of objects is removed in next blocks, at least one object in each block");
+    block_pruner pruner(depth, 1, fc::microseconds(1));
+    auto prune_block = pruner.get_prune_block(*db);
+    auto old = count_operations(prune_block);
+    BOOST_REQUIRE_GT(old, 1);
+
+    pruner.start();
+    BOOST_CHECK(!remove_operations(pruner));
+    const auto rest = count_operations(prune_block);
+    BOOST_CHECK_LT(rest, old);
+    BOOST_CHECK_GT(rest, 0);
+
+    uint32_t blocks = 0;
+    for (bool is_removed = false; !is_removed; ++blocks) {
+        generate_blocks_with_operations(1);
+        prune_block = pruner.get_prune_block(*db);
+        old = count_operations(prune_block);
+        pruner.start();
+        is_removed = remove_operations(pruner);
+        BOOST_CHECK_LT(count_operations(prune_block), old);
+        BOOST_REQUIRE_LE(blocks, 1000);
+    }
+    BOOST_CHECK_GT(blocks, 0);
+    BOOST_CHECK_EQUAL(count_operations(prune_block), 0);
+    BOOST_CHECK_GT(count_operations(), 0);
+
+    BOOST_TEST_MESSAGE("--- the zero budget doesn't limit removing");
+    generate_blocks_with_operations(50);
+    block_pruner unlimited_pruner(depth, 1, fc::microseconds(0));
+    unlimited_pruner.start();
+    BOOST_CHECK(!unlimited_pruner.is_exceeded());
+    prune_block = unlimited_pruner.get_prune_block(*db);
+    BOOST_REQUIRE_GT(count_operations(prune_block), 1);
+    BOOST_CHECK(remove_operations(unlimited_pruner));
+    BOOST_CHECK_EQUAL(count_operations(prune_block), 0);
+    BOOST_CHECK_GT(count_operations(), 0);
+}
+
 BOOST_AUTO_TEST_CASE(operation_history_blocks) {
     const uint32_t HISTORY_BLOCKS = 2;
     BOOST_TEST_MESSAGE("Testing: operation_history_blocks");
@@ -150,4 +272,85 @@ BOOST_AUTO_TEST_CASE(short_operation_history_blocks) {
     BOOST_CHECK_EQUAL(_checked_ops_count, 3);
 }
 
+BOOST_AUTO_TEST_CASE(operation_history_store) {
+    BOOST_TEST_MESSAGE("Testing: operation_history_store");
+    fc::temp_directory store_dir(golos::utilities::temp_directory_path());
+    initialize({
+        {"history-store-dir", store_dir.path().string()}
+    });
+
+    auto _added_ops = add_operations();
+    generate_blocks(5);
+
+    BOOST_REQUIRE(oh_plugin->store() != nullptr);
+    const auto store_head = oh_plugin->store()->head_block_num();
+    BOOST_CHECK_GT(store_head, 0);
+
+    // operations of irreversible blocks are moved from the shared memory to the store
+    const auto& idx = db->get_index<golos::plugins::operation_history::operation_index>().indices();
+    for (const auto& o: idx) {
+        BOOST_CHECK_GT(o.block, store_head);
+    }
+
+    auto _found_ops = check_operations();
+    for (const auto& op: _added_ops) {
+        auto itr = _found_ops.find(op.first);
+        BOOST_CHECK(itr != _found_ops.end());
+        if (itr != _found_ops.end()) {
+            BOOST_CHECK_EQUAL(itr->second, op.second);
+        }
+
+        msg_pack mp;
+        mp.args = std::vector<fc::variant>({fc::variant(op.first)});
+        auto trx = oh_plugin->get_transaction(mp);
+        BOOST_CHECK_EQUAL(trx.transaction_id.str(), op.first);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(operation_history_store_growth) {
+    BOOST_TEST_MESSAGE("Testing: operation_history_store_growth");
+    using golos::plugins::operation_history::history_store;
+    using golos::plugins::operation_history::stored_operation;
+
+    fc::temp_directory store_dir(golos::utilities::temp_directory_path());
+    const auto segment_path = store_dir.path() / "ops-000000.dat";
+
+    auto make_op = [](uint32_t block_num) {
+        stored_operation op;
+        op.block = block_num;
+        op.serialized_op.resize(100, char(block_num));
+        return op;
+    };
+
+    history_store store;
+    store.open(store_dir.path());
+    store.append_block(1, {});
+    for (uint32_t block_num = 2; block_num <= 10; ++block_num) {
+        store.append_block(block_num, {make_op(block_num), make_op(block_num)});
+    }
+    BOOST_CHECK_EQUAL(store.head_block_num(), 10);
+
+    // the segment grows by big steps, and the unused end is cut off on close
+    BOOST_CHECK_GT(boost::filesystem::file_size(segment_path), 18 * 100);
+    store.close();
+    const auto data_size = boost::filesystem::file_size(segment_path);
+    BOOST_CHECK_LT(data_size, 18 * 200);
+
+    // the unused end of files after the crash
+    boost::filesystem::resize_file(segment_path, 4 * data_size);
+    boost::filesystem::resize_file(store_dir.path() / "blocks.idx", 100 * sizeof(uint64_t));
+
+    store.open(store_dir.path());
+    BOOST_CHECK_EQUAL(store.head_block_num(), 10);
+    BOOST_CHECK_EQUAL(store.get_block(1).size(), 0);
+    auto ops = store.get_block(10);
+    BOOST_REQUIRE_EQUAL(ops.size(), 2);
+    BOOST_CHECK_EQUAL(ops[1].block, 10);
+    BOOST_CHECK(ops[1].serialized_op == make_op(10).serialized_op);
+
+    store.append_block(11, {make_op(11)});
+    BOOST_CHECK_EQUAL(store.get_block(11).size(), 1);
+    store.close();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
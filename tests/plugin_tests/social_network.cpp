@@ -0,0 +1,126 @@
+#include <boost/test/unit_test.hpp>
+
+#include "database_fixture.hpp"
+
+#include <golos/api/discussion_helper.hpp>
+#include <golos/plugins/social_network/social_network.hpp>
+
+using golos::api::discussion;
+using golos::api::discussion_helper;
+using golos::api::vote_state;
+using golos::plugins::json_rpc::msg_pack;
+using golos::protocol::comment_operation;
+using golos::protocol::vote_operation;
+using golos::protocol::signed_transaction;
+
+struct votes_cache_fixture : public golos::chain::database_fixture {
+    votes_cache_fixture() {
+        initialize();
+        open_database();
+        startup();
+    }
+
+    void post(const std::string& author, const fc::ecc::private_key& key, const std::string& permlink) {
+        comment_operation op;
+        op.author = author;
+        op.permlink = permlink;
+        op.parent_author = "";
+        op.parent_permlink = "test";
+        op.title = "test";
+        op.body = "foobar";
+
+        signed_transaction tx;
+        BOOST_CHECK_NO_THROW(push_tx_with_ops(tx, key, op));
+    }
+
+    void vote(const std::string& voter, const fc::ecc::private_key& key, const std::string& author, int16_t weight) {
+        vote_operation op;
+        op.voter = voter;
+        op.author = author;
+        op.permlink = "test";
+        op.weight = weight;
+
+        signed_transaction tx;
+        BOOST_CHECK_NO_THROW(push_tx_with_ops(tx, key, op));
+    }
+
+    /// The discussion from the social_network plugin, which caches vote-derived values between calls
+    discussion get_content(const std::string& author) {
+        msg_pack mp;
+        mp.args = std::vector<fc::variant>({fc::variant(author), fc::variant("test"), fc::variant(100)});
+        return sn_plugin->get_content(mp);
+    }
+
+    /// The discussion calculated by a new helper without cached values
+    discussion get_uncached_content(const std::string& author) {
+        discussion_helper helper(
+            *db,
+            [](const golos::chain::database&, const account_name_type&, fc::optional<share_type>&) {},
+            [](const golos::chain::database&, discussion&) {},
+            nullptr);
+        return helper.get_discussion(db->get_comment(author, std::string("test")), 100, 0);
+    }
+
+    void check_cached_content(const std::string& author) {
+        const auto cached = get_content(author);
+        const auto expected = get_uncached_content(author);
+
+        BOOST_CHECK_EQUAL(cached.total_vote_weight, expected.total_vote_weight);
+        BOOST_CHECK_EQUAL(cached.auction_window_weight, expected.auction_window_weight);
+        BOOST_CHECK_EQUAL(cached.votes_in_auction_window_weight, expected.votes_in_auction_window_weight);
+        BOOST_CHECK(cached.pending_payout_value == expected.pending_payout_value);
+        BOOST_REQUIRE_EQUAL(cached.active_votes.size(), expected.active_votes.size());
+        for (std::size_t i = 0; i < expected.active_votes.size(); ++i) {
+            BOOST_CHECK_EQUAL(cached.active_votes[i].voter, expected.active_votes[i].voter);
+            BOOST_CHECK_EQUAL(cached.active_votes[i].weight, expected.active_votes[i].weight);
+            BOOST_CHECK_EQUAL(cached.active_votes[i].rshares, expected.active_votes[i].rshares);
+            BOOST_CHECK_EQUAL(cached.active_votes[i].percent, expected.active_votes[i].percent);
+        }
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(social_network_plugin, votes_cache_fixture)
+
+BOOST_AUTO_TEST_CASE(votes_cache_invalidation) {
+    BOOST_TEST_MESSAGE("Testing: votes_cache_invalidation");
+
+    ACTORS((alice)(bob)(carol));
+    vest("bob", 10000);
+    vest("carol", 10000);
+    generate_block();
+
+    post("alice", alice_private_key, "test");
+    generate_block();
+
+    // values of the comment without votes are cached
+    BOOST_CHECK(get_content("alice").active_votes.empty());
+
+    BOOST_TEST_MESSAGE("--- the new vote");
+    vote("bob", bob_private_key, "alice", STEEMIT_100_PERCENT);
+    generate_block();
+    BOOST_CHECK_EQUAL(get_content("alice").active_votes.size(), 1);
+    check_cached_content("alice");
+
+    vote("carol", carol_private_key, "alice", STEEMIT_100_PERCENT);
+    generate_block();
+    BOOST_CHECK_EQUAL(get_content("alice").active_votes.size(), 2);
+    check_cached_content("alice");
+
+    BOOST_TEST_MESSAGE("--- the changed vote");
+    generate_blocks(STEEMIT_MIN_VOTE_INTERVAL_SEC / STEEMIT_BLOCK_INTERVAL + 1);
+    vote("bob", bob_private_key, "alice", STEEMIT_1_PERCENT * 10);
+    generate_block();
+    const auto votes = get_content("alice").active_votes;
+    auto bob_vote = std::find_if(votes.begin(), votes.end(), [](const vote_state& v) { return v.voter == "bob"; });
+    BOOST_REQUIRE(bob_vote != votes.end());
+    BOOST_CHECK_EQUAL(bob_vote->percent, STEEMIT_1_PERCENT * 10);
+    check_cached_content("alice");
+
+    BOOST_TEST_MESSAGE("--- the payout of the comment");
+    generate_blocks(db->get_comment("alice", std::string("test")).cashout_time, true);
+    generate_block();
+    BOOST_CHECK(db->get_comment("alice", std::string("test")).last_payout != time_point_sec());
+    check_cached_content("alice");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
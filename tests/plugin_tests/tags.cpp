@@ -0,0 +1,275 @@
+#include <boost/test/unit_test.hpp>
+
+#include <boost/algorithm/string/join.hpp>
+
+#include "database_fixture.hpp"
+
+#include <golos/plugins/tags/plugin.hpp>
+#include <golos/plugins/tags/tags_object.hpp>
+#include <golos/plugins/tags/tags_sort.hpp>
+
+using golos::api::discussion;
+using golos::chain::comment_object;
+using golos::plugins::json_rpc::msg_pack;
+using golos::protocol::comment_operation;
+using golos::protocol::delete_comment_operation;
+using golos::protocol::vote_operation;
+using golos::protocol::signed_transaction;
+
+using namespace golos::plugins::tags;
+
+struct tags_fixture : public golos::chain::database_fixture {
+    tags_fixture() {
+        initialize<tags_plugin>();
+        open_database();
+        startup();
+        tags_api = find_plugin<tags_plugin>();
+    }
+
+    void comment(
+        const std::string& author, const fc::ecc::private_key& key, const std::string& permlink,
+        const std::string& parent_author, const std::string& parent_permlink, const std::string& json_metadata
+    ) {
+        comment_operation op;
+        op.author = author;
+        op.permlink = permlink;
+        op.parent_author = parent_author;
+        op.parent_permlink = parent_permlink;
+        op.title = "test";
+        op.body = "foobar";
+        op.json_metadata = json_metadata;
+
+        signed_transaction tx;
+        BOOST_CHECK_NO_THROW(push_tx_with_ops(tx, key, op));
+    }
+
+    void vote(
+        const std::string& voter, const fc::ecc::private_key& key, const std::string& author, const std::string& permlink
+    ) {
+        vote_operation op;
+        op.voter = voter;
+        op.author = author;
+        op.permlink = permlink;
+        op.weight = STEEMIT_100_PERCENT;
+
+        signed_transaction tx;
+        BOOST_CHECK_NO_THROW(push_tx_with_ops(tx, key, op));
+    }
+
+    void delete_comment(const std::string& author, const fc::ecc::private_key& key, const std::string& permlink) {
+        delete_comment_operation op;
+        op.author = author;
+        op.permlink = permlink;
+
+        signed_transaction tx;
+        BOOST_CHECK_NO_THROW(push_tx_with_ops(tx, key, op));
+    }
+
+    const comment_object& get_comment(const std::string& author, const std::string& permlink) {
+        return db->get_comment(author, permlink);
+    }
+
+    const comment_rank_object* find_rank(const comment_object::id_type& comment) {
+        return db->find<comment_rank_object, by_comment>(comment);
+    }
+
+    std::set<std::string> get_tags(const comment_object::id_type& comment) {
+        std::set<std::string> result;
+        const auto& idx = db->get_index<tag_index>().indices().get<by_comment>();
+        for (auto itr = idx.lower_bound(comment); itr != idx.end() && itr->comment == comment; ++itr) {
+            if (itr->type == tag_type::tag) {
+                result.insert(std::string(itr->name));
+            }
+        }
+        return result;
+    }
+
+    std::size_t ranks_count() {
+        return db->get_index<comment_rank_index>().indices().size();
+    }
+
+    using discussions_method = std::vector<discussion> (tags_plugin::*)(msg_pack&);
+
+    static std::string key(const discussion& d) {
+        return std::string(d.author) + "/" + d.permlink;
+    }
+
+    /// All pages of the selection, the start comment of the next page is the last one of the previous page
+    std::vector<std::string> get_pages(discussions_method method, const std::set<std::string>& select_tags) {
+        std::vector<std::string> result;
+        discussion_query query;
+        query.select_tags = select_tags;
+        query.limit = 3;
+        while (true) {
+            msg_pack mp;
+            mp.args = std::vector<fc::variant>({fc::variant(query)});
+            const auto page = (tags_api->*method)(mp);
+
+            auto itr = page.begin();
+            if (query.has_start_comment()) {
+                BOOST_REQUIRE(!page.empty());
+                BOOST_CHECK_EQUAL(key(page.front()), *query.start_author + "/" + *query.start_permlink);
+                ++itr;
+            }
+            for (; itr != page.end(); ++itr) {
+                result.push_back(key(*itr));
+            }
+            if (page.size() < query.limit) {
+                return result;
+            }
+            query.start_author = std::string(page.back().author);
+            query.start_permlink = page.back().permlink;
+        }
+    }
+
+    /// The selection, which is sorted as discussions were sorted before ranks were merged
+    template<typename DiscussionOrder>
+    std::vector<std::string> get_expected(const std::set<std::string>& select_tags) {
+        std::set<comment_object::id_type> ids;
+        const auto& idx = db->get_index<tag_index>().indices().get<by_tag>();
+        for (const auto& name : select_tags) {
+            auto itr = idx.lower_bound(std::make_tuple(name, tag_type::tag));
+            for (; itr != idx.end() && itr->name == name && itr->type == tag_type::tag; ++itr) {
+                ids.insert(itr->comment);
+            }
+        }
+
+        std::vector<discussion> discussions;
+        for (const auto& id : ids) {
+            const auto& c = db->get(id);
+            discussion d;
+            d.id = c.id;
+            d.author = c.author;
+            d.permlink = to_string(c.permlink);
+            d.created = c.created;
+            d.net_votes = c.net_votes;
+            discussions.push_back(d);
+        }
+        std::sort(discussions.begin(), discussions.end(), DiscussionOrder());
+
+        std::vector<std::string> result;
+        for (const auto& d : discussions) {
+            result.push_back(key(d));
+        }
+        return result;
+    }
+
+    tags_plugin* tags_api = nullptr;
+};
+
+BOOST_FIXTURE_TEST_SUITE(tags_plugin_tests, tags_fixture)
+
+BOOST_AUTO_TEST_CASE(comment_rank_follows_comment) {
+    BOOST_TEST_MESSAGE("Testing: comment_rank_follows_comment");
+
+    ACTORS((alice)(bob)(carol));
+    vest("carol", 10000);
+    generate_block();
+
+    BOOST_TEST_MESSAGE("--- the rank is created with tags of the comment");
+    comment("alice", alice_private_key, "post", "", "test", "{\"tags\":[\"a\",\"b\"]}");
+    comment("bob", bob_private_key, "reply", "alice", "post", "{\"tags\":[\"a\"]}");
+    generate_block();
+
+    const auto post_id = get_comment("alice", "post").id;
+    const auto reply_id = get_comment("bob", "reply").id;
+    const auto* post_rank = find_rank(post_id);
+    const auto* reply_rank = find_rank(reply_id);
+    BOOST_REQUIRE(post_rank != nullptr);
+    BOOST_REQUIRE(reply_rank != nullptr);
+    BOOST_CHECK(post_rank->is_post());
+    BOOST_CHECK(post_rank->author == alice_id);
+    BOOST_CHECK(post_rank->created == get_comment("alice", "post").created);
+    BOOST_CHECK(reply_rank->parent == post_id);
+    BOOST_CHECK(get_tags(post_id) == std::set<std::string>({"a", "b"}));
+    BOOST_CHECK(get_tags(reply_id) == std::set<std::string>({"a"}));
+    BOOST_CHECK_EQUAL(ranks_count(), 2);
+
+    BOOST_TEST_MESSAGE("--- the vote updates the rank");
+    vote("carol", carol_private_key, "alice", "post");
+    generate_block();
+    post_rank = find_rank(post_id);
+    BOOST_REQUIRE(post_rank != nullptr);
+    BOOST_CHECK_EQUAL(post_rank->net_votes, 1);
+    BOOST_CHECK_EQUAL(post_rank->net_rshares, get_comment("alice", "post").net_rshares.value);
+    BOOST_CHECK(post_rank->net_rshares > 0);
+
+    BOOST_TEST_MESSAGE("--- re-tagging keeps the rank");
+    const auto post_rank_id = post_rank->id;
+    comment("alice", alice_private_key, "post", "", "test", "{\"tags\":[\"b\",\"c\"]}");
+    generate_block();
+    post_rank = find_rank(post_id);
+    BOOST_REQUIRE(post_rank != nullptr);
+    BOOST_CHECK(post_rank->id == post_rank_id);
+    BOOST_CHECK_EQUAL(post_rank->net_votes, 1);
+    BOOST_CHECK(get_tags(post_id) == std::set<std::string>({"b", "c"}));
+    BOOST_CHECK_EQUAL(ranks_count(), 2);
+
+    BOOST_TEST_MESSAGE("--- the rank is removed with the deleted comment");
+    delete_comment("bob", bob_private_key, "reply");
+    generate_block();
+    BOOST_CHECK(find_rank(reply_id) == nullptr);
+    BOOST_CHECK(get_tags(reply_id).empty());
+    BOOST_CHECK(find_rank(post_id) != nullptr);
+    BOOST_CHECK_EQUAL(ranks_count(), 1);
+
+    BOOST_TEST_MESSAGE("--- the rank is removed with the last tag at the end of the cashout window");
+    generate_blocks(get_comment("alice", "post").cashout_time, true);
+    generate_block();
+    BOOST_CHECK(get_tags(post_id).empty());
+    BOOST_CHECK(find_rank(post_id) == nullptr);
+    BOOST_CHECK_EQUAL(ranks_count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ordered_discussions_paging) {
+    BOOST_TEST_MESSAGE("Testing: ordered_discussions_paging");
+
+    ACTORS((alice)(bob)(carol)(dave)(eve)(fred)(gina)(hank)(iris)(jack)(sam)(tom));
+    vest("sam", 10000);
+    vest("tom", 10000);
+    generate_block();
+
+    const std::vector<std::pair<std::string, fc::ecc::private_key>> authors = {
+        {"alice", alice_private_key}, {"bob", bob_private_key}, {"carol", carol_private_key},
+        {"dave", dave_private_key}, {"eve", eve_private_key}, {"fred", fred_private_key},
+        {"gina", gina_private_key}, {"hank", hank_private_key}, {"iris", iris_private_key},
+        {"jack", jack_private_key}};
+    const std::vector<std::string> metadata = {
+        "{\"tags\":[\"a\"]}", "{\"tags\":[\"b\"]}", "{\"tags\":[\"a\",\"b\"]}", "{\"tags\":[\"c\"]}"};
+
+    // two posts in a block have the same creation time
+    for (std::size_t i = 0; i < authors.size(); ++i) {
+        comment(authors[i].first, authors[i].second, "post", "", "test", metadata[i % metadata.size()]);
+        if (i % 2) {
+            generate_block();
+        }
+    }
+    for (std::size_t i = 0; i < 5; ++i) {
+        vote("tom", tom_private_key, authors[i].first, "post");
+        vote("sam", sam_private_key, authors[i + 3].first, "post");
+    }
+    generate_block();
+
+    const std::vector<std::set<std::string>> selections = {{"a"}, {"a", "b"}, {"b", "c"}, {"a", "b", "c", "d"}};
+    for (const auto& select_tags : selections) {
+        BOOST_TEST_MESSAGE("--- tags: " << boost::algorithm::join(select_tags, ", "));
+
+        const auto created = get_expected<golos::plugins::tags::sort::by_created>(select_tags);
+        BOOST_CHECK(!created.empty());
+        BOOST_CHECK(get_pages(&tags_plugin::get_discussions_by_created, select_tags) == created);
+
+        const auto votes = get_expected<golos::plugins::tags::sort::by_net_votes>(select_tags);
+        BOOST_CHECK(get_pages(&tags_plugin::get_discussions_by_votes, select_tags) == votes);
+    }
+
+    BOOST_TEST_MESSAGE("--- the start comment without selected tags");
+    discussion_query query;
+    query.select_tags = {"a"};
+    query.start_author = std::string("bob");
+    query.start_permlink = std::string("post");
+    msg_pack mp;
+    mp.args = std::vector<fc::variant>({fc::variant(query)});
+    BOOST_CHECK(tags_api->get_discussions_by_created(mp).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
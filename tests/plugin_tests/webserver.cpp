@@ -0,0 +1,257 @@
+#include <boost/test/unit_test.hpp>
+
+#include <golos/plugins/webserver/request_scheduler.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using golos::plugins::webserver::reject_reason;
+using golos::plugins::webserver::request_priority;
+using golos::plugins::webserver::request_scheduler;
+
+namespace {
+    const std::chrono::seconds wait_timeout(10);
+
+    /// Collects executed requests and allows to wait for them
+    struct executed_requests {
+        explicit executed_requests(std::size_t expected)
+            : expected(expected) {
+        }
+
+        request_scheduler::task_type task(int id) {
+            return [this, id]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                ids.push_back(id);
+                if (ids.size() == expected) {
+                    done.set_value();
+                }
+            };
+        }
+
+        bool wait() {
+            return done.get_future().wait_for(wait_timeout) == std::future_status::ready;
+        }
+
+        std::vector<int> get_ids() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return ids;
+        }
+
+        std::size_t expected;
+        std::mutex mutex;
+        std::vector<int> ids;
+        std::promise<void> done;
+    };
+}
+
+BOOST_AUTO_TEST_SUITE(webserver_request_scheduler)
+
+BOOST_AUTO_TEST_CASE(requests_are_executed_by_priorities) {
+    BOOST_TEST_MESSAGE("Testing: requests_are_executed_by_priorities");
+
+    std::atomic<bool> is_busy(true);
+    executed_requests executed(4);
+    request_scheduler scheduler;
+    scheduler.start(1, 0, std::chrono::milliseconds(0), [&]() { return is_busy.load(); });
+
+    BOOST_CHECK(scheduler.post(request_priority::low, executed.task(1)));
+    BOOST_CHECK(scheduler.post(request_priority::normal, executed.task(2)));
+    BOOST_CHECK(scheduler.post(request_priority::high, executed.task(3)));
+    BOOST_CHECK(scheduler.post(request_priority::normal, executed.task(4)));
+
+    // all requests are prepared before the first one is executed
+    is_busy = false;
+    scheduler.resume();
+
+    BOOST_REQUIRE(executed.wait());
+    BOOST_CHECK((executed.get_ids() == std::vector<int>{3, 2, 4, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(requests_are_prepared_by_workers) {
+    BOOST_TEST_MESSAGE("Testing: requests_are_prepared_by_workers");
+
+    const auto poster_id = std::this_thread::get_id();
+    std::atomic<bool> is_prepared_by_poster(false);
+    std::atomic<bool> is_busy(true);
+    executed_requests executed(1);
+    request_scheduler scheduler;
+    scheduler.start(2, 0, std::chrono::milliseconds(0), [&]() { return is_busy.load(); });
+
+    std::promise<void> prepared;
+    BOOST_CHECK(scheduler.post([&]() {
+        is_prepared_by_poster = (std::this_thread::get_id() == poster_id);
+        prepared.set_value();
+        return request_priority::high;
+    }, executed.task(1)));
+
+    // preparing doesn't wait for the end of block writes
+    BOOST_REQUIRE(prepared.get_future().wait_for(wait_timeout) == std::future_status::ready);
+    BOOST_CHECK(!is_prepared_by_poster);
+    BOOST_CHECK(executed.get_ids().empty());
+
+    is_busy = false;
+    scheduler.resume();
+    BOOST_REQUIRE(executed.wait());
+}
+
+BOOST_AUTO_TEST_CASE(failed_preparing_uses_normal_priority) {
+    BOOST_TEST_MESSAGE("Testing: failed_preparing_uses_normal_priority");
+
+    std::atomic<bool> is_busy(true);
+    executed_requests executed(3);
+    request_scheduler scheduler;
+    scheduler.start(1, 0, std::chrono::milliseconds(0), [&]() { return is_busy.load(); });
+
+    BOOST_CHECK(scheduler.post(request_priority::low, executed.task(1)));
+    BOOST_CHECK(scheduler.post([]() -> request_priority { FC_THROW("Parse error"); }, executed.task(2)));
+    BOOST_CHECK(scheduler.post(request_priority::high, executed.task(3)));
+
+    is_busy = false;
+    scheduler.resume();
+
+    BOOST_REQUIRE(executed.wait());
+    BOOST_CHECK((executed.get_ids() == std::vector<int>{3, 2, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(requests_are_parked_while_blocks_are_written) {
+    BOOST_TEST_MESSAGE("Testing: requests_are_parked_while_blocks_are_written");
+
+    std::atomic<bool> is_busy(true);
+    executed_requests executed(1);
+    request_scheduler scheduler;
+    scheduler.start(2, 0, std::chrono::milliseconds(0), [&]() { return is_busy.load(); });
+
+    BOOST_CHECK(scheduler.post(request_priority::normal, executed.task(1)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    BOOST_CHECK(executed.get_ids().empty());
+
+    is_busy = false;
+    scheduler.resume();
+    BOOST_REQUIRE(executed.wait());
+}
+
+BOOST_AUTO_TEST_CASE(parking_is_bounded_by_time) {
+    BOOST_TEST_MESSAGE("Testing: parking_is_bounded_by_time");
+
+    const auto max_park_time = std::chrono::milliseconds(50);
+
+    // blocks are written back to back, so the write lock isn't released for long
+    executed_requests executed(2);
+    request_scheduler scheduler;
+    scheduler.start(2, 0, max_park_time, []() { return true; });
+
+    const auto start = std::chrono::steady_clock::now();
+    BOOST_CHECK(scheduler.post(request_priority::low, executed.task(1)));
+    BOOST_CHECK(scheduler.post(request_priority::high, executed.task(2)));
+
+    BOOST_REQUIRE(executed.wait());
+    BOOST_CHECK(std::chrono::steady_clock::now() - start >= max_park_time);
+}
+
+BOOST_AUTO_TEST_CASE(queue_size_is_limited) {
+    BOOST_TEST_MESSAGE("Testing: queue_size_is_limited");
+
+    std::atomic<bool> is_busy(true);
+    executed_requests executed(2);
+    request_scheduler scheduler;
+    scheduler.start(1, 2, std::chrono::milliseconds(0), [&]() { return is_busy.load(); });
+
+    BOOST_CHECK(scheduler.post(request_priority::normal, executed.task(1)));
+    BOOST_CHECK(scheduler.post(request_priority::normal, executed.task(2)));
+    // parked requests are counted too
+    BOOST_CHECK(!scheduler.post(request_priority::high, executed.task(3)));
+
+    is_busy = false;
+    scheduler.resume();
+    BOOST_REQUIRE(executed.wait());
+    BOOST_CHECK((executed.get_ids() == std::vector<int>{1, 2}));
+
+    BOOST_CHECK(scheduler.post(request_priority::normal, []() {}));
+}
+
+BOOST_AUTO_TEST_CASE(split_requests_are_counted_and_parked) {
+    BOOST_TEST_MESSAGE("Testing: split_requests_are_counted_and_parked");
+
+    std::atomic<bool> is_busy(true);
+    executed_requests executed(3);
+    request_scheduler scheduler;
+    scheduler.start(2, 3, std::chrono::milliseconds(0), [&]() { return is_busy.load(); });
+
+    std::atomic<bool> is_rejected(false);
+    BOOST_CHECK(scheduler.post([&]() {
+        return std::vector<request_scheduler::prepared_request>{
+            {request_priority::low, executed.task(1), {}},
+            {request_priority::high, executed.task(2), {}},
+            {request_priority::normal, executed.task(3), {}}};
+    }, [&](reject_reason) { is_rejected = true; }));
+
+    // all split requests are counted by the limit
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    BOOST_CHECK(!scheduler.post(request_priority::high, executed.task(4)));
+    BOOST_CHECK(executed.get_ids().empty());
+
+    is_busy = false;
+    scheduler.resume();
+    BOOST_REQUIRE(executed.wait());
+    BOOST_CHECK(!is_rejected);
+    auto ids = executed.get_ids();
+    std::sort(ids.begin(), ids.end());
+    BOOST_CHECK((ids == std::vector<int>{1, 2, 3}));
+}
+
+BOOST_AUTO_TEST_CASE(split_requests_over_limit_are_rejected) {
+    BOOST_TEST_MESSAGE("Testing: split_requests_over_limit_are_rejected");
+
+    executed_requests executed(1);
+    request_scheduler scheduler;
+    scheduler.start(1, 2, std::chrono::milliseconds(0), {});
+
+    std::promise<reject_reason> rejected;
+    BOOST_CHECK(scheduler.post([&]() {
+        return std::vector<request_scheduler::prepared_request>{
+            {request_priority::normal, executed.task(1), {}},
+            {request_priority::normal, executed.task(2), {}},
+            {request_priority::normal, executed.task(3), {}}};
+    }, [&](reject_reason reason) { rejected.set_value(reason); }));
+
+    auto reason = rejected.get_future();
+    BOOST_REQUIRE(reason.wait_for(wait_timeout) == std::future_status::ready);
+    BOOST_CHECK(reason.get() == reject_reason::busy);
+    BOOST_CHECK(executed.get_ids().empty());
+
+    BOOST_CHECK(scheduler.post(request_priority::normal, executed.task(4)));
+    BOOST_REQUIRE(executed.wait());
+}
+
+BOOST_AUTO_TEST_CASE(requests_are_cancelled_on_stop) {
+    BOOST_TEST_MESSAGE("Testing: requests_are_cancelled_on_stop");
+
+    std::atomic<bool> is_busy(true);
+    executed_requests executed(1);
+    request_scheduler scheduler;
+    scheduler.start(1, 0, std::chrono::milliseconds(0), [&]() { return is_busy.load(); });
+
+    std::atomic<int> cancelled(0);
+    BOOST_CHECK(scheduler.post(request_priority::normal, executed.task(1), [&]() { ++cancelled; }));
+    BOOST_CHECK(scheduler.post([&]() {
+        return std::vector<request_scheduler::prepared_request>{
+            {request_priority::low, executed.task(2), [&]() { ++cancelled; }},
+            {request_priority::high, executed.task(3), [&]() { ++cancelled; }}};
+    }, [&](reject_reason) { cancelled += 100; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // parked requests aren't executed, but their clients get responses
+    scheduler.stop();
+    BOOST_CHECK_EQUAL(cancelled.load(), 3);
+    BOOST_CHECK(executed.get_ids().empty());
+
+    BOOST_CHECK(!scheduler.post(request_priority::normal, executed.task(4), [&]() { ++cancelled; }));
+    BOOST_CHECK_EQUAL(cancelled.load(), 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -26,6 +26,7 @@
 #include <boost/test/unit_test_monitor.hpp>
 
 #include <golos/chain/database.hpp>
+#include <golos/protocol/recovered_keys_cache.hpp>
 
 #include <fc/crypto/digest.hpp>
 #include "database_fixture.hpp"
@@ -313,4 +314,100 @@ BOOST_FIXTURE_TEST_SUITE(basic_tests, clean_database_fixture)
         BOOST_CHECK(block.calculate_merkle_root() == c(dO));
     }
 
+    BOOST_AUTO_TEST_CASE(recovered_keys_cache_test) {
+        auto& cache = recovered_keys_cache::instance();
+        auto old_max_size = cache.max_size();
+        cache.set_max_size(0);
+        cache.set_max_size(64);
+
+        auto priv_key = generate_private_key("alice");
+        signed_transaction trx;
+        transfer_operation op;
+        op.from = "alice";
+        op.to = "bob";
+        op.amount = asset(100, STEEM_SYMBOL);
+        trx.operations.push_back(op);
+        trx.sign(priv_key, STEEMIT_CHAIN_ID);
+
+        auto hits = cache.hits();
+        auto misses = cache.misses();
+
+        auto keys = trx.get_signature_keys(STEEMIT_CHAIN_ID);
+        BOOST_CHECK_EQUAL(keys.count(priv_key.get_public_key()), 1);
+        BOOST_CHECK_EQUAL(cache.misses(), misses + 1);
+        BOOST_CHECK_EQUAL(cache.hits(), hits);
+
+        BOOST_CHECK(trx.get_signature_keys(STEEMIT_CHAIN_ID) == keys);
+        BOOST_CHECK_EQUAL(cache.misses(), misses + 1);
+        BOOST_CHECK_EQUAL(cache.hits(), hits + 1);
+
+        // the cache is bounded
+        for (int i = 0; i < 1000; ++i) {
+            trx.expiration += 1;
+            trx.signatures.clear();
+            trx.sign(priv_key, STEEMIT_CHAIN_ID);
+            trx.get_signature_keys(STEEMIT_CHAIN_ID);
+        }
+        BOOST_CHECK_LE(cache.size(), cache.max_size());
+
+        cache.set_max_size(0);
+        BOOST_CHECK_EQUAL(cache.size(), 0);
+        cache.set_max_size(old_max_size);
+    }
+
+    BOOST_AUTO_TEST_CASE(lookup_by_hashed_name) {
+        try {
+            BOOST_TEST_MESSAGE("Testing: lookup_by_hashed_name");
+
+            ACTORS((alice)(bob)(carol));
+
+            // results of the hashed indexes are compared with the ordered ones
+            auto find_ordered_account = [&](const account_name_type& name) {
+                return db->find<account_object, by_name>(name);
+            };
+            auto find_ordered_authority = [&](const account_name_type& name) -> const account_authority_object* {
+                const auto& idx = db->get_index<account_authority_index>().indices().get<by_account>();
+                auto itr = idx.lower_bound(boost::make_tuple(name));
+                return itr != idx.end() && itr->account == name ? &*itr : nullptr;
+            };
+            auto find_ordered_witness = [&](const account_name_type& name) {
+                return db->find<witness_object, by_name>(name);
+            };
+
+            BOOST_TEST_MESSAGE("--- existing names");
+            for (const account_name_type name : {account_name_type(STEEMIT_INIT_MINER_NAME), account_name_type("alice"),
+                    account_name_type("bob"), account_name_type("carol")}) {
+                const auto* account = find_ordered_account(name);
+                BOOST_REQUIRE(account != nullptr);
+                BOOST_CHECK(db->find_account(name) == account);
+                BOOST_CHECK(&db->get_account(name) == account);
+
+                const auto* authority = find_ordered_authority(name);
+                BOOST_REQUIRE(authority != nullptr);
+                BOOST_CHECK(&db->get_authority(name) == authority);
+
+                BOOST_CHECK(db->find_witness(name) == find_ordered_witness(name));
+            }
+            BOOST_REQUIRE(find_ordered_witness(STEEMIT_INIT_MINER_NAME) != nullptr);
+            BOOST_CHECK(&db->get_witness(STEEMIT_INIT_MINER_NAME) == find_ordered_witness(STEEMIT_INIT_MINER_NAME));
+            BOOST_CHECK(db->find_witness("alice") == nullptr);
+
+            BOOST_TEST_MESSAGE("--- missing names");
+            for (const account_name_type name : {account_name_type("dave"), account_name_type("alic"),
+                    account_name_type("alicee")}) {
+                BOOST_CHECK(find_ordered_account(name) == nullptr);
+                BOOST_CHECK(db->find_account(name) == nullptr);
+                BOOST_CHECK_THROW(db->get_account(name), golos::missing_object);
+
+                BOOST_CHECK(find_ordered_authority(name) == nullptr);
+                BOOST_CHECK_THROW(db->get_authority(name), golos::missing_object);
+
+                BOOST_CHECK(find_ordered_witness(name) == nullptr);
+                BOOST_CHECK(db->find_witness(name) == nullptr);
+                BOOST_CHECK_THROW(db->get_witness(name), golos::missing_object);
+            }
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -28,7 +28,9 @@
 #include <golos/protocol/exceptions.hpp>
 
 #include <golos/chain/database.hpp>
+#include <golos/chain/block_prevalidator.hpp>
 #include <golos/chain/steem_objects.hpp>
+#include <golos/chain/state_snapshot.hpp>
 
 #include <golos/plugins/account_history/history_object.hpp>
 #include <golos/plugins/account_history/plugin.hpp>
@@ -37,6 +39,9 @@
 
 #include <fc/crypto/digest.hpp>
 
+#include <atomic>
+#include <thread>
+
 #include "database_fixture.hpp"
 
 using namespace golos;
@@ -108,6 +113,292 @@ BOOST_AUTO_TEST_SUITE(block_tests)
         }
     }
 
+    BOOST_AUTO_TEST_CASE(state_snapshot) {
+        try {
+            fc::temp_directory data_dir(golos::utilities::temp_directory_path());
+            fc::temp_directory snapshot_dir(golos::utilities::temp_directory_path());
+            auto snapshot = snapshot_dir.path() / "state.snapshot";
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+
+            block_id_type head_block_id;
+            std::size_t accounts_count = 0;
+            std::size_t witnesses_count = 0;
+            asset current_supply;
+            {
+                database db;
+                db._log_hardforks = false;
+                db.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+                while (db.get_dynamic_global_properties().last_irreversible_block_num < 50) {
+                    db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+                }
+                db.close();
+            }
+            {
+                database db;
+                db._log_hardforks = false;
+                db.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+                db.set_state_snapshot_threads(4);
+                db.create_state_snapshot(snapshot);
+
+                head_block_id = db.head_block_id();
+                accounts_count = db.get_index<account_index>().indices().size();
+                witnesses_count = db.get_index<witness_index>().indices().size();
+                current_supply = db.get_dynamic_global_properties().current_supply;
+                db.close();
+            }
+            {
+                fc::temp_directory shared_mem_dir(golos::utilities::temp_directory_path());
+                database db;
+                db._log_hardforks = false;
+                db.set_state_snapshot_threads(4);
+                db.open_from_state_snapshot(data_dir.path(), shared_mem_dir.path(), snapshot, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+                BOOST_CHECK(db.head_block_id() == head_block_id);
+                BOOST_CHECK_EQUAL(db.revision(), db.head_block_num());
+                BOOST_CHECK_EQUAL(db.get_index<account_index>().indices().size(), accounts_count);
+                BOOST_CHECK_EQUAL(db.get_index<witness_index>().indices().size(), witnesses_count);
+                BOOST_CHECK_EQUAL(db.get_dynamic_global_properties().current_supply, current_supply);
+                BOOST_CHECK(db.find_account(STEEMIT_INIT_MINER_NAME) != nullptr);
+
+                // loaded state should be able to continue the chain
+                auto head_block_num = db.head_block_num();
+                for (uint32_t i = 0; i < 10; ++i) {
+                    db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+                }
+                BOOST_CHECK_EQUAL(db.head_block_num(), head_block_num + 10);
+            }
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(state_snapshot_chunk_size) {
+        try {
+            fc::temp_directory snapshot_dir(golos::utilities::temp_directory_path());
+            auto snapshot = snapshot_dir.path() / "state.snapshot";
+            const std::size_t chunk_size = state_snapshot_section_writer::chunk_size;
+            const std::size_t record_size = chunk_size / 2;
+
+            state_snapshot_header header;
+            header.sections_count = 2;
+            std::vector<state_snapshot_section> sections(2);
+            {
+                state_snapshot_writer out(snapshot, header);
+                state_snapshot_section_writer section(out, 0, sections[0]);
+                for (int i = 0; i < 3; ++i) {
+                    auto& buffer = section.begin_record();
+                    buffer.resize(buffer.size() + record_size, char(i));
+                    section.end_record();
+                }
+                section.finish();
+
+                std::vector<char> data(chunk_size + 1);
+                out.write_chunk(1, data.data(), data.size());
+                out.close(sections);
+            }
+
+            state_snapshot_reader in(snapshot);
+            state_snapshot_chunk chunk;
+            std::vector<char> data;
+
+            BOOST_TEST_MESSAGE("--- the record, which doesn't fit the rest of chunk, starts the next one");
+            for (int i = 0; i < 3; ++i) {
+                BOOST_REQUIRE(in.read_chunk(chunk));
+                BOOST_CHECK_EQUAL(chunk.section_num, 0);
+                BOOST_CHECK_EQUAL(chunk.size, sizeof(uint32_t) + record_size);
+                chunk.unpack(data);
+                BOOST_CHECK_EQUAL(data.back(), char(i));
+            }
+
+            BOOST_TEST_MESSAGE("--- the chunk above the limit is rejected");
+            BOOST_CHECK_THROW(in.read_chunk(chunk), state_snapshot_exception);
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(compressed_block_log) {
+        try {
+            fc::temp_directory data_dir(golos::utilities::temp_directory_path());
+            fc::temp_directory compressed_dir(golos::utilities::temp_directory_path());
+            auto compressed_path = compressed_dir.path() / "block_log";
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+            {
+                database db;
+                db._log_hardforks = false;
+                db.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+                while (db.get_dynamic_global_properties().last_irreversible_block_num < 100) {
+                    db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+                }
+                db.close();
+            }
+
+            block_log plain;
+            plain.open(data_dir.path() / "block_log");
+            const auto head_num = plain.head()->block_num();
+
+            // small chunks to have several compressed chunks and the tail
+            std::vector<char> dictionary = fc::raw::pack(*plain.read_block_by_num(1));
+            block_log::create_compressed(compressed_path, 1024, dictionary);
+            {
+                block_log compressed;
+                compressed.open(compressed_path);
+                for (uint32_t block_num = 1; block_num <= head_num; ++block_num) {
+                    BOOST_CHECK_EQUAL(compressed.append(*plain.read_block_by_num(block_num)), plain.get_block_pos(block_num));
+                }
+            }
+
+            // chunks and index should be reconstructed from the compressed file
+            fc::remove_all(compressed_dir.path() / "block_log.chunks");
+            fc::remove_all(compressed_dir.path() / "block_log.index");
+
+            block_log compressed;
+            compressed.open(compressed_path);
+            BOOST_REQUIRE(compressed.head().valid());
+            BOOST_CHECK(compressed.head()->id() == plain.head()->id());
+            BOOST_CHECK(fc::file_size(compressed_path) < fc::file_size(data_dir.path() / "block_log"));
+
+            auto read_serialized_block = [](const block_log& log, uint32_t block_num) {
+                std::vector<char> result;
+                BOOST_CHECK(log.read_serialized_block(block_num, [&](const char* data, std::size_t size) {
+                    result.assign(data, data + size);
+                }));
+                return result;
+            };
+
+            for (uint32_t block_num = head_num; block_num > 0; --block_num) {
+                BOOST_CHECK_EQUAL(compressed.get_block_pos(block_num), plain.get_block_pos(block_num));
+                auto block = compressed.read_block_by_num(block_num);
+                BOOST_REQUIRE(block.valid());
+                BOOST_CHECK(block->id() == plain.read_block_by_num(block_num)->id());
+
+                auto serialized_block = fc::raw::pack(*block);
+                BOOST_CHECK(read_serialized_block(plain, block_num) == serialized_block);
+                BOOST_CHECK(read_serialized_block(compressed, block_num) == serialized_block);
+            }
+            BOOST_CHECK(!plain.read_serialized_block(head_num + 1, [](const char*, std::size_t) {}));
+
+            auto r1 = compressed.read_block(0);
+            auto r2 = compressed.read_block(r1.second);
+            BOOST_CHECK_EQUAL(r2.first.block_num(), 2);
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(read_only_replica) {
+        try {
+            fc::temp_directory data_dir(golos::utilities::temp_directory_path());
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+
+            database db;
+            db._log_hardforks = false;
+            db.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+            db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+
+            database replica;
+            replica._log_hardforks = false;
+            replica.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_only);
+
+            BOOST_TEST_MESSAGE("--- the replica reads the state and blocks appended by the writer");
+            uint32_t read_blocks = 0;
+            for (uint32_t i = 0; i < 1000 && db.last_non_undoable_block_num() < 50; ++i) {
+                db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+
+                replica.with_weak_read_lock([&]() {
+                    BOOST_CHECK_EQUAL(replica.head_block_num(), db.head_block_num());
+                    BOOST_CHECK(replica.head_block_id() == db.head_block_id());
+                    BOOST_CHECK(replica.get_account(STEEMIT_INIT_MINER_NAME).balance == db.get_account(STEEMIT_INIT_MINER_NAME).balance);
+                });
+
+                const auto block_num = db.get_block_log().head() ? db.get_block_log().head()->block_num() : 0;
+                if (block_num == 0) {
+                    continue;
+                }
+
+                auto block = replica.fetch_block_by_number(block_num);
+                BOOST_REQUIRE(block.valid());
+                BOOST_CHECK(block->id() == db.fetch_block_by_number(block_num)->id());
+
+                std::vector<char> serialized_block;
+                BOOST_CHECK(replica.get_block_log().read_serialized_block(block_num, [&](const char* data, std::size_t size) {
+                    serialized_block.assign(data, data + size);
+                }));
+                BOOST_CHECK(serialized_block == fc::raw::pack(*block));
+                ++read_blocks;
+            }
+            BOOST_CHECK(read_blocks > 0);
+            BOOST_CHECK(!replica.fetch_block_by_number(db.head_block_num() + 1).valid());
+
+            BOOST_TEST_MESSAGE("--- the read-only block log is read while blocks are appended to it");
+            fc::temp_directory log_dir(golos::utilities::temp_directory_path());
+            const auto head_num = db.get_block_log().head()->block_num();
+            block_log writer;
+            writer.open(log_dir.path() / "block_log");
+            block_log reader;
+            reader.open(log_dir.path() / "block_log", true);
+            BOOST_CHECK(!reader.head().valid());
+            BOOST_CHECK_THROW(reader.append(*db.fetch_block_by_number(1)), fc::exception);
+
+            std::thread appender([&]() {
+                for (uint32_t block_num = 1; block_num <= head_num; ++block_num) {
+                    writer.append(*db.get_block_log().read_block_by_num(block_num));
+                }
+            });
+
+            // the head is read by other threads, while files are remapped on reading of new blocks
+            std::atomic<bool> is_read{false};
+            std::atomic<uint32_t> wrong_heads{0};
+            std::vector<std::thread> head_readers;
+            for (int i = 0; i < 4; ++i) {
+                head_readers.emplace_back([&]() {
+                    uint32_t last_head_num = 0;
+                    while (!is_read) {
+                        auto head = reader.head();
+                        if (!head.valid()) {
+                            continue;
+                        }
+                        const auto num = head->block_num();
+                        if (num < last_head_num || head->id() != db.get_block_log().read_block_by_num(num)->id()) {
+                            ++wrong_heads;
+                        }
+                        last_head_num = num;
+                    }
+                });
+            }
+
+            uint32_t last_read_num = 0;
+            while (last_read_num < head_num) {
+                auto block = reader.read_block_by_num(last_read_num + 1);
+                if (!block.valid()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                ++last_read_num;
+                BOOST_CHECK_EQUAL(block->block_num(), last_read_num);
+            }
+            appender.join();
+            is_read = true;
+            for (auto& thread: head_readers) {
+                thread.join();
+            }
+            BOOST_CHECK_EQUAL(wrong_heads.load(), 0);
+
+            BOOST_REQUIRE(reader.head().valid());
+            BOOST_CHECK(reader.head()->id() == db.get_block_log().head()->id());
+            BOOST_CHECK(!reader.read_block_by_num(head_num + 1).valid());
+
+            replica.close();
+            db.close();
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
     BOOST_AUTO_TEST_CASE(undo_block) {
         try {
             fc::temp_directory data_dir(golos::utilities::temp_directory_path());
@@ -332,6 +623,59 @@ BOOST_AUTO_TEST_SUITE(block_tests)
         }
     }
 
+    BOOST_AUTO_TEST_CASE(prevalidated_block) {
+        try {
+            fc::temp_directory dir1(golos::utilities::temp_directory_path()),
+                    dir2(golos::utilities::temp_directory_path());
+            database db1,
+                    db2;
+            db1._log_hardforks = false;
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+            db2._log_hardforks = false;
+            db2.open(dir2.path(), dir2.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+            public_key_type init_account_pub_key = init_account_priv_key.get_public_key();
+
+            signed_transaction trx;
+            account_create_operation cop;
+            cop.new_account_name = "alice";
+            cop.creator = STEEMIT_INIT_MINER_NAME;
+            cop.owner = authority(1, init_account_pub_key, 1);
+            cop.active = cop.owner;
+            trx.operations.push_back(cop);
+            trx.set_expiration(
+                    db1.head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            trx.sign(init_account_priv_key, db1.get_chain_id());
+            PUSH_TX(db1, trx);
+
+            auto b = db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+
+            block_prevalidator prevalidator;
+            prevalidator.start(2);
+
+            auto pb = prevalidator.prevalidate(b, database::skip_nothing).get();
+            BOOST_CHECK(pb->id == b.id());
+            BOOST_CHECK_EQUAL(pb->size, fc::raw::pack_size(b));
+            BOOST_CHECK(pb->has_merkle_root);
+            BOOST_CHECK(pb->merkle_root == b.transaction_merkle_root);
+            BOOST_REQUIRE_EQUAL(pb->transactions.size(), 1);
+            BOOST_CHECK(pb->transactions[0].is_validated);
+            BOOST_CHECK(pb->transactions[0].has_signature_keys);
+            BOOST_CHECK_EQUAL(pb->transactions[0].signature_keys.count(init_account_pub_key), 1);
+
+            auto skipped = prevalidator.prevalidate(b, database::skip_transaction_signatures).get();
+            BOOST_CHECK(!skipped->transactions[0].has_signature_keys);
+
+            db2.push_block(*pb, database::skip_nothing);
+            BOOST_CHECK(db2.head_block_id() == b.id());
+            BOOST_CHECK(db2.find_account("alice") != nullptr);
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
     BOOST_AUTO_TEST_CASE(tapos) {
         try {
             fc::temp_directory dir1(golos::utilities::temp_directory_path());
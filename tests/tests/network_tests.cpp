@@ -0,0 +1,556 @@
+#ifdef STEEMIT_BUILD_TESTNET
+
+#include <boost/test/unit_test.hpp>
+
+#include <golos/network/compact_block_pool.hpp>
+#include <golos/network/io_thread_pool.hpp>
+#include <golos/network/message_oriented_connection.hpp>
+#include <golos/network/pushed_block_limiter.hpp>
+#include <golos/network/sync_block_buffer.hpp>
+#include <golos/protocol/config.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/network/ip.hpp>
+#include <fc/network/tcp_socket.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace golos::network;
+using golos::protocol::signed_block;
+using golos::protocol::signed_transaction;
+
+namespace {
+    signed_transaction make_transaction(uint16_t n) {
+        signed_transaction trx;
+        trx.ref_block_num = n;
+        trx.expiration = STEEMIT_GENESIS_TIME + n;
+        return trx;
+    }
+
+    signed_block make_block(uint16_t first_trx, uint16_t trx_count) {
+        signed_block block;
+        block.timestamp = STEEMIT_GENESIS_TIME + first_trx;
+        for (uint16_t i = 0; i < trx_count; ++i) {
+            block.transactions.push_back(make_transaction(first_trx + i));
+        }
+        block.transaction_merkle_root = block.calculate_merkle_root();
+        return block;
+    }
+
+    compact_block_message make_compact_block(const signed_block &block) {
+        return compact_block_message(block, block.id(), message(block_message(block)).id());
+    }
+
+    /// finds transactions of the "message cache"
+    compact_block_pool::transaction_finder make_finder(const std::vector<signed_transaction> &transactions) {
+        return [transactions](const transaction_id_type &id) {
+            fc::optional<signed_transaction> result;
+            for (const auto &trx : transactions) {
+                if (trx.id() == id) {
+                    result = trx;
+                }
+            }
+            return result;
+        };
+    }
+
+    block_transactions_message make_transactions(const signed_block &block, const std::vector<uint32_t> &indexes) {
+        block_transactions_message result;
+        result.block_id = block.id();
+        result.transaction_indexes = indexes;
+        for (auto index : indexes) {
+            result.transactions.push_back(block.transactions[index]);
+        }
+        return result;
+    }
+
+    /// ids of blocks, which peers have during sync
+    sync_block_buffer::item_ids_type make_item_ids(const std::vector<block_message> &blocks) {
+        sync_block_buffer::item_ids_type result;
+        for (const auto &block : blocks) {
+            result.push_back(block.block_id);
+        }
+        return result;
+    }
+
+    bool is_not_requested(const item_hash_t &) {
+        return false;
+    }
+
+    message make_message(uint32_t n, uint32_t size) {
+        message result;
+        result.msg_type = trx_message_type;
+        result.data.assign(size, char(n));
+        result.size = size;
+        return result;
+    }
+
+    /// waits for the condition, while tasks of the current thread are executed
+    bool wait_for(const std::function<bool()> &condition) {
+        for (int i = 0; i < 1000 && !condition(); ++i) {
+            fc::usleep(fc::milliseconds(10));
+        }
+        return condition();
+    }
+
+    struct received_messages final : public message_oriented_connection_delegate {
+        void on_message(message_oriented_connection *, const message &received_message,
+                const message_hash_type &message_hash) override {
+            messages.push_back(received_message);
+            hashes.push_back(message_hash);
+        }
+
+        void on_connection_closed(message_oriented_connection *) override {
+            is_closed = true;
+        }
+
+        std::vector<message> messages;
+        std::vector<message_hash_type> hashes;
+        bool is_closed = false;
+    };
+
+    /// connections of the sender and the receiver via the local socket
+    struct connection_pair final {
+        connection_pair(const std::shared_ptr<fc::thread> &sender_io_thread,
+                const std::shared_ptr<fc::thread> &receiver_io_thread)
+                : sender(&sender_delegate),
+                  receiver(&receiver_delegate) {
+            fc::tcp_server server;
+            server.listen(fc::ip::endpoint(fc::ip::address("127.0.0.1"), 0));
+
+            receiver.set_io_thread(receiver_io_thread);
+            fc::future<void> accepted = fc::async([&]() {
+                server.accept(receiver.get_socket());
+                receiver.accept();
+            }, "accept connection");
+
+            sender.set_io_thread(sender_io_thread);
+            sender.connect_to(fc::ip::endpoint(fc::ip::address("127.0.0.1"), server.get_local_endpoint().port()));
+            accepted.wait();
+        }
+
+        received_messages sender_delegate;
+        received_messages receiver_delegate;
+        message_oriented_connection sender;
+        message_oriented_connection receiver;
+    };
+
+    void check_messages_order(connection_pair &connections) {
+        std::vector<message> messages;
+        for (uint32_t i = 0; i < 50; ++i) {
+            messages.push_back(make_message(i, i % 2 ? 64 * 1024 + i : 10 + i));
+        }
+        for (const auto &m : messages) {
+            connections.sender.send_message(m);
+        }
+
+        const auto &received = connections.receiver_delegate;
+        BOOST_REQUIRE(wait_for([&]() { return received.messages.size() == messages.size(); }));
+        for (std::size_t i = 0; i < messages.size(); ++i) {
+            BOOST_CHECK(received.messages[i].data == messages[i].data);
+            BOOST_CHECK(received.hashes[i] == messages[i].id());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(network_tests)
+
+BOOST_AUTO_TEST_CASE(compact_block_validation) {
+    BOOST_TEST_MESSAGE("Testing: compact_block_validation");
+
+    const auto block = make_block(1, 3);
+    BOOST_CHECK_NO_THROW(compact_block_pool::validate(make_compact_block(block)));
+    BOOST_CHECK_NO_THROW(compact_block_pool::validate(make_compact_block(make_block(1, 0))));
+
+    auto compact_block = make_compact_block(block);
+    compact_block.block_id = make_block(2, 3).id();
+    BOOST_CHECK_THROW(compact_block_pool::validate(compact_block), fc::exception);
+
+    compact_block = make_compact_block(block);
+    compact_block.transaction_ids.clear();
+    BOOST_CHECK_THROW(compact_block_pool::validate(compact_block), fc::exception);
+
+    compact_block = make_compact_block(block);
+    compact_block.transaction_ids[1] = compact_block.transaction_ids[0];
+    BOOST_CHECK_THROW(compact_block_pool::validate(compact_block), fc::exception);
+}
+
+BOOST_AUTO_TEST_CASE(compact_block_restoring) {
+    BOOST_TEST_MESSAGE("Testing: compact_block_restoring");
+
+    const int peer = 0;
+    const auto now = fc::time_point::now();
+    const auto block = make_block(1, 3);
+    const auto compact_block = make_compact_block(block);
+    compact_block_pool pool;
+
+    BOOST_TEST_MESSAGE("--- all transactions are cached");
+    auto result = pool.add(&peer, compact_block, make_finder(block.transactions), now);
+    BOOST_REQUIRE(result.block.valid());
+    BOOST_CHECK(result.block->id() == compact_block.item_hash);
+    BOOST_CHECK(result.block->as<block_message>().block.id() == block.id());
+    BOOST_CHECK_EQUAL(pool.size(), 0);
+
+    BOOST_TEST_MESSAGE("--- the missing transaction is requested");
+    result = pool.add(&peer, compact_block, make_finder({block.transactions[0], block.transactions[2]}), now);
+    BOOST_CHECK(!result.block.valid());
+    BOOST_CHECK((result.missing_indexes == std::vector<uint32_t>{1}));
+    BOOST_CHECK_EQUAL(pool.size(&peer), 1);
+
+    result = pool.add_transactions(&peer, make_transactions(block, {1}), now);
+    BOOST_REQUIRE(result.block.valid());
+    BOOST_CHECK(result.block->id() == compact_block.item_hash);
+    BOOST_CHECK_EQUAL(pool.size(), 0);
+
+    BOOST_TEST_MESSAGE("--- transactions of the block, which isn't waited for, are ignored");
+    result = pool.add_transactions(&peer, make_transactions(block, {1}), now);
+    BOOST_CHECK(!result.block.valid());
+    BOOST_CHECK(result.missing_indexes.empty());
+
+    BOOST_TEST_MESSAGE("--- the wrong index of transaction");
+    pool.add(&peer, compact_block, make_finder({}), now);
+    auto transactions = make_transactions(block, {0});
+    transactions.transaction_indexes[0] = 3;
+    BOOST_CHECK_THROW(pool.add_transactions(&peer, transactions, now), fc::exception);
+    BOOST_CHECK_EQUAL(pool.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(compact_block_with_other_cached_transactions) {
+    BOOST_TEST_MESSAGE("Testing: compact_block_with_other_cached_transactions");
+
+    const int peer = 0;
+    const auto now = fc::time_point::now();
+
+    // the id of transaction doesn't depend on signatures, but the merkle root does
+    auto signed_block = make_block(1, 2);
+    signed_block.transactions[1].signatures.emplace_back();
+    signed_block.transaction_merkle_root = signed_block.calculate_merkle_root();
+    const auto compact_block = make_compact_block(signed_block);
+    const auto unsigned_transactions = make_block(1, 2).transactions;
+
+    compact_block_pool pool;
+    auto result = pool.add(&peer, compact_block, make_finder(unsigned_transactions), now);
+    BOOST_CHECK(!result.block.valid());
+    BOOST_CHECK((result.missing_indexes == std::vector<uint32_t>{0, 1}));
+
+    result = pool.add_transactions(&peer, make_transactions(signed_block, {0, 1}), now);
+    BOOST_REQUIRE(result.block.valid());
+    BOOST_CHECK(result.block->id() == compact_block.item_hash);
+
+    BOOST_TEST_MESSAGE("--- the peer sends wrong transactions again");
+    pool.add(&peer, compact_block, make_finder(unsigned_transactions), now);
+    BOOST_CHECK_THROW(pool.add_transactions(&peer, make_transactions(make_block(1, 2), {0, 1}), now), fc::exception);
+
+    BOOST_TEST_MESSAGE("--- the restored block doesn't match the item hash");
+    auto wrong_hash_block = make_compact_block(signed_block);
+    wrong_hash_block.item_hash = compact_block_message().item_hash;
+    BOOST_CHECK_THROW(pool.add(&peer, wrong_hash_block, make_finder(signed_block.transactions), now), fc::exception);
+}
+
+BOOST_AUTO_TEST_CASE(compact_blocks_per_peer_limit) {
+    BOOST_TEST_MESSAGE("Testing: compact_blocks_per_peer_limit");
+
+    const int peer = 0;
+    const int other_peer = 1;
+    const auto now = fc::time_point::now();
+    compact_block_pool pool(2, fc::seconds(30));
+
+    std::vector<signed_block> blocks;
+    for (uint16_t i = 0; i < 3; ++i) {
+        blocks.push_back(make_block(10 * (i + 1), 2));
+        pool.add(&peer, make_compact_block(blocks.back()), make_finder({}), now + fc::seconds(i));
+    }
+    pool.add(&other_peer, make_compact_block(blocks[0]), make_finder({}), now);
+
+    BOOST_CHECK_EQUAL(pool.size(&peer), 2);
+    BOOST_CHECK_EQUAL(pool.size(&other_peer), 1);
+    BOOST_CHECK_EQUAL(pool.size(), 3);
+
+    // the oldest block of the peer is dropped
+    auto result = pool.add_transactions(&peer, make_transactions(blocks[0], {0, 1}), now + fc::seconds(3));
+    BOOST_CHECK(!result.block.valid());
+    result = pool.add_transactions(&peer, make_transactions(blocks[2], {0, 1}), now + fc::seconds(3));
+    BOOST_CHECK(result.block.valid());
+    result = pool.add_transactions(&other_peer, make_transactions(blocks[0], {0, 1}), now + fc::seconds(3));
+    BOOST_CHECK(result.block.valid());
+
+    pool.remove_peer(&peer);
+    BOOST_CHECK_EQUAL(pool.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(compact_blocks_expiration) {
+    BOOST_TEST_MESSAGE("Testing: compact_blocks_expiration");
+
+    const int peer = 0;
+    const auto now = fc::time_point::now();
+    const auto block = make_block(1, 2);
+    compact_block_pool pool(4, fc::seconds(30));
+
+    pool.add(&peer, make_compact_block(block), make_finder({}), now);
+    BOOST_CHECK_EQUAL(pool.size(), 1);
+
+    auto result = pool.add_transactions(&peer, make_transactions(block, {0, 1}), now + fc::seconds(31));
+    BOOST_CHECK(!result.block.valid());
+    BOOST_CHECK_EQUAL(pool.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(compact_block_cache_of_sent_blocks) {
+    BOOST_TEST_MESSAGE("Testing: compact_block_cache_of_sent_blocks");
+
+    compact_block_cache cache(2);
+    std::vector<block_message> blocks;
+    for (uint16_t i = 0; i < 3; ++i) {
+        blocks.emplace_back(make_block(10 * (i + 1), 2));
+    }
+
+    const auto hash = message(blocks[0]).id();
+    const auto &compact_block = cache.get(blocks[0], hash);
+    BOOST_CHECK(compact_block.block_id == blocks[0].block_id);
+    BOOST_CHECK(compact_block.item_hash == hash);
+    BOOST_CHECK_EQUAL(compact_block.transaction_ids.size(), 2);
+    BOOST_CHECK_EQUAL(&cache.get(blocks[0], hash), &compact_block);
+    BOOST_CHECK_EQUAL(cache.size(), 1);
+
+    cache.get(blocks[1], message(blocks[1]).id());
+    cache.get(blocks[2], message(blocks[2]).id());
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+
+    // the oldest block is evicted
+    cache.get(blocks[0], hash);
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+    BOOST_CHECK(cache.get(blocks[0], hash).item_hash == hash);
+}
+
+BOOST_AUTO_TEST_CASE(pushed_blocks_rate) {
+    BOOST_TEST_MESSAGE("Testing: pushed_blocks_rate");
+
+    const auto now = fc::time_point::now();
+    pushed_block_limiter limiter(2, fc::seconds(3));
+
+    BOOST_CHECK(limiter.allow(now));
+    BOOST_CHECK(limiter.allow(now));
+    BOOST_CHECK(!limiter.allow(now + fc::seconds(2)));
+
+    // one block is allowed after each interval
+    BOOST_CHECK(limiter.allow(now + fc::seconds(3)));
+    BOOST_CHECK(!limiter.allow(now + fc::seconds(4)));
+    BOOST_CHECK(limiter.allow(now + fc::seconds(6)));
+    BOOST_CHECK(!limiter.allow(now + fc::seconds(6)));
+
+    // the limit isn't exceeded after a long pause
+    BOOST_CHECK(limiter.allow(now + fc::seconds(60)));
+    BOOST_CHECK(limiter.allow(now + fc::seconds(60)));
+    BOOST_CHECK(!limiter.allow(now + fc::seconds(60)));
+}
+
+BOOST_AUTO_TEST_CASE(pushed_blocks_from_allowed_peer) {
+    BOOST_TEST_MESSAGE("Testing: pushed_blocks_from_allowed_peer");
+
+    const auto now = fc::time_point::now();
+    pushed_block_limiter limiter(2, fc::seconds(3));
+
+    BOOST_CHECK(limiter.check(true, now) == pushed_block_action::process);
+    BOOST_CHECK(limiter.check(true, now + fc::seconds(1)) == pushed_block_action::process);
+
+    // blocks above the limit are fetched via the inventory, the peer isn't disconnected
+    BOOST_CHECK(limiter.check(true, now + fc::seconds(2)) == pushed_block_action::ignore);
+    BOOST_CHECK(limiter.check(true, now + fc::seconds(3)) == pushed_block_action::process);
+}
+
+BOOST_AUTO_TEST_CASE(pushed_blocks_from_other_peer) {
+    BOOST_TEST_MESSAGE("Testing: pushed_blocks_from_other_peer");
+
+    const auto now = fc::time_point::now();
+    pushed_block_limiter limiter(2, fc::seconds(3));
+
+    BOOST_CHECK(limiter.check(false, now) == pushed_block_action::disconnect);
+
+    // blocks of the disconnected peer aren't counted
+    BOOST_CHECK(limiter.check(true, now) == pushed_block_action::process);
+    BOOST_CHECK(limiter.check(true, now) == pushed_block_action::process);
+    BOOST_CHECK(limiter.check(false, now) == pushed_block_action::disconnect);
+}
+
+BOOST_AUTO_TEST_CASE(sync_block_buffer_size) {
+    BOOST_TEST_MESSAGE("Testing: sync_block_buffer_size");
+
+    const block_message block(make_block(1, 2));
+    const block_message other_block(make_block(10, 2));
+    const uint64_t block_size = fc::raw::pack_size(block.block);
+    sync_block_buffer buffer(2 * block_size);
+
+    BOOST_CHECK(buffer.add(block));
+    BOOST_CHECK(!buffer.add(block));
+    BOOST_CHECK(buffer.contains(block.block_id));
+    BOOST_CHECK_EQUAL(buffer.count(), 1);
+    BOOST_CHECK_EQUAL(buffer.size(), block_size);
+    BOOST_CHECK_EQUAL(buffer.average_block_size(), block_size);
+    BOOST_CHECK(!buffer.is_full());
+
+    BOOST_CHECK(buffer.add(other_block));
+    BOOST_CHECK(buffer.is_full());
+
+    auto taken_block = buffer.take(block.block_id);
+    BOOST_REQUIRE(taken_block.valid());
+    BOOST_CHECK(taken_block->block_id == block.block_id);
+    BOOST_CHECK(!buffer.contains(block.block_id));
+    BOOST_CHECK(!buffer.take(block.block_id).valid());
+    BOOST_CHECK_EQUAL(buffer.count(), 1);
+    BOOST_CHECK(!buffer.is_full());
+
+    BOOST_TEST_MESSAGE("--- the buffer limited by the number of blocks");
+    buffer.set_limits(100 * block_size, 1);
+    BOOST_CHECK(buffer.is_full());
+}
+
+BOOST_AUTO_TEST_CASE(sync_block_requests_striping) {
+    BOOST_TEST_MESSAGE("Testing: sync_block_requests_striping");
+
+    std::vector<block_message> blocks;
+    for (uint16_t i = 0; i < 100; ++i) {
+        blocks.emplace_back(make_block(10 * (i + 1), 1));
+    }
+    const auto item_ids = make_item_ids(blocks);
+    const uint64_t block_size = fc::raw::pack_size(blocks[0].block);
+
+    sync_block_buffer buffer(61 * block_size);
+    buffer.add(blocks[99]);
+    BOOST_CHECK_EQUAL(buffer.average_block_size(), block_size);
+
+    BOOST_TEST_MESSAGE("--- blocks, which fit into the buffer, are split between syncing peers");
+    // 1 received and 10 requested blocks, so 50 blocks fit, 25 blocks per peer
+    auto requests = buffer.select_requests({&item_ids, &item_ids}, 2, 10,
+            [&](const item_hash_t &id) { return id == blocks[0].block_id; });
+    BOOST_REQUIRE_EQUAL(requests.size(), 2);
+    BOOST_REQUIRE_EQUAL(requests[0].size(), 25);
+    BOOST_REQUIRE_EQUAL(requests[1].size(), 25);
+    BOOST_CHECK(requests[0].front() == blocks[1].block_id);
+    BOOST_CHECK(requests[0].back() == blocks[25].block_id);
+    BOOST_CHECK(requests[1].front() == blocks[26].block_id);
+    BOOST_CHECK(requests[1].back() == blocks[50].block_id);
+
+    BOOST_TEST_MESSAGE("--- a busy peer has its share");
+    requests = buffer.select_requests({&item_ids}, 2, 0, is_not_requested);
+    BOOST_REQUIRE_EQUAL(requests[0].size(), 30);
+
+    BOOST_TEST_MESSAGE("--- the number of blocks per peer is limited");
+    requests = buffer.select_requests({&item_ids}, 1, 0, is_not_requested, 20);
+    BOOST_CHECK_EQUAL(requests[0].size(), 20);
+    requests = buffer.select_requests({&item_ids}, 10, 0, is_not_requested);
+    BOOST_CHECK_EQUAL(requests[0].size(), GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING);
+
+    BOOST_TEST_MESSAGE("--- the buffer limited by the number of blocks");
+    buffer.set_limits(61 * block_size, 5);
+    requests = buffer.select_requests({&item_ids}, 1, 0, is_not_requested);
+    BOOST_CHECK_EQUAL(requests[0].size(), GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING);
+}
+
+BOOST_AUTO_TEST_CASE(sync_block_requests_with_full_buffer) {
+    BOOST_TEST_MESSAGE("Testing: sync_block_requests_with_full_buffer");
+
+    std::vector<block_message> blocks;
+    for (uint16_t i = 0; i < 100; ++i) {
+        blocks.emplace_back(make_block(10 * (i + 1), 1));
+    }
+    const auto item_ids = make_item_ids(blocks);
+    const uint64_t block_size = fc::raw::pack_size(blocks[0].block);
+
+    // the buffer is filled by later blocks, the request of the first block has failed
+    sync_block_buffer buffer(40 * block_size);
+    for (uint16_t i = 5; i < 45; ++i) {
+        buffer.add(blocks[i]);
+    }
+    BOOST_REQUIRE(buffer.is_full());
+
+    BOOST_TEST_MESSAGE("--- the lowest missing blocks are requested");
+    auto requests = buffer.select_requests({&item_ids, &item_ids}, 2, 0,
+            [&](const item_hash_t &id) { return id == blocks[1].block_id; });
+    BOOST_REQUIRE_EQUAL(requests.size(), 2);
+    BOOST_CHECK((requests[0] == std::vector<item_hash_t>{blocks[0].block_id, blocks[2].block_id,
+            blocks[3].block_id, blocks[4].block_id}));
+    BOOST_CHECK(requests[1].empty());
+
+    BOOST_TEST_MESSAGE("--- blocks further ahead aren't requested");
+    const auto later_item_ids = make_item_ids(std::vector<block_message>(blocks.begin() + 5, blocks.end()));
+    requests = buffer.select_requests({&later_item_ids}, 1, 0, is_not_requested);
+    BOOST_CHECK(requests[0].empty());
+}
+
+BOOST_AUTO_TEST_CASE(connection_messages_order) {
+    BOOST_TEST_MESSAGE("Testing: connection_messages_order");
+
+    BOOST_TEST_MESSAGE("--- without io threads");
+    {
+        connection_pair connections(nullptr, nullptr);
+        check_messages_order(connections);
+    }
+
+    BOOST_TEST_MESSAGE("--- with io threads");
+    {
+        connection_pair connections(std::make_shared<fc::thread>("sender_io"), std::make_shared<fc::thread>("receiver_io"));
+        check_messages_order(connections);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(connection_is_destroyed_while_message_is_passed) {
+    BOOST_TEST_MESSAGE("Testing: connection_is_destroyed_while_message_is_passed");
+
+    connection_pair connections(nullptr, std::make_shared<fc::thread>("receiver_io"));
+    connections.sender.send_message(make_message(1, 100));
+
+    // the current thread doesn't execute tasks, so the read loop waits for it to pass the message to the delegate
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    connections.receiver.destroy_connection();
+    fc::usleep(fc::milliseconds(100));
+
+    BOOST_CHECK(connections.receiver_delegate.messages.empty());
+    BOOST_CHECK(!connections.receiver_delegate.is_closed);
+}
+
+BOOST_AUTO_TEST_CASE(connection_is_closed_in_io_thread) {
+    BOOST_TEST_MESSAGE("Testing: connection_is_closed_in_io_thread");
+
+    connection_pair connections(std::make_shared<fc::thread>("sender_io"), std::make_shared<fc::thread>("receiver_io"));
+    connections.sender.send_message(make_message(1, 64 * 1024));
+    connections.sender.close_connection();
+    connections.sender.close_connection();
+
+    const auto &received = connections.receiver_delegate;
+    BOOST_REQUIRE(wait_for([&]() { return received.is_closed; }));
+    BOOST_CHECK_EQUAL(received.messages.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(io_thread_count_is_changed_at_runtime) {
+    BOOST_TEST_MESSAGE("Testing: io_thread_count_is_changed_at_runtime");
+
+    io_thread_pool pool;
+    BOOST_CHECK_EQUAL(pool.size(), 0);
+    BOOST_CHECK(!pool.next());
+
+    pool.resize(2);
+    BOOST_CHECK_EQUAL(pool.size(), 2);
+    auto first_thread = pool.next();
+    auto second_thread = pool.next();
+    BOOST_REQUIRE(first_thread && second_thread);
+    BOOST_CHECK(first_thread != second_thread);
+    BOOST_CHECK(pool.next() == first_thread);
+
+    BOOST_TEST_MESSAGE("--- existing connections keep their threads");
+    connection_pair connections(second_thread, second_thread);
+    pool.resize(1);
+    BOOST_CHECK_EQUAL(pool.size(), 1);
+    BOOST_CHECK(pool.next() == first_thread);
+    second_thread.reset();
+    check_messages_order(connections);
+
+    pool.resize(0);
+    BOOST_CHECK_EQUAL(pool.size(), 0);
+    BOOST_CHECK(!pool.next());
+    BOOST_CHECK_EQUAL(first_thread->async([]() { return 1; }).wait(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif